@@ -31,6 +31,37 @@ int main(int argc, char *argv[])
     MyApplication a(argc, argv);
     a.make_all_qmessagebox_texts_selectable();
     date::set_install("tzdata");
+    if (fs::is_regular_file("tzdata.vpz")) {
+        try {
+            vp::text_ui::enable_tz_database("tzdata.vpz");
+        } catch (const std::runtime_error & e) {
+            QMessageBox::warning(nullptr, "tzdata.vpz", QString::fromStdString(fmt::format("Using text tzdata: {}", e.what())));
+        }
+    }
+    if (fs::is_regular_file("locations.csv")) {
+        try {
+            vp::text_ui::LocationDb::load("locations.csv");
+        } catch (const std::runtime_error & e) {
+            QMessageBox::warning(nullptr, "locations.csv", QString::fromStdString(fmt::format("Using built-in locations: {}", e.what())));
+        }
+    }
+    if (fs::is_directory("cache")) {
+        vp::text_ui::enable_disk_cache("cache");
+    }
+    if (fs::is_regular_file("almanac.vpa")) {
+        try {
+            vp::text_ui::enable_almanac("almanac.vpa");
+        } catch (const std::runtime_error &) {
+            // stale or damaged almanac: just calculate everything live
+        }
+    }
+    if (fs::is_regular_file("events.vpe")) {
+        try {
+            vp::text_ui::enable_event_catalog("events.vpe");
+        } catch (const std::runtime_error &) {
+            // same here
+        }
+    }
     MainWindow w;
     w.show();
     return a.exec();
@@ -231,7 +231,7 @@ void MainWindow::recalcVratasForSelectedDateAndLocation() {
     auto location_string = selected_location();
     const auto flags = flagsForCurrentSettings();
 
-    vratas = vp::text_ui::calc(date, location_string, flags);
+    vratas = vp::text_ui::calc_shared(date, location_string, flags);
 }
 
 void MainWindow::refreshAllTabs()
@@ -284,7 +284,7 @@ p.paran { margin-bottom: 0; } /* to ensure "Details->" link is not separated fro
 
     bool first = true;
 
-    for (const auto & vrata : vratas) {
+    for (const auto & vrata : *vratas) {
         if (vrata.has_value()) {
             if (!first) {
                 summary += "<p>&nbsp;</p>";
@@ -385,12 +385,12 @@ int MainWindow::getTableVerticalScrollValue() const
 void MainWindow::refreshTable()
 {
     if (!ui->tableTextBrowser->isVisible()) { return; }
-    std::stringstream s;
+    fmt::memory_buffer html;
     date::year current_year = date::year_month_day{date::floor<date::days>(std::chrono::system_clock::now())}.year();
-    s << vp::Html_Table_Writer{vp::Table_Calendar_Generator::generate(vratas, current_year, custom_dates)};
+    vp::Html_Table_Writer{vp::Table_Calendar_Generator::generate(*vratas, current_year, custom_dates)}.write(html);
 
     int old_scroll_y = getTableVerticalScrollValue();
-    ui->tableTextBrowser->setHtmlForNormalAndSourceView(table_css + QString::fromStdString(s.str()));
+    ui->tableTextBrowser->setHtmlForNormalAndSourceView(table_css + QString::fromUtf8(html.data(), static_cast<int>(html.size())));
     if (QScrollBar * bar = ui->tableTextBrowser->verticalScrollBar(); bar) {
         bar->setValue(old_scroll_y);
     }
@@ -421,36 +421,36 @@ QString html_for_daybyday(const vp::text_ui::DayByDayInfo & info) {
             const auto tithi_until = date::make_zoned(tz, info.tithi_until->round_to_minute());
             auto tithi_until_date{date::floor<date::days>(tithi_until.get_local_time())};
             fmt::format_to(out,
-                           FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
+                           FMT_STRING("<big><b>{}</b></big> until <big><b>{:%H:%M}{}</b></big><br>\n"),
                            info.tithi,
-                           date::format("%H:%M", tithi_until),
+                           tithi_until.get_local_time(),
                            tithi_until_date == sunrise_date ? "" : " next day");
         }
         if (info.tithi2_until) {
             const auto tithi2_until = date::make_zoned(tz, info.tithi2_until->round_to_minute());
             auto tithi2_until_date{date::floor<date::days>(tithi2_until.get_local_time())};
             fmt::format_to(out,
-                           FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
+                           FMT_STRING("<big><b>{}</b></big> until <big><b>{:%H:%M}{}</b></big><br>\n"),
                            info.tithi2,
-                           date::format("%H:%M", tithi2_until),
+                           tithi2_until.get_local_time(),
                            tithi2_until_date == sunrise_date ? "" : " next day");
         }
         if (info.nakshatra_until) {
             const auto until = date::make_zoned(tz, info.nakshatra_until->round_to_minute());
             const auto date = date::floor<date::days>(until.get_local_time());
             fmt::format_to(out,
-                           FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
+                           FMT_STRING("<big><b>{}</b></big> until <big><b>{:%H:%M}{}</b></big><br>\n"),
                            info.nakshatra,
-                           date::format("%H:%M", until),
+                           until.get_local_time(),
                            date == sunrise_date ? "" : " next day");
         }
         if (info.nakshatra2_until) {
             const auto until = date::make_zoned(tz, info.nakshatra2_until->round_to_minute());
             const auto date = date::floor<date::days>(until.get_local_time());
             fmt::format_to(out,
-                           FMT_STRING("<big><b>{}</b></big> until <big><b>{}{}</b></big><br>\n"),
+                           FMT_STRING("<big><b>{}</b></big> until <big><b>{:%H:%M}{}</b></big><br>\n"),
                            info.nakshatra2,
-                           date::format("%H:%M", until),
+                           until.get_local_time(),
                            date == sunrise_date ? "" : " next day");
         }
     }
@@ -597,7 +597,7 @@ void MainWindow::on_locationComboBox_currentIndexChanged(const QString &location
         auto location = vp::text_ui::LocationDb().find_coord(location_arr.data());
         if (location.has_value()) {
             ui->latlong_edit->setCoord({location->latitude, location->longitude});
-            ui->timezone->setText(QString::fromStdString(location->time_zone()->name()));
+            ui->timezone->setText(QString::fromStdString(std::string{location->time_zone()->name()}));
         }
     }
     refreshAllTabs();
@@ -633,12 +633,12 @@ static QDate to_qdate(date::local_days date) {
 
 void MainWindow::on_dateNextEkadashi_clicked()
 {
-    auto next_date = vratas.guess_start_date_for_next_ekadashi(to_local_days(ui->dateEdit->date()));
+    auto next_date = vratas->guess_start_date_for_next_ekadashi(to_local_days(ui->dateEdit->date()));
     ui->dateEdit->setDate(to_qdate(next_date));
 }
 
 void MainWindow::on_datePrevEkadashi_clicked()
 {
-    auto prev_date = vratas.guess_start_date_for_prev_ekadashi(to_local_days(ui->dateEdit->date()));
+    auto prev_date = vratas->guess_start_date_for_prev_ekadashi(to_local_days(ui->dateEdit->date()));
     ui->dateEdit->setDate(to_qdate(prev_date));
 }
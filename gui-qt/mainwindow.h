@@ -9,6 +9,7 @@
 #include "calc-flags.h"
 #include "date-fixed.h"
 #include <fmt/core.h>
+#include <memory>
 #include <QAction>
 #include <QMainWindow>
 
@@ -43,7 +44,8 @@ private slots:
 
 private:
     Ui::MainWindow *ui;
-    vp::VratasForDate vratas;
+    // shared with the result cache, never null
+    std::shared_ptr<const vp::VratasForDate> vratas = std::make_shared<const vp::VratasForDate>();
     bool gui_ready = false; // set to true at the and of the MainWindow constructor
     bool expand_details_in_summary_tab = false;
     QAction * addCustomDatesForTableAction = nullptr;
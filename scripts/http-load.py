@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Simple load generator for the --http server mode.
+
+Opens N keep-alive connections to the server and sends GET requests in a loop
+for the given duration, then prints throughput and latency percentiles.
+
+    vaishnavam-panchangam --http 8080 &
+    scripts/http-load.py --connections 8 --seconds 10 \
+        '/calc_all?date=2024-01-01' '/daybyday?date=2024-01-01&location=Kiev'
+
+Each connection cycles through the given paths. Use --dates to spread
+requests over a range of dates (to measure misses rather than cache hits).
+"""
+
+import argparse
+import datetime
+import http.client
+import threading
+import time
+
+
+def worker(host, port, paths, deadline, latencies, errors, lock):
+    conn = http.client.HTTPConnection(host, port)
+    local = []
+    failed = 0
+    i = 0
+    while time.monotonic() < deadline:
+        path = paths[i % len(paths)]
+        i += 1
+        started = time.monotonic()
+        try:
+            conn.request("GET", path)
+            response = conn.getresponse()
+            response.read()
+            if response.status != 200:
+                failed += 1
+        except (OSError, http.client.HTTPException):
+            failed += 1
+            conn.close()
+            conn = http.client.HTTPConnection(host, port)
+            continue
+        local.append(time.monotonic() - started)
+    conn.close()
+    with lock:
+        latencies.extend(local)
+        errors[0] += failed
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return 0.0
+    index = min(len(sorted_values) - 1, int(len(sorted_values) * p / 100))
+    return sorted_values[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--connections", type=int, default=8)
+    parser.add_argument("--seconds", type=float, default=10.0)
+    parser.add_argument("--dates", type=int, default=0,
+                        help="replace {date} in paths with each of that many consecutive dates starting from --from")
+    parser.add_argument("--from", dest="from_date", default="2024-01-01")
+    parser.add_argument("paths", nargs="*", default=["/calc_all?date=2024-01-01"])
+    args = parser.parse_args()
+
+    paths = args.paths
+    if args.dates:
+        start = datetime.date.fromisoformat(args.from_date)
+        dates = [(start + datetime.timedelta(days=d)).isoformat() for d in range(args.dates)]
+        paths = [p.replace("{date}", d) for d in dates for p in args.paths]
+
+    latencies = []
+    errors = [0]
+    lock = threading.Lock()
+    deadline = time.monotonic() + args.seconds
+    threads = [threading.Thread(target=worker, args=(args.host, args.port, paths[i:] + paths[:i], deadline, latencies, errors, lock))
+               for i in range(args.connections)]
+    started = time.monotonic()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.monotonic() - started
+
+    latencies.sort()
+    print(f"{len(latencies)} requests in {elapsed:.2f}s, {len(latencies) / elapsed:.1f} req/s, {errors[0]} errors")
+    print("latency ms: p50 {:.3f}, p90 {:.3f}, p99 {:.3f}, max {:.3f}".format(
+        *(1000 * percentile(latencies, p) for p in (50, 90, 99, 100))))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Cold-start benchmark: compiled tz database (tzdata.vpz) vs. text tzdata.
+
+Runs the program the given number of times with tzdata.vpz next to it and
+then with tzdata.vpz temporarily moved aside (so that text tzdata is parsed),
+and prints wall time and peak RSS of each variant.
+
+    scripts/startup-bench.py --runs 20 build/vaishnavam-panchangam 2024-01-01 Kiev
+
+Arguments after the program are passed to it as is; pick a query which
+doesn't take long on its own, so that the startup is what is measured.
+"""
+
+import argparse
+import os
+import statistics
+import subprocess
+import time
+
+
+def run_once(command):
+    started = time.monotonic()
+    process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    _, status, usage = os.wait4(process.pid, 0)
+    elapsed = time.monotonic() - started
+    stderr = process.stderr.read().decode(errors="replace")
+    process.stderr.close()
+    if os.waitstatus_to_exitcode(status) != 0:
+        raise SystemExit(f"{' '.join(command)} failed:\n{stderr}")
+    return elapsed, usage.ru_maxrss  # KiB on Linux
+
+
+def measure(command, runs):
+    times = []
+    rss = []
+    for _ in range(runs):
+        elapsed, max_rss = run_once(command)
+        times.append(elapsed)
+        rss.append(max_rss)
+    return times, rss
+
+
+def report(title, times, rss):
+    times = sorted(times)
+    print(f"{title}: wall ms median {1000 * statistics.median(times):.1f}, min {1000 * times[0]:.1f}, "
+          f"max {1000 * times[-1]:.1f}; peak RSS MiB median {statistics.median(rss) / 1024:.1f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--runs", type=int, default=10)
+    parser.add_argument("program")
+    parser.add_argument("args", nargs=argparse.REMAINDER)
+    args = parser.parse_args()
+
+    command = [args.program] + args.args
+    database = os.path.join(os.path.dirname(os.path.abspath(args.program)), "tzdata.vpz")
+    if not os.path.isfile(database):
+        raise SystemExit(f"{database} not found; build it with: {args.program} --build-tzdb tzdata.vpz")
+
+    run_once(command)  # warm up the page cache for both variants
+    report("tzdata.vpz", *measure(command, args.runs))
+
+    moved_aside = database + ".bench"
+    os.rename(database, moved_aside)
+    try:
+        run_once(command)
+        report("text tzdata", *measure(command, args.runs))
+    finally:
+        os.rename(moved_aside, database)
+
+
+if __name__ == "__main__":
+    main()
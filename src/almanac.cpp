@@ -0,0 +1,257 @@
+#include "almanac.h"
+
+#include "binary-record.h"
+#include "disk-cache.h"
+#include "vrata-record.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+namespace vp {
+
+namespace {
+
+constexpr std::uint32_t almanac_magic = 0x4C415056; // "VPAL" when read as little-endian bytes
+constexpr std::size_t almanac_header_size = 4 * 4 + 4 + 4 + 8 + 4 + 8 * 4;
+constexpr std::size_t location_index_size = 8 + 8 + 8;
+constexpr std::size_t entry_size = 4 + 4 + 8;
+
+std::int32_t days_since_epoch(date::local_days d) {
+    return static_cast<std::int32_t>(d.time_since_epoch().count());
+}
+
+date::local_days local_days_from(std::int32_t days) {
+    return date::local_days{date::days{days}};
+}
+
+} // anonymous namespace
+
+Almanac_Writer::Almanac_Writer(fs::path path, std::uint64_t build_id, CalcFlags flags, date::local_days from, date::local_days to)
+    : path_(std::move(path)), build_id_(build_id), flags_(flags), from_(from), to_(to), records_checksum_(fnv1a_64({}))
+{
+    temp_path_ = path_;
+    temp_path_ += ".tmp";
+    out_.open(temp_path_, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        throw std::runtime_error(fmt::format("can't create almanac file '{}'", temp_path_.string()));
+    }
+    // real header is written in finish(), when all the offsets are known
+    const std::string placeholder(almanac_header_size, '\0');
+    write(placeholder);
+}
+
+Almanac_Writer::~Almanac_Writer()
+{
+    if (!finished_) {
+        out_.close();
+        std::error_code ec;
+        fs::remove(temp_path_, ec);
+    }
+}
+
+void Almanac_Writer::write(std::string_view data)
+{
+    out_.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!out_) {
+        throw std::runtime_error(fmt::format("can't write almanac file '{}'", temp_path_.string()));
+    }
+    offset_ += data.size();
+}
+
+void Almanac_Writer::add(const Location & location, date::local_days search_from, const Vrata & vrata)
+{
+    const auto location_fingerprint = fingerprint(location);
+    if (locations_.empty() || locations_.back().fingerprint != location_fingerprint) {
+        const bool seen = std::any_of(locations_.begin(), locations_.end(), [&](const Location_Index & l) {
+            return l.fingerprint == location_fingerprint;
+        });
+        if (seen) {
+            throw std::runtime_error(fmt::format("almanac: vratas for '{}' are not grouped together", location.name));
+        }
+        locations_.push_back(Location_Index{location_fingerprint, entries_.size(), 0});
+    } else if (vrata.date <= entries_.back().date) {
+        throw std::runtime_error(fmt::format("almanac: vratas for '{}' are not sorted by date", location.name));
+    }
+
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    write_vrata(w, vrata);
+    const std::string_view record{buf.data(), buf.size()};
+    records_checksum_ = fnv1a_64(record, records_checksum_);
+    entries_.push_back(Entry{search_from, vrata.date, offset_});
+    ++locations_.back().entry_count;
+    write(record);
+}
+
+void Almanac_Writer::finish()
+{
+    const auto index_offset = offset_;
+    fmt::memory_buffer index;
+    {
+        Record_Writer w{index};
+        for (const auto & location : locations_) {
+            w.u64(location.fingerprint);
+            w.u64(location.first_entry);
+            w.u64(location.entry_count);
+        }
+        for (const auto & entry : entries_) {
+            w.i32(days_since_epoch(entry.search_from));
+            w.i32(days_since_epoch(entry.date));
+            w.u64(entry.record_offset);
+        }
+    }
+    const std::string_view index_data{index.data(), index.size()};
+    write(index_data);
+
+    fmt::memory_buffer header;
+    Record_Writer w{header};
+    w.u32(almanac_magic);
+    w.u32(almanac_format_version);
+    w.u32(vrata_record_version);
+    w.u32(static_cast<std::uint32_t>(flags_));
+    w.i32(days_since_epoch(from_));
+    w.i32(days_since_epoch(to_));
+    w.u64(build_id_);
+    w.u32(static_cast<std::uint32_t>(locations_.size()));
+    w.u64(entries_.size());
+    w.u64(index_offset);
+    w.u64(records_checksum_);
+    w.u64(fnv1a_64(index_data));
+    out_.seekp(0);
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error(fmt::format("can't write almanac file '{}'", temp_path_.string()));
+    }
+    std::error_code ec;
+    fs::rename(temp_path_, path_, ec);
+    if (ec) {
+        throw std::runtime_error(fmt::format("can't rename '{}' to '{}': {}", temp_path_.string(), path_.string(), ec.message()));
+    }
+    finished_ = true;
+}
+
+Almanac::Almanac(const fs::path & path)
+    : file_(path), data_(file_.data())
+{
+    if (data_.size() < almanac_header_size) {
+        throw std::runtime_error(fmt::format("'{}' is not an almanac: too short", path.string()));
+    }
+    Record_Reader r{data_.substr(0, almanac_header_size)};
+    if (r.u32() != almanac_magic) {
+        throw std::runtime_error(fmt::format("'{}' is not an almanac", path.string()));
+    }
+    if (const auto version = r.u32(); version != almanac_format_version) {
+        throw std::runtime_error(fmt::format("almanac '{}' has format version {}, expected {}; rebuild it", path.string(), version, almanac_format_version));
+    }
+    if (const auto version = r.u32(); version != vrata_record_version) {
+        throw std::runtime_error(fmt::format("almanac '{}' has vrata record version {}, expected {}; rebuild it", path.string(), version, vrata_record_version));
+    }
+    flags_ = static_cast<CalcFlags>(r.u32());
+    from_ = local_days_from(r.i32());
+    to_ = local_days_from(r.i32());
+    build_id_ = r.u64();
+    const auto location_count = r.u32();
+    entry_count_ = r.u64();
+    index_offset_ = r.u64();
+    records_checksum_ = r.u64();
+    const auto index_checksum = r.u64();
+
+    const auto index_size = location_count * location_index_size + entry_count_ * entry_size;
+    if (index_offset_ < almanac_header_size || index_offset_ > data_.size() || data_.size() - index_offset_ != index_size) {
+        throw std::runtime_error(fmt::format("almanac '{}' is truncated or damaged", path.string()));
+    }
+    const auto index = data_.substr(index_offset_);
+    if (fnv1a_64(index) != index_checksum) {
+        throw std::runtime_error(fmt::format("almanac '{}': index checksum mismatch", path.string()));
+    }
+    entries_offset_ = index_offset_ + location_count * location_index_size;
+
+    Record_Reader index_reader{index};
+    for (std::uint32_t i = 0; i < location_count; ++i) {
+        const auto location_fingerprint = index_reader.u64();
+        const auto first_entry = index_reader.u64();
+        const auto count = index_reader.u64();
+        if (first_entry > entry_count_ || count > entry_count_ - first_entry) {
+            throw std::runtime_error(fmt::format("almanac '{}': bad location index", path.string()));
+        }
+        locations_.emplace(location_fingerprint, Location_Index{first_entry, count});
+    }
+}
+
+Almanac::~Almanac() = default;
+
+date::local_days Almanac::entry_search_from(std::uint64_t index) const
+{
+    Record_Reader r{data_.substr(entries_offset_ + index * entry_size, 4)};
+    return local_days_from(r.i32());
+}
+
+date::local_days Almanac::entry_date(std::uint64_t index) const
+{
+    Record_Reader r{data_.substr(entries_offset_ + index * entry_size + 4, 4)};
+    return local_days_from(r.i32());
+}
+
+Vrata Almanac::entry_vrata(std::uint64_t index) const
+{
+    Record_Reader entry{data_.substr(entries_offset_ + index * entry_size + 8, 8)};
+    const auto offset = entry.u64();
+    if (offset < almanac_header_size || offset >= index_offset_) {
+        throw std::runtime_error(fmt::format("almanac: bad record offset {} in entry {}", offset, index));
+    }
+    Record_Reader r{data_.substr(offset, index_offset_ - offset)};
+    auto vrata = read_vrata(r);
+    if (!vrata) {
+        throw std::runtime_error(fmt::format("almanac: unexpected error record in entry {}", index));
+    }
+    return std::move(*vrata);
+}
+
+std::optional<Vrata> Almanac::find(date::local_days base_date, const Location & location, CalcFlags flags) const
+{
+    if (flags != flags_) return std::nullopt;
+    const auto found = locations_.find(fingerprint(location));
+    if (found == locations_.end()) return std::nullopt;
+
+    // first entry with vrata date >= base_date
+    auto first = found->second.first_entry;
+    auto count = found->second.entry_count;
+    while (count > 0) {
+        const auto step = count / 2;
+        if (entry_date(first + step) < base_date) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    if (first == found->second.first_entry + found->second.entry_count) return std::nullopt;
+    if (entry_search_from(first) > base_date) return std::nullopt;
+    return entry_vrata(first);
+}
+
+Almanac::Entry Almanac::entry(std::uint64_t index) const
+{
+    if (index >= entry_count_) {
+        throw std::out_of_range(fmt::format("almanac entry {} out of range, there are only {}", index, entry_count_));
+    }
+    const auto location = std::find_if(locations_.begin(), locations_.end(), [&](const auto & l) {
+        return index >= l.second.first_entry && index - l.second.first_entry < l.second.entry_count;
+    });
+    if (location == locations_.end()) {
+        throw std::runtime_error(fmt::format("almanac: entry {} doesn't belong to any location", index));
+    }
+    return Entry{location->first, entry_search_from(index), entry_vrata(index)};
+}
+
+void Almanac::verify_checksums() const
+{
+    const auto records = data_.substr(almanac_header_size, index_offset_ - almanac_header_size);
+    if (fnv1a_64(records) != records_checksum_) {
+        throw std::runtime_error("almanac: records checksum mismatch");
+    }
+}
+
+} // namespace vp
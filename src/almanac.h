@@ -0,0 +1,142 @@
+#ifndef VP_ALMANAC_H
+#define VP_ALMANAC_H
+
+#include "calc-flags.h"
+#include "filesystem-fixed.h"
+#include "location.h"
+#include "mapped-file.h"
+#include "vrata.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vp {
+
+/*
+ * Precomputed vratas in a single read-only file which is memory-mapped
+ * (see mapped-file.h) and used in place: opening it costs one index checksum, a lookup is
+ * a binary search over the location's date index plus decoding a single
+ * vrata record (see vrata-record.h).
+ *
+ * File layout (little-endian, see binary-record.h):
+ *   header (almanac_header_size bytes):
+ *     u32 magic, u32 format version, u32 vrata record version, u32 calc flags,
+ *     i32 from, i32 to (days since epoch, [from, to) is the range covered),
+ *     u64 build id, u32 location count, u64 entry count, u64 index offset,
+ *     u64 checksum of records, u64 checksum of index
+ *   records: vrata records, one per entry
+ *   index:
+ *     location table, one per location: u64 location fingerprint, u64 first entry, u64 entry count
+ *     entries sorted by date within each location: i32 search_from, i32 vrata date, u64 record offset
+ *
+ * Each entry stores the answer of calc_one(base_date, location, flags)
+ * for all base_date in [search_from, vrata date]. Anything else (other
+ * dates, locations, flags) is a miss and has to be calculated live.
+ *
+ * Build id identifies everything the results depend on besides the inputs
+ * (program version, ephemeris, tzdata); it's opaque for the almanac itself.
+ */
+constexpr std::uint32_t almanac_format_version = 1;
+
+class Almanac_Writer {
+public:
+    // Writes to a temporary file next to path, which replaces path in finish().
+    Almanac_Writer(fs::path path, std::uint64_t build_id, CalcFlags flags, date::local_days from, date::local_days to);
+    ~Almanac_Writer();
+    Almanac_Writer(const Almanac_Writer &) = delete;
+    Almanac_Writer & operator=(const Almanac_Writer &) = delete;
+
+    // Vratas must be added grouped by location and sorted by date within each location.
+    void add(const Location & location, date::local_days search_from, const Vrata & vrata);
+    void finish();
+
+    std::uint64_t entry_count() const { return entries_.size(); }
+
+private:
+    struct Location_Index {
+        std::uint64_t fingerprint;
+        std::uint64_t first_entry;
+        std::uint64_t entry_count;
+    };
+    struct Entry {
+        date::local_days search_from;
+        date::local_days date;
+        std::uint64_t record_offset;
+    };
+
+    void write(std::string_view data);
+
+    fs::path path_;
+    fs::path temp_path_;
+    std::ofstream out_;
+    std::uint64_t build_id_;
+    CalcFlags flags_;
+    date::local_days from_;
+    date::local_days to_;
+    std::uint64_t offset_ = 0;
+    std::uint64_t records_checksum_;
+    std::vector<Location_Index> locations_;
+    std::vector<Entry> entries_;
+    bool finished_ = false;
+};
+
+class Almanac {
+public:
+    // Throws std::runtime_error if the file can't be read or it's not an almanac.
+    explicit Almanac(const fs::path & path);
+    ~Almanac();
+    Almanac(const Almanac &) = delete;
+    Almanac & operator=(const Almanac &) = delete;
+
+    std::uint64_t build_id() const { return build_id_; }
+    CalcFlags flags() const { return flags_; }
+    date::local_days from() const { return from_; }
+    date::local_days to() const { return to_; }
+    std::size_t location_count() const { return locations_.size(); }
+    std::uint64_t entry_count() const { return entry_count_; }
+
+    // Stored result of calc_one(base_date, location, flags), nullopt when it's not in the almanac.
+    std::optional<Vrata> find(date::local_days base_date, const Location & location, CalcFlags flags) const;
+
+    struct Entry {
+        std::uint64_t location_fingerprint; // of the location given to Almanac_Writer::add()
+        date::local_days search_from;
+        Vrata vrata;
+    };
+    // index in [0, entry_count())
+    Entry entry(std::uint64_t index) const;
+
+    // Full scan of all records. Throws std::runtime_error on mismatch.
+    void verify_checksums() const;
+
+private:
+    struct Location_Index {
+        std::uint64_t first_entry;
+        std::uint64_t entry_count;
+    };
+
+    date::local_days entry_date(std::uint64_t index) const;
+    date::local_days entry_search_from(std::uint64_t index) const;
+    Vrata entry_vrata(std::uint64_t index) const;
+
+    Mapped_File file_;
+    std::string_view data_;
+    std::uint64_t build_id_ = 0;
+    CalcFlags flags_ = CalcFlags::Default;
+    date::local_days from_;
+    date::local_days to_;
+    std::uint64_t entry_count_ = 0;
+    std::uint64_t index_offset_ = 0;
+    std::uint64_t entries_offset_ = 0;
+    std::uint64_t records_checksum_ = 0;
+    std::unordered_map<std::uint64_t, Location_Index> locations_; // by location fingerprint
+};
+
+} // namespace vp
+
+#endif // VP_ALMANAC_H
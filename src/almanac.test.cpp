@@ -0,0 +1,101 @@
+#include "almanac.h"
+
+#include "catch-formatters.h"
+#include "temp-dir.h"
+
+#include <fstream>
+
+using namespace date;
+using namespace vp;
+
+namespace {
+Vrata test_vrata(local_days date, Chandra_Masa masa, Paksha paksha) {
+    Vrata vrata{date, masa, paksha};
+    vrata.location = udupi_coord;
+    vrata.dates_for_this_paksha.emplace(date + days{4}, NamedDate{"Pūrṇimā", "", "custom"});
+    return vrata;
+}
+
+// Two Udupi vratas, one Kiev vrata.
+void write_test_almanac(const fs::path & path) {
+    Almanac_Writer writer{path, 42, CalcFlags::Default, local_days{2021_y/January/1}, local_days{2021_y/March/1}};
+    writer.add(udupi_coord, local_days{2021_y/January/1}, test_vrata(local_days{2021_y/January/24}, Chandra_Masa::Pausha, Paksha::Shukla));
+    writer.add(udupi_coord, local_days{2021_y/January/27}, test_vrata(local_days{2021_y/February/7}, Chandra_Masa::Pausha, Paksha::Krishna));
+    writer.add(kiev_coord, local_days{2021_y/January/1}, Vrata{local_days{2021_y/January/24}, Chandra_Masa::Pausha, Paksha::Shukla});
+    writer.finish();
+}
+}
+
+TEST_CASE("Almanac finds stored vratas for covered base dates only") {
+    Temp_Dir dir{"almanac-find"};
+    const auto path = dir.path / "test.vpa";
+    write_test_almanac(path);
+    REQUIRE_FALSE(fs::exists(dir.path / "test.vpa.tmp"));
+
+    const Almanac almanac{path};
+    REQUIRE(almanac.build_id() == 42);
+    REQUIRE(almanac.location_count() == 2);
+    REQUIRE(almanac.entry_count() == 3);
+    REQUIRE_NOTHROW(almanac.verify_checksums());
+
+    SECTION("base dates from search_from to vrata date give the same vrata") {
+        for (auto base_date : {local_days{2021_y/January/1}, local_days{2021_y/January/24}}) {
+            const auto vrata = almanac.find(base_date, udupi_coord, CalcFlags::Default);
+            REQUIRE(vrata.has_value());
+            REQUIRE(vrata->date == local_days{2021_y/January/24});
+            REQUIRE(vrata->location.name == udupi_coord.name);
+            REQUIRE(vrata->dates_for_this_paksha.size() == 1);
+        }
+        const auto second = almanac.find(local_days{2021_y/January/27}, udupi_coord, CalcFlags::Default);
+        REQUIRE(second.has_value());
+        REQUIRE(second->date == local_days{2021_y/February/7});
+        REQUIRE(second->paksha == Paksha::Krishna);
+    }
+    SECTION("gaps, dates after the last vrata, other locations and other flags are misses") {
+        REQUIRE_FALSE(almanac.find(local_days{2021_y/January/25}, udupi_coord, CalcFlags::Default));
+        REQUIRE_FALSE(almanac.find(local_days{2021_y/February/8}, udupi_coord, CalcFlags::Default));
+        REQUIRE_FALSE(almanac.find(local_days{2021_y/January/10}, udupi_coord, CalcFlags::RefractionOn));
+        REQUIRE_FALSE(almanac.find(local_days{2021_y/January/10}, dummy_coord, CalcFlags::Default));
+        REQUIRE(almanac.find(local_days{2021_y/January/10}, kiev_coord, CalcFlags::Default));
+    }
+    SECTION("entries can be listed with their locations") {
+        const auto entry = almanac.entry(2);
+        REQUIRE(entry.location_fingerprint == fingerprint(kiev_coord));
+        REQUIRE(entry.search_from == local_days{2021_y/January/1});
+        REQUIRE(entry.vrata.date == local_days{2021_y/January/24});
+    }
+}
+
+TEST_CASE("Almanac_Writer requires vratas grouped by location and sorted by date") {
+    Temp_Dir dir{"almanac-order"};
+    Almanac_Writer writer{dir.path / "test.vpa", 1, CalcFlags::Default, local_days{2021_y/January/1}, local_days{2021_y/March/1}};
+    writer.add(udupi_coord, local_days{2021_y/January/1}, test_vrata(local_days{2021_y/January/24}, Chandra_Masa::Pausha, Paksha::Shukla));
+    REQUIRE_THROWS(writer.add(udupi_coord, local_days{2021_y/January/1}, test_vrata(local_days{2021_y/January/24}, Chandra_Masa::Pausha, Paksha::Shukla)));
+    writer.add(kiev_coord, local_days{2021_y/January/1}, test_vrata(local_days{2021_y/January/24}, Chandra_Masa::Pausha, Paksha::Shukla));
+    REQUIRE_THROWS(writer.add(udupi_coord, local_days{2021_y/January/27}, test_vrata(local_days{2021_y/February/7}, Chandra_Masa::Pausha, Paksha::Krishna)));
+}
+
+TEST_CASE("Almanac detects damaged files") {
+    Temp_Dir dir{"almanac-damaged"};
+    const auto path = dir.path / "test.vpa";
+    write_test_almanac(path);
+    const auto size = fs::file_size(path);
+
+    SECTION("truncated") {
+        fs::resize_file(path, size - 1);
+        REQUIRE_THROWS_AS(Almanac{path}, std::runtime_error);
+    }
+    SECTION("damaged record is found by full check") {
+        {
+            std::fstream f{path, std::ios::binary | std::ios::in | std::ios::out};
+            f.seekp(100);
+            f.put('\xff');
+        }
+        const Almanac almanac{path};
+        REQUIRE_THROWS_AS(almanac.verify_checksums(), std::runtime_error);
+    }
+    SECTION("not an almanac at all") {
+        std::ofstream{path, std::ios::binary | std::ios::trunc} << "hello, world! this is definitely not an almanac file, just some text";
+        REQUIRE_THROWS_AS(Almanac{path}, std::runtime_error);
+    }
+}
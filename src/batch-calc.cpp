@@ -0,0 +1,164 @@
+#include "batch-calc.h"
+
+#include "binary-record.h"
+#include "nameworthy-dates.h"
+#include "text-interface.h"
+#include "vrata-record.h"
+
+#include <chrono>
+#include <optional>
+
+namespace vp {
+
+namespace {
+
+struct Shard {
+    std::size_t location_index;
+    date::local_days from;
+    date::local_days to;
+};
+
+std::string encode_task(const Shard & shard, const Location & location, CalcFlags flags) {
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    w.u32(static_cast<std::uint32_t>(shard.location_index));
+    write_location(w, location);
+    w.u32(static_cast<std::uint32_t>(flags));
+    w.i32(static_cast<std::int32_t>(shard.from.time_since_epoch().count()));
+    w.i32(static_cast<std::int32_t>(shard.to.time_since_epoch().count()));
+    return fmt::to_string(buf);
+}
+
+struct Shard_Vrata {
+    date::local_days search_from;
+    MaybeVrata vrata;
+};
+
+// Runs in the worker process. Result is u32 count followed by that many
+// (i32 search_from, vrata record) pairs.
+void calc_shard(std::string_view task, fmt::memory_buffer & out) {
+    Record_Reader r{task};
+    r.u32(); // location index, only needed by the coordinator
+    const auto location = read_location(r);
+    const auto flags = static_cast<CalcFlags>(r.u32());
+    const date::local_days from{date::days{r.i32()}};
+    const date::local_days to{date::days{r.i32()}};
+
+    std::vector<Shard_Vrata> vratas;
+    for (auto base_date = from; base_date < to;) {
+        auto vrata = text_ui::calc_one(base_date, location, flags);
+        if (!vrata) {
+            // Can't know where to continue from, so report the error and give up on this shard.
+            vratas.push_back(Shard_Vrata{base_date, std::move(vrata)});
+            break;
+        }
+        if (vrata->date >= to) break;
+        vrata->dates_for_this_paksha = nameworthy_dates_for_this_paksha(*vrata, flags);
+        vratas.push_back(Shard_Vrata{base_date, std::move(vrata)});
+        // +3 days gets us past dvādaśī and pāraṇam even for two-day vratas,
+        // and it's still way before the next ekādaśī.
+        base_date = vratas.back().vrata->date + date::days{3};
+    }
+
+    Record_Writer w{out};
+    w.u32(static_cast<std::uint32_t>(vratas.size()));
+    for (const auto & vrata : vratas) {
+        w.i32(static_cast<std::int32_t>(vrata.search_from.time_since_epoch().count()));
+        write_vrata(w, vrata.vrata);
+    }
+}
+
+std::vector<Shard_Vrata> decode_shard_result(std::string_view data) {
+    Record_Reader r{data};
+    std::vector<Shard_Vrata> vratas;
+    const auto count = r.u32();
+    vratas.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const date::local_days search_from{date::days{r.i32()}};
+        vratas.push_back(Shard_Vrata{search_from, read_vrata(r)});
+    }
+    return vratas;
+}
+
+// Just enough of the previous entry to recognize the same vrata again.
+struct Previous_Vrata {
+    std::size_t location_index;
+    Chandra_Masa masa;
+    Paksha paksha;
+    date::local_days date;
+};
+
+// Shard boundaries may cut through a two-day vrata so that both neighbouring
+// shards find it (starting on different dates). Keep only the first one.
+bool is_same_vrata_as_previous(const std::optional<Previous_Vrata> & prev, const Batch_Entry & entry) {
+    if (!prev || !entry.vrata) return false;
+    if (prev->location_index != entry.location_index) return false;
+    return prev->masa == entry.vrata->masa
+        && prev->paksha == entry.vrata->paksha
+        && entry.vrata->date - prev->date <= date::days{3};
+}
+
+} // anonymous namespace
+
+Batch_Result batch_calc(const Batch_Request & request, const Batch_Entry_Fn & on_entry)
+{
+    const auto started = std::chrono::steady_clock::now();
+
+    std::vector<Shard> shards;
+    for (std::size_t i = 0; i < request.locations.size(); ++i) {
+        for (auto from = request.from; from < request.to; from += request.shard_length) {
+            shards.push_back(Shard{i, from, std::min(from + request.shard_length, request.to)});
+        }
+    }
+    std::vector<std::string> tasks;
+    tasks.reserve(shards.size());
+    for (const auto & shard : shards) {
+        tasks.push_back(encode_task(shard, request.locations[shard.location_index], request.flags));
+    }
+
+    Batch_Result result;
+    std::vector<std::size_t> vratas_by_worker;
+    std::optional<Previous_Vrata> prev;
+    // Shard results arrive here in the order of shards.
+    auto handle_result = [&](std::size_t i, Process_Pool::Task_Result && task_result) {
+        const auto & shard = shards[i];
+        if (!task_result.ok) {
+            result.failures.push_back(Batch_Failure{shard.location_index, shard.from, shard.to, std::move(task_result.data)});
+            return;
+        }
+        std::vector<Shard_Vrata> vratas;
+        try {
+            vratas = decode_shard_result(task_result.data);
+        } catch (const std::exception & e) {
+            result.failures.push_back(Batch_Failure{shard.location_index, shard.from, shard.to, e.what()});
+            return;
+        }
+        if (vratas_by_worker.size() <= task_result.worker) vratas_by_worker.resize(task_result.worker + 1);
+        vratas_by_worker[task_result.worker] += vratas.size();
+        for (auto & vrata : vratas) {
+            Batch_Entry entry{shard.location_index, std::move(vrata.vrata), vrata.search_from};
+            if (is_same_vrata_as_previous(prev, entry)) continue;
+            if (entry.vrata) {
+                prev = Previous_Vrata{entry.location_index, entry.vrata->masa, entry.vrata->paksha, entry.vrata->date};
+            } else {
+                prev.reset();
+            }
+            if (on_entry) {
+                on_entry(std::move(entry));
+            } else {
+                result.entries.push_back(std::move(entry));
+            }
+        }
+    };
+
+    Process_Pool pool{request.workers, calc_shard};
+    pool.run(tasks, handle_result);
+
+    for (std::size_t worker = 0; worker < pool.stats().size(); ++worker) {
+        result.workers.push_back(Batch_Worker_Summary{pool.stats()[worker], worker < vratas_by_worker.size() ? vratas_by_worker[worker] : 0});
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+} // namespace vp
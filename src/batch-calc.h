@@ -0,0 +1,66 @@
+#ifndef VP_BATCH_CALC_H
+#define VP_BATCH_CALC_H
+
+#include "calc-flags.h"
+#include "location.h"
+#include "process-pool.h"
+#include "vrata.h"
+
+#include <functional>
+#include <vector>
+
+namespace vp {
+
+// Calculate all vratas in [from, to) for given locations using several worker processes.
+struct Batch_Request {
+    date::local_days from;
+    date::local_days to; // exclusive
+    std::vector<Location> locations;
+    CalcFlags flags = CalcFlags::Default;
+    unsigned workers = Process_Pool::default_worker_count();
+    // (date × location) grid is split into shards of one location
+    // and this many days; each shard is a single task for a worker.
+    date::days shard_length{91};
+};
+
+struct Batch_Entry {
+    std::size_t location_index; // index in Batch_Request::locations
+    MaybeVrata vrata;
+    // Base date of the search which found this vrata. Searching from any
+    // date in [search_from, vrata->date] gives the same vrata.
+    date::local_days search_from{};
+};
+
+// Shard which couldn't be calculated at all: exception or worker crash.
+struct Batch_Failure {
+    std::size_t location_index;
+    date::local_days from;
+    date::local_days to;
+    std::string reason;
+};
+
+struct Batch_Worker_Summary {
+    Process_Pool::Worker_Stats process;
+    std::size_t vratas = 0;
+};
+
+struct Batch_Result {
+    // Ordered by location (in the order of Batch_Request::locations), then by date.
+    // Order doesn't depend on number of workers or on their timing.
+    std::vector<Batch_Entry> entries;
+    std::vector<Batch_Failure> failures;
+    std::vector<Batch_Worker_Summary> workers;
+    double seconds = 0.0;
+};
+
+// Called with entries in the same order as in Batch_Result::entries, as soon as
+// the shard they come from and all shards before it are done.
+using Batch_Entry_Fn = std::function<void(Batch_Entry && entry)>;
+
+// When on_entry is given, entries go there instead of Batch_Result::entries,
+// so memory use doesn't grow with the number of vratas.
+Batch_Result batch_calc(const Batch_Request & request, const Batch_Entry_Fn & on_entry = {});
+
+} // namespace vp
+
+#endif // VP_BATCH_CALC_H
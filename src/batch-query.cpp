@@ -0,0 +1,223 @@
+#include "batch-query.h"
+
+#include "binary-record.h"
+#include "nameworthy-dates.h"
+#include "process-pool.h"
+#include "text-interface.h"
+#include "tz-fixed.h"
+#include "vrata-json.h"
+#include "vrata-record.h"
+
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace vp::text_ui {
+
+namespace {
+
+struct Flag_Name {
+    std::string_view name;
+    CalcFlags flag;
+};
+
+constexpr Flag_Name flag_names[] = {
+    {"disc-edge", CalcFlags::SunriseByDiscEdge},
+    {"refraction", CalcFlags::RefractionOn},
+    {"moshier", CalcFlags::EphemerisMoshier},
+    {"geocentric-rise-set", CalcFlags::RiseSetGeocentricOn},
+    {"shravana-14gh", CalcFlags::ShravanaDvadashi14ghPlus},
+};
+
+std::vector<std::string_view> split_words(std::string_view line) {
+    std::vector<std::string_view> words;
+    constexpr std::string_view whitespace{" \t\r"};
+    while (true) {
+        const auto start = line.find_first_not_of(whitespace);
+        if (start == std::string_view::npos) break;
+        line.remove_prefix(start);
+        const auto end = std::min(line.find_first_of(whitespace), line.size());
+        words.push_back(line.substr(0, end));
+        line.remove_prefix(end);
+    }
+    return words;
+}
+
+std::optional<CalcFlags> find_flag(std::string_view word) {
+    for (const auto & [name, flag] : flag_names) {
+        if (word == name) return flag;
+    }
+    return std::nullopt;
+}
+
+CalcFlags parse_flag(std::string_view word) {
+    if (const auto flag = find_flag(word)) return *flag;
+    throw std::runtime_error(fmt::format("unknown flag '{}'", word));
+}
+
+// Text of line from the start of words[first] to the end of words[last - 1] (words point into line).
+std::string_view words_text(const std::vector<std::string_view> & words, std::size_t first, std::size_t last) {
+    return {words[first].data(), static_cast<std::size_t>(words[last - 1].data() + words[last - 1].size() - words[first].data())};
+}
+
+// Location names may contain spaces, e.g. "Stary Oskol", so the name is either
+// quoted or the longest run of words starting at words[first] which is a known
+// location; the rest are flags. Returns index of the first word after the name.
+std::size_t parse_location_name(std::string_view line, const std::vector<std::string_view> & words, std::size_t first, std::string & name) {
+    if (words[first].front() == '"') {
+        const auto start = static_cast<std::size_t>(words[first].data() - line.data()) + 1;
+        const auto end = line.find('"', start);
+        if (end == std::string_view::npos || (end + 1 < line.size() && line.find_first_of(" \t\r", end + 1) != end + 1)) {
+            throw std::runtime_error("closing quote and a space or end of line expected after location name");
+        }
+        name = std::string{line.substr(start, end - start)};
+        if (!LocationDb::find_coord(name.c_str())) {
+            throw std::runtime_error(fmt::format("location not found: '{}'", name));
+        }
+        std::size_t next = first;
+        while (next < words.size() && words[next].data() <= line.data() + end) ++next;
+        return next;
+    }
+    for (std::size_t last = words.size(); last > first; --last) {
+        name = std::string{words_text(words, first, last)};
+        if (LocationDb::find_coord(name.c_str())) return last;
+    }
+    // not found: report it without the flags at the end, if any
+    std::size_t last = words.size();
+    while (last > first + 1 && find_flag(words[last - 1])) --last;
+    throw std::runtime_error(fmt::format("location not found: '{}'", words_text(words, first, last)));
+}
+
+// Task: u32 flags, i32 date, u8 has_location_name, then either str location_name or location record.
+std::string encode_task(const Batch_Query & query) {
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    w.u32(static_cast<std::uint32_t>(query.flags));
+    w.i32(static_cast<std::int32_t>(date::local_days{query.date}.time_since_epoch().count()));
+    w.u8(query.location_name.empty() ? 0 : 1);
+    if (!query.location_name.empty()) {
+        w.str(query.location_name);
+    } else {
+        write_location(w, Location{Latitude{query.latitude}, Longitude{query.longitude}, "Custom Location", query.time_zone_name.c_str()});
+    }
+    return fmt::to_string(buf);
+}
+
+// Runs in the worker process, result is JSON of the vrata.
+void run_query(std::string_view task, fmt::memory_buffer & out) {
+    Record_Reader r{task};
+    const auto flags = static_cast<CalcFlags>(r.u32());
+    const date::local_days date{date::days{r.i32()}};
+    Json_Writer w{out};
+    if (r.u8() != 0) {
+        // named locations go through the result cache (and disk cache, if enabled)
+        const auto vratas = calc_shared(date::year_month_day{date}, std::string{r.str()}, flags);
+        write_json(w, *vratas->begin());
+    } else {
+        const auto location = read_location(r);
+        auto vrata = calc_one(date, location, flags);
+        if (vrata) {
+            vrata->dates_for_this_paksha = nameworthy_dates_for_this_paksha(*vrata, flags);
+        }
+        write_json(w, vrata);
+    }
+}
+
+std::string error_line(std::size_t line, std::string_view error) {
+    fmt::memory_buffer buf;
+    Json_Writer{buf}.begin_object().key("line").value(static_cast<std::uint64_t>(line)).key("error").value(error).end_object();
+    buf.push_back('\n');
+    return fmt::to_string(buf);
+}
+
+} // anonymous namespace
+
+std::optional<Batch_Query> parse_batch_query(std::string_view line) {
+    const auto words = split_words(line);
+    if (words.empty() || words[0].front() == '#') return std::nullopt;
+
+    Batch_Query query;
+    query.date = parse_ymd(words[0]);
+    if (!query.date.ok()) {
+        throw std::runtime_error(fmt::format("bad date '{}', expected YYYY-MM-DD", words[0]));
+    }
+    if (words.size() < 2) {
+        throw std::runtime_error("location name or coordinates expected after the date");
+    }
+    std::size_t flags_start;
+    if (const auto latitude = parse_degrees(words[1])) {
+        if (words.size() < 4) {
+            throw std::runtime_error("expected latitude, longitude and time zone after the date");
+        }
+        const auto longitude = parse_degrees(words[2]);
+        if (!longitude || *latitude < -90.0 || *latitude > 90.0 || *longitude < -180.0 || *longitude > 180.0) {
+            throw std::runtime_error(fmt::format("bad coordinates '{} {}'", words[1], words[2]));
+        }
+        query.latitude = *latitude;
+        query.longitude = *longitude;
+        query.time_zone_name = std::string{words[3]};
+        // throws for unknown time zone
+        locate_time_zone(query.time_zone_name);
+        flags_start = 4;
+    } else {
+        flags_start = parse_location_name(line, words, 1, query.location_name);
+    }
+    for (std::size_t i = flags_start; i < words.size(); ++i) {
+        query.flags = query.flags | parse_flag(words[i]);
+    }
+    return query;
+}
+
+Batch_Query_Summary run_batch_queries(std::istream & in, unsigned workers, const std::function<void(std::string_view)> & write_line) {
+    const auto started = std::chrono::steady_clock::now();
+    Batch_Query_Summary summary;
+
+    // Bad queries are answered right away, but only when their turn comes in the output.
+    struct Entry {
+        std::size_t line;
+        std::optional<std::size_t> task; // index in tasks, none for bad query
+        std::string error;
+    };
+    std::vector<Entry> entries;
+    std::vector<std::string> tasks;
+    std::string line;
+    for (std::size_t line_number = 1; std::getline(in, line); ++line_number) {
+        try {
+            if (auto query = parse_batch_query(line)) {
+                query->line = line_number;
+                entries.push_back(Entry{line_number, tasks.size(), {}});
+                tasks.push_back(encode_task(*query));
+            }
+        } catch (const std::exception & e) {
+            entries.push_back(Entry{line_number, std::nullopt, e.what()});
+        }
+    }
+    summary.queries = entries.size();
+
+    std::size_t next_entry = 0;
+    auto write_errors_before_next_task = [&]() {
+        for (; next_entry < entries.size() && !entries[next_entry].task; ++next_entry) {
+            ++summary.errors;
+            write_line(error_line(entries[next_entry].line, entries[next_entry].error));
+        }
+    };
+    write_errors_before_next_task();
+
+    Process_Pool pool{workers, run_query};
+    pool.run(tasks, [&](std::size_t, Process_Pool::Task_Result && result) {
+        const auto & entry = entries[next_entry++];
+        if (!result.ok) {
+            ++summary.errors;
+            write_line(error_line(entry.line, result.data));
+        } else {
+            write_line(fmt::format("{{\"line\":{},\"vrata\":{}}}\n", entry.line, result.data));
+        }
+        write_errors_before_next_task();
+    });
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return summary;
+}
+
+} // namespace vp::text_ui
@@ -0,0 +1,59 @@
+#ifndef VP_BATCH_QUERY_H
+#define VP_BATCH_QUERY_H
+
+#include "calc-flags.h"
+#include "location.h"
+
+#include <functional>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace vp::text_ui {
+
+/*
+ * Many independent (date, location) queries per process (--batch mode).
+ *
+ * Input is one query per line, whitespace-separated:
+ *
+ *     YYYY-MM-DD location-name [flag...]
+ *     YYYY-MM-DD "location-name" [flag...]
+ *     YYYY-MM-DD latitude longitude time-zone [flag...]
+ *
+ * Location names may contain spaces: unquoted, the name is the longest run
+ * of words after the date which is a known location. latitude/longitude are decimal degrees, negative for S/W. Flags are
+ * "disc-edge", "refraction", "moshier", "geocentric-rise-set", "shravana-14gh"
+ * (see CalcFlags). Empty lines and lines starting with '#' are skipped.
+ *
+ * Output is one JSON object per query (NDJSON), in input order:
+ *
+ *     {"line":1,"vrata":{...}}   (see vrata-json.h)
+ *     {"line":2,"error":"..."}
+ */
+struct Batch_Query {
+    std::size_t line = 0; // 1-based line number in the input
+    date::year_month_day date;
+    std::string location_name; // empty for custom coordinates
+    double latitude = 0.0;
+    double longitude = 0.0;
+    std::string time_zone_name;
+    CalcFlags flags = CalcFlags::Default;
+};
+
+// std::nullopt for empty and comment lines. Throws std::runtime_error with human-readable reason on bad query.
+std::optional<Batch_Query> parse_batch_query(std::string_view line);
+
+struct Batch_Query_Summary {
+    std::size_t queries = 0;
+    std::size_t errors = 0;
+    double seconds = 0.0;
+};
+
+// Run all queries from `in` on `workers` processes, call write_line() with each
+// NDJSON line (including "\n") in input order, as soon as it and all lines before it are ready.
+Batch_Query_Summary run_batch_queries(std::istream & in, unsigned workers, const std::function<void(std::string_view)> & write_line);
+
+} // namespace vp::text_ui
+
+#endif // VP_BATCH_QUERY_H
@@ -0,0 +1,66 @@
+#include "batch-query.h"
+
+#include "catch-formatters.h"
+
+using Catch::Matchers::Contains;
+using vp::text_ui::parse_batch_query;
+
+TEST_CASE("batch query: empty and comment lines are skipped") {
+    REQUIRE_FALSE(parse_batch_query(""));
+    REQUIRE_FALSE(parse_batch_query("   \t"));
+    REQUIRE_FALSE(parse_batch_query("# 2020-11-12 Kiev"));
+}
+
+TEST_CASE("batch query: named location") {
+    const auto query = parse_batch_query("2020-11-12 Kiev");
+    REQUIRE(query);
+    REQUIRE(query->date == date::year_month_day{date::year{2020}, date::November, date::day{12}});
+    REQUIRE(query->location_name == "Kiev");
+    REQUIRE(query->flags == vp::CalcFlags::Default);
+}
+
+TEST_CASE("batch query: custom coordinates and flags") {
+    const auto query = parse_batch_query("2020-11-12 50.45 -30.5 Europe/Kiev\tmoshier refraction\r");
+    REQUIRE(query);
+    REQUIRE(query->location_name.empty());
+    REQUIRE(query->latitude == 50.45);
+    REQUIRE(query->longitude == -30.5);
+    REQUIRE(query->time_zone_name == "Europe/Kiev");
+    REQUIRE(query->flags == (vp::CalcFlags::EphemerisMoshier | vp::CalcFlags::RefractionOn));
+}
+
+TEST_CASE("batch query: bad queries throw with the reason") {
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-13-45 Kiev"), Contains("bad date '2020-13-45'"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12"), Contains("location"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 NoSuchPlace"), Contains("location not found: 'NoSuchPlace'"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 50.45 30.5"), Contains("time zone"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 95 30.5 UTC"), Contains("bad coordinates"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 50.45 nan UTC"), Contains("bad coordinates"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 50.45 -inf UTC"), Contains("bad coordinates"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 50.45 0x1e UTC"), Contains("bad coordinates"));
+    // not a number at all, so it's taken for a location name
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-01-01 nan nan UTC"), Contains("location not found"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 Kiev fast"), Contains("unknown flag 'fast'"));
+}
+
+TEST_CASE("batch query: location names with spaces, unquoted and quoted") {
+    const auto query = parse_batch_query("2020-11-12 Stary Oskol");
+    REQUIRE(query);
+    REQUIRE(query->location_name == "Stary Oskol");
+    REQUIRE(query->flags == vp::CalcFlags::Default);
+
+    const auto with_flags = parse_batch_query("2020-11-12 Dillingen an der Donau moshier refraction");
+    REQUIRE(with_flags);
+    REQUIRE(with_flags->location_name == "Dillingen an der Donau");
+    REQUIRE(with_flags->flags == (vp::CalcFlags::EphemerisMoshier | vp::CalcFlags::RefractionOn));
+
+    const auto quoted = parse_batch_query("2020-11-12 \"Velikiy Novgorod\"\tmoshier");
+    REQUIRE(quoted);
+    REQUIRE(quoted->location_name == "Velikiy Novgorod");
+    REQUIRE(quoted->flags == vp::CalcFlags::EphemerisMoshier);
+
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 Stary Oskol fast"), Contains("unknown flag 'fast'"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 No Such Place moshier"), Contains("location not found: 'No Such Place'"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 \"Stary Oskol"), Contains("closing quote"));
+    REQUIRE_THROWS_WITH(parse_batch_query("2020-11-12 \"Stary Oskol\"moshier"), Contains("closing quote"));
+}
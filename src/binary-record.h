@@ -0,0 +1,113 @@
+#ifndef VP_BINARY_RECORD_H
+#define VP_BINARY_RECORD_H
+
+#include "fmt-format-fixed.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace vp {
+
+/*
+ * Minimal encoder for compact binary records. All integers are written
+ * little-endian regardless of host byte order, doubles are written as their
+ * IEEE-754 bit pattern, strings as u32 length followed by raw UTF-8 bytes.
+ * No field names, no alignment: the reader must know the exact layout.
+ */
+class Record_Writer {
+public:
+    explicit Record_Writer(fmt::memory_buffer & out) : out_(out) {}
+
+    void u8(std::uint8_t v) {
+        out_.push_back(static_cast<char>(v));
+    }
+    void u32(std::uint32_t v) {
+        for (unsigned shift = 0; shift < 32; shift += 8) {
+            out_.push_back(static_cast<char>((v >> shift) & 0xFFu));
+        }
+    }
+    void u64(std::uint64_t v) {
+        for (unsigned shift = 0; shift < 64; shift += 8) {
+            out_.push_back(static_cast<char>((v >> shift) & 0xFFu));
+        }
+    }
+    void i32(std::int32_t v) {
+        u32(static_cast<std::uint32_t>(v));
+    }
+    void f64(double v) {
+        std::uint64_t bits;
+        static_assert(sizeof(bits) == sizeof(v));
+        std::memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+    void str(std::string_view s) {
+        u32(static_cast<std::uint32_t>(s.size()));
+        out_.append(s.data(), s.data() + s.size());
+    }
+
+private:
+    fmt::memory_buffer & out_;
+};
+
+// Counterpart of Record_Writer. Throws std::runtime_error on truncated input.
+class Record_Reader {
+public:
+    explicit Record_Reader(std::string_view data) : data_(data) {}
+
+    std::uint8_t u8() {
+        return static_cast<std::uint8_t>(*take(1));
+    }
+    std::uint32_t u32() {
+        const auto * p = reinterpret_cast<const unsigned char *>(take(4));
+        std::uint32_t v = 0;
+        for (unsigned i = 0; i < 4; ++i) {
+            v |= static_cast<std::uint32_t>(p[i]) << (8*i);
+        }
+        return v;
+    }
+    std::uint64_t u64() {
+        const auto * p = reinterpret_cast<const unsigned char *>(take(8));
+        std::uint64_t v = 0;
+        for (unsigned i = 0; i < 8; ++i) {
+            v |= static_cast<std::uint64_t>(p[i]) << (8*i);
+        }
+        return v;
+    }
+    std::int32_t i32() {
+        return static_cast<std::int32_t>(u32());
+    }
+    double f64() {
+        const std::uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    // Returned view points into the original data, copy it if it must outlive the data.
+    std::string_view str() {
+        const auto len = u32();
+        const char * p = take(len);
+        return std::string_view{p, len};
+    }
+
+    bool at_end() const { return pos_ == data_.size(); }
+    std::size_t position() const { return pos_; }
+
+private:
+    const char * take(std::size_t n) {
+        if (data_.size() - pos_ < n) {
+            throw std::runtime_error(fmt::format("truncated binary record: need {} more bytes at offset {}, but only {} left", n, pos_, data_.size() - pos_));
+        }
+        const char * p = data_.data() + pos_;
+        pos_ += n;
+        return p;
+    }
+
+    std::string_view data_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace vp
+
+#endif // VP_BINARY_RECORD_H
@@ -194,8 +194,7 @@ Vrata_Time_Points Calc::calc_key_times_from_sunset_and_sunrise(JulDays_UT sunset
  */
 date::local_days Calc::get_vrata_date(const JulDays_UT sunrise) const
 {
-    auto zoned = sunrise.as_zoned_time(swe.location.time_zone());
-    return date::floor<date::days>(zoned.get_local_time());
+    return date::floor<date::days>(sunrise.as_local_time(swe.location.time_zone()));
 }
 
 Vrata_Type Calc::calc_vrata_type(const Vrata &vrata) const
@@ -384,7 +383,16 @@ JulDays_UT find_time_with_given_value(
 
 }
 
+const Event_Catalog * Calc::usable_catalog() const
+{
+    if (!catalog || (swe.calc_flags & CalcFlags::EphemerisMask) != catalog->ephemeris()) return nullptr;
+    return catalog;
+}
+
 JulDays_UT Calc::find_exact_tithi_start(JulDays_UT from, Tithi tithi) const {
+    if (const auto * c = usable_catalog()) {
+        if (const auto found = c->find_tithi_start(from, tithi, false)) return *found;
+    }
     return find_time_with_given_value(
         from,
         tithi,
@@ -396,19 +404,22 @@ JulDays_UT Calc::find_exact_tithi_start(JulDays_UT from, Tithi tithi) const {
         [](Tithi & /*target*/, double & /*delta*/) {} );
 }
 
-tl::expected<date::local_days, CalcError> Calc::find_exact_tithi_date(const JulDays_UT from, const DiscreteTithi tithi, const date::time_zone * tz) const
+tl::expected<date::local_days, CalcError> Calc::find_exact_tithi_date(const JulDays_UT from, const DiscreteTithi tithi, const Time_Zone * tz) const
 {
     const auto tithi_start = find_exact_tithi_start(from, Tithi{tithi});
     const auto sunrise = swe.next_sunrise(tithi_start);
     if (!sunrise) {
         return tl::make_unexpected(sunrise.error());
     }
-    const auto date = date::floor<date::days>(sunrise->as_zoned_time(tz).get_local_time());
+    const auto date = date::floor<date::days>(sunrise->as_local_time(tz));
     return date;
 }
 
 JulDays_UT Calc::find_either_tithi_start(JulDays_UT from, Tithi tithi) const
 {
+    if (const auto * c = usable_catalog()) {
+        if (const auto found = c->find_tithi_start(from, tithi, true)) return *found;
+    }
     return find_time_with_given_value(
         from,
         tithi,
@@ -428,6 +439,9 @@ JulDays_UT Calc::find_either_tithi_start(JulDays_UT from, Tithi tithi) const
 
 JulDays_UT Calc::find_nakshatra_start(const JulDays_UT from, const Nakshatra target_nakshatra) const
 {
+    if (const auto * c = usable_catalog()) {
+        if (const auto found = c->find_nakshatra_start(from, target_nakshatra)) return *found;
+    }
     return find_time_with_given_value(
         from,
         target_nakshatra,
@@ -442,6 +456,9 @@ JulDays_UT Calc::find_nakshatra_start(const JulDays_UT from, const Nakshatra tar
 
 JulDays_UT Calc::find_sankranti(JulDays_UT after, Saura_Masa masa) const
 {
+    if (const auto * c = usable_catalog()) {
+        if (const auto found = c->find_sankranti(after, masa)) return *found;
+    }
     auto target_longitude = starting_longitude(masa);
     constexpr auto average_saura_masa_length_per_degree = date::years{1} / 360.0;
     return find_time_with_given_value(
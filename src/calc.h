@@ -3,6 +3,7 @@
 
 #include "location.h"
 #include "date-fixed.h"
+#include "event-catalog.h"
 #include "masa.h"
 #include "nakshatra.h"
 #include "swe.h"
@@ -58,7 +59,7 @@ public:
     JulDays_UT find_either_tithi_start(JulDays_UT, Tithi) const;
     // find exactly given tithi (Shukla- or Krishna-), even if another paksha's tithi is closer.
     JulDays_UT find_exact_tithi_start(JulDays_UT, Tithi) const;
-    tl::expected<date::local_days, CalcError> find_exact_tithi_date(const JulDays_UT, const DiscreteTithi, const date::time_zone *) const;
+    tl::expected<date::local_days, CalcError> find_exact_tithi_date(const JulDays_UT, const DiscreteTithi, const Time_Zone *) const;
     JulDays_UT find_nakshatra_start(const JulDays_UT, const Nakshatra) const;
     Saura_Masa saura_masa(JulDays_UT time) const;
     Saura_Masa_Point saura_masa_at(JulDays_UT time) const;
@@ -78,8 +79,12 @@ public:
     JulDays_UT find_next_rashi_start(JulDays_UT, Rashi*) const;
 
     vp::Swe swe;
+    // Tithi, nakshatra and sankranti starts are taken from here when it has them,
+    // instead of solving for them. nullptr to always solve.
+    const Event_Catalog * catalog = event_catalog();
 
 private:
+    const Event_Catalog * usable_catalog() const;
     Vrata_Time_Points calc_key_times_from_sunset_and_sunrise(JulDays_UT sunset0, JulDays_UT sunrise1) const;
     tl::expected<JulDays_UT, CalcError> sunset_before_sunrise(JulDays_UT const sunrise) const;
     date::local_days get_vrata_date(const JulDays_UT sunrise) const;
@@ -0,0 +1,119 @@
+#include "css-classes.h"
+
+#include "fmt-format-fixed.h"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace vp {
+
+namespace {
+
+constexpr std::size_t max_css_classes = 64;
+
+struct Css_Class_Registry {
+    std::mutex mutex;
+    std::deque<std::string> storage; // deque: names must stay put as it grows
+    std::array<std::string_view, max_css_classes> names{};
+    std::unordered_map<std::string_view, unsigned> bits;
+    unsigned size = 0;
+
+    Css_Class_Registry() {
+        for (const auto & [c, name] : {
+                 std::pair{css::mainpart, "mainpart"},
+                 std::pair{css::skipped, "skipped"},
+                 std::pair{css::custom, "custom"},
+                 std::pair{css::vrata, "vrata"},
+                 std::pair{css::separator, "separator"},
+                 std::pair{css::odd, "odd"},
+                 std::pair{css::even, "even"},
+                 std::pair{css::merge_to_top, "merge-to-top"},
+                 std::pair{css::merge_to_bottom, "merge-to-bottom"},
+             }) {
+            names[c.bit()] = name;
+            bits.emplace(name, c.bit());
+            size = std::max(size, c.bit() + 1);
+        }
+    }
+};
+
+Css_Class_Registry & registry() {
+    static Css_Class_Registry registry_;
+    return registry_;
+}
+
+bool is_css_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+} // anonymous namespace
+
+std::string_view Css_Class::name() const
+{
+    auto & r = registry();
+    std::lock_guard<std::mutex> lock{r.mutex};
+    return r.names[bit_];
+}
+
+Css_Class css_class(std::string_view name)
+{
+    auto & r = registry();
+    std::lock_guard<std::mutex> lock{r.mutex};
+    if (const auto found = r.bits.find(name); found != r.bits.end()) {
+        return Css_Class{found->second};
+    }
+    if (name.empty() || std::find_if(name.begin(), name.end(), is_css_space) != name.end()) {
+        throw std::runtime_error(fmt::format("bad CSS class name '{}'", name));
+    }
+    if (r.size == max_css_classes) {
+        throw std::runtime_error(fmt::format("can't add CSS class '{}': all {} are taken", name, max_css_classes));
+    }
+    const auto bit = r.size++;
+    r.names[bit] = r.storage.emplace_back(name);
+    r.bits.emplace(r.names[bit], bit);
+    return Css_Class{bit};
+}
+
+Css_Classes Css_Classes::parse(std::string_view names)
+{
+    Css_Classes classes;
+    std::size_t pos = 0;
+    while (pos < names.size()) {
+        if (is_css_space(names[pos])) {
+            ++pos;
+            continue;
+        }
+        auto end = pos;
+        while (end < names.size() && !is_css_space(names[end])) ++end;
+        classes |= css_class(names.substr(pos, end - pos));
+        pos = end;
+    }
+    return classes;
+}
+
+std::string Css_Classes::to_string() const
+{
+    std::string result;
+    for_each_name([&](std::string_view name) {
+        if (!result.empty()) result += ' ';
+        result += name;
+    });
+    return result;
+}
+
+unsigned Css_Classes::lowest_bit(std::uint64_t bits)
+{
+    unsigned bit = 0;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        ++bit;
+    }
+    return bit;
+}
+
+} // namespace vp
@@ -0,0 +1,79 @@
+#ifndef VP_CSS_CLASSES_H
+#define VP_CSS_CLASSES_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace vp {
+
+/*
+ * CSS class names as bits of a 64-bit set, so that table cells and rows
+ * carry their classes in 8 bytes, checking for a class is a bit test and
+ * adding one is an OR. Names are only needed when HTML is written.
+ *
+ * Each distinct name gets its bit from a process-wide registry: the classes
+ * the calendar itself uses have fixed bits (see namespace css below), others
+ * (e.g. from NamedDate::css_classes) are registered on first use.
+ */
+class Css_Class {
+public:
+    constexpr explicit Css_Class(unsigned bit) : bit_(bit) {}
+    constexpr unsigned bit() const { return bit_; }
+    std::string_view name() const;
+    friend constexpr bool operator==(Css_Class c1, Css_Class c2) { return c1.bit_ == c2.bit_; }
+private:
+    unsigned bit_;
+};
+
+namespace css {
+constexpr Css_Class mainpart{0};
+constexpr Css_Class skipped{1};
+constexpr Css_Class custom{2};
+constexpr Css_Class vrata{3};
+constexpr Css_Class separator{4};
+constexpr Css_Class odd{5};
+constexpr Css_Class even{6};
+constexpr Css_Class merge_to_top{7};
+constexpr Css_Class merge_to_bottom{8};
+} // namespace css
+
+// Class by name, registering it if it's new. Throws std::runtime_error when
+// more than 64 distinct names are used, or for names with whitespace.
+Css_Class css_class(std::string_view name);
+
+class Css_Classes {
+public:
+    constexpr Css_Classes() = default;
+    constexpr Css_Classes(Css_Class c) : bits_(std::uint64_t{1} << c.bit()) {}
+    constexpr Css_Classes(std::initializer_list<Css_Class> classes) {
+        for (const auto c : classes) bits_ |= std::uint64_t{1} << c.bit();
+    }
+    // Space-separated names, like in the HTML class attribute.
+    static Css_Classes parse(std::string_view names);
+
+    constexpr bool empty() const { return bits_ == 0; }
+    constexpr bool has(Css_Class c) const { return (bits_ >> c.bit()) & 1; }
+    constexpr Css_Classes & operator|=(Css_Classes other) { bits_ |= other.bits_; return *this; }
+    friend constexpr Css_Classes operator|(Css_Classes c1, Css_Classes c2) { return c1 |= c2; }
+    friend constexpr bool operator==(Css_Classes c1, Css_Classes c2) { return c1.bits_ == c2.bits_; }
+    friend constexpr bool operator!=(Css_Classes c1, Css_Classes c2) { return c1.bits_ != c2.bits_; }
+
+    // Names in the order of their bits, separated by spaces.
+    std::string to_string() const;
+    template<typename Fn>
+    void for_each_name(Fn fn) const {
+        for (auto bits = bits_; bits != 0; bits &= bits - 1) {
+            fn(Css_Class{lowest_bit(bits)}.name());
+        }
+    }
+
+private:
+    static unsigned lowest_bit(std::uint64_t bits);
+    std::uint64_t bits_ = 0;
+};
+
+} // namespace vp
+
+#endif // VP_CSS_CLASSES_H
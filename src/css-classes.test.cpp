@@ -0,0 +1,31 @@
+#include "css-classes.h"
+
+#include "catch-formatters.h"
+
+using namespace vp;
+
+TEST_CASE("Css_Classes are sets of whole class names") {
+    Css_Classes classes{css::mainpart, css::skipped};
+    REQUIRE(classes.has(css::mainpart));
+    REQUIRE(classes.has(css::skipped));
+    REQUIRE_FALSE(classes.has(css::custom));
+    classes |= css::custom;
+    REQUIRE(classes.has(css::custom));
+    REQUIRE(classes.to_string() == "mainpart skipped custom");
+    REQUIRE(Css_Classes{}.empty());
+    REQUIRE(Css_Classes{}.to_string().empty());
+}
+
+TEST_CASE("Css_Classes::parse() registers new names and finds known ones") {
+    const auto parsed = Css_Classes::parse("  mainpart\tsome-new-class  merge-to-top ");
+    REQUIRE(parsed.has(css::mainpart));
+    REQUIRE(parsed.has(css::merge_to_top));
+    const auto new_class = css_class("some-new-class");
+    REQUIRE(parsed.has(new_class));
+    REQUIRE(new_class.name() == "some-new-class");
+    REQUIRE(css_class("some-new-class") == new_class);
+    REQUIRE(parsed == (Css_Classes{css::mainpart, css::merge_to_top} | new_class));
+    REQUIRE(Css_Classes::parse("").empty());
+    REQUIRE(css_class("merge-to-bottom") == css::merge_to_bottom);
+    REQUIRE_THROWS_AS(css_class(""), std::runtime_error);
+}
@@ -14,6 +14,8 @@ DISABLE_WARNING_POP
 
 #include "fmt-format-fixed.h"
 
+#include <string_view>
+
 template<>
 struct fmt::formatter<date::year_month_day> {
     bool as_local = false;
@@ -100,17 +102,96 @@ struct fmt::formatter<date::hh_mm_ss<Duration>> {
     }
 };
 
+namespace vp {
+
+constexpr bool is_local_time_conversion(char c) {
+    return c == 'Y' || c == 'm' || c == 'd' || c == 'H' || c == 'M' || c == 'S' || c == '%';
+}
+
+/*
+ * Writes t by strftime-like spec of %Y, %m, %d, %H, %M, %S, %% and plain
+ * characters, same as date::format() with that format, but digits are
+ * written directly, without iostreams and locales. Throws fmt::format_error
+ * for other conversions (e.g. %Z). Fractions of seconds are not shown, so
+ * floor or ceil the time to minutes or seconds first.
+ */
+template<typename OutputIt, typename Duration>
+OutputIt format_local_time(OutputIt out, const date::local_time<Duration> & t, std::string_view spec) {
+    const auto write_2_digits = [&out](unsigned value) {
+        *out++ = static_cast<char>('0' + value / 10);
+        *out++ = static_cast<char>('0' + value % 10);
+    };
+    const auto daypoint = date::floor<date::days>(t);
+    const auto ymd = date::year_month_day{daypoint};
+    const auto seconds = static_cast<unsigned>(date::floor<std::chrono::seconds>(t - daypoint).count());
+    for (std::size_t i = 0; i < spec.size(); ++i) {
+        if (spec[i] != '%') {
+            *out++ = spec[i];
+            continue;
+        }
+        if (++i == spec.size() || !is_local_time_conversion(spec[i])) {
+            throw fmt::format_error("invalid local time format: only %Y, %m, %d, %H, %M, %S and %% are supported");
+        }
+        switch (spec[i]) {
+        case 'Y': {
+            const int year = static_cast<int>(ymd.year());
+            if (year >= 0 && year <= 9999) {
+                write_2_digits(static_cast<unsigned>(year / 100));
+                write_2_digits(static_cast<unsigned>(year % 100));
+            } else {
+                out = fmt::format_to(out, "{:04}", year);
+            }
+            break;
+        }
+        case 'm': write_2_digits(static_cast<unsigned>(ymd.month())); break;
+        case 'd': write_2_digits(static_cast<unsigned>(ymd.day())); break;
+        case 'H': write_2_digits(seconds / 3600); break;
+        case 'M': write_2_digits(seconds / 60 % 60); break;
+        case 'S': write_2_digits(seconds % 60); break;
+        default: *out++ = '%'; break;
+        }
+    }
+    return out;
+}
+
+} // namespace vp
+
+/*
+ * Without format spec: "2019-03-10 06:30:00.000000".
+ * With spec (e.g. "{:%H:%M}") it's vp::format_local_time() with that spec,
+ * which is checked when the format string is parsed.
+ */
 template<typename Duration>
 struct fmt::formatter<date::local_time<Duration>> {
+    const char * spec_begin = nullptr;
+    const char * spec_end = nullptr;
+
     template<typename ParseContext>
-    constexpr auto parse(ParseContext & ctx) { return ctx.begin(); }
+    constexpr auto parse(ParseContext & ctx) {
+        auto it = ctx.begin();
+        const auto end = ctx.end();
+        spec_begin = it;
+        while (it != end && *it != '}') {
+            if (*it == '%') {
+                ++it;
+                if (it == end || !vp::is_local_time_conversion(*it)) {
+                    throw fmt::format_error("invalid local time format: only %Y, %m, %d, %H, %M, %S and %% are supported");
+                }
+            }
+            ++it;
+        }
+        spec_end = it;
+        return it;
+    }
 
     template<typename FormatContext>
     auto format(const date::local_time<Duration> & t, FormatContext & ctx) {
-        const auto daypoint = date::floor<date::days>(t);
-        const auto ymd = date::year_month_day{daypoint};
-        const auto tod = date::hh_mm_ss<Duration>{t - daypoint};
-        return fmt::format_to(ctx.out(), "{} {}", ymd, tod);
+        if (spec_begin == spec_end) {
+            const auto daypoint = date::floor<date::days>(t);
+            const auto tod = date::hh_mm_ss<Duration>{t - daypoint};
+            return fmt::format_to(ctx.out(), "{} {}", date::year_month_day{daypoint}, tod);
+        }
+        return vp::format_local_time(ctx.out(), t, std::string_view{spec_begin, static_cast<std::size_t>(spec_end - spec_begin)});
     }
 };
 
@@ -0,0 +1,87 @@
+#include "daybyday-record.h"
+
+#include "vrata-record.h"
+
+namespace vp::text_ui {
+
+namespace {
+
+void write_tithi(Record_Writer & w, DiscreteTithi tithi) {
+    w.i32(tithi.num);
+}
+
+DiscreteTithi read_tithi(Record_Reader & r) {
+    const auto num = r.i32();
+    if (num < 0) return DiscreteTithi::Unknown();
+    return DiscreteTithi{Tithi{static_cast<double>(num)}};
+}
+
+void write_nakshatra(Record_Writer & w, DiscreteNakshatra nakshatra) {
+    w.i32(nakshatra.number());
+}
+
+DiscreteNakshatra read_nakshatra(Record_Reader & r) {
+    const auto num = r.i32();
+    if (num < 0) return DiscreteNakshatra::Unknown();
+    return DiscreteNakshatra{Nakshatra{static_cast<double>(num)}};
+}
+
+} // anonymous namespace
+
+void write_daybyday(Record_Writer & w, const DayByDayInfo & info) {
+    write_location(w, info.location);
+    w.i32(static_cast<std::int32_t>(date::local_days{info.date}.time_since_epoch().count()));
+    write_optional_juldays(w, info.sunrise1);
+    write_optional_juldays(w, info.sunset1);
+    write_optional_juldays(w, info.sunrise2);
+    w.u8(static_cast<std::uint8_t>(info.saura_masa));
+    write_optional_juldays(w, info.saura_masa_until);
+    w.u8(static_cast<std::uint8_t>(info.chandra_masa));
+    write_optional_juldays(w, info.chandra_masa_until);
+    write_tithi(w, info.tithi);
+    write_optional_juldays(w, info.tithi_until);
+    write_tithi(w, info.tithi2);
+    write_optional_juldays(w, info.tithi2_until);
+    write_nakshatra(w, info.nakshatra);
+    write_optional_juldays(w, info.nakshatra_until);
+    write_nakshatra(w, info.nakshatra2);
+    write_optional_juldays(w, info.nakshatra2_until);
+    w.u32(static_cast<std::uint32_t>(info.events.size()));
+    for (const auto & event : info.events) {
+        w.str(event.name);
+        write_juldays(w, event.time_point);
+        w.u8(static_cast<std::uint8_t>(event.trackIntervalChange));
+    }
+}
+
+DayByDayInfo read_daybyday(Record_Reader & r) {
+    DayByDayInfo info;
+    info.location = read_location(r);
+    info.date = date::year_month_day{date::local_days{date::days{r.i32()}}};
+    info.sunrise1 = read_optional_juldays(r);
+    info.sunset1 = read_optional_juldays(r);
+    info.sunrise2 = read_optional_juldays(r);
+    info.saura_masa = static_cast<Saura_Masa>(r.u8());
+    info.saura_masa_until = read_optional_juldays(r);
+    info.chandra_masa = static_cast<Chandra_Masa>(r.u8());
+    info.chandra_masa_until = read_optional_juldays(r);
+    info.tithi = read_tithi(r);
+    info.tithi_until = read_optional_juldays(r);
+    info.tithi2 = read_tithi(r);
+    info.tithi2_until = read_optional_juldays(r);
+    info.nakshatra = read_nakshatra(r);
+    info.nakshatra_until = read_optional_juldays(r);
+    info.nakshatra2 = read_nakshatra(r);
+    info.nakshatra2_until = read_optional_juldays(r);
+    const auto count = r.u32();
+    info.events.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::string name{r.str()};
+        const auto time_point = read_juldays(r);
+        const auto track = static_cast<TrackIntervalChange>(r.u8());
+        info.events.push_back(NamedTimePoint{std::move(name), time_point, track});
+    }
+    return info;
+}
+
+} // namespace vp::text_ui
@@ -0,0 +1,18 @@
+#ifndef VP_DAYBYDAY_RECORD_H
+#define VP_DAYBYDAY_RECORD_H
+
+#include "binary-record.h"
+#include "text-interface.h"
+
+namespace vp::text_ui {
+
+// Binary (de)serialization of DayByDayInfo, same conventions as in vrata-record.h.
+// Bump daybyday_record_version whenever the layout changes.
+constexpr std::uint32_t daybyday_record_version = 1;
+
+void write_daybyday(Record_Writer & w, const DayByDayInfo & info);
+DayByDayInfo read_daybyday(Record_Reader & r);
+
+} // namespace vp::text_ui
+
+#endif // VP_DAYBYDAY_RECORD_H
@@ -0,0 +1,181 @@
+#include "disk-cache.h"
+
+#include "binary-record.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <vector>
+
+namespace vp {
+
+std::uint64_t fnv1a_64(std::string_view data, std::uint64_t hash) {
+    for (const char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+namespace {
+
+// File layout: u32 magic, u32 format version, str key, u64 payload checksum, str payload.
+constexpr std::uint32_t disk_cache_magic = 0x43445056; // "VPDC" when read as little-endian bytes
+constexpr std::uint32_t disk_cache_format_version = 1;
+constexpr const char * entry_extension = ".vpc";
+
+std::optional<std::string> read_file(const fs::path & path) {
+    std::ifstream f{path, std::ios::binary};
+    if (!f) return std::nullopt;
+    std::string data{std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{}};
+    if (f.bad()) return std::nullopt;
+    return data;
+}
+
+// Unique among threads of this process and (very likely) among other processes
+// sharing the cache directory.
+std::string temp_suffix() {
+    static std::atomic<std::uint64_t> counter{[]() {
+        std::random_device rd;
+        return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    }()};
+    return fmt::format(".{:016x}.tmp", counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+} // anonymous namespace
+
+Disk_Cache::Disk_Cache(fs::path dir, std::uintmax_t max_bytes)
+    : dir_(std::move(dir)), max_bytes_(max_bytes)
+{
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+}
+
+fs::path Disk_Cache::path_for(std::string_view key) const
+{
+    return dir_ / fmt::format("{:016x}{}", fnv1a_64(key), entry_extension);
+}
+
+std::optional<std::string> Disk_Cache::load(std::string_view key)
+{
+    const auto path = path_for(key);
+    auto data = read_file(path);
+    if (!data) return std::nullopt;
+    try {
+        Record_Reader r{*data};
+        if (r.u32() != disk_cache_magic || r.u32() != disk_cache_format_version) {
+            throw std::runtime_error("not a cache entry or old format");
+        }
+        if (r.str() != key) {
+            // Different key with the same hash: not an error, just not ours.
+            return std::nullopt;
+        }
+        const auto checksum = r.u64();
+        const auto payload = r.str();
+        if (!r.at_end() || fnv1a_64(payload) != checksum) {
+            throw std::runtime_error("checksum mismatch");
+        }
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        return std::string{payload};
+    } catch (const std::exception &) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        return std::nullopt;
+    }
+}
+
+void Disk_Cache::store(std::string_view key, std::string_view payload)
+{
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    w.u32(disk_cache_magic);
+    w.u32(disk_cache_format_version);
+    w.str(key);
+    w.u64(fnv1a_64(payload));
+    w.str(payload);
+
+    const auto path = path_for(key);
+    auto temp_path = path;
+    temp_path += temp_suffix();
+    {
+        std::ofstream f{temp_path, std::ios::binary | std::ios::trunc};
+        f.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        f.close();
+        if (!f) {
+            std::error_code ec;
+            fs::remove(temp_path, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        return;
+    }
+    add_bytes(buf.size());
+}
+
+void Disk_Cache::add_bytes(std::uintmax_t bytes)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (!bytes_) {
+        // First store in this run: count what's already there (includes the new entry).
+        evict();
+        return;
+    }
+    *bytes_ += bytes;
+    if (*bytes_ > max_bytes_) {
+        evict();
+    }
+}
+
+// Must be called with mutex_ locked. Recounts the directory from scratch:
+// other processes may be using it too, and overwritten entries make our own count approximate.
+void Disk_Cache::evict()
+{
+    struct Entry {
+        fs::path path;
+        fs::file_time_type mtime;
+        std::uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    std::uintmax_t total = 0;
+    const auto stale_temp_time = fs::file_time_type::clock::now() - std::chrono::hours{1};
+    std::error_code ec;
+    for (fs::directory_iterator it{dir_, ec}, end; !ec && it != end; it.increment(ec)) {
+        const auto & path = it->path();
+        std::error_code entry_ec;
+        const auto mtime = fs::last_write_time(path, entry_ec);
+        if (entry_ec) continue;
+        if (path.extension() == ".tmp") {
+            // left over from a crash in the middle of store()
+            if (mtime < stale_temp_time) fs::remove(path, entry_ec);
+            continue;
+        }
+        if (path.extension() != entry_extension) continue;
+        const auto size = fs::file_size(path, entry_ec);
+        if (entry_ec) continue;
+        entries.push_back(Entry{path, mtime, size});
+        total += size;
+    }
+    if (total > max_bytes_) {
+        // Go down to 90% so that we don't have to rescan on every following store().
+        const auto target = max_bytes_ / 10 * 9;
+        std::sort(entries.begin(), entries.end(), [](const Entry & a, const Entry & b) { return a.mtime < b.mtime; });
+        for (const auto & entry : entries) {
+            if (total <= target) break;
+            std::error_code remove_ec;
+            if (fs::remove(entry.path, remove_ec)) {
+                total -= entry.size;
+            }
+        }
+    }
+    bytes_ = total;
+}
+
+} // namespace vp
@@ -0,0 +1,58 @@
+#ifndef VP_DISK_CACHE_H
+#define VP_DISK_CACHE_H
+
+#include "filesystem-fixed.h"
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace vp {
+
+// 64-bit FNV-1a, for checksums and file names. Not cryptographic.
+std::uint64_t fnv1a_64(std::string_view data, std::uint64_t hash = 0xcbf29ce484222325ull);
+
+/*
+ * Persistent key→blob cache, one file per entry in the given directory.
+ *
+ * Keys are arbitrary strings, they must include everything the value depends on
+ * (there is no other invalidation). Each file stores the full key, so hash
+ * collisions in file names are detected, and a payload checksum, so truncated or
+ * damaged files are detected too; both are treated as a miss and the file is removed.
+ *
+ * Writes go to a temporary file which is then renamed over the final name, so
+ * readers (including other processes) never see a half-written entry, even if
+ * we crash in the middle.
+ *
+ * Total size of the directory is kept under max_bytes by removing least recently
+ * used entries (by mtime, which is refreshed on every hit).
+ *
+ * Cache is best-effort: I/O errors never propagate, they just mean a miss or a
+ * value that wasn't stored.
+ */
+class Disk_Cache {
+public:
+    Disk_Cache(fs::path dir, std::uintmax_t max_bytes);
+
+    std::optional<std::string> load(std::string_view key);
+    void store(std::string_view key, std::string_view payload);
+
+    const fs::path & dir() const { return dir_; }
+    std::uintmax_t max_bytes() const { return max_bytes_; }
+
+private:
+    fs::path path_for(std::string_view key) const;
+    void add_bytes(std::uintmax_t bytes);
+    void evict();
+
+    fs::path dir_;
+    std::uintmax_t max_bytes_;
+    std::mutex mutex_;
+    std::optional<std::uintmax_t> bytes_; // unknown until first store()
+};
+
+} // namespace vp
+
+#endif // VP_DISK_CACHE_H
@@ -0,0 +1,82 @@
+#include "disk-cache.h"
+
+#include "catch-formatters.h"
+#include "temp-dir.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace vp;
+
+namespace {
+std::vector<fs::path> files_in(const fs::path & dir) {
+    std::vector<fs::path> files;
+    for (const auto & entry : fs::directory_iterator{dir}) {
+        files.push_back(entry.path());
+    }
+    return files;
+}
+}
+
+TEST_CASE("Disk_Cache returns stored values, also from another instance") {
+    Temp_Dir dir{"disk-cache-roundtrip"};
+    {
+        Disk_Cache cache{dir.path, 1024 * 1024};
+        REQUIRE_FALSE(cache.load("key1").has_value());
+        cache.store("key1", "value1");
+        cache.store("key2", std::string_view{"binary\0value", 12});
+        REQUIRE(cache.load("key1") == std::optional<std::string>{"value1"});
+    }
+    Disk_Cache cache{dir.path, 1024 * 1024};
+    REQUIRE(cache.load("key1") == std::optional<std::string>{"value1"});
+    REQUIRE(cache.load("key2") == std::optional<std::string>{std::string{"binary\0value", 12}});
+    REQUIRE_FALSE(cache.load("key3").has_value());
+    // no temporary files are left behind
+    REQUIRE(files_in(dir.path).size() == 2);
+}
+
+TEST_CASE("Disk_Cache treats damaged entries as a miss and removes them") {
+    Temp_Dir dir{"disk-cache-damaged"};
+    Disk_Cache cache{dir.path, 1024 * 1024};
+    cache.store("key", "some long enough value");
+    const auto files = files_in(dir.path);
+    REQUIRE(files.size() == 1);
+
+    SECTION("truncated") {
+        fs::resize_file(files[0], fs::file_size(files[0]) - 3);
+    }
+    SECTION("flipped byte in the payload") {
+        std::fstream f{files[0], std::ios::in | std::ios::out | std::ios::binary};
+        f.seekp(-2, std::ios::end);
+        f.put('X');
+    }
+    REQUIRE_FALSE(cache.load("key").has_value());
+    REQUIRE(files_in(dir.path).empty());
+}
+
+TEST_CASE("Disk_Cache removes least recently used entries when over the size limit") {
+    Temp_Dir dir{"disk-cache-eviction"};
+    const std::string payload(1000, 'x');
+    Disk_Cache cache{dir.path, 5500};
+    const auto now = fs::file_time_type::clock::now();
+    for (int i = 0; i < 5; ++i) {
+        cache.store(fmt::format("key{}", i), payload);
+        // Age each entry explicitly: file system timestamp resolution may be too coarse otherwise.
+        for (const auto & path : files_in(dir.path)) {
+            if (fs::last_write_time(path) > now - std::chrono::minutes{1}) {
+                fs::last_write_time(path, now - std::chrono::hours{10 - i});
+            }
+        }
+    }
+    REQUIRE(files_in(dir.path).size() == 5);
+
+    // 6 entries of ~1KB each don't fit into 5500 bytes, oldest ones must go
+    cache.store("key5", payload);
+    REQUIRE(files_in(dir.path).size() == 4);
+    REQUIRE_FALSE(cache.load("key0").has_value());
+    REQUIRE_FALSE(cache.load("key1").has_value());
+    REQUIRE(cache.load("key2").has_value());
+    REQUIRE(cache.load("key5").has_value());
+}
@@ -0,0 +1,384 @@
+#include "event-catalog.h"
+
+#include "binary-record.h"
+#include "calc.h"
+#include "disk-cache.h"
+#include "process-pool.h"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+namespace vp {
+
+namespace {
+
+constexpr std::uint32_t event_catalog_magic = 0x56455056; // "VPEV" when read as little-endian bytes
+constexpr std::size_t series_header_size = 4 + 4 + 8 + 8 + 8 + 8;
+constexpr std::size_t event_catalog_header_size = 4 + 4 + 8 + 4 + 4 + 4 + event_series_count * series_header_size + 8;
+constexpr std::array<std::uint32_t, event_series_count> series_period{30, 27, 12};
+
+constexpr double ms_per_day = 86'400'000.0;
+
+std::int64_t to_ms(JulDays_UT t) {
+    return std::llround(t.raw_julian_days_ut().count() * ms_per_day);
+}
+
+JulDays_UT from_ms(std::int64_t ms) {
+    return JulDays_UT{double_days{static_cast<double>(ms) / ms_per_day}};
+}
+
+std::uint32_t checkpoint_count(std::uint32_t event_count) {
+    return (event_count + event_catalog_checkpoint_interval - 1) / event_catalog_checkpoint_interval;
+}
+
+// Starts of consecutive values (tithis, nakṣatras, māsas) in [from, to), beginning with next_value.
+// margin must be shorter than the shortest interval, it gets us past the start just found.
+template<typename Find>
+Event_Catalog_Data::Series calc_series(JulDays_UT from, JulDays_UT to, std::uint32_t next_value, std::uint32_t period, double_hours margin, Find find) {
+    Event_Catalog_Data::Series series;
+    series.first_value = next_value;
+    for (auto t = from;;) {
+        const auto start = find(t, next_value);
+        if (start >= to) break;
+        series.times.push_back(to_ms(start));
+        t = start + margin;
+        next_value = (next_value + 1) % period;
+    }
+    return series;
+}
+
+// Runs in the worker process. Task is (u32 ephemeris flags, i32 from, i32 to), result is
+// for each series u32 first value, u32 count and that many times (as u64).
+void calc_chunk(std::string_view task, fmt::memory_buffer & out) {
+    Record_Reader r{task};
+    const auto ephemeris = static_cast<CalcFlags>(r.u32());
+    const JulDays_UT from{date::sys_time<double_days>{date::sys_days{date::days{r.i32()}}}};
+    const JulDays_UT to{date::sys_time<double_days>{date::sys_days{date::days{r.i32()}}}};
+
+    Calc calc{Swe{Location{}, ephemeris}};
+    calc.catalog = nullptr; // we are making the catalog, so always solve
+
+    const auto next_tithi = static_cast<std::uint32_t>(std::floor(calc.swe.tithi(from).tithi) + 1) % 30;
+    const auto next_nakshatra = static_cast<std::uint32_t>(std::floor(calc.swe.nakshatra(from).nakshatra) + 1) % 27;
+    const auto next_masa_index = static_cast<std::uint32_t>(calc.saura_masa(from)) % 12;
+    const std::array<Event_Catalog_Data::Series, event_series_count> series{
+        calc_series(from, to, next_tithi, 30, double_hours{1.0}, [&](JulDays_UT t, std::uint32_t value) {
+            return calc.find_exact_tithi_start(t, Tithi{static_cast<double>(value)});
+        }),
+        calc_series(from, to, next_nakshatra, 27, double_hours{1.0}, [&](JulDays_UT t, std::uint32_t value) {
+            return calc.find_nakshatra_start(t, Nakshatra{static_cast<double>(value)});
+        }),
+        calc_series(from, to, next_masa_index, 12, double_hours{24.0}, [&](JulDays_UT t, std::uint32_t value) {
+            return calc.find_sankranti(t, Saura_Masa{static_cast<int>(value) + 1});
+        }),
+    };
+
+    Record_Writer w{out};
+    for (const auto & s : series) {
+        w.u32(s.first_value);
+        w.u32(static_cast<std::uint32_t>(s.times.size()));
+        for (const auto time : s.times) {
+            w.u64(static_cast<std::uint64_t>(time));
+        }
+    }
+}
+
+} // anonymous namespace
+
+Event_Catalog_Data calc_event_catalog(date::year from_year, date::year to_year, CalcFlags ephemeris, unsigned workers)
+{
+    Event_Catalog_Data data;
+    data.ephemeris = ephemeris & CalcFlags::EphemerisMask;
+    data.from = date::sys_days{from_year / date::January / 1};
+    data.to = date::sys_days{(to_year + date::years{1}) / date::January / 1};
+
+    // ten years per task
+    std::vector<std::string> tasks;
+    for (auto year = from_year; year <= to_year; year += date::years{10}) {
+        const auto chunk_to = std::min(year + date::years{10}, to_year + date::years{1});
+        fmt::memory_buffer buf;
+        Record_Writer w{buf};
+        w.u32(static_cast<std::uint32_t>(data.ephemeris));
+        w.i32(static_cast<std::int32_t>(date::sys_days{year / date::January / 1}.time_since_epoch().count()));
+        w.i32(static_cast<std::int32_t>(date::sys_days{chunk_to / date::January / 1}.time_since_epoch().count()));
+        tasks.push_back(fmt::to_string(buf));
+    }
+
+    Process_Pool pool{workers, calc_chunk};
+    pool.run(tasks, [&](std::size_t i, Process_Pool::Task_Result && result) {
+        if (!result.ok) {
+            throw std::runtime_error(fmt::format("can't calculate event catalog chunk {}: {}", i, result.data));
+        }
+        Record_Reader r{result.data};
+        for (std::size_t s = 0; s < event_series_count; ++s) {
+            auto & series = data.series[s];
+            const auto first_value = r.u32();
+            const auto count = r.u32();
+            if (i == 0) {
+                series.first_value = first_value;
+            } else if (first_value != (series.first_value + series.times.size()) % series_period[s]) {
+                throw std::runtime_error(fmt::format("event catalog chunks {} and {} don't join", i - 1, i));
+            }
+            for (std::uint32_t k = 0; k < count; ++k) {
+                series.times.push_back(static_cast<std::int64_t>(r.u64()));
+            }
+        }
+    });
+    return data;
+}
+
+std::string encode_event_catalog(const Event_Catalog_Data & data)
+{
+    fmt::memory_buffer body;
+    std::array<std::uint64_t, event_series_count> deltas_offsets{};
+    std::array<std::uint64_t, event_series_count> checkpoints_offsets{};
+    {
+        Record_Writer w{body};
+        for (std::size_t s = 0; s < event_series_count; ++s) {
+            const auto & times = data.series[s].times;
+            if (times.size() > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::runtime_error("event catalog: too many events");
+            }
+            deltas_offsets[s] = event_catalog_header_size + body.size();
+            for (std::size_t i = 1; i < times.size(); ++i) {
+                const auto delta = times[i] - times[i-1];
+                if (delta <= 0 || delta > std::numeric_limits<std::uint32_t>::max()) {
+                    throw std::runtime_error(fmt::format("event catalog: can't encode interval of {} ms between events {} and {}", delta, i - 1, i));
+                }
+                w.u32(static_cast<std::uint32_t>(delta));
+            }
+            checkpoints_offsets[s] = event_catalog_header_size + body.size();
+            for (std::size_t i = 0; i < times.size(); i += event_catalog_checkpoint_interval) {
+                w.u64(static_cast<std::uint64_t>(times[i]));
+            }
+        }
+    }
+
+    fmt::memory_buffer header;
+    Record_Writer w{header};
+    w.u32(event_catalog_magic);
+    w.u32(event_catalog_format_version);
+    w.u64(data.build_id);
+    w.u32(static_cast<std::uint32_t>(data.ephemeris));
+    w.i32(static_cast<std::int32_t>(data.from.time_since_epoch().count()));
+    w.i32(static_cast<std::int32_t>(data.to.time_since_epoch().count()));
+    for (std::size_t s = 0; s < event_series_count; ++s) {
+        const auto & times = data.series[s].times;
+        w.u32(data.series[s].first_value);
+        w.u32(static_cast<std::uint32_t>(times.size()));
+        w.u64(static_cast<std::uint64_t>(times.empty() ? 0 : times.front()));
+        w.u64(static_cast<std::uint64_t>(times.empty() ? 0 : times.back()));
+        w.u64(deltas_offsets[s]);
+        w.u64(checkpoints_offsets[s]);
+    }
+    w.u64(fnv1a_64(std::string_view{body.data(), body.size()}));
+    return fmt::to_string(header) + fmt::to_string(body);
+}
+
+void write_event_catalog(const fs::path & path, const Event_Catalog_Data & data)
+{
+    const auto contents = encode_event_catalog(data);
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream f{temp_path, std::ios::binary | std::ios::trunc};
+        f.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        f.close();
+        if (!f) {
+            std::error_code ec;
+            fs::remove(temp_path, ec);
+            throw std::runtime_error(fmt::format("can't write event catalog '{}'", temp_path.string()));
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        throw std::runtime_error(fmt::format("can't rename '{}' to '{}': {}", temp_path.string(), path.string(), ec.message()));
+    }
+}
+
+Event_Catalog::Event_Catalog(const fs::path & path)
+    : file_(path), data_(file_.data())
+{
+    read_header(path.string());
+}
+
+Event_Catalog::Event_Catalog(const Event_Catalog_Data & data)
+    : file_(encode_event_catalog(data)), data_(file_.data())
+{
+    read_header("(calculated)");
+}
+
+void Event_Catalog::read_header(std::string_view source_name)
+{
+    if (data_.size() < event_catalog_header_size) {
+        throw std::runtime_error(fmt::format("'{}' is not an event catalog: too short", source_name));
+    }
+    Record_Reader r{data_.substr(0, event_catalog_header_size)};
+    if (r.u32() != event_catalog_magic) {
+        throw std::runtime_error(fmt::format("'{}' is not an event catalog", source_name));
+    }
+    if (const auto version = r.u32(); version != event_catalog_format_version) {
+        throw std::runtime_error(fmt::format("event catalog '{}' has format version {}, expected {}; rebuild it", source_name, version, event_catalog_format_version));
+    }
+    build_id_ = r.u64();
+    ephemeris_ = static_cast<CalcFlags>(r.u32());
+    from_ = date::sys_days{date::days{r.i32()}};
+    to_ = date::sys_days{date::days{r.i32()}};
+    for (auto & s : series_) {
+        s.first_value = r.u32();
+        s.count = r.u32();
+        s.first_time = static_cast<std::int64_t>(r.u64());
+        s.last_time = static_cast<std::int64_t>(r.u64());
+        s.deltas_offset = r.u64();
+        s.checkpoints_offset = r.u64();
+        const auto deltas_size = std::uint64_t{s.count > 0 ? s.count - 1 : 0u} * 4;
+        const auto checkpoints_size = std::uint64_t{checkpoint_count(s.count)} * 8;
+        if (s.deltas_offset < event_catalog_header_size || s.deltas_offset + deltas_size > data_.size()
+                || s.checkpoints_offset < event_catalog_header_size || s.checkpoints_offset + checkpoints_size > data_.size()) {
+            throw std::runtime_error(fmt::format("event catalog '{}' is truncated or damaged", source_name));
+        }
+    }
+    const auto checksum = r.u64();
+    // small enough (a few MB for centuries) to check on every start
+    if (fnv1a_64(data_.substr(event_catalog_header_size)) != checksum) {
+        throw std::runtime_error(fmt::format("event catalog '{}': checksum mismatch", source_name));
+    }
+}
+
+Event_Catalog::~Event_Catalog() = default;
+
+std::int64_t Event_Catalog::delta(const Series_Index & s, std::uint32_t index) const
+{
+    Record_Reader r{data_.substr(s.deltas_offset + std::uint64_t{index} * 4, 4)};
+    return r.u32();
+}
+
+std::int64_t Event_Catalog::checkpoint(const Series_Index & s, std::uint32_t index) const
+{
+    Record_Reader r{data_.substr(s.checkpoints_offset + std::uint64_t{index} * 8, 8)};
+    return static_cast<std::int64_t>(r.u64());
+}
+
+std::optional<JulDays_UT> Event_Catalog::find(Event_Series series, double target, std::uint32_t modulus, JulDays_UT from) const
+{
+    if (target < 0.0 || std::floor(target) != target) return std::nullopt;
+    const auto & s = series_[static_cast<std::size_t>(series)];
+    if (s.count == 0) return std::nullopt;
+    // Stored times are rounded to milliseconds, so the start we are
+    // searching from may be up to half a millisecond before its stored time.
+    const auto from_time = to_ms(from) - 1;
+    if (from_time < to_ms(JulDays_UT{date::sys_time<double_days>{from_}}) || from_time > s.last_time) {
+        return std::nullopt;
+    }
+
+    // last checkpoint at or before from_time
+    std::uint32_t low = 0;
+    std::uint32_t high = checkpoint_count(s.count);
+    while (high - low > 1) {
+        const auto mid = low + (high - low) / 2;
+        if (checkpoint(s, mid) <= from_time) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    auto index = low * event_catalog_checkpoint_interval;
+    auto time = checkpoint(s, low);
+    // from_time <= last_time, so we can't run past the end here
+    while (time < from_time) {
+        time += delta(s, index);
+        ++index;
+    }
+
+    const auto value = (s.first_value + index) % series_period[static_cast<std::size_t>(series)];
+    const auto steps = (static_cast<std::uint32_t>(target) % modulus + modulus - value % modulus) % modulus;
+    if (std::uint64_t{index} + steps >= s.count) return std::nullopt;
+    for (std::uint32_t i = 0; i < steps; ++i) {
+        time += delta(s, index);
+        ++index;
+    }
+    return from_ms(time);
+}
+
+std::optional<JulDays_UT> Event_Catalog::find_tithi_start(JulDays_UT from, Tithi tithi, bool either_paksha) const
+{
+    return find(Event_Series::Tithi, tithi.tithi, either_paksha ? 15 : 30, from);
+}
+
+std::optional<JulDays_UT> Event_Catalog::find_nakshatra_start(JulDays_UT from, Nakshatra nakshatra) const
+{
+    return find(Event_Series::Nakshatra, nakshatra.nakshatra, 27, from);
+}
+
+std::optional<JulDays_UT> Event_Catalog::find_sankranti(JulDays_UT from, Saura_Masa masa) const
+{
+    return find(Event_Series::Sankranti, static_cast<double>(static_cast<int>(masa) - 1), 12, from);
+}
+
+Event_Catalog_Data::Series Event_Catalog::series(Event_Series series) const
+{
+    const auto & s = series_[static_cast<std::size_t>(series)];
+    Event_Catalog_Data::Series result;
+    result.first_value = s.first_value;
+    result.times.reserve(s.count);
+    if (s.count == 0) return result;
+    auto time = s.first_time;
+    result.times.push_back(time);
+    for (std::uint32_t i = 0; i + 1 < s.count; ++i) {
+        time += delta(s, i);
+        result.times.push_back(time);
+    }
+    return result;
+}
+
+namespace {
+std::unique_ptr<const Event_Catalog> & global_event_catalog() {
+    static std::unique_ptr<const Event_Catalog> catalog;
+    return catalog;
+}
+} // anonymous namespace
+
+const Event_Catalog * event_catalog()
+{
+    return global_event_catalog().get();
+}
+
+std::unique_ptr<const Event_Catalog> set_event_catalog(std::unique_ptr<const Event_Catalog> catalog)
+{
+    std::swap(global_event_catalog(), catalog);
+    return catalog;
+}
+
+namespace {
+// The vrata search needs tithis from about two months before base_date (to
+// know the māsa) to about a month and a half after it.
+constexpr date::days scope_margin{90};
+
+bool covers(const Event_Catalog * catalog, date::local_days base_date, CalcFlags flags) {
+    if (!catalog || catalog->ephemeris() != (flags & CalcFlags::EphemerisMask)) return false;
+    const date::sys_days base{base_date.time_since_epoch()};
+    return catalog->from() <= base - scope_margin && base + scope_margin <= catalog->to();
+}
+} // anonymous namespace
+
+Event_Catalog_Scope::Event_Catalog_Scope(date::local_days base_date, CalcFlags flags, unsigned workers)
+{
+    if (covers(event_catalog(), base_date, flags)) return;
+    const auto from_year = date::year_month_day{base_date - scope_margin}.year();
+    const auto to_year = date::year_month_day{base_date + scope_margin}.year();
+    previous_ = set_event_catalog(std::make_unique<const Event_Catalog>(calc_event_catalog(from_year, to_year, flags, workers)));
+    replaced_ = true;
+}
+
+Event_Catalog_Scope::~Event_Catalog_Scope()
+{
+    if (replaced_) {
+        set_event_catalog(std::move(previous_));
+    }
+}
+
+} // namespace vp
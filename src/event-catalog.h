@@ -0,0 +1,147 @@
+#ifndef VP_EVENT_CATALOG_H
+#define VP_EVENT_CATALOG_H
+
+#include "calc-flags.h"
+#include "date-fixed.h"
+#include "filesystem-fixed.h"
+#include "juldays_ut.h"
+#include "mapped-file.h"
+#include "masa.h"
+#include "nakshatra.h"
+#include "tithi.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vp {
+
+/*
+ * Location-independent timeline: starts of all tithis, nakṣatras and saura
+ * māsas (saṅkrāntis) over a range of years. Calc looks them up here instead
+ * of solving for them with sweph, which leaves only sunrises and sunsets
+ * (and anything outside the catalog) to live calculation.
+ *
+ * The file is memory-mapped (see mapped-file.h) and used in place.
+ * Each series is stored delta-encoded: time of the first event, then u32
+ * milliseconds from each event to the next one (even the longest saura māsa
+ * fits), plus absolute times of every event_catalog_checkpoint_interval-th event for
+ * binary search. Values are not stored: each event starts the next tithi
+ * (nakṣatra, māsa) after the previous one.
+ *
+ * File layout (little-endian, see binary-record.h):
+ *   u32 magic, u32 format version, u64 build id, u32 ephemeris flags,
+ *   i32 from, i32 to (days since epoch, [from, to) is the range covered),
+ *   for each series: u32 first value, u32 event count, i64 first event, i64 last event,
+ *                    u64 offset of deltas, u64 offset of checkpoints
+ *   u64 checksum of everything after the header,
+ *   then deltas and checkpoints of all series.
+ * Times are milliseconds since Julian day 0.
+ */
+constexpr std::uint32_t event_catalog_format_version = 1;
+constexpr std::uint32_t event_catalog_checkpoint_interval = 256;
+
+enum class Event_Series {
+    Tithi,     // values 0..29, see Tithi
+    Nakshatra, // values 0..26, see Nakshatra
+    Sankranti, // values 0..11, Saura_Masa minus one
+};
+constexpr std::size_t event_series_count = 3;
+
+// Uncompressed contents, as calculated or as read back.
+struct Event_Catalog_Data {
+    struct Series {
+        std::uint32_t first_value = 0;
+        std::vector<std::int64_t> times; // ms since Julian day 0, ascending
+    };
+    std::uint64_t build_id = 0;
+    CalcFlags ephemeris = CalcFlags::EphemerisSwiss;
+    date::sys_days from;
+    date::sys_days to;
+    std::array<Series, event_series_count> series;
+};
+
+// Calculate all events in [from_year, to_year] using `workers` processes.
+Event_Catalog_Data calc_event_catalog(date::year from_year, date::year to_year, CalcFlags ephemeris, unsigned workers);
+// Contents of the catalog file.
+std::string encode_event_catalog(const Event_Catalog_Data & data);
+void write_event_catalog(const fs::path & path, const Event_Catalog_Data & data);
+
+class Event_Catalog {
+public:
+    // Throws std::runtime_error if the file can't be read, it's not a catalog or it's damaged.
+    explicit Event_Catalog(const fs::path & path);
+    // In-memory catalog, e.g. for a short range calculated on the fly.
+    explicit Event_Catalog(const Event_Catalog_Data & data);
+    ~Event_Catalog();
+    Event_Catalog(const Event_Catalog &) = delete;
+    Event_Catalog & operator=(const Event_Catalog &) = delete;
+
+    std::uint64_t build_id() const { return build_id_; }
+    CalcFlags ephemeris() const { return ephemeris_; }
+    date::sys_days from() const { return from_; }
+    date::sys_days to() const { return to_; }
+    std::size_t size(Event_Series series) const { return series_[static_cast<std::size_t>(series)].count; }
+
+    // First start of tithi at or after `from`, like Calc::find_exact_tithi_start(), or
+    // of either tithi or tithi+15 (Calc::find_either_tithi_start()) when either_paksha is set.
+    // nullopt when the answer is not in the catalog or tithi is not a whole number.
+    std::optional<JulDays_UT> find_tithi_start(JulDays_UT from, Tithi tithi, bool either_paksha) const;
+    std::optional<JulDays_UT> find_nakshatra_start(JulDays_UT from, Nakshatra nakshatra) const;
+    std::optional<JulDays_UT> find_sankranti(JulDays_UT from, Saura_Masa masa) const;
+
+    Event_Catalog_Data::Series series(Event_Series series) const;
+
+private:
+    void read_header(std::string_view source_name);
+
+    struct Series_Index {
+        std::uint32_t first_value;
+        std::uint32_t count;
+        std::int64_t first_time;
+        std::int64_t last_time;
+        std::uint64_t deltas_offset;
+        std::uint64_t checkpoints_offset;
+    };
+
+    std::optional<JulDays_UT> find(Event_Series series, double target, std::uint32_t modulus, JulDays_UT from) const;
+    std::int64_t delta(const Series_Index & s, std::uint32_t index) const;
+    std::int64_t checkpoint(const Series_Index & s, std::uint32_t index) const;
+
+    Mapped_File file_;
+    std::string_view data_;
+    std::uint64_t build_id_ = 0;
+    CalcFlags ephemeris_ = CalcFlags::EphemerisSwiss;
+    date::sys_days from_;
+    date::sys_days to_;
+    std::array<Series_Index, event_series_count> series_{};
+};
+
+// Catalog consulted by Calc, nullptr if there is none.
+const Event_Catalog * event_catalog();
+// Call at startup, before any calculations (and before forking worker processes),
+// or when no Calc is alive. Returns the previous catalog.
+std::unique_ptr<const Event_Catalog> set_event_catalog(std::unique_ptr<const Event_Catalog> catalog);
+
+// For runs which look for the same vrata at many locations: while this object
+// lives, event_catalog() covers the months around base_date. If the current
+// catalog doesn't, one is calculated on the spot (using `workers` processes)
+// and replaces it until the end of the scope. Same rules as for set_event_catalog().
+class Event_Catalog_Scope {
+public:
+    Event_Catalog_Scope(date::local_days base_date, CalcFlags flags, unsigned workers);
+    ~Event_Catalog_Scope();
+    Event_Catalog_Scope(const Event_Catalog_Scope &) = delete;
+    Event_Catalog_Scope & operator=(const Event_Catalog_Scope &) = delete;
+
+private:
+    bool replaced_ = false;
+    std::unique_ptr<const Event_Catalog> previous_;
+};
+
+} // namespace vp
+
+#endif // VP_EVENT_CATALOG_H
@@ -0,0 +1,143 @@
+#include "event-catalog.h"
+
+#include "calc.h"
+
+#include "catch-formatters.h"
+#include "temp-dir.h"
+
+#include <cmath>
+
+using namespace date;
+using namespace vp;
+
+namespace {
+constexpr std::int64_t ms_per_day = 86'400'000;
+// 2000-01-01 12:00 UT
+constexpr double j2000 = 2451545.0;
+
+std::int64_t ms(double juldays) {
+    return std::llround(juldays * static_cast<double>(ms_per_day));
+}
+
+// Tithis starting every day at noon UT from 2000-01-01, starting with tithi 28;
+// more than one checkpoint interval of them.
+Event_Catalog_Data synthetic_catalog() {
+    Event_Catalog_Data data;
+    data.build_id = 7;
+    data.from = sys_days{2000_y/January/1};
+    data.to = sys_days{2001_y/January/1};
+    auto & tithis = data.series[static_cast<std::size_t>(Event_Series::Tithi)];
+    tithis.first_value = 28;
+    for (int i = 0; i < 300; ++i) {
+        tithis.times.push_back(ms(j2000 + i));
+    }
+    auto & sankrantis = data.series[static_cast<std::size_t>(Event_Series::Sankranti)];
+    sankrantis.first_value = 9;
+    sankrantis.times = {ms(j2000 + 13.25), ms(j2000 + 43.75)};
+    return data;
+}
+
+double juldays(std::optional<JulDays_UT> t) {
+    REQUIRE(t.has_value());
+    return t->raw_julian_days_ut().count();
+}
+}
+
+TEST_CASE("Event_Catalog reads back what was written") {
+    Temp_Dir dir{"event-catalog-roundtrip"};
+    const auto path = dir.path / "events.vpe";
+    const auto data = synthetic_catalog();
+    write_event_catalog(path, data);
+
+    const Event_Catalog catalog{path};
+    REQUIRE(catalog.build_id() == 7);
+    REQUIRE(catalog.from() == data.from);
+    REQUIRE(catalog.size(Event_Series::Tithi) == 300);
+    REQUIRE(catalog.size(Event_Series::Nakshatra) == 0);
+    for (std::size_t s = 0; s < event_series_count; ++s) {
+        const auto series = catalog.series(static_cast<Event_Series>(s));
+        REQUIRE(series.first_value == data.series[s].first_value);
+        REQUIRE(series.times == data.series[s].times);
+    }
+}
+
+TEST_CASE("In-memory Event_Catalog is the same as the one read from file") {
+    const auto data = synthetic_catalog();
+    const Event_Catalog catalog{data};
+    REQUIRE(catalog.build_id() == 7);
+    REQUIRE(catalog.to() == data.to);
+    for (std::size_t s = 0; s < event_series_count; ++s) {
+        REQUIRE(catalog.series(static_cast<Event_Series>(s)).times == data.series[s].times);
+    }
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 0.5}}, Tithi{0.0}, false)) == Approx(j2000 + 2.0));
+}
+
+TEST_CASE("set_event_catalog() returns the previous catalog") {
+    const auto data = synthetic_catalog();
+    auto previous = set_event_catalog(std::make_unique<const Event_Catalog>(data));
+    REQUIRE(event_catalog() != nullptr);
+    REQUIRE(event_catalog()->build_id() == 7);
+    auto ours = set_event_catalog(std::move(previous));
+    REQUIRE(ours != nullptr);
+    REQUIRE(ours->build_id() == 7);
+}
+
+TEST_CASE("Event_Catalog finds next start of given tithi, nakshatra or saura masa") {
+    Temp_Dir dir{"event-catalog-find"};
+    const auto path = dir.path / "events.vpe";
+    write_event_catalog(path, synthetic_catalog());
+    const Event_Catalog catalog{path};
+
+    // event i starts tithi (28 + i) % 30
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000}}, Tithi{28.0}, false)) == j2000);
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 0.1}}, Tithi{28.0}, false)) == j2000 + 30);
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 0.1}}, Tithi{0.0}, false)) == j2000 + 2);
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 0.1}}, Tithi::Ekadashi(), false)) == j2000 + 12);
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 0.1}}, Tithi::Ekadashi(), true)) == j2000 + 12);
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 14}}, Tithi::Ekadashi(), true)) == j2000 + 27);
+    // across checkpoints
+    REQUIRE(juldays(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 255.5}}, Tithi{28.0}, false)) == j2000 + 270);
+    REQUIRE(juldays(catalog.find_sankranti(JulDays_UT{double_days{j2000}}, Saura_Masa{10})) == j2000 + 13.25);
+    REQUIRE(juldays(catalog.find_sankranti(JulDays_UT{double_days{j2000}}, Saura_Masa{11})) == j2000 + 43.75);
+
+    SECTION("answers not in the catalog are not guessed") {
+        // past the last event
+        REQUIRE_FALSE(catalog.find_tithi_start(JulDays_UT{double_days{j2000 + 290.5}}, Tithi{28.0}, false));
+        // before the start of the catalog, earlier tithis may be missing
+        REQUIRE_FALSE(catalog.find_tithi_start(JulDays_UT{double_days{j2000 - 1}}, Tithi{28.0}, false));
+        REQUIRE_FALSE(catalog.find_tithi_start(JulDays_UT{double_days{j2000}}, Tithi{10.5}, false));
+        REQUIRE_FALSE(catalog.find_nakshatra_start(JulDays_UT{double_days{j2000}}, Nakshatra{3.0}));
+        REQUIRE_FALSE(catalog.find_sankranti(JulDays_UT{double_days{j2000}}, Saura_Masa{12}));
+    }
+}
+
+TEST_CASE("Event_Catalog rejects damaged files") {
+    Temp_Dir dir{"event-catalog-damaged"};
+    const auto path = dir.path / "events.vpe";
+    write_event_catalog(path, synthetic_catalog());
+    fs::resize_file(path, fs::file_size(path) - 1);
+    REQUIRE_THROWS_AS(Event_Catalog{path}, std::runtime_error);
+}
+
+TEST_CASE("Calc gives the same times with event catalog as without it") {
+    Temp_Dir dir{"event-catalog-calc"};
+    const auto path = dir.path / "events.vpe";
+    write_event_catalog(path, calc_event_catalog(2020_y, 2020_y, CalcFlags::Default, 2));
+    const Event_Catalog catalog{path};
+    REQUIRE(catalog.size(Event_Series::Tithi) > 360);
+    REQUIRE(catalog.size(Event_Series::Nakshatra) > 330);
+    REQUIRE(catalog.size(Event_Series::Sankranti) == 12);
+
+    Calc live{Swe{udupi_coord}};
+    live.catalog = nullptr;
+    Calc cataloged{Swe{udupi_coord}};
+    cataloged.catalog = &catalog;
+    const auto max_difference = double_days{std::chrono::milliseconds{1}};
+    for (int day = 0; day < 300; day += 7) {
+        const JulDays_UT from{local_days{2020_y/January/1} + days{day}};
+        REQUIRE(std::chrono::abs(cataloged.find_exact_tithi_start(from, Tithi::Ekadashi()) - live.find_exact_tithi_start(from, Tithi::Ekadashi())) < max_difference);
+        REQUIRE(std::chrono::abs(cataloged.find_either_tithi_start(from, Tithi::Dvadashi()) - live.find_either_tithi_start(from, Tithi::Dvadashi())) < max_difference);
+        REQUIRE(std::chrono::abs(cataloged.find_nakshatra_start(from, Nakshatra::SHRAVANA_START()) - live.find_nakshatra_start(from, Nakshatra::SHRAVANA_START())) < max_difference);
+        REQUIRE(std::chrono::abs(cataloged.find_sankranti(from, Saura_Masa::Mesha) - live.find_sankranti(from, Saura_Masa::Mesha)) < max_difference);
+    }
+}
@@ -3,73 +3,123 @@
 #include "html-util.h"
 
 #include <string_view>
+#include <vector>
 
 namespace vp {
 
-Html_Table_Writer::Html_Table_Writer(const vp::Table & table) : table_(table){}
+namespace {
 
-std::ostream &operator<<(std::ostream &s, const Html_Table_Writer &tw)
-{
-    struct WriterCallBack : vp::Table::CallBack {
-        std::ostream & s_;
-        const vp::Table & table_;
-        std::vector<bool> width_written_for_column;
-        WriterCallBack(std::ostream & s, const vp::Table & table) : s_(s), table_(table){
-            width_written_for_column.resize(table.width());
-        }
-        void row_begin(std::string_view classes) override {
-            s_ << "<tr";
-            if (!classes.empty()) {
-                s_ << " class=\"" << classes << "\"";
-            }
-            s_ << ">";
+void append(fmt::memory_buffer & buf, std::string_view s) {
+    buf.append(s.data(), s.data() + s.size());
+}
+
+struct WriterCallBack : vp::Table::CallBack {
+    fmt::memory_buffer & buf_;
+    const vp::Table & table_;
+    const Html_Table_Writer::Flush_Fn * flush_fn_;
+    std::size_t chunk_size_;
+    std::vector<bool> width_written_for_column;
+    WriterCallBack(fmt::memory_buffer & buf, const vp::Table & table, const Html_Table_Writer::Flush_Fn * flush_fn, std::size_t chunk_size)
+        : buf_(buf), table_(table), flush_fn_(flush_fn), chunk_size_(chunk_size) {
+        width_written_for_column.resize(table.width());
+    }
+    void write_classes(vp::Css_Classes classes) {
+        if (classes.empty()) return;
+        append(buf_, " class=\"");
+        bool first = true;
+        classes.for_each_name([&](std::string_view name) {
+            if (!first) buf_.push_back(' ');
+            append(buf_, name);
+            first = false;
+        });
+        buf_.push_back('"');
+    }
+    void row_begin(vp::Css_Classes classes) override {
+        append(buf_, "<tr");
+        write_classes(classes);
+        buf_.push_back('>');
+    }
+    void row_end() override {
+        append(buf_, "</tr>\n");
+        if (flush_fn_ && buf_.size() >= chunk_size_) {
+            (*flush_fn_)(std::string_view{buf_.data(), buf_.size()});
+            buf_.clear();
         }
-        void row_end() override {
-            s_ << "</tr>\n";
+    }
+    void write_col_width_if_needed(const vp::Table::Cell & cell) {
+        if (width_written_for_column[cell.col]) {
+            return;
         }
-        void write_col_width_if_needed(const vp::Table::Cell & cell) {
-            if (width_written_for_column[cell.col]) {
-                return;
-            }
-            auto & col_widths = table_.column_widths();
-            if (col_widths.size() >= cell.col+1) {
-                s_ << " width=\"" << col_widths[cell.col] << "%\"";
-            }
-            width_written_for_column[cell.col] = true;
+        auto & col_widths = table_.column_widths();
+        if (col_widths.size() >= cell.col+1) {
+            // same as default std::ostream formatting of doubles
+            fmt::format_to(fmt::appender{buf_}, FMT_STRING(" width=\"{:g}%\""), col_widths[cell.col]);
         }
-        void write_td_or_th(const vp::Table::Cell & cell, std::string_view tag) {
-            s_ << "<" << tag;
-            if (cell.rowspan != 1) {
-                s_ << " rowspan=\"" << cell.rowspan << "\"";
-            }
-            if (cell.colspan != 1) {
-                s_ << " colspan=\"" << cell.colspan << "\"";
-            } else {
-                write_col_width_if_needed(cell);
-            }
-            if (!cell.classes.empty()) {
-                s_ << " class=\"" << cell.classes << "\"";
-            }
-            if (!cell.title.empty()) {
-                s_ << " title=\"" << html::escape_attribute(cell.title) << "\"";
-            }
-            s_ << ">" << cell.text << "</" << tag << ">\n";
+        width_written_for_column[cell.col] = true;
+    }
+    void write_td_or_th(const vp::Table::Cell & cell, std::string_view tag) {
+        buf_.push_back('<');
+        append(buf_, tag);
+        if (cell.rowspan != 1) {
+            fmt::format_to(fmt::appender{buf_}, FMT_STRING(" rowspan=\"{}\""), cell.rowspan);
         }
-        void cell(const vp::Table::Cell & cell) override {
-            write_td_or_th(cell, "td");
+        if (cell.colspan != 1) {
+            fmt::format_to(fmt::appender{buf_}, FMT_STRING(" colspan=\"{}\""), cell.colspan);
+        } else {
+            write_col_width_if_needed(cell);
         }
-        void header_cell(const vp::Table::Cell & cell) override {
-            write_td_or_th(cell, "th");
+        write_classes(cell.classes);
+        if (!cell.title().empty()) {
+            append(buf_, " title=\"");
+            html::escape_attribute_to(buf_, cell.title());
+            buf_.push_back('"');
         }
-    };
+        buf_.push_back('>');
+        append(buf_, cell.text());
+        append(buf_, "</");
+        append(buf_, tag);
+        append(buf_, ">\n");
+    }
+    void cell(const vp::Table::Cell & cell) override {
+        write_td_or_th(cell, "td");
+    }
+    void header_cell(const vp::Table::Cell & cell) override {
+        write_td_or_th(cell, "th");
+    }
+};
 
-    s << "<table>\n";
+} // anonymous namespace
+
+Html_Table_Writer::Html_Table_Writer(const vp::Table & table) : table_(table){}
+
+void Html_Table_Writer::render(fmt::memory_buffer & buf, const Flush_Fn * flush_fn, std::size_t chunk_size) const
+{
+    append(buf, "<table>\n");
     {
-        WriterCallBack callback{s, tw.table_};
-        tw.table_.iterate(callback);
+        WriterCallBack callback{buf, table_, flush_fn, chunk_size};
+        table_.iterate(callback);
     }
-    s << "</table>\n";
-    return s;
+    append(buf, "</table>\n");
+}
+
+void Html_Table_Writer::write(fmt::memory_buffer & buf) const
+{
+    render(buf, nullptr, 0);
+}
+
+void Html_Table_Writer::write(const Flush_Fn & flush_fn, std::size_t chunk_size) const
+{
+    fmt::memory_buffer buf;
+    buf.reserve(chunk_size);
+    render(buf, &flush_fn, chunk_size);
+    flush_fn(std::string_view{buf.data(), buf.size()});
+}
+
+std::ostream &operator<<(std::ostream &s, const Html_Table_Writer &tw)
+{
+    fmt::memory_buffer buf;
+    tw.write(buf);
+    return s.write(buf.data(), static_cast<std::streamsize>(buf.size()));
 }
 
 }
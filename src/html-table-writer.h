@@ -1,17 +1,40 @@
 #ifndef HTML_TABLE_WRITER_H
 #define HTML_TABLE_WRITER_H
 
-#include <ostream>
+#include "fmt-format-fixed.h"
 #include "table.h"
 
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
 namespace vp {
 
+/*
+ * Renders vp::Table as HTML <table> with fmt into a memory buffer, escaping
+ * titles right into it.
+ *
+ * write(buf) appends the whole table to the caller's buffer. write(flush_fn)
+ * renders into an internal buffer and hands it to flush_fn whenever it grows
+ * past chunk_size (at row boundaries) and once more at the end, so that
+ * output of big tables goes out while the rest is still being rendered.
+ */
 class Html_Table_Writer
 {
 public:
+    using Flush_Fn = std::function<void(std::string_view data)>;
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+
     Html_Table_Writer(const vp::Table & table);
+
+    void write(fmt::memory_buffer & buf) const;
+    void write(const Flush_Fn & flush_fn, std::size_t chunk_size = default_chunk_size) const;
+
     friend std::ostream & operator<<(std::ostream & s, const vp::Html_Table_Writer & tw);
 private:
+    void render(fmt::memory_buffer & buf, const Flush_Fn * flush_fn, std::size_t chunk_size) const;
+
     const vp::Table & table_;
 };
 
@@ -2,6 +2,10 @@
 
 #include "html-table-writer.h"
 
+#include <sstream>
+#include <string>
+#include <vector>
+
 namespace {
 std::string table_to_string(const vp::Table & table) {
     std::stringstream stream;
@@ -90,3 +94,39 @@ TEST_CASE("Html_Table_Writer writes cells' 'title' attribute with proper escape"
     using Catch::Matchers::Contains;
     REQUIRE_THAT(s, Contains(R"(title="qwe&amp;&#039;&quot;&lt;&gt;")"));
 }
+
+TEST_CASE("Html_Table_Writer appends to the caller's buffer") {
+    vp::Table table;
+    table.add_cell("text").set_title("a&b");
+
+    fmt::memory_buffer buf;
+    fmt::format_to(fmt::appender{buf}, "<p>before</p>\n");
+    vp::Html_Table_Writer{table}.write(buf);
+    REQUIRE(fmt::to_string(buf) == "<p>before</p>\n" + table_to_string(table));
+}
+
+TEST_CASE("Html_Table_Writer flushes big tables in chunks at row boundaries") {
+    vp::Table table;
+    for (int row = 0; row < 1000; ++row) {
+        table.start_new_row();
+        table.add_cell(fmt::format("cell{},1", row));
+        table.add_cell(fmt::format("cell{},2", row)).set_title("<title>");
+    }
+
+    std::vector<std::string> chunks;
+    vp::Html_Table_Writer{table}.write([&](std::string_view data) { chunks.emplace_back(data); }, 4096);
+
+    REQUIRE(chunks.size() > 5);
+    std::string joined;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        CAPTURE(i);
+        if (i + 1 < chunks.size()) {
+            REQUIRE(chunks[i].size() >= 4096);
+            REQUIRE(chunks[i].size() < 4096 * 2);
+            using Catch::Matchers::EndsWith;
+            REQUIRE_THAT(chunks[i], EndsWith("</tr>\n"));
+        }
+        joined += chunks[i];
+    }
+    REQUIRE(joined == table_to_string(table));
+}
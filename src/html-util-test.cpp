@@ -2,6 +2,76 @@
 
 #include "html-util.h"
 
+#include <string>
+
+namespace {
+
+// Straightforward escaping, char by char into a new string.
+std::string reference_escape(std::string_view s) {
+    std::string escaped;
+    for (auto c : s) {
+        switch(c) {
+        case '&': escaped += "&amp;"; break;
+        case '"': escaped += "&quot;"; break;
+        case '\'': escaped += "&#039;"; break;
+        case '<': escaped += "&lt;"; break;
+        case '>': escaped += "&gt;"; break;
+        default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+std::string repeat(std::string_view s, std::size_t times) {
+    std::string result;
+    for (std::size_t i = 0; i < times; ++i) result += s;
+    return result;
+}
+
+const std::string devanagari = "ॐ नमो भगवते वासुदेवाय। श्रीमन्नारायणाय नमः। ";
+const std::string iast = "Śrīmad-bhāgavatam, Ekādaśī-vrata, pāraṇam, Vaiṣṇavam pañcāṅgam; ";
+
+} // anonymous namespace
+
 TEST_CASE("html::escape_attribute does proper escaping") {
     REQUIRE(html::escape_attribute(R"(qwe&'"<>)") == R"(qwe&amp;&#039;&quot;&lt;&gt;)");
 }
+
+TEST_CASE("html::escape_attribute_to appends escaped text to the buffer") {
+    fmt::memory_buffer buf;
+    html::escape_attribute_to(buf, "a<b");
+    html::escape_attribute_to(buf, "");
+    html::escape_attribute_to(buf, R"("plain" & 'more')");
+    REQUIRE(fmt::to_string(buf) == R"(a&lt;b&quot;plain&quot; &amp; &#039;more&#039;)");
+}
+
+TEST_CASE("html::find_first_to_escape finds each special character at every position and alignment") {
+    for (const char special : std::string{"&\"'<>"}) {
+        for (std::size_t size = 1; size <= 100; ++size) {
+            for (std::size_t pos = 0; pos < size; ++pos) {
+                // offset from the start of the buffer, so that vector loads are unaligned too
+                std::string buffer(size + 7, 'x');
+                buffer[7 + pos] = special;
+                const std::string_view s{buffer.data() + 7, size};
+                CAPTURE(special, size, pos);
+                REQUIRE(html::find_first_to_escape(s) == pos);
+                REQUIRE(html::find_first_to_escape(s, pos) == pos);
+                REQUIRE(html::find_first_to_escape(s, pos + 1) == std::string_view::npos);
+            }
+        }
+    }
+    REQUIRE(html::find_first_to_escape("") == std::string_view::npos);
+    REQUIRE(html::find_first_to_escape(repeat("clean text ", 10)) == std::string_view::npos);
+    // bytes of UTF-8 sequences are never mistaken for ASCII
+    REQUIRE(html::find_first_to_escape(repeat(devanagari + iast, 5)) == std::string_view::npos);
+}
+
+TEST_CASE("html::escape_attribute escapes long Devanagari and IAST strings like the char-by-char loop") {
+    std::string text;
+    for (int i = 0; i < 50; ++i) {
+        text += (i % 2 ? devanagari : iast);
+        text += std::string(1, "&\"'<>"[i % 5]);
+    }
+    REQUIRE(html::escape_attribute(text) == reference_escape(text));
+    REQUIRE(html::escape_attribute(devanagari) == devanagari);
+}
@@ -1,17 +1,123 @@
 #include "html-util.h"
 
-std::string html::escape_attribute(const std::string &s)
-{
-    std::string escaped;
-    for (auto c : s) {
-        switch(c) {
-        case '&': escaped += "&amp;"; break;
-        case '"': escaped += "&quot;"; break;
-        case '\'': escaped += "&#039;"; break;
-        case '<': escaped += "&lt;"; break;
-        case '>': escaped += "&gt;"; break;
-        default: escaped += c; break;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VP_HTML_UTIL_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(VP_HTML_UTIL_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VP_HTML_UTIL_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+bool needs_escaping(char c) {
+    return c == '&' || c == '"' || c == '\'' || c == '<' || c == '>';
+}
+
+const char * find_scalar(const char * p, const char * end) {
+    while (p != end && !needs_escaping(*p)) ++p;
+    return p;
+}
+
+#ifdef VP_HTML_UTIL_SSE2
+const char * find_sse2(const char * p, const char * end) {
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i quot = _mm_set1_epi8('"');
+    const __m128i apos = _mm_set1_epi8('\'');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    for (; end - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i found = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, amp), _mm_cmpeq_epi8(chunk, quot)), _mm_cmpeq_epi8(chunk, apos)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, lt), _mm_cmpeq_epi8(chunk, gt)));
+        if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(found))) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return p + index;
+#else
+            return p + __builtin_ctz(mask);
+#endif
         }
     }
-    return escaped;
+    return find_scalar(p, end);
+}
+#endif
+
+#ifdef VP_HTML_UTIL_AVX2
+__attribute__((target("avx2")))
+const char * find_avx2(const char * p, const char * end) {
+    const __m256i amp = _mm256_set1_epi8('&');
+    const __m256i quot = _mm256_set1_epi8('"');
+    const __m256i apos = _mm256_set1_epi8('\'');
+    const __m256i lt = _mm256_set1_epi8('<');
+    const __m256i gt = _mm256_set1_epi8('>');
+    for (; end - p >= 32; p += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i found = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, amp), _mm256_cmpeq_epi8(chunk, quot)), _mm256_cmpeq_epi8(chunk, apos)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lt), _mm256_cmpeq_epi8(chunk, gt)));
+        if (const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(found))) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_sse2(p, end);
+}
+#endif
+
+using Find_Fn = const char * (*)(const char * p, const char * end);
+
+// Picked once: AVX2 when the CPU has it, otherwise SSE2 (always there on x86-64) or plain loop.
+Find_Fn find_fn() {
+#if defined(VP_HTML_UTIL_AVX2)
+    static const Find_Fn fn = __builtin_cpu_supports("avx2") ? find_avx2 : find_sse2;
+    return fn;
+#elif defined(VP_HTML_UTIL_SSE2)
+    return find_sse2;
+#else
+    return find_scalar;
+#endif
+}
+
+std::string_view entity(char c) {
+    switch(c) {
+    case '&': return "&amp;";
+    case '"': return "&quot;";
+    case '\'': return "&#039;";
+    case '<': return "&lt;";
+    case '>': return "&gt;";
+    }
+    return {};
+}
+
+} // anonymous namespace
+
+std::size_t html::find_first_to_escape(std::string_view s, std::size_t from)
+{
+    if (from >= s.size()) return std::string_view::npos;
+    const auto end = s.data() + s.size();
+    const auto found = find_fn()(s.data() + from, end);
+    return found == end ? std::string_view::npos : static_cast<std::size_t>(found - s.data());
+}
+
+std::string html::escape_attribute(std::string_view s)
+{
+    fmt::memory_buffer escaped;
+    escape_attribute_to(escaped, s);
+    return fmt::to_string(escaped);
+}
+
+void html::escape_attribute_to(fmt::memory_buffer & out, std::string_view s)
+{
+    // Copy runs of ordinary characters at once, titles and names rarely have anything to escape.
+    std::size_t run_start = 0;
+    for (auto i = find_first_to_escape(s); i != std::string_view::npos; i = find_first_to_escape(s, run_start)) {
+        const auto replacement = entity(s[i]);
+        out.append(s.data() + run_start, s.data() + i);
+        out.append(replacement.data(), replacement.data() + replacement.size());
+        run_start = i + 1;
+    }
+    out.append(s.data() + run_start, s.data() + s.size());
 }
@@ -1,11 +1,21 @@
 #ifndef HTMLUTIL_H
 #define HTMLUTIL_H
 
+#include "fmt-format-fixed.h"
+
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 namespace html {
 
-std::string escape_attribute(const std::string & s);
+std::string escape_attribute(std::string_view s);
+// Same as escape_attribute(), but appends to out without a temporary string.
+void escape_attribute_to(fmt::memory_buffer & out, std::string_view s);
+
+// Position of the first of &"'<> in s at or after from, std::string_view::npos if none.
+// Scans 16 or 32 bytes at a time with SSE2 or AVX2 where available.
+std::size_t find_first_to_escape(std::string_view s, std::size_t from = 0);
 
 }
 
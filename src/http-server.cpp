@@ -0,0 +1,665 @@
+#include "http-server.h"
+
+#include "html-table-writer.h"
+#include "json-writer.h"
+#include "lru-cache.h"
+#include "swe.h"
+#include "table-calendar-generator.h"
+#include "text-interface.h"
+#include "vrata-json.h"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+#ifdef __linux__
+#define VP_HAVE_EPOLL
+#include <arpa/inet.h>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#endif
+
+namespace vp::text_ui {
+
+namespace {
+
+struct Http_Error : std::runtime_error {
+    int status;
+    Http_Error(int _status, const std::string & message) : std::runtime_error(message), status(_status) {}
+};
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string percent_decode(std::string_view s) {
+    std::string result;
+    result.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '+') {
+            result += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size() && hex_digit(s[i+1]) >= 0 && hex_digit(s[i+2]) >= 0) {
+            result += static_cast<char>(hex_digit(s[i+1]) * 16 + hex_digit(s[i+2]));
+            i += 2;
+        } else {
+            result += s[i];
+        }
+    }
+    return result;
+}
+
+using Query = std::map<std::string, std::string, std::less<>>;
+
+Query parse_query(std::string_view query) {
+    Query params;
+    while (!query.empty()) {
+        const auto end = std::min(query.find('&'), query.size());
+        const auto param = query.substr(0, end);
+        query.remove_prefix(std::min(end + 1, query.size()));
+        if (param.empty()) continue;
+        const auto eq = param.find('=');
+        if (eq == std::string_view::npos) {
+            params[percent_decode(param)] = "";
+        } else {
+            params[percent_decode(param.substr(0, eq))] = percent_decode(param.substr(eq + 1));
+        }
+    }
+    return params;
+}
+
+const std::string & required_param(const Query & query, std::string_view name) {
+    const auto found = query.find(name);
+    if (found == query.end() || found->second.empty()) {
+        throw Http_Error{400, fmt::format("missing required parameter '{}'", name)};
+    }
+    return found->second;
+}
+
+date::year_month_day date_param(const Query & query) {
+    const auto & s = required_param(query, "date");
+    const auto date = parse_ymd(s);
+    if (!date.ok()) {
+        throw Http_Error{400, fmt::format("bad date '{}', expected YYYY-MM-DD", s)};
+    }
+    return date;
+}
+
+std::string location_param(const Query & query, bool allow_all) {
+    const auto & name = required_param(query, "location");
+    if (!(allow_all && name == "all") && !LocationDb::find_coord(name.c_str())) {
+        throw Http_Error{404, fmt::format("location not found: '{}'", name)};
+    }
+    return name;
+}
+
+Http_Response json_response(int status, const fmt::memory_buffer & buf) {
+    return Http_Response{status, "application/json; charset=utf-8", fmt::to_string(buf)};
+}
+
+Http_Response error_response(int status, std::string_view message) {
+    fmt::memory_buffer buf;
+    Json_Writer{buf}.begin_object().key("error").value(message).end_object();
+    return json_response(status, buf);
+}
+
+Http_Response vratas_response(date::year_month_day date, const std::string & location_name) {
+    std::shared_ptr<const VratasForDate> vratas;
+    {
+        std::lock_guard<std::mutex> lock{sweph_mutex()};
+        vratas = calc_shared(date, location_name);
+    }
+    fmt::memory_buffer buf;
+    Json_Writer w{buf};
+    write_json(w, *vratas);
+    return json_response(200, buf);
+}
+
+Http_Response daybyday_response(date::year_month_day date, const std::string & location_name) {
+    const auto location = LocationDb::find_coord(location_name.c_str());
+    DayByDayInfo info;
+    {
+        std::lock_guard<std::mutex> lock{sweph_mutex()};
+        info = daybyday_calc_one(date, *location, CalcFlags::Default);
+    }
+    fmt::memory_buffer buf;
+    Json_Writer w{buf};
+    write_json(w, info);
+    return json_response(200, buf);
+}
+
+Http_Response table_response(date::year_month_day date) {
+    std::shared_ptr<const VratasForDate> vratas;
+    {
+        std::lock_guard<std::mutex> lock{sweph_mutex()};
+        vratas = calc_shared(date, "all");
+    }
+    fmt::memory_buffer buf;
+    Html_Table_Writer{Table_Calendar_Generator::generate(*vratas, date.year())}.write(buf);
+    return Http_Response{200, "text/html; charset=utf-8", fmt::to_string(buf)};
+}
+
+} // anonymous namespace
+
+Http_Response handle_http_request(std::string_view target) {
+    try {
+        const auto question = target.find('?');
+        const auto path = target.substr(0, question);
+        const auto query = parse_query(question == std::string_view::npos ? std::string_view{} : target.substr(question + 1));
+        if (path == "/calc") {
+            const auto date = date_param(query);
+            return vratas_response(date, location_param(query, true));
+        } else if (path == "/calc_all") {
+            return vratas_response(date_param(query), "all");
+        } else if (path == "/daybyday") {
+            const auto date = date_param(query);
+            return daybyday_response(date, location_param(query, false));
+        } else if (path == "/table") {
+            return table_response(date_param(query));
+        } else if (path == "/version") {
+            fmt::memory_buffer buf;
+            Json_Writer{buf}.begin_object().key("version").value(program_name_and_version()).end_object();
+            return json_response(200, buf);
+        }
+        throw Http_Error{404, fmt::format("unknown endpoint '{}', expected one of: /calc, /calc_all, /daybyday, /table, /version", path)};
+    } catch (const Http_Error & e) {
+        return error_response(e.status, e.what());
+    } catch (const std::exception & e) {
+        return error_response(500, e.what());
+    }
+}
+
+#ifdef VP_HAVE_EPOLL
+
+namespace {
+
+const char * reason_phrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    }
+    return "Unknown";
+}
+
+void append_response(std::string & out, const Http_Response & response, bool keep_alive) {
+    fmt::format_to(std::back_inserter(out),
+                   FMT_STRING("HTTP/1.1 {} {}\r\n"
+                              "Content-Type: {}\r\n"
+                              "Content-Length: {}\r\n"
+                              "Connection: {}\r\n"
+                              "\r\n"),
+                   response.status, reason_phrase(response.status),
+                   response.content_type,
+                   response.body.size(),
+                   keep_alive ? "keep-alive" : "close");
+    out += response.body;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+constexpr std::size_t max_header_size = 8192;
+
+struct Request {
+    std::string target;
+    bool keep_alive = true;
+    // set when request can't be served at all: respond with this and close the connection
+    std::optional<Http_Response> error;
+};
+
+// Parse request head (everything before the empty line).
+Request parse_request_head(std::string_view head) {
+    Request request;
+    const auto line_end = std::min(head.find("\r\n"), head.size());
+    const auto request_line = head.substr(0, line_end);
+    head.remove_prefix(line_end);
+
+    const auto sp1 = request_line.find(' ');
+    const auto sp2 = request_line.rfind(' ');
+    if (sp1 == std::string_view::npos || sp2 == sp1) {
+        request.error = error_response(400, "malformed request line");
+        return request;
+    }
+    const auto method = request_line.substr(0, sp1);
+    const auto version = request_line.substr(sp2 + 1);
+    request.target = std::string{request_line.substr(sp1 + 1, sp2 - sp1 - 1)};
+    request.keep_alive = version == "HTTP/1.1";
+
+    while (!head.empty()) {
+        head.remove_prefix(std::min<std::size_t>(2, head.size())); // "\r\n"
+        const auto end = std::min(head.find("\r\n"), head.size());
+        const auto header = head.substr(0, end);
+        head.remove_prefix(end);
+        const auto colon = header.find(':');
+        if (colon == std::string_view::npos) continue;
+        const auto name = trim(header.substr(0, colon));
+        const auto value = trim(header.substr(colon + 1));
+        if (iequals(name, "Connection")) {
+            if (iequals(value, "close")) request.keep_alive = false;
+            if (iequals(value, "keep-alive")) request.keep_alive = true;
+        } else if ((iequals(name, "Content-Length") && value != "0") || iequals(name, "Transfer-Encoding")) {
+            request.error = error_response(400, "request body is not supported");
+        }
+    }
+    if (!request.error && method != "GET") {
+        request.error = error_response(405, "only GET is supported");
+    }
+    if (request.error) {
+        request.keep_alive = false;
+    }
+    return request;
+}
+
+using Response_Cache = Sharded_Lru_Cache<std::string, Http_Response>;
+
+std::size_t response_size(const Http_Response & response) {
+    return sizeof(response) + response.content_type.capacity() + response.body.capacity();
+}
+
+[[noreturn]] void throw_errno(std::string_view what) {
+    throw std::runtime_error(fmt::format("{}: {}", what, std::strerror(errno)));
+}
+
+class Http_Server {
+public:
+    explicit Http_Server(const Http_Server_Options & options)
+        : options_(options), cache_(options.response_cache_bytes, response_size)
+    {
+    }
+
+    ~Http_Server() {
+        {
+            std::lock_guard<std::mutex> lock{jobs_mutex_};
+            stopping_ = true;
+        }
+        jobs_cv_.notify_all();
+        for (auto & worker : workers_) {
+            worker.join();
+        }
+        for (auto & [id, connection] : connections_) {
+            ::close(connection.fd);
+        }
+        for (int fd : {listen_fd_, epoll_fd_, wake_fd_}) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    void run() {
+        setup();
+        fmt::print(stderr, "listening on http://{}:{}/\n", options_.host, options_.port);
+        epoll_event events[64];
+        auto last_sweep = std::chrono::steady_clock::now();
+        while (true) {
+            const int n = ::epoll_wait(epoll_fd_, events, 64, 1000);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw_errno("epoll_wait() failed");
+            }
+            for (int i = 0; i < n; ++i) {
+                const auto id = events[i].data.u64;
+                if (id == listen_id) {
+                    accept_all();
+                } else if (id == wake_id) {
+                    handle_completions();
+                } else {
+                    handle_connection_event(id, events[i].events);
+                }
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last_sweep > std::chrono::seconds{1}) {
+                close_idle_connections(now);
+                last_sweep = now;
+            }
+        }
+    }
+
+private:
+    static constexpr std::uint64_t listen_id = 0;
+    static constexpr std::uint64_t wake_id = 1;
+
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        std::string out;
+        std::size_t out_sent = 0;
+        std::deque<Request> pending;
+        bool busy = false;               // request is being calculated by a worker
+        bool close_after_write = false;
+        bool read_closed = false;        // client has shut down its side, answer what we've got and close
+        std::uint32_t watched_events = EPOLLIN | EPOLLRDHUP;
+        std::chrono::steady_clock::time_point last_activity;
+    };
+
+    struct Job {
+        std::uint64_t connection_id;
+        std::string target;
+    };
+
+    struct Completion {
+        std::uint64_t connection_id;
+        std::shared_ptr<const Http_Response> response;
+    };
+
+    void setup() {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) throw_errno("can't create socket");
+        const int one = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(options_.port);
+        if (::inet_pton(AF_INET, options_.host.c_str(), &addr.sin_addr) != 1) {
+            throw std::runtime_error(fmt::format("bad IPv4 address '{}'", options_.host));
+        }
+        if (::bind(listen_fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+            throw_errno(fmt::format("can't bind to {}:{}", options_.host, options_.port));
+        }
+        if (::listen(listen_fd_, SOMAXCONN) != 0) throw_errno("listen() failed");
+
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) throw_errno("epoll_create1() failed");
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0) throw_errno("eventfd() failed");
+        watch(listen_fd_, listen_id, EPOLLIN, EPOLL_CTL_ADD);
+        watch(wake_fd_, wake_id, EPOLLIN, EPOLL_CTL_ADD);
+
+        for (unsigned i = 0; i < std::max(1u, options_.workers); ++i) {
+            workers_.emplace_back([this]() { worker_main(); });
+        }
+    }
+
+    void watch(int fd, std::uint64_t id, std::uint32_t events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = id;
+        if (::epoll_ctl(epoll_fd_, op, fd, &ev) != 0) throw_errno("epoll_ctl() failed");
+    }
+
+    void accept_all() {
+        while (true) {
+            const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                // EMFILE and friends: try again on the next wakeup rather than dying
+                fmt::print(stderr, "accept() failed: {}\n", std::strerror(errno));
+                return;
+            }
+            const int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            const auto id = next_connection_id_++;
+            auto & connection = connections_[id];
+            connection.fd = fd;
+            connection.last_activity = std::chrono::steady_clock::now();
+            watch(fd, id, connection.watched_events, EPOLL_CTL_ADD);
+        }
+    }
+
+    void close_connection(std::uint64_t id) {
+        const auto found = connections_.find(id);
+        if (found == connections_.end()) return;
+        // closing fd removes it from epoll set too
+        ::close(found->second.fd);
+        connections_.erase(found);
+    }
+
+    void handle_connection_event(std::uint64_t id, std::uint32_t events) {
+        const auto found = connections_.find(id);
+        if (found == connections_.end()) return;
+        auto & connection = found->second;
+        connection.last_activity = std::chrono::steady_clock::now();
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            close_connection(id);
+            return;
+        }
+        if (events & EPOLLOUT) {
+            if (!flush(id, connection)) return;
+        }
+        if (events & (EPOLLIN | EPOLLRDHUP)) {
+            char buf[16384];
+            while (true) {
+                const auto got = ::read(connection.fd, buf, sizeof(buf));
+                if (got > 0) {
+                    connection.in.append(buf, static_cast<std::size_t>(got));
+                    continue;
+                }
+                if (got < 0 && errno == EINTR) continue;
+                if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (got < 0) {
+                    close_connection(id);
+                    return;
+                }
+                connection.read_closed = true;
+                break;
+            }
+            parse_requests(connection);
+            process_pending(id, connection);
+            flush(id, connection);
+        }
+    }
+
+    void parse_requests(Connection & connection) {
+        if (connection.close_after_write) {
+            connection.in.clear();
+            return;
+        }
+        std::size_t start = 0;
+        while (true) {
+            const auto end = connection.in.find("\r\n\r\n", start);
+            if (end == std::string::npos) break;
+            auto request = parse_request_head(std::string_view{connection.in}.substr(start, end - start));
+            start = end + 4;
+            const bool last = !request.keep_alive;
+            connection.pending.push_back(std::move(request));
+            if (last) {
+                // anything after "Connection: close" is ignored
+                start = connection.in.size();
+                break;
+            }
+        }
+        connection.in.erase(0, start);
+        if (connection.in.size() > max_header_size) {
+            Request request;
+            request.keep_alive = false;
+            request.error = error_response(431, fmt::format("request head is longer than {} bytes", max_header_size));
+            connection.pending.push_back(std::move(request));
+            connection.in.clear();
+        }
+    }
+
+    // Answer pending requests in order: from the cache right away, otherwise
+    // by handing the first one to a worker and waiting for its completion.
+    void process_pending(std::uint64_t id, Connection & connection) {
+        while (!connection.busy && !connection.pending.empty() && !connection.close_after_write) {
+            auto request = std::move(connection.pending.front());
+            connection.pending.pop_front();
+            if (request.error) {
+                respond(connection, *request.error, false);
+                continue;
+            }
+            if (auto cached = cache_.find(request.target)) {
+                respond(connection, *cached, request.keep_alive);
+                continue;
+            }
+            if (!enqueue(Job{id, request.target})) {
+                respond(connection, error_response(503, "too many requests in the queue"), request.keep_alive);
+                continue;
+            }
+            connection.busy = true;
+            // keep the request around for its keep_alive flag
+            connection.pending.push_front(std::move(request));
+        }
+    }
+
+    void respond(Connection & connection, const Http_Response & response, bool keep_alive) {
+        append_response(connection.out, response, keep_alive);
+        if (!keep_alive) {
+            connection.close_after_write = true;
+            connection.pending.clear();
+        }
+    }
+
+    // false if connection was closed
+    bool flush(std::uint64_t id, Connection & connection) {
+        while (connection.out_sent < connection.out.size()) {
+            const auto sent = ::send(connection.fd, connection.out.data() + connection.out_sent,
+                                     connection.out.size() - connection.out_sent, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                close_connection(id);
+                return false;
+            }
+            connection.out_sent += static_cast<std::size_t>(sent);
+        }
+        if (connection.out_sent == connection.out.size()) {
+            connection.out.clear();
+            connection.out_sent = 0;
+            const bool all_answered = !connection.busy && connection.pending.empty();
+            if (connection.close_after_write || (connection.read_closed && all_answered)) {
+                close_connection(id);
+                return false;
+            }
+        }
+        const std::uint32_t events = (connection.read_closed ? 0u : EPOLLIN | EPOLLRDHUP)
+                                   | (connection.out.empty() ? 0u : EPOLLOUT);
+        if (events != connection.watched_events) {
+            watch(connection.fd, id, events, EPOLL_CTL_MOD);
+            connection.watched_events = events;
+        }
+        return true;
+    }
+
+    void close_idle_connections(std::chrono::steady_clock::time_point now) {
+        std::vector<std::uint64_t> idle;
+        for (const auto & [id, connection] : connections_) {
+            if (!connection.busy && connection.out.empty() && now - connection.last_activity > options_.idle_timeout) {
+                idle.push_back(id);
+            }
+        }
+        for (const auto id : idle) {
+            close_connection(id);
+        }
+    }
+
+    bool enqueue(Job job) {
+        {
+            std::lock_guard<std::mutex> lock{jobs_mutex_};
+            if (jobs_.size() >= options_.max_queued_requests) return false;
+            jobs_.push_back(std::move(job));
+        }
+        jobs_cv_.notify_one();
+        return true;
+    }
+
+    void worker_main() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock{jobs_mutex_};
+                jobs_cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+                if (stopping_) return;
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            const auto started = std::chrono::steady_clock::now();
+            auto response = std::make_shared<const Http_Response>(handle_http_request(job.target));
+            if (response->status == 200) {
+                response = cache_.insert(job.target, response);
+            }
+            const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+            fmt::print(stderr, FMT_STRING("{:.3f} ms {} {}\n"), ms, response->status, job.target);
+            {
+                std::lock_guard<std::mutex> lock{completions_mutex_};
+                completions_.push_back(Completion{job.connection_id, std::move(response)});
+            }
+            const std::uint64_t one = 1;
+            [[maybe_unused]] const auto written = ::write(wake_fd_, &one, sizeof(one));
+        }
+    }
+
+    void handle_completions() {
+        std::uint64_t counter;
+        [[maybe_unused]] const auto got = ::read(wake_fd_, &counter, sizeof(counter));
+        std::vector<Completion> completions;
+        {
+            std::lock_guard<std::mutex> lock{completions_mutex_};
+            completions.swap(completions_);
+        }
+        for (const auto & completion : completions) {
+            const auto found = connections_.find(completion.connection_id);
+            if (found == connections_.end()) continue; // client is gone already
+            auto & connection = found->second;
+            const auto request = std::move(connection.pending.front());
+            connection.pending.pop_front();
+            connection.busy = false;
+            respond(connection, *completion.response, request.keep_alive);
+            process_pending(completion.connection_id, connection);
+            flush(completion.connection_id, connection);
+        }
+    }
+
+    Http_Server_Options options_;
+    Response_Cache cache_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::uint64_t next_connection_id_ = 2;
+    std::unordered_map<std::uint64_t, Connection> connections_;
+
+    std::vector<std::thread> workers_;
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+
+    std::mutex completions_mutex_;
+    std::vector<Completion> completions_;
+};
+
+} // anonymous namespace
+
+void serve_http(const Http_Server_Options & options) {
+    LocationDb::locate_time_zones();
+    Http_Server server{options};
+    server.run();
+}
+
+#else
+
+void serve_http(const Http_Server_Options & options) {
+    throw std::runtime_error(fmt::format("can't listen on {}:{}: HTTP server mode is only supported on Linux", options.host, options.port));
+}
+
+#endif // VP_HAVE_EPOLL
+
+} // namespace vp::text_ui
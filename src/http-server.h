@@ -0,0 +1,52 @@
+#ifndef VP_HTTP_SERVER_H
+#define VP_HTTP_SERVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace vp::text_ui {
+
+/*
+ * Minimal HTTP/1.1 server exposing text_ui calculations as JSON (--http mode).
+ * Only GET requests without body are supported:
+ *
+ *     /calc?date=YYYY-MM-DD&location=NAME  → JSON array with one vrata (or "all" locations)
+ *     /calc_all?date=YYYY-MM-DD            → JSON array of vratas for all locations
+ *     /daybyday?date=YYYY-MM-DD&location=NAME → JSON object, see vrata-json.h
+ *     /table?date=YYYY-MM-DD               → HTML table for all locations, like in GUI
+ *     /version                             → {"version": "..."}
+ *
+ * Errors are reported with proper status code and {"error": "..."} body.
+ */
+struct Http_Response {
+    int status = 200;
+    std::string content_type;
+    std::string body;
+};
+
+// Handle single GET request for target like "/calc?date=2020-01-01&location=Kiev". Thread-safe.
+Http_Response handle_http_request(std::string_view target);
+
+struct Http_Server_Options {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 8080;
+    // Calculations are serialized anyway (see sweph_mutex()), more workers only
+    // help with formatting responses and with cache hits while another request calculates.
+    unsigned workers = 4;
+    // When this many requests are waiting for a worker, new ones get "503 Service Unavailable".
+    std::size_t max_queued_requests = 256;
+    // Responses are cached by request target (path + query).
+    std::size_t response_cache_bytes = 64 * 1024 * 1024;
+    std::chrono::seconds idle_timeout{30};
+};
+
+// Single epoll event loop thread handles all connections, keep-alive and pipelining,
+// calculations run in a bounded pool of worker threads. Runs until killed.
+// Linux-only; throws std::runtime_error on other platforms or if the socket can't be set up.
+void serve_http(const Http_Server_Options & options);
+
+} // namespace vp::text_ui
+
+#endif // VP_HTTP_SERVER_H
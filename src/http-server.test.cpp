@@ -0,0 +1,55 @@
+#include "http-server.h"
+
+#include "catch-formatters.h"
+
+using Catch::Matchers::Contains;
+using Catch::Matchers::StartsWith;
+using vp::text_ui::handle_http_request;
+
+TEST_CASE("handle_http_request() reports errors as JSON with proper status") {
+    SECTION("unknown endpoint") {
+        const auto r = handle_http_request("/nope");
+        REQUIRE(r.status == 404);
+        REQUIRE_THAT(r.content_type, StartsWith("application/json"));
+        REQUIRE_THAT(r.body, StartsWith(R"({"error":"unknown endpoint '/nope')"));
+    }
+    SECTION("missing parameter") {
+        REQUIRE(handle_http_request("/calc?location=Kiev").status == 400);
+        REQUIRE(handle_http_request("/calc?date=2020-01-01").status == 400);
+    }
+    SECTION("bad date") {
+        REQUIRE(handle_http_request("/calc_all?date=2020-1-1").status == 400);
+    }
+    SECTION("unknown location") {
+        REQUIRE(handle_http_request("/daybyday?date=2020-01-01&location=Atlantis").status == 404);
+        // "all" is only valid for /calc
+        REQUIRE(handle_http_request("/daybyday?date=2020-01-01&location=all").status == 404);
+    }
+}
+
+TEST_CASE("handle_http_request() calculates vratas") {
+    SECTION("single location, percent-encoded name") {
+        const auto r = handle_http_request("/calc?date=2020-01-01&location=%4Biev");
+        REQUIRE(r.status == 200);
+        REQUIRE_THAT(r.body, StartsWith(R"([{"location":{"name":"Kiev")"));
+        REQUIRE_THAT(r.body, Contains(R"("date":"2020-01-06")"));
+    }
+    SECTION("all locations") {
+        const auto r = handle_http_request("/calc_all?date=2020-01-01");
+        REQUIRE(r.status == 200);
+        REQUIRE_THAT(r.body, Contains(R"("name":"Udupi")"));
+        REQUIRE_THAT(r.body, Contains(R"("name":"Kiev")"));
+    }
+    SECTION("day by day") {
+        const auto r = handle_http_request("/daybyday?date=2020-01-01&location=Kiev");
+        REQUIRE(r.status == 200);
+        REQUIRE_THAT(r.body, Contains(R"("sunrise":"2020-01-01T)"));
+        REQUIRE_THAT(r.body, Contains("+02:00"));
+    }
+    SECTION("table") {
+        const auto r = handle_http_request("/table?date=2020-01-01");
+        REQUIRE(r.status == 200);
+        REQUIRE_THAT(r.content_type, StartsWith("text/html"));
+        REQUIRE_THAT(r.body, Contains("<table"));
+    }
+}
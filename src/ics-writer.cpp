@@ -0,0 +1,219 @@
+#include "ics-writer.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vp {
+
+namespace {
+
+struct Event {
+    std::string kind; // unique within the vrata, part of UID
+    date::local_days date; // first local date
+    date::days days{1}; // for all-day events
+    std::optional<std::pair<JulDays_UT, JulDays_UT>> time; // for timed events
+    std::string summary;
+    std::string description;
+};
+
+date::local_days local_date(const Time_Zone * time_zone, JulDays_UT t) {
+    return date::floor<date::days>(t.as_local_time(time_zone));
+}
+
+std::vector<Event> events_for(const Vrata & vrata) {
+    const auto * time_zone = vrata.location.time_zone();
+    std::vector<Event> events;
+
+    {
+        Event ekadashi;
+        ekadashi.kind = "ekadashi";
+        ekadashi.date = vrata.date;
+        ekadashi.days = date::days{is_atirikta(vrata.type) ? 2 : 1};
+        ekadashi.summary = fmt::format(FMT_STRING("{} Ekādaśī"), vrata.ekadashi_name());
+        ekadashi.description = fmt::format(FMT_STRING("{}. {} māsa, {} pakṣa."), vrata.type, vrata.masa, vrata.paksha);
+        const auto day1 = vrata.day1_additional_event_name();
+        if (!day1.empty()) {
+            ekadashi.description += "\n" + day1;
+        }
+        const auto day2 = vrata.day2_additional_event_name();
+        if (!day2.empty()) {
+            ekadashi.description += "\n" + day2;
+        }
+        events.push_back(std::move(ekadashi));
+    }
+
+    {
+        Event paran;
+        paran.kind = "paran";
+        paran.summary = "Pāraṇam";
+        const auto & p = vrata.paran;
+        if (p.paran_start && p.paran_end) {
+            paran.date = local_date(time_zone, *p.paran_start);
+            paran.time = std::make_pair(*p.paran_start, *p.paran_end);
+            paran.description = fmt::format(FMT_STRING("{} ({}) until {} ({})"), p.start_str(), p.start_type(), p.end_str(), p.end_type());
+        } else {
+            paran.date = vrata.local_paran_date();
+            if (p.paran_start) {
+                paran.description = fmt::format(FMT_STRING("after {} ({})"), p.start_str(), p.start_type());
+            } else if (p.paran_end) {
+                paran.description = fmt::format(FMT_STRING("before {} ({})"), p.end_str(), p.end_type());
+            }
+        }
+        events.push_back(std::move(paran));
+    }
+
+    if (const auto harivasara = vrata.harivasara()) {
+        Event event;
+        event.kind = "harivasara";
+        event.date = local_date(time_zone, *harivasara);
+        event.time = std::make_pair(*harivasara, vrata.sunrise1);
+        event.summary = "Harivāsara";
+        event.description = "Last quarter of Ekādaśī tithi, until sunrise";
+        events.push_back(std::move(event));
+    }
+
+    // Ekādaśī, pāraṇam and Harivāsara are already covered above, only festivals are left.
+    int index = 0;
+    for (const auto & [date, named_date] : vrata.dates_for_this_paksha) {
+        if (named_date.css_classes != "custom") continue;
+        Event event;
+        event.kind = fmt::format(FMT_STRING("named{}"), index++);
+        event.date = date;
+        event.summary = named_date.name;
+        event.description = named_date.title;
+        events.push_back(std::move(event));
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const Event & left, const Event & right) {
+        if (left.date != right.date) return left.date < right.date;
+        // all-day events first
+        if (left.time.has_value() != right.time.has_value()) return !left.time.has_value();
+        return left.time && left.time->first < right.time->first;
+    });
+    return events;
+}
+
+void append(fmt::memory_buffer & out, std::string_view s) {
+    out.append(s.data(), s.data() + s.size());
+}
+
+// TEXT value escaping (RFC 5545 3.3.11)
+void append_escaped(fmt::memory_buffer & out, std::string_view s) {
+    for (const char c : s) {
+        switch (c) {
+        case '\\': append(out, "\\\\"); break;
+        case ';': append(out, "\\;"); break;
+        case ',': append(out, "\\,"); break;
+        case '\n': append(out, "\\n"); break;
+        case '\r': break;
+        default: out.push_back(c);
+        }
+    }
+}
+
+// Lines longer than 75 octets must be folded (RFC 5545 3.1), without
+// splitting UTF-8 sequences. Folds the line starting at `start` in place and terminates it.
+void end_line(fmt::memory_buffer & out, std::size_t start) {
+    constexpr std::size_t max_octets = 75;
+    if (out.size() - start > max_octets) {
+        const std::string line{out.data() + start, out.size() - start};
+        out.resize(start);
+        std::size_t pos = 0;
+        std::size_t limit = max_octets;
+        while (line.size() - pos > limit) {
+            auto cut = pos + limit;
+            while (cut > pos && (static_cast<unsigned char>(line[cut]) & 0xC0) == 0x80) --cut;
+            out.append(line.data() + pos, line.data() + cut);
+            append(out, "\r\n ");
+            pos = cut;
+            limit = max_octets - 1; // leading space counts too
+        }
+        out.append(line.data() + pos, line.data() + line.size());
+    }
+    append(out, "\r\n");
+}
+
+void text_property(fmt::memory_buffer & out, std::string_view name, std::string_view value) {
+    const auto start = out.size();
+    append(out, name);
+    out.push_back(':');
+    append_escaped(out, value);
+    end_line(out, start);
+}
+
+void format_date(fmt::memory_buffer & out, date::local_days d) {
+    const date::year_month_day ymd{d};
+    fmt::format_to(fmt::appender{out}, FMT_STRING("{:04}{:02}{:02}"),
+                   static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()));
+}
+
+void format_utc(fmt::memory_buffer & out, date::sys_seconds t) {
+    const auto day = date::floor<date::days>(t);
+    format_date(out, date::local_days{day.time_since_epoch()});
+    const date::hh_mm_ss<std::chrono::seconds> time{t - day};
+    fmt::format_to(fmt::appender{out}, FMT_STRING("T{:02}{:02}{:02}Z"), time.hours().count(), time.minutes().count(), time.seconds().count());
+}
+
+} // anonymous namespace
+
+Ics_Writer::Ics_Writer(std::string_view calendar_name, Flush_Fn flush_fn, date::sys_seconds dtstamp)
+    : flush_(std::move(flush_fn)), dtstamp_(dtstamp)
+{
+    append(buf_, "BEGIN:VCALENDAR\r\n"
+                 "VERSION:2.0\r\n"
+                 "PRODID:-//vaishnavam-panchangam//EN\r\n"
+                 "CALSCALE:GREGORIAN\r\n"
+                 "METHOD:PUBLISH\r\n");
+    text_property(buf_, "X-WR-CALNAME", calendar_name);
+    flush();
+}
+
+void Ics_Writer::write(const Vrata & vrata) {
+    const auto location = vrata.location_name();
+    for (const auto & event : events_for(vrata)) {
+        append(buf_, "BEGIN:VEVENT\r\n");
+        auto start = buf_.size();
+        append(buf_, "UID:");
+        format_date(buf_, event.date);
+        fmt::format_to(fmt::appender{buf_}, FMT_STRING("-{}-{}@vaishnavam-panchangam"), event.kind, location);
+        end_line(buf_, start);
+        append(buf_, "DTSTAMP:");
+        format_utc(buf_, dtstamp_);
+        append(buf_, "\r\n");
+        if (event.time) {
+            append(buf_, "DTSTART:");
+            format_utc(buf_, event.time->first.round_to_second());
+            append(buf_, "\r\nDTEND:");
+            format_utc(buf_, event.time->second.round_to_second());
+        } else {
+            append(buf_, "DTSTART;VALUE=DATE:");
+            format_date(buf_, event.date);
+            append(buf_, "\r\nDTEND;VALUE=DATE:");
+            format_date(buf_, event.date + event.days);
+        }
+        append(buf_, "\r\n");
+        text_property(buf_, "SUMMARY", event.summary);
+        if (!event.description.empty()) {
+            text_property(buf_, "DESCRIPTION", event.description);
+        }
+        text_property(buf_, "LOCATION", location);
+        append(buf_, "TRANSP:TRANSPARENT\r\n"
+                     "END:VEVENT\r\n");
+    }
+    flush();
+}
+
+void Ics_Writer::finish() {
+    append(buf_, "END:VCALENDAR\r\n");
+    flush();
+}
+
+void Ics_Writer::flush() {
+    flush_(std::string_view{buf_.data(), buf_.size()});
+    buf_.clear();
+}
+
+} // namespace vp
@@ -0,0 +1,49 @@
+#ifndef VP_ICS_WRITER_H
+#define VP_ICS_WRITER_H
+
+#include "fmt-format-fixed.h"
+#include "tz-fixed.h"
+#include "vrata.h"
+
+#include <chrono>
+#include <functional>
+#include <string_view>
+
+namespace vp {
+
+/*
+ * Streaming iCalendar (RFC 5545) export, for importing vratas into calendar apps.
+ *
+ * For each vrata these events are written: the ekādaśī itself (all-day,
+ * two days for atirikta vratas), pāraṇam (timed when both start and end
+ * are known, all-day otherwise), Harivāsara (from its start until sunrise)
+ * and other named dates of the pakṣa like Māgha festivals and Jayantī.
+ * Events of one vrata are sorted by time. Events of consecutive vratas
+ * don't overlap in time, so the whole output is in time order as long as
+ * vratas come in date order.
+ *
+ * Header goes out in the constructor, footer in finish(). Each vrata's
+ * events are written into the same reused buffer and flushed at once.
+ */
+class Ics_Writer {
+public:
+    using Flush_Fn = std::function<void(std::string_view data)>;
+
+    // dtstamp is the creation time of the calendar, required by RFC 5545.
+    Ics_Writer(std::string_view calendar_name, Flush_Fn flush_fn,
+               date::sys_seconds dtstamp = date::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+
+    void write(const Vrata & vrata);
+    void finish();
+
+private:
+    void flush();
+
+    Flush_Fn flush_;
+    fmt::memory_buffer buf_;
+    date::sys_seconds dtstamp_;
+};
+
+} // namespace vp
+
+#endif // VP_ICS_WRITER_H
@@ -0,0 +1,84 @@
+#include "ics-writer.h"
+
+#include "catch-formatters.h"
+
+#include <sstream>
+
+using namespace date;
+using namespace vp;
+using Catch::Matchers::Contains;
+using Catch::Matchers::StartsWith;
+using Catch::Matchers::EndsWith;
+
+namespace {
+std::vector<std::string> lines_of(const std::string & ics) {
+    std::vector<std::string> lines;
+    std::size_t pos = 0;
+    while (pos < ics.size()) {
+        const auto end = ics.find("\r\n", pos);
+        REQUIRE(end != std::string::npos);
+        lines.push_back(ics.substr(pos, end - pos));
+        pos = end + 2;
+    }
+    return lines;
+}
+
+std::string ics_for(const Vrata & vrata, std::size_t * flushes = nullptr) {
+    std::string ics;
+    std::size_t flush_count = 0;
+    Ics_Writer writer{"Test", [&](std::string_view data) { ics += data; ++flush_count; }, sys_days{2021_y/January/1}};
+    writer.write(vrata);
+    writer.finish();
+    if (flushes) *flushes = flush_count;
+    return ics;
+}
+}
+
+TEST_CASE("Ics_Writer writes all-day ekadashi event and festivals of the paksha in time order") {
+    Vrata vrata{local_days{2021_y/February/23}, Chandra_Masa::Magha, Paksha::Shukla};
+    vrata.dates_for_this_paksha.emplace(local_days{2021_y/February/27}, NamedDate{"Pūrṇimā, Māgha-snāna-vrata ends", "", "custom"});
+    vrata.dates_for_this_paksha.emplace(local_days{2021_y/February/16}, NamedDate{"Vasanta-pañcamī", "", "custom"});
+    vrata.dates_for_this_paksha.emplace(local_days{2021_y/February/23}, NamedDate{"only for HTML tables", "", "vrata"});
+
+    std::size_t flushes = 0;
+    const auto ics = ics_for(vrata, &flushes);
+    REQUIRE(flushes == 3); // header, vrata, footer
+    REQUIRE_THAT(ics, StartsWith("BEGIN:VCALENDAR\r\nVERSION:2.0\r\n"));
+    REQUIRE_THAT(ics, EndsWith("END:VEVENT\r\nEND:VCALENDAR\r\n"));
+    REQUIRE_THAT(ics, Contains("DTSTAMP:20210101T000000Z\r\n"));
+    REQUIRE_THAT(ics, Contains("SUMMARY:Pūrṇimā\\, Māgha-snāna-vrata ends\r\n"));
+    REQUIRE_THAT(ics, !Contains("only for HTML tables"));
+
+    std::vector<std::string> starts;
+    for (const auto & line : lines_of(ics)) {
+        REQUIRE(line.size() <= 75);
+        if (line.rfind("DTSTART", 0) == 0) starts.push_back(line);
+    }
+    REQUIRE(starts == std::vector<std::string>{
+        "DTSTART;VALUE=DATE:20210216",
+        "DTSTART;VALUE=DATE:20210223",
+        "DTSTART;VALUE=DATE:20210224", // pāraṇam without known times
+        "DTSTART;VALUE=DATE:20210227",
+    });
+}
+
+TEST_CASE("Ics_Writer folds long lines without splitting UTF-8 characters") {
+    Vrata vrata{local_days{2021_y/February/23}, Chandra_Masa::Magha, Paksha::Shukla};
+    std::string long_name;
+    for (int i = 0; i < 20; ++i) long_name += "Ekādaśī ";
+    vrata.dates_for_this_paksha.emplace(local_days{2021_y/February/24}, NamedDate{long_name, "", "custom"});
+
+    const auto ics = ics_for(vrata);
+    std::string unfolded;
+    for (const auto & line : lines_of(ics)) {
+        REQUIRE(line.size() <= 75);
+        // continuation lines never start in the middle of a UTF-8 sequence
+        if (line.size() > 1 && line[0] == ' ') {
+            REQUIRE((static_cast<unsigned char>(line[1]) & 0xC0) != 0x80);
+            unfolded += line.substr(1);
+        } else {
+            unfolded += "\n" + line;
+        }
+    }
+    REQUIRE_THAT(unfolded, Contains("\nSUMMARY:" + long_name + "\n"));
+}
@@ -1,9 +1,14 @@
 #include "jayanti.h"
 
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+
 namespace vp {
 
 static tl::expected<date::local_days, vp::CalcError>
-local_sun_date_covering_given_time(vp::Swe & swe, const date::time_zone * time_zone, vp::JulDays_UT time);
+local_sun_date_covering_given_time(vp::Swe & swe, const Time_Zone * time_zone, vp::JulDays_UT time);
 
 tl::expected<std::vector<RohiniBahulashtamiYoga>, CalcError> rohini_bahulashtami_yogas_in_year(Calc &c, date::year year) {
     std::vector<RohiniBahulashtamiYoga> yogas;
@@ -124,21 +129,49 @@ bool Interval::contains(JulDays_UT t) const
 }
 
 static tl::expected<date::local_days, vp::CalcError>
-local_sun_date_covering_given_time(vp::Swe & swe, const date::time_zone * time_zone, vp::JulDays_UT time) {
+local_sun_date_covering_given_time(vp::Swe & swe, const Time_Zone * time_zone, vp::JulDays_UT time) {
     const auto sunset = swe.next_sunset(time);
     if (!sunset) { return tl::make_unexpected(sunset.error()); }
 
-    const auto sunset_local = sunset->as_zoned_time(time_zone).get_local_time();
+    const auto sunset_local = sunset->as_local_time(time_zone);
     return date::floor<date::days>(sunset_local) - date::days{1};
 }
 
+namespace {
+
+/**
+ * Yearly Rohiṇī-bahulāṣṭamī scan is by far the most expensive part of finding
+ * Jayanti, and it's needed twice per year for the same location (both for
+ * Śrāvaṇa and Bhādrapada kṛṣṇa-pakṣa), so keep the results around.
+ * Scan result depends only on coordinates, flags and year (times are UT).
+ */
+tl::expected<std::vector<RohiniBahulashtamiYoga>, CalcError> cached_rohini_bahulashtami_yogas_in_year(Calc &c, date::year year) {
+    using Key = std::tuple<double, double, std::uint32_t, int>;
+    static std::mutex mutex;
+    static std::map<Key, tl::expected<std::vector<RohiniBahulashtamiYoga>, CalcError>> cache;
+    constexpr std::size_t max_entries = 1024;
+
+    const Key key{c.swe.location.latitude.latitude, c.swe.location.longitude.longitude, static_cast<std::uint32_t>(c.swe.calc_flags), static_cast<int>(year)};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (auto found = cache.find(key); found != cache.end()) return found->second;
+    }
+    auto yogas = rohini_bahulashtami_yogas_in_year(c, year);
+    std::lock_guard<std::mutex> lock{mutex};
+    if (cache.size() >= max_entries) cache.clear();
+    cache.emplace(key, yogas);
+    return yogas;
+}
+
+} // anonymous namespace
+
 /**
  * find_krishna_jayanti: find Krishna Jayanti vrata date, but only when it's
  * on the same half-masa as a given Ekadashi vrata.
  */
 tl::expected<std::pair<date::local_days, vp::RoK8YogaKalpa>, vp::CalcError>
 find_krishna_jayanti(const vp::Vrata & vrata, vp::Calc & calc) {
-    const auto yogas = rohini_bahulashtami_yogas_in_year(calc, date::year_month_day{vrata.date}.year());
+    const auto yogas = cached_rohini_bahulashtami_yogas_in_year(calc, date::year_month_day{vrata.date}.year());
     if (!yogas) return tl::make_unexpected(yogas.error());
     if (yogas->empty()) {
         return tl::make_unexpected(vp::NoRohiniAshtamiIntersectionForJayanti{});
@@ -0,0 +1,156 @@
+#ifndef VP_JSON_WRITER_H
+#define VP_JSON_WRITER_H
+
+#include "fmt-format-fixed.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vp {
+
+/*
+ * Minimal streaming JSON writer: appends compact JSON straight to a
+ * memory_buffer, inserting commas automatically. Strings are expected to be
+ * UTF-8 and are written as-is except for mandatory escapes. Non-finite
+ * numbers are written as null.
+ *
+ *     w.begin_object().key("a").value(1).key("b").begin_array().value("x").end_array().end_object();
+ */
+class Json_Writer {
+public:
+    explicit Json_Writer(fmt::memory_buffer & out) : out_(out) {}
+
+    Json_Writer & begin_object() { return open('{'); }
+    Json_Writer & end_object() { return close('}'); }
+    Json_Writer & begin_array() { return open('['); }
+    Json_Writer & end_array() { return close(']'); }
+
+    Json_Writer & key(std::string_view k) {
+        before_value();
+        write_string(k);
+        out_.push_back(':');
+        after_key_ = true;
+        return *this;
+    }
+
+    Json_Writer & value(std::string_view s) {
+        before_value();
+        write_string(s);
+        return *this;
+    }
+    Json_Writer & value(const char * s) { return value(std::string_view{s}); }
+    // String value appended by write(out), for text known to need no escaping (dates, numbers).
+    template<typename Write>
+    Json_Writer & raw_string(Write && write) {
+        before_value();
+        out_.push_back('"');
+        write(out_);
+        out_.push_back('"');
+        return *this;
+    }
+    // String value formatted straight into the output, without a temporary std::string.
+    template<typename... Args>
+    Json_Writer & formatted_value(fmt::format_string<Args...> format, Args &&... args) {
+        before_value();
+        out_.push_back('"');
+        const auto start = out_.size();
+        fmt::format_to(fmt::appender{out_}, format, std::forward<Args>(args)...);
+        const auto needs_escape = [](char c) { return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20; };
+        if (std::any_of(out_.data() + start, out_.data() + out_.size(), needs_escape)) {
+            // rare: move it out of the way and write it again, escaped
+            const std::string raw{out_.data() + start, out_.size() - start};
+            out_.resize(start);
+            write_escaped(raw);
+        }
+        out_.push_back('"');
+        return *this;
+    }
+    Json_Writer & value(bool b) {
+        before_value();
+        append(b ? "true" : "false");
+        return *this;
+    }
+    Json_Writer & value(int i) { return value(static_cast<std::int64_t>(i)); }
+    Json_Writer & value(std::int64_t i) {
+        before_value();
+        fmt::format_to(fmt::appender{out_}, "{}", i);
+        return *this;
+    }
+    Json_Writer & value(std::uint64_t i) {
+        before_value();
+        fmt::format_to(fmt::appender{out_}, "{}", i);
+        return *this;
+    }
+    Json_Writer & value(double d) {
+        if (!std::isfinite(d)) return null();
+        before_value();
+        fmt::format_to(fmt::appender{out_}, "{}", d);
+        return *this;
+    }
+    Json_Writer & null() {
+        before_value();
+        append("null");
+        return *this;
+    }
+
+private:
+    Json_Writer & open(char c) {
+        before_value();
+        out_.push_back(c);
+        empty_.push_back(true);
+        return *this;
+    }
+    Json_Writer & close(char c) {
+        out_.push_back(c);
+        empty_.pop_back();
+        return *this;
+    }
+    void before_value() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (!empty_.empty()) {
+            if (!empty_.back()) out_.push_back(',');
+            empty_.back() = false;
+        }
+    }
+    void append(std::string_view s) {
+        out_.append(s.data(), s.data() + s.size());
+    }
+    void write_string(std::string_view s) {
+        out_.push_back('"');
+        write_escaped(s);
+        out_.push_back('"');
+    }
+    void write_escaped(std::string_view s) {
+        for (const char c : s) {
+            switch (c) {
+            case '"': append("\\\""); break;
+            case '\\': append("\\\\"); break;
+            case '\n': append("\\n"); break;
+            case '\r': append("\\r"); break;
+            case '\t': append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    fmt::format_to(fmt::appender{out_}, "\\u{:04x}", static_cast<unsigned>(c));
+                } else {
+                    out_.push_back(c);
+                }
+            }
+        }
+    }
+
+    fmt::memory_buffer & out_;
+    std::vector<bool> empty_; // per nesting level: nothing written there yet
+    bool after_key_ = false;
+};
+
+} // namespace vp
+
+#endif // VP_JSON_WRITER_H
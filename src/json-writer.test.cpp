@@ -0,0 +1,50 @@
+#include "json-writer.h"
+
+#include "catch-formatters.h"
+
+#include <limits>
+
+using vp::Json_Writer;
+
+namespace {
+template<typename Fn>
+std::string json(Fn && fn) {
+    fmt::memory_buffer buf;
+    Json_Writer w{buf};
+    fn(w);
+    return fmt::to_string(buf);
+}
+}
+
+TEST_CASE("Json_Writer inserts commas between elements and members") {
+    REQUIRE(json([](Json_Writer & w) { w.begin_array().end_array(); }) == "[]");
+    REQUIRE(json([](Json_Writer & w) { w.begin_array().value(1).value("a").value(true).null().end_array(); }) == R"([1,"a",true,null])");
+    REQUIRE(json([](Json_Writer & w) {
+        w.begin_object()
+            .key("a").value(1)
+            .key("b").begin_array().begin_object().end_object().begin_object().key("c").value(false).end_object().end_array()
+            .key("d").begin_object().end_object()
+        .end_object();
+    }) == R"({"a":1,"b":[{},{"c":false}],"d":{}})");
+}
+
+TEST_CASE("Json_Writer escapes strings") {
+    REQUIRE(json([](Json_Writer & w) { w.value("quote\" backslash\\ newline\n tab\t bell\x07"); })
+            == R"("quote\" backslash\\ newline\n tab\t bell\u0007")");
+    // UTF-8 is passed through as is
+    REQUIRE(json([](Json_Writer & w) { w.value("Ekādaśī"); }) == "\"Ekādaśī\"");
+}
+
+TEST_CASE("Json_Writer writes non-finite numbers as null") {
+    REQUIRE(json([](Json_Writer & w) { w.value(1.5); }) == "1.5");
+    REQUIRE(json([](Json_Writer & w) { w.value(std::numeric_limits<double>::quiet_NaN()); }) == "null");
+    REQUIRE(json([](Json_Writer & w) { w.value(std::numeric_limits<double>::infinity()); }) == "null");
+}
+
+TEST_CASE("Json_Writer formats values in place") {
+    REQUIRE(json([](Json_Writer & w) { w.begin_array().formatted_value("{}-{:02}", 2020, 1).formatted_value("{}", "a\"b").end_array(); })
+            == R"(["2020-01","a\"b"])");
+    REQUIRE(json([](Json_Writer & w) {
+        w.begin_object().key("x").raw_string([](fmt::memory_buffer & out) { out.push_back('1'); }).end_object();
+    }) == R"({"x":"1"})");
+}
@@ -16,7 +16,7 @@ JulDays_UT::JulDays_UT(date::year_month_day d, double_hours hours)
                                          SE_GREG_CAL)};
 }
 
-JulDays_UT::JulDays_UT(date::local_time<double_days> t, const date::time_zone * tz)
+JulDays_UT::JulDays_UT(date::local_time<double_days> t, const Time_Zone * tz)
 {
     auto z = date::make_zoned(tz, t, date::choose::earliest);
     date::sys_time<double_days> sys = z.get_sys_time();
@@ -160,9 +160,14 @@ date::sys_seconds JulDays_UT::round_to_second() const
     return date::round<std::chrono::seconds>(as_sys_time());
 }
 
-date::zoned_time<double_days> JulDays_UT::as_zoned_time(const date::time_zone * time_zone) const
+date::zoned_time<double_days, const Time_Zone *> JulDays_UT::as_zoned_time(const Time_Zone * time_zone) const
 {
     return date::make_zoned(time_zone, as_sys_time());
 }
 
+date::local_time<std::common_type_t<double_days, std::chrono::seconds>> JulDays_UT::as_local_time(const Time_Zone * time_zone) const
+{
+    return time_zone->to_local(as_sys_time());
+}
+
 } // namespace vp
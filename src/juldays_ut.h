@@ -2,7 +2,7 @@
 #define JulDays_UT_H_INCLUDED
 
 #include "date-fixed.h"
-#include "tz-fixed.h"
+#include "time-zone.h"
 
 namespace vp {
 
@@ -23,7 +23,7 @@ class JulDays_UT
 public:
     constexpr explicit JulDays_UT(double_days juldays_ut) : juldays_ut_(juldays_ut){}
     explicit JulDays_UT(date::year_month_day d, double_hours hours=double_hours{});
-    explicit JulDays_UT(date::local_time<double_days> t, const date::time_zone * tz);
+    explicit JulDays_UT(date::local_time<double_days> t, const Time_Zone * tz);
     explicit JulDays_UT(date::sys_time<double_days> t);
     explicit JulDays_UT(date::local_days);
 
@@ -45,7 +45,9 @@ public:
     date::sys_seconds round_to_second_down() const;
     date::sys_seconds round_to_minute() const;
     date::sys_seconds round_to_second() const;
-    date::zoned_time<double_days> as_zoned_time(const date::time_zone * time_zone) const;
+    date::zoned_time<double_days, const Time_Zone *> as_zoned_time(const Time_Zone * time_zone) const;
+    // Same as as_zoned_time(time_zone).get_local_time(), but with only an offset lookup.
+    date::local_time<std::common_type_t<double_days, std::chrono::seconds>> as_local_time(const Time_Zone * time_zone) const;
 private:
     double_days juldays_ut_{};
 };
@@ -53,8 +55,8 @@ private:
 class JulDays_Zoned {
 public:
     JulDays_UT t_;
-    const date::time_zone *time_zone_;
-    JulDays_Zoned(const date::time_zone * time_zone, JulDays_UT t) :
+    const Time_Zone *time_zone_;
+    JulDays_Zoned(const Time_Zone * time_zone, JulDays_UT t) :
         t_(t), time_zone_(time_zone) {}
 };
 
@@ -87,8 +89,9 @@ struct fmt::formatter<vp::JulDays_Zoned> {
     auto parse(ParseContext & ctx) { return ctx.begin(); }
     template<typename FormatContext>
     auto format(const vp::JulDays_Zoned & t, FormatContext & ctx) -> decltype(ctx.out()) {
-        const auto z = t.t_.as_zoned_time(t.time_zone_);
-        return fmt::format_to(ctx.out(), "{}", z);
+        // same as formatting t.t_.as_zoned_time(t.time_zone_), without building date::sys_info
+        const auto sys = date::sys_time<vp::double_days>{t.t_.as_sys_time()};
+        return fmt::format_to(ctx.out(), "{} {}", t.time_zone_->to_local(sys), t.time_zone_->abbrev(date::floor<std::chrono::seconds>(sys)));
     }
 };
 
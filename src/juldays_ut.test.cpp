@@ -101,14 +101,14 @@ TEST_CASE("Can substract JulDays_UT from JulDays_UT") {
 }
 
 TEST_CASE("Pretty-print zoned time") {
-    const auto time_zone = date::locate_zone("Europe/Kiev");
+    const auto time_zone = locate_time_zone("Europe/Kiev");
     const auto t = JulDays_Zoned{time_zone, JulDays_UT{2019_y/March/10, double_hours{4.5}}};
     REQUIRE(fmt::to_string(t) == "2019-03-10 06:30:00.000000 EET");
 }
 
 TEST_CASE("Can create Juldays_UT from local hh:mm") {
     date::local_time<double_days> local = date::local_days(2019_y/January/1) + std::chrono::hours{3} + std::chrono::minutes{15};
-    JulDays_UT jd{local, date::locate_zone("Europe/Moscow")};
+    JulDays_UT jd{local, locate_time_zone("Europe/Moscow")};
     // 0.25 means 00:15am UTC which correposnds to 03:15 Moscow local time
     REQUIRE(JulDays_UT{2019_y/January/1, double_hours{0.25}} == jd);
 }
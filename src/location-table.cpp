@@ -0,0 +1,217 @@
+#include "location-table.h"
+
+#include "fmt-format-fixed.h"
+#include "mapped-file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace vp {
+
+namespace {
+
+std::array<double, 3> unit_vector(Coord coord) {
+    constexpr double degrees = 3.14159265358979323846 / 180.0;
+    const double lat = coord.latitude.latitude * degrees;
+    const double lng = coord.longitude.longitude * degrees;
+    return {std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat)};
+}
+
+// Squared chord length: grows monotonically with the great-circle distance, and it's cheap.
+double distance2(const std::array<double, 3> & a, const std::array<double, 3> & b) {
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Splits one CSV line into fields. Returns nullopt on unbalanced quotes.
+std::optional<std::vector<std::string>> split_csv_line(std::string_view line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quoted) {
+            if (c != '"') {
+                fields.back() += c;
+            } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += '"';
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else {
+            fields.back() += c;
+        }
+    }
+    if (quoted) return std::nullopt;
+    return fields;
+}
+
+std::string_view trim(std::string_view s) {
+    constexpr std::string_view whitespace{" \t\r"};
+    const auto start = s.find_first_not_of(whitespace);
+    if (start == std::string_view::npos) return {};
+    return s.substr(start, s.find_last_not_of(whitespace) - start + 1);
+}
+
+} // anonymous namespace
+
+Location_Table::Location_Table(const std::vector<Location> & locations)
+{
+    locations_.reserve(locations.size());
+    for (const auto & location : locations) {
+        add(location);
+    }
+    build_indexes();
+}
+
+void Location_Table::add(Location location)
+{
+    location.name = strings_.intern(location.name);
+    location.country = strings_.intern(location.country);
+    location.time_zone_name = strings_.intern(location.time_zone_name);
+    auto zone = zones_.find(location.time_zone_name);
+    if (zone == zones_.end()) {
+        // locate_time_zone() throws std::runtime_error for unknown zones, which is what we want
+        zone = zones_.emplace(location.time_zone_name, locate_time_zone(location.time_zone_name)).first;
+    }
+    location.set_time_zone(zone->second);
+    locations_.push_back(location);
+}
+
+void Location_Table::build_indexes()
+{
+    if (locations_.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error(fmt::format("too many locations: {}", locations_.size()));
+    }
+    fingerprint_ = vp::fingerprint(Location{});
+    by_name_.clear();
+    by_name_.reserve(locations_.size());
+    tree_.clear();
+    tree_.reserve(locations_.size());
+    for (std::uint32_t i = 0; i < locations_.size(); ++i) {
+        const auto & location = locations_[i];
+        fingerprint_ = vp::fingerprint(location, fingerprint_);
+        by_name_.emplace(location.name, i); // keeps the first one for duplicate names
+        tree_.push_back(Tree_Node{unit_vector(Coord{location.latitude, location.longitude}), i});
+    }
+    build_tree(0, tree_.size(), 0);
+}
+
+void Location_Table::build_tree(std::size_t from, std::size_t to, unsigned axis)
+{
+    if (to - from <= 1) return;
+    const auto middle = from + (to - from) / 2;
+    const auto begin = tree_.begin();
+    using Diff = decltype(tree_)::difference_type;
+    std::nth_element(begin + static_cast<Diff>(from), begin + static_cast<Diff>(middle), begin + static_cast<Diff>(to),
+                     [axis](const Tree_Node & a, const Tree_Node & b) { return a.point[axis] < b.point[axis]; });
+    const unsigned next_axis = (axis + 1) % 3;
+    build_tree(from, middle, next_axis);
+    build_tree(middle + 1, to, next_axis);
+}
+
+void Location_Table::search_tree(std::size_t from, std::size_t to, unsigned axis, const std::array<double, 3> & point,
+                                 std::uint32_t & best, double & best_distance) const
+{
+    if (from >= to) return;
+    const auto middle = from + (to - from) / 2;
+    const auto & node = tree_[middle];
+    const double distance = distance2(node.point, point);
+    // Ties go to the earlier location, so that the result doesn't depend on the tree shape.
+    if (distance < best_distance || (distance == best_distance && node.location < best)) {
+        best = node.location;
+        best_distance = distance;
+    }
+    const unsigned next_axis = (axis + 1) % 3;
+    const double offset = point[axis] - node.point[axis];
+    const bool left_first = offset < 0;
+    if (left_first) {
+        search_tree(from, middle, next_axis, point, best, best_distance);
+    } else {
+        search_tree(middle + 1, to, next_axis, point, best, best_distance);
+    }
+    // The other half can only have something closer if the splitting plane is within reach.
+    if (offset * offset <= best_distance) {
+        if (left_first) {
+            search_tree(middle + 1, to, next_axis, point, best, best_distance);
+        } else {
+            search_tree(from, middle, next_axis, point, best, best_distance);
+        }
+    }
+}
+
+const Location * Location_Table::find(std::string_view name) const
+{
+    const auto found = by_name_.find(name);
+    if (found == by_name_.end()) return nullptr;
+    return &locations_[found->second];
+}
+
+const Location * Location_Table::nearest(Coord coord) const
+{
+    if (tree_.empty()) return nullptr;
+    std::uint32_t best = 0;
+    double best_distance = std::numeric_limits<double>::infinity();
+    search_tree(0, tree_.size(), 0, unit_vector(coord), best, best_distance);
+    return &locations_[best];
+}
+
+Location_Table Location_Table::parse_csv(std::string_view csv, std::string_view source_name)
+{
+    Location_Table table;
+    std::size_t line_number = 0;
+    while (!csv.empty()) {
+        const auto eol = std::min(csv.find('\n'), csv.size());
+        const auto line = trim(csv.substr(0, eol));
+        csv.remove_prefix(std::min(eol + 1, csv.size()));
+        ++line_number;
+        if (line.empty() || line.front() == '#') continue;
+
+        const auto error = [&](std::string_view what) {
+            return std::runtime_error(fmt::format("{}:{}: {}", source_name, line_number, what));
+        };
+        const auto fields = split_csv_line(line);
+        if (!fields) throw error("unbalanced quotes");
+        if (trim((*fields)[0]) == "name") continue; // header
+        if (fields->size() != 4 && fields->size() != 5) {
+            throw error(fmt::format("expected 4 or 5 fields (name,latitude,longitude,time zone[,country]), got {}", fields->size()));
+        }
+        const auto name = trim((*fields)[0]);
+        const auto latitude = parse_degrees(trim((*fields)[1]));
+        const auto longitude = parse_degrees(trim((*fields)[2]));
+        const auto time_zone_name = trim((*fields)[3]);
+        const auto country = fields->size() == 5 ? trim((*fields)[4]) : std::string_view{};
+        if (name.empty()) throw error("empty location name");
+        if (!latitude || *latitude < -90.0 || *latitude > 90.0) throw error(fmt::format("bad latitude '{}'", (*fields)[1]));
+        if (!longitude || *longitude < -180.0 || *longitude > 180.0) throw error(fmt::format("bad longitude '{}'", (*fields)[2]));
+
+        Location location{Latitude{*latitude}, Longitude{*longitude}};
+        location.name = name;
+        location.time_zone_name = time_zone_name;
+        if (!country.empty()) location.country = country;
+        try {
+            table.add(location);
+        } catch (const std::runtime_error & e) {
+            throw error(e.what());
+        }
+    }
+    table.build_indexes();
+    return table;
+}
+
+Location_Table Location_Table::load_csv(const fs::path & path)
+{
+    const Mapped_File file{path};
+    return parse_csv(file.data(), path.string());
+}
+
+} // namespace vp
@@ -0,0 +1,86 @@
+#ifndef VP_LOCATION_TABLE_H
+#define VP_LOCATION_TABLE_H
+
+#include "filesystem-fixed.h"
+#include "location.h"
+#include "string-pool.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vp {
+
+/*
+ * Named locations with indexes for fast lookups, meant to stay fast with
+ * 100k entries:
+ * - names, time zone names and countries are interned into the table's own
+ *   string pool (so Locations handed out by the table point into it and stay
+ *   valid for as long as the table lives);
+ * - each distinct time zone is looked up in tzdata once, when the table is
+ *   built, and all Locations come with it already set (see Location::set_time_zone());
+ * - find() is a hash lookup by name;
+ * - nearest() is a k-d tree search over points on the unit sphere, so it
+ *   works across the antimeridian and near the poles.
+ *
+ * Locations can be loaded from CSV, one per line:
+ *   name,latitude,longitude,time zone[,country]
+ * with latitude and longitude in decimal degrees (negative for S and W).
+ * Fields containing commas go in double quotes ("" for a quote inside).
+ * Empty lines, lines starting with '#' and a "name,..." header line are skipped.
+ */
+class Location_Table {
+public:
+    Location_Table() = default;
+    // Throws std::runtime_error if some time zone is not in tzdata.
+    explicit Location_Table(const std::vector<Location> & locations);
+    Location_Table(Location_Table &&) = default;
+    Location_Table & operator=(Location_Table &&) = default;
+    Location_Table(const Location_Table &) = delete;
+    Location_Table & operator=(const Location_Table &) = delete;
+
+    // Throws std::runtime_error pointing to the line on any syntax error, bad coordinates or unknown time zone.
+    // source_name is only used in error messages.
+    static Location_Table parse_csv(std::string_view csv, std::string_view source_name);
+    static Location_Table load_csv(const fs::path & path);
+
+    // In the original order.
+    auto begin() const { return locations_.cbegin(); }
+    auto end() const { return locations_.cend(); }
+    std::size_t size() const { return locations_.size(); }
+    bool empty() const { return locations_.empty(); }
+
+    // First location with this exact name, nullptr if there is none.
+    const Location * find(std::string_view name) const;
+    // Location with the smallest great-circle distance to coord, nullptr if the table is empty.
+    const Location * nearest(Coord coord) const;
+
+    // Identity of the whole set of locations (see vp::fingerprint()), stable between runs.
+    std::uint64_t fingerprint() const { return fingerprint_; }
+
+private:
+    struct Tree_Node {
+        std::array<double, 3> point; // on the unit sphere
+        std::uint32_t location;      // index in locations_
+    };
+
+    void add(Location location);
+    void build_indexes();
+    void build_tree(std::size_t from, std::size_t to, unsigned axis);
+    void search_tree(std::size_t from, std::size_t to, unsigned axis, const std::array<double, 3> & point,
+                     std::uint32_t & best, double & best_distance) const;
+
+    String_Pool strings_;
+    std::unordered_map<std::string_view, const Time_Zone *> zones_;
+    std::vector<Location> locations_;
+    std::unordered_map<std::string_view, std::uint32_t> by_name_;
+    std::vector<Tree_Node> tree_; // implicit: node of [from, to) is at the middle, left half before it
+    std::uint64_t fingerprint_ = 0;
+};
+
+} // namespace vp
+
+#endif // VP_LOCATION_TABLE_H
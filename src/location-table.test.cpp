@@ -0,0 +1,117 @@
+#include "location-table.h"
+
+#include "catch-formatters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace vp;
+
+namespace {
+
+constexpr std::string_view sample_csv =
+    "# sample locations\n"
+    "name,latitude,longitude,time zone,country\n"
+    "Udupi,13.3408,74.7517,Asia/Kolkata,India\n"
+    "\n"
+    "\"Washington, D.C.\",38.8833,-77.0333,America/New_York,USA\r\n"
+    "Kolkata, 22.5333, 88.3667, Asia/Kolkata\n"
+    "Petropavlovsk-Kamchatsky,53.0167,158.65,Asia/Kamchatka,Russia\n"
+    "Anadyr,64.7333,177.5167,Asia/Anadyr,Russia\n"
+    "Udupi,0,0,UTC,Duplicate";
+
+double great_circle(Coord a, Coord b) {
+    constexpr double degrees = 3.14159265358979323846 / 180.0;
+    const double lat1 = a.latitude.latitude * degrees, lat2 = b.latitude.latitude * degrees;
+    const double dlng = (b.longitude.longitude - a.longitude.longitude) * degrees;
+    return std::acos(std::clamp(std::sin(lat1) * std::sin(lat2) + std::cos(lat1) * std::cos(lat2) * std::cos(dlng), -1.0, 1.0));
+}
+
+} // anonymous namespace
+
+TEST_CASE("Location_Table parses CSV with comments, header, quotes and optional country") {
+    const auto table = Location_Table::parse_csv(sample_csv, "sample.csv");
+    REQUIRE(table.size() == 6);
+
+    const auto washington = table.find("Washington, D.C.");
+    REQUIRE(washington != nullptr);
+    REQUIRE(washington->latitude == Latitude{38.8833});
+    REQUIRE(washington->longitude == Longitude{-77.0333});
+    REQUIRE(washington->time_zone_name == "America/New_York");
+    REQUIRE(washington->country == "USA");
+
+    const auto kolkata = table.find("Kolkata");
+    REQUIRE(kolkata != nullptr);
+    REQUIRE(kolkata->country == "Unknown");
+
+    REQUIRE(table.find("Nowhere") == nullptr);
+    // first one wins for duplicate names
+    REQUIRE(table.find("Udupi")->country == "India");
+}
+
+TEST_CASE("Location_Table interns strings and resolves each time zone once") {
+    const auto table = Location_Table::parse_csv(sample_csv, "sample.csv");
+    const auto udupi = table.find("Udupi");
+    const auto kolkata = table.find("Kolkata");
+    REQUIRE(udupi->time_zone_name.data() == kolkata->time_zone_name.data());
+    REQUIRE(udupi->time_zone() == locate_time_zone("Asia/Kolkata"));
+    // copies keep the resolved zone
+    const Location copy = *kolkata;
+    REQUIRE(copy.time_zone() == udupi->time_zone());
+}
+
+TEST_CASE("Location_Table reports bad lines with their numbers") {
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("A,1,2,UTC\nB,1,2\n", "x.csv"), Catch::Contains("x.csv:2:"));
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("A,91,2,UTC\n", "x.csv"), Catch::Contains("bad latitude"));
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("A,1,east,UTC\n", "x.csv"), Catch::Contains("bad longitude"));
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("A,nan,2,UTC\n", "x.csv"), Catch::Contains("bad latitude"));
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("A,1,inf,UTC\n", "x.csv"), Catch::Contains("bad longitude"));
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("A,0x1p4,2,UTC\n", "x.csv"), Catch::Contains("bad latitude"));
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("\"A,1,2,UTC\n", "x.csv"), Catch::Contains("unbalanced quotes"));
+    REQUIRE_THROWS_WITH(Location_Table::parse_csv("\n\nA,1,2,Mars/Olympus_Mons\n", "x.csv"), Catch::Contains("x.csv:3:"));
+}
+
+TEST_CASE("Location_Table::nearest() works across the antimeridian") {
+    const auto table = Location_Table::parse_csv(sample_csv, "sample.csv");
+    // Chukotka, just east of 180°: Anadyr is closer than Petropavlovsk
+    REQUIRE(table.nearest(Coord{Latitude{65.0}, Longitude{-178.0}})->name == "Anadyr");
+    REQUIRE(table.nearest(Coord{Latitude{13.0}, Longitude{75.0}})->name == "Udupi");
+    REQUIRE(table.nearest(Coord{Latitude{40.0}, Longitude{-75.0}})->name == "Washington, D.C.");
+    REQUIRE(Location_Table{}.nearest(Coord{}) == nullptr);
+}
+
+TEST_CASE("Location_Table::nearest() agrees with brute force on many random locations") {
+    std::mt19937 random{12345};
+    std::uniform_real_distribution<double> latitude{-90.0, 90.0};
+    std::uniform_real_distribution<double> longitude{-180.0, 180.0};
+    std::vector<std::string> names;
+    for (int i = 0; i < 5000; ++i) names.push_back(fmt::format("L{}", i));
+    std::vector<Location> locations;
+    for (const auto & name : names) {
+        Location l{Latitude{latitude(random)}, Longitude{longitude(random)}, name.c_str()};
+        locations.push_back(l);
+    }
+    const Location_Table table{locations};
+    REQUIRE(table.size() == locations.size());
+
+    for (int i = 0; i < 500; ++i) {
+        const Coord coord{Latitude{latitude(random)}, Longitude{longitude(random)}};
+        const auto found = table.nearest(coord);
+        REQUIRE(found != nullptr);
+        double best = 10.0;
+        for (const auto & l : locations) {
+            best = std::min(best, great_circle(coord, Coord{l.latitude, l.longitude}));
+        }
+        REQUIRE(great_circle(coord, Coord{found->latitude, found->longitude}) == Approx(best).margin(1e-12));
+    }
+}
+
+TEST_CASE("Location_Table fingerprint depends on all locations in order") {
+    const std::vector<Location> locations{udupi_coord, kalkuta_coord};
+    const std::vector<Location> reversed{kalkuta_coord, udupi_coord};
+    auto expected = fingerprint(Location{});
+    for (const auto & l : locations) expected = fingerprint(l, expected);
+    REQUIRE(Location_Table{locations}.fingerprint() == expected);
+    REQUIRE(Location_Table{reversed}.fingerprint() != expected);
+}
@@ -1,5 +1,8 @@
 #include "location.h"
 
+#include <cstdlib>
+#include <cstring>
+
 namespace {
 int_fast8_t compare(vp::Latitude l1, vp::Latitude l2) {
     if (l1.latitude < l2.latitude) {
@@ -107,3 +110,54 @@ bool vp::operator >(vp::Coord coord1, vp::Coord coord2) {
 bool vp::operator >=(vp::Coord coord1, vp::Coord coord2) {
     return compare(coord1, coord2) >= 0;
 }
+
+namespace {
+constexpr std::uint64_t fnv_prime = 0x100000001b3ull;
+
+std::uint64_t fnv1a(std::uint64_t hash, const void * data, std::size_t size) {
+    const auto * bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+std::uint64_t fnv1a(std::uint64_t hash, double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // hash bytes in fixed (little-endian) order so that result doesn't depend on the platform
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        hash ^= (bits >> shift) & 0xFFu;
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+std::uint64_t fnv1a(std::uint64_t hash, std::string_view s) {
+    hash = fnv1a(hash, s.data(), s.size());
+    // terminator, so that {"ab", "c"} and {"a", "bc"} differ
+    hash ^= 0xFFu;
+    return hash * fnv_prime;
+}
+}
+
+std::uint64_t vp::fingerprint(const vp::Location & location, std::uint64_t seed) {
+    auto hash = fnv1a(seed, location.latitude.latitude);
+    hash = fnv1a(hash, location.longitude.longitude);
+    hash = fnv1a(hash, location.time_zone_name);
+    hash = fnv1a(hash, location.name);
+    hash = fnv1a(hash, location.country);
+    const unsigned char adjusted = location.latitude_adjusted ? 1 : 0;
+    return fnv1a(hash, &adjusted, 1);
+}
+
+std::optional<double> vp::parse_degrees(std::string_view s) {
+    // std::from_chars for double isn't available everywhere yet
+    std::string str{s};
+    if (str.find_first_of("xX") != std::string::npos) return std::nullopt;
+    char * end = nullptr;
+    const double value = std::strtod(str.c_str(), &end);
+    if (str.empty() || end != str.c_str() + str.size() || !std::isfinite(value)) return std::nullopt;
+    return value;
+}
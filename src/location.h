@@ -2,11 +2,14 @@
 #define LOCATION_H
 
 #include <cmath> // fabs
+#include <cstdint>
 #include <cstring>
 #include "fmt-format-fixed.h"
+#include <optional>
+#include <string>
 #include <string_view>
 #include <tuple> // for std::tie() in comparison operators.
-#include "tz-fixed.h"
+#include "time-zone.h"
 
 namespace vp {
 
@@ -94,14 +97,19 @@ struct Location
           time_zone_name(_time_zone_name),
           name(_name),
           country(_country) {}
-    const date::time_zone * time_zone() const {
+    const Time_Zone * time_zone() const {
         if (!_time_zone) {
-            _time_zone = date::locate_zone(time_zone_name);
+            _time_zone = locate_time_zone(time_zone_name);
         }
         return _time_zone;
     }
+    // Use already looked up zone (which must be the one named time_zone_name),
+    // so that neither this Location nor its copies have to call locate_time_zone().
+    void set_time_zone(const Time_Zone * zone) {
+        _time_zone = zone;
+    }
 private:
-    mutable const date::time_zone * _time_zone = nullptr;
+    mutable const Time_Zone * _time_zone = nullptr;
 };
 
 inline bool operator==(const Location & one, const Location & other) {
@@ -112,6 +120,16 @@ inline bool operator!=(const Location & one, const Location & other) {
     return !(one == other);
 }
 
+// Latitude or longitude in decimal degrees, like "50.45" or "-30.5".
+// Unlike strtod() this refuses "nan", "inf" and hex floats: NaN would
+// slip through any range check. Range is up to the caller.
+std::optional<double> parse_degrees(std::string_view s);
+
+// 64-bit FNV-1a hash of coordinates, time zone and names. Unlike std::hash
+// it's stable between runs, so it can be used in persistent cache keys.
+// Pass previous result as a seed to combine several locations.
+std::uint64_t fingerprint(const Location & location, std::uint64_t seed = 0xcbf29ce484222325ull);
+
 inline bool operator<(const Location & one, const Location & two) {
     return
             std::tie(one.latitude.latitude, one.longitude.longitude, one.time_zone_name, one.name, one.country) <
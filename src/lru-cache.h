@@ -0,0 +1,169 @@
+#ifndef VP_LRU_CACHE_H
+#define VP_LRU_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vp {
+
+struct Lru_Cache_Stats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+    std::size_t memory_budget = 0;
+};
+
+/*
+ * Thread-safe LRU cache bounded by (approximate) memory usage.
+ *
+ * Values are immutable and handed out as shared_ptr<const Value>, so a hit
+ * costs one mutex lock of a single shard, one hash lookup and one refcount
+ * increment: no copying, no allocations. Evicted values stay alive for as
+ * long as somebody still holds them.
+ *
+ * Keys are split into independent shards by hash to reduce lock contention.
+ * Memory budget is split equally between shards, each shard evicts its own
+ * least recently used entries. The most recently inserted entry is never
+ * evicted, even if it alone exceeds the shard budget.
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class Sharded_Lru_Cache {
+public:
+    using Value_Ptr = std::shared_ptr<const Value>;
+    // Approximate number of bytes used by the value, including heap-allocated parts.
+    using Size_Fn = std::function<std::size_t(const Value &)>;
+
+    explicit Sharded_Lru_Cache(std::size_t memory_budget, Size_Fn size_fn, std::size_t shard_count = 8)
+        : shards_(std::max<std::size_t>(1, shard_count)), size_fn_(std::move(size_fn))
+    {
+        set_memory_budget(memory_budget);
+    }
+
+    // nullptr when not found
+    Value_Ptr find(const Key & key) {
+        auto & shard = shard_for(key);
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        auto found = shard.index.find(key);
+        if (found == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        // move to the front (most recently used), splice() doesn't allocate
+        shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return found->second->value;
+    }
+
+    // Returns the value which ends up in cache: if another thread has
+    // inserted the same key in the meantime, its value wins.
+    Value_Ptr insert(const Key & key, Value_Ptr value) {
+        const auto size = size_fn_(*value);
+        auto & shard = shard_for(key);
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        if (auto found = shard.index.find(key); found != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+            return found->second->value;
+        }
+        shard.lru.push_front(Entry{key, value, size});
+        shard.index.emplace(key, shard.lru.begin());
+        shard.bytes += size;
+        evict_if_needed(shard);
+        return value;
+    }
+
+    // Look up the key, calculate and insert the value if it's not there yet.
+    // compute() is called without holding any locks, so two threads missing
+    // the same key at the same time may both compute it; only one result is kept.
+    template<typename Compute>
+    Value_Ptr get_or_compute(const Key & key, Compute && compute) {
+        if (auto found = find(key)) {
+            return found;
+        }
+        return insert(key, std::make_shared<const Value>(compute()));
+    }
+
+    void set_memory_budget(std::size_t memory_budget) {
+        memory_budget_.store(memory_budget, std::memory_order_relaxed);
+        for (auto & shard : shards_) {
+            std::lock_guard<std::mutex> lock{shard.mutex};
+            evict_if_needed(shard);
+        }
+    }
+
+    void clear() {
+        for (auto & shard : shards_) {
+            std::lock_guard<std::mutex> lock{shard.mutex};
+            shard.index.clear();
+            shard.lru.clear();
+            shard.bytes = 0;
+        }
+    }
+
+    Lru_Cache_Stats stats() const {
+        Lru_Cache_Stats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        stats.memory_budget = memory_budget_.load(std::memory_order_relaxed);
+        for (auto & shard : shards_) {
+            std::lock_guard<std::mutex> lock{shard.mutex};
+            stats.entries += shard.index.size();
+            stats.bytes += shard.bytes;
+        }
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        Value_Ptr value;
+        std::size_t size;
+    };
+    using Lru_List = std::list<Entry>;
+    struct Shard {
+        mutable std::mutex mutex;
+        Lru_List lru; // most recently used first
+        std::unordered_map<Key, typename Lru_List::iterator, Hash> index;
+        std::size_t bytes = 0;
+    };
+
+    Shard & shard_for(const Key & key) {
+        // Mix the hash before picking a shard: otherwise all keys in a shard
+        // would share the same low bits, which is bad for the shard's own hash map.
+        const std::uint64_t mixed = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[static_cast<std::size_t>(mixed >> 32) % shards_.size()];
+    }
+
+    // must be called with shard.mutex locked
+    void evict_if_needed(Shard & shard) {
+        const auto shard_budget = memory_budget_.load(std::memory_order_relaxed) / shards_.size();
+        while (shard.bytes > shard_budget && shard.lru.size() > 1) {
+            const auto & victim = shard.lru.back();
+            shard.bytes -= victim.size;
+            shard.index.erase(victim.key);
+            shard.lru.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<Shard> shards_;
+    Size_Fn size_fn_;
+    std::atomic<std::size_t> memory_budget_{0};
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
+
+} // namespace vp
+
+#endif // VP_LRU_CACHE_H
@@ -0,0 +1,92 @@
+#include "lru-cache.h"
+
+#include "catch-formatters.h"
+
+#include <string>
+#include <thread>
+
+using namespace vp;
+
+namespace {
+using String_Cache = Sharded_Lru_Cache<int, std::string>;
+
+std::size_t string_size(const std::string & s) {
+    return s.size();
+}
+}
+
+TEST_CASE("Sharded_Lru_Cache counts hits and misses") {
+    String_Cache cache{1000, string_size, 1};
+    REQUIRE(cache.find(1) == nullptr);
+    cache.insert(1, std::make_shared<const std::string>("one"));
+    const auto found = cache.find(1);
+    REQUIRE(found != nullptr);
+    REQUIRE(*found == "one");
+
+    const auto stats = cache.stats();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.bytes == 3);
+}
+
+TEST_CASE("Sharded_Lru_Cache hits return the same shared object") {
+    String_Cache cache{1000, string_size};
+    const auto inserted = cache.get_or_compute(42, []{ return std::string{"forty two"}; });
+    const auto found = cache.get_or_compute(42, []{ return std::string{"must not be called"}; });
+    REQUIRE(found.get() == inserted.get());
+}
+
+TEST_CASE("Sharded_Lru_Cache evicts least recently used entries when over budget") {
+    String_Cache cache{10, string_size, 1};
+    cache.insert(1, std::make_shared<const std::string>("aaaa"));
+    cache.insert(2, std::make_shared<const std::string>("bbbb"));
+    cache.find(1); // now 2 is the least recently used one
+    const auto held = cache.find(2);
+    cache.find(1);
+    cache.insert(3, std::make_shared<const std::string>("cccc"));
+
+    REQUIRE(cache.find(1) != nullptr);
+    REQUIRE(cache.find(2) == nullptr);
+    REQUIRE(cache.find(3) != nullptr);
+    REQUIRE(cache.stats().evictions == 1);
+    // evicted value is still alive for those who hold it
+    REQUIRE(*held == "bbbb");
+}
+
+TEST_CASE("Sharded_Lru_Cache keeps the newest entry even if it's bigger than the budget") {
+    String_Cache cache{4, string_size, 1};
+    cache.insert(1, std::make_shared<const std::string>("way too long"));
+    REQUIRE(cache.find(1) != nullptr);
+}
+
+TEST_CASE("Sharded_Lru_Cache shrinks when budget is decreased") {
+    String_Cache cache{100, string_size, 1};
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(i, std::make_shared<const std::string>("0123456789"));
+    }
+    REQUIRE(cache.stats().entries == 10);
+    cache.set_memory_budget(30);
+    REQUIRE(cache.stats().entries == 3);
+    REQUIRE(cache.find(9) != nullptr);
+    REQUIRE(cache.find(0) == nullptr);
+}
+
+TEST_CASE("Sharded_Lru_Cache can be used from several threads") {
+    String_Cache cache{1000000, string_size};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache]{
+            for (int i = 0; i < 1000; ++i) {
+                const auto value = cache.get_or_compute(i % 100, [i]{ return std::to_string(i % 100); });
+                if (*value != std::to_string(i % 100)) throw std::logic_error("wrong value in cache");
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    const auto stats = cache.stats();
+    REQUIRE(stats.entries == 100);
+    REQUIRE(stats.hits + stats.misses == 4000);
+}
@@ -1,25 +1,123 @@
 #include <chrono>
 #include <cstring>
+#include <fstream>
+#include <iostream>
 #include "fmt-format-fixed.h"
 
+#include "batch-query.h"
+#include "http-server.h"
+#include "process-pool.h"
+#include "serve.h"
 #include "text-interface.h"
+#include "vrata-export.h"
+#include "vrata-boundary.h"
+#include "vrata-grid.h"
 
 // include Windows.h should go after including date.h (which is included from text-interface.h).
 // Otherwise troubles with min() which is used both as: 1) a macro in Windows.h 2) method function in date.h.
 #ifdef _WIN32
 #include <Windows.h>
+#include <fcntl.h>
+#include <io.h>
 #endif
 
 void print_usage() {
     fmt::print("{}\n"
                "USAGE:\n"
-               "vaishnavam-panchangam YYYY-MM-DD latitude longitude\n"
+               "vaishnavam-panchangam YYYY-MM-DD latitude longitude [--nearest-time-zone]\n"
                "vaishnavam-panchangam YYYY-MM-DD location-name\n"
+               "vaishnavam-panchangam -d YYYY-MM-DD[..YYYY-MM-DD] location-name\n"
+               "vaishnavam-panchangam --processes N YYYY-MM-DD YYYY-MM-DD [location-name]\n"
+               "vaishnavam-panchangam --serve [socket-path]\n"
+               "vaishnavam-panchangam --http [port]\n"
+               "vaishnavam-panchangam --batch FILE|- [processes]\n"
+               "vaishnavam-panchangam --year YYYY [--combined|--continuous] [--compare] [processes]\n"
+               "vaishnavam-panchangam --ics location-name FROM-YEAR [TO-YEAR] [processes]\n"
+               "vaishnavam-panchangam --grid YYYY-MM-DD [step] [south north west east] [processes]\n"
+               "vaishnavam-panchangam --boundaries YYYY-MM-DD [--along-longitudes] [step] [south north west east] [processes]\n"
+               "vaishnavam-panchangam --build-almanac FILE [FROM-YEAR TO-YEAR] [processes]\n"
+               "vaishnavam-panchangam --verify-almanac FILE [samples]\n"
+               "vaishnavam-panchangam --build-event-catalog FILE [FROM-YEAR TO-YEAR] [processes]\n"
+               "vaishnavam-panchangam --build-tzdb FILE\n"
+               "vaishnavam-panchangam --format=ndjson|csv|bin YYYY-MM-DD location-name|all\n"
+               "vaishnavam-panchangam --format=ndjson|csv|bin -d YYYY-MM-DD[..YYYY-MM-DD] location-name\n"
+               "vaishnavam-panchangam --format=ndjson|csv|bin --processes N YYYY-MM-DD YYYY-MM-DD [location-name]\n"
                "\n"
-               "    latitude and longitude are given as decimal degrees (e.g. 30.7)\n",
+               "    latitude and longitude are given as decimal degrees (e.g. 30.7); times are in UTC\n"
+               "    or, with --nearest-time-zone, in the time zone of the nearest known location\n"
+               "    -d: day-by-day events for the date or for the range of dates (both inclusive)\n"
+               "    --processes: calculate all vratas from the first date (inclusive) to the second one (exclusive)\n"
+               "                 for given location (default: all locations) using N worker processes\n"
+               "    --serve: stay resident and answer requests (see src/serve.h) on the Unix domain socket\n"
+               "             or, if no socket-path is given, on stdin/stdout\n"
+               "    --http: serve JSON API (see src/http-server.h) on 127.0.0.1:port (default: 8080)\n"
+               "    --batch: answer (date, location) queries from FILE or stdin (see src/batch-query.h),\n"
+               "             one JSON line per query, using given number of processes (default: one per CPU)\n"
+               "    --year: HTML tables of all vratas of the year for all locations, one per ekadashi\n"
+               "            (or a single table with --combined, or a single table with a header per ekadashi with --continuous);\n"
+               "            --compare also times one calc per ekadashi, the old way\n"
+               "    --ics: iCalendar with vratas, paranams and festivals of given years (both inclusive)\n"
+               "    --grid: CSV map of the next vrata after the date over a grid of step x step degree cells\n"
+               "            (default: 1 degree over the whole globe, see src/vrata-grid.h)\n"
+               "    --boundaries: GeoJSON lines where the next vrata after the date changes its date or type\n"
+               "                  (default: scan lines 2 degrees apart over 60S..60N, see src/vrata-boundary.h)\n"
+               "    --format: machine-readable output instead of text (see src/vrata-export.h)\n"
+               "    --build-almanac: precalculate all vratas of given years (default: 1900..2100) for all locations\n"
+               "                     into FILE (see src/almanac.h)\n"
+               "    --verify-almanac: check FILE checksums and compare given number of its vratas (default: 200)\n"
+               "                      with freshly calculated ones\n"
+               "    --build-event-catalog: precalculate all tithi, nakshatra and sankranti times of given years\n"
+               "                           (default: 1800..2200) into FILE (see src/event-catalog.h)\n"
+               "    --build-tzdb: compile text tzdata into FILE (see src/tz-database.h)\n"
+               "\n"
+               "    If \"locations.csv\" file exists next to \"eph\" and \"tzdata\", known locations are taken from it\n"
+               "    instead of built-in ones (see src/location-table.h).\n"
+               "    If \"cache\" directory exists next to \"eph\" and \"tzdata\", calculated results are kept there between runs.\n"
+               "    If \"almanac.vpa\" file exists there, results are taken from it whenever possible.\n"
+               "    If \"events.vpe\" file exists there, tithi, nakshatra and sankranti times are taken from it.\n"
+               "    If \"tzdata.vpz\" file exists there, time zones are taken from it instead of parsing text tzdata.\n",
                vp::text_ui::program_name_and_version());
 }
 
+namespace {
+// --format=... modes. argv[0] is the --format option itself.
+void export_main(vp::Export_Format format, int argc, char *argv[]) {
+#ifdef _WIN32
+    if (format == vp::Export_Format::Bin) {
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+    vp::Record_Exporter exporter{format, [](std::string_view data) {
+        std::fwrite(data.data(), 1, data.size(), stdout);
+    }};
+    if (argc-1 == 3 && strcmp(argv[1], "-d") == 0) {
+        const std::string_view dates{argv[2]};
+        const auto separator = dates.find("..");
+        const auto from = vp::text_ui::parse_ymd(dates.substr(0, separator));
+        const auto to = separator == std::string_view::npos ? from : vp::text_ui::parse_ymd(dates.substr(separator + 2));
+        if (!from.ok() || !to.ok() || to < from) {
+            print_usage();
+            exit(-1);
+        }
+        vp::text_ui::export_daybyday_range(from, to, argv[3], exporter);
+    } else if ((argc-1 == 4 || argc-1 == 5) && strcmp(argv[1], "--processes") == 0) {
+        const auto workers = static_cast<unsigned>(std::stoul(argv[2]));
+        const auto from = vp::text_ui::parse_ymd(argv[3]);
+        const auto to = vp::text_ui::parse_ymd(argv[4]);
+        const char * const location_name = argc-1 == 5 ? argv[5] : "all";
+        fmt::memory_buffer summary;
+        vp::text_ui::export_batch(from, to, location_name, workers, exporter, fmt::appender{summary});
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 == 2) {
+        vp::text_ui::export_vratas(vp::text_ui::parse_ymd(argv[1]), argv[2], exporter);
+    } else {
+        print_usage();
+        exit(-1);
+    }
+    std::fflush(stdout);
+}
+} // anonymous namespace
+
 int main(int argc, char *argv[]) try
 {
 #ifdef _WIN32
@@ -27,18 +125,279 @@ int main(int argc, char *argv[]) try
 #endif
     vp::text_ui::change_to_data_dir(argv[0]);
     date::set_install("tzdata");
-    if (argc-1 >= 1 && strcmp(argv[1], "-d") == 0) {
+    if (fs::is_regular_file("tzdata.vpz")) {
+        try {
+            vp::text_ui::enable_tz_database("tzdata.vpz");
+        } catch (const std::runtime_error & err) {
+            fmt::print(stderr, "Warning: not using compiled tz database: {}\n", err.what());
+        }
+    }
+    if (fs::is_directory("cache")) {
+        vp::text_ui::enable_disk_cache("cache");
+    }
+    if (fs::is_regular_file("locations.csv")) {
+        try {
+            vp::text_ui::LocationDb::load("locations.csv");
+        } catch (const std::runtime_error & err) {
+            fmt::print(stderr, "Warning: using built-in locations: {}\n", err.what());
+        }
+    }
+    if (fs::is_regular_file("almanac.vpa")) {
+        try {
+            vp::text_ui::enable_almanac("almanac.vpa");
+        } catch (const std::runtime_error & err) {
+            fmt::print(stderr, "Warning: not using almanac: {}\n", err.what());
+        }
+    }
+    if (fs::is_regular_file("events.vpe")) {
+        try {
+            vp::text_ui::enable_event_catalog("events.vpe");
+        } catch (const std::runtime_error & err) {
+            fmt::print(stderr, "Warning: not using event catalog: {}\n", err.what());
+        }
+    }
+    if (argc-1 >= 1 && strncmp(argv[1], "--format=", std::strlen("--format=")) == 0) {
+        const auto format = vp::parse_export_format(argv[1] + std::strlen("--format="));
+        if (!format) {
+            print_usage();
+            exit(-1);
+        }
+        export_main(*format, argc-1, argv+1);
+    } else if (argc-1 >= 1 && strcmp(argv[1], "-d") == 0) {
         if (argc-1 != 3) {
             print_usage();
             exit(-1);
         }
-        auto base_date = vp::text_ui::parse_ymd(argv[2]);
+        const std::string_view dates{argv[2]};
         const char * const location_name = argv[3];
         fmt::memory_buffer buf;
-        vp::text_ui::daybyday_print_one(base_date, location_name, fmt::appender{buf}, vp::CalcFlags::Default);
+        if (const auto separator = dates.find(".."); separator != std::string_view::npos) {
+            const auto from = vp::text_ui::parse_ymd(dates.substr(0, separator));
+            const auto to = vp::text_ui::parse_ymd(dates.substr(separator + 2));
+            if (!from.ok() || !to.ok() || to < from) {
+                print_usage();
+                exit(-1);
+            }
+            vp::text_ui::daybyday_print_range(from, to, location_name, fmt::appender{buf}, vp::CalcFlags::Default);
+        } else {
+            auto base_date = vp::text_ui::parse_ymd(dates);
+            vp::text_ui::daybyday_print_one(base_date, location_name, fmt::appender{buf}, vp::CalcFlags::Default);
+        }
         fmt::print("{}", std::string_view{buf.data(), buf.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--processes") == 0) {
+        if (argc-1 != 4 && argc-1 != 5) {
+            print_usage();
+            exit(-1);
+        }
+        const auto workers = static_cast<unsigned>(std::stoul(argv[2]));
+        const auto from = vp::text_ui::parse_ymd(argv[3]);
+        const auto to = vp::text_ui::parse_ymd(argv[4]);
+        const char * const location_name = argc-1 == 5 ? argv[5] : "all";
+        fmt::memory_buffer summary;
+        vp::text_ui::batch_calc_and_report(from, to, location_name, workers, [](std::string_view data) {
+            std::fwrite(data.data(), 1, data.size(), stdout);
+        }, fmt::appender{summary});
+        std::fflush(stdout);
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--serve") == 0) {
+        if (argc-1 != 1 && argc-1 != 2) {
+            print_usage();
+            exit(-1);
+        }
+        if (argc-1 == 2) {
+            vp::text_ui::serve_unix_socket(argv[2]);
+        } else {
+            vp::text_ui::serve_stdio();
+        }
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--http") == 0) {
+        if (argc-1 != 1 && argc-1 != 2) {
+            print_usage();
+            exit(-1);
+        }
+        vp::text_ui::Http_Server_Options options;
+        if (argc-1 == 2) {
+            options.port = static_cast<std::uint16_t>(std::stoul(argv[2]));
+        }
+        vp::text_ui::serve_http(options);
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--year") == 0) {
+        if (argc-1 < 2) {
+            print_usage();
+            exit(-1);
+        }
+        const auto year = date::year{std::stoi(argv[2])};
+        auto layout = vp::text_ui::Year_Layout::Per_Paksha;
+        bool compare = false;
+        auto workers = vp::Process_Pool::default_worker_count();
+        for (int i = 3; i < argc; ++i) {
+            if (strcmp(argv[i], "--combined") == 0) {
+                layout = vp::text_ui::Year_Layout::Combined;
+            } else if (strcmp(argv[i], "--continuous") == 0) {
+                layout = vp::text_ui::Year_Layout::Continuous;
+            } else if (strcmp(argv[i], "--compare") == 0) {
+                compare = true;
+            } else {
+                workers = static_cast<unsigned>(std::stoul(argv[i]));
+            }
+        }
+        fmt::memory_buffer summary;
+        vp::text_ui::year_calc_and_report(year, layout, workers, compare, [](std::string_view data) {
+            std::fwrite(data.data(), 1, data.size(), stdout);
+        }, fmt::appender{summary});
+        std::fflush(stdout);
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--ics") == 0) {
+        if (argc-1 < 3 || argc-1 > 5) {
+            print_usage();
+            exit(-1);
+        }
+        const auto from_year = date::year{std::stoi(argv[3])};
+        const auto to_year = argc-1 >= 4 ? date::year{std::stoi(argv[4])} : from_year;
+        const auto workers = argc-1 == 5 ? static_cast<unsigned>(std::stoul(argv[5])) : vp::Process_Pool::default_worker_count();
+        fmt::memory_buffer summary;
+        vp::text_ui::export_ics(argv[2], from_year, to_year, workers, [](std::string_view data) {
+            std::fwrite(data.data(), 1, data.size(), stdout);
+        }, fmt::appender{summary});
+        std::fflush(stdout);
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--grid") == 0) {
+        if (argc-1 < 2 || argc-1 == 5 || argc-1 == 6 || argc-1 > 8) {
+            print_usage();
+            exit(-1);
+        }
+        vp::Grid_Request request;
+        request.base_date = date::local_days{vp::text_ui::parse_ymd(argv[2])};
+        if (argc-1 >= 3) {
+            request.step = std::stod(argv[3]);
+        }
+        if (argc-1 >= 7) {
+            request.south = vp::Latitude{std::stod(argv[4])};
+            request.north = vp::Latitude{std::stod(argv[5])};
+            request.west = vp::Longitude{std::stod(argv[6])};
+            request.east = vp::Longitude{std::stod(argv[7])};
+        }
+        if (argc-1 == 4 || argc-1 == 8) {
+            request.workers = static_cast<unsigned>(std::stoul(argv[argc-1]));
+        }
+        fmt::memory_buffer summary;
+        vp::text_ui::export_grid(request, [](std::string_view data) {
+            std::fwrite(data.data(), 1, data.size(), stdout);
+        }, fmt::appender{summary});
+        std::fflush(stdout);
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--boundaries") == 0) {
+        vp::Boundary_Request request;
+        int first_arg = 3;
+        if (argc-1 >= 3 && strcmp(argv[3], "--along-longitudes") == 0) {
+            request.scan = vp::Boundary_Scan::Along_Longitudes;
+            first_arg = 4;
+        }
+        const int args = argc - first_arg;
+        if (argc-1 < 2 || args == 3 || args == 4 || args > 6) {
+            print_usage();
+            exit(-1);
+        }
+        request.base_date = date::local_days{vp::text_ui::parse_ymd(argv[2])};
+        if (args >= 1) {
+            request.step = std::stod(argv[first_arg]);
+        }
+        if (args >= 5) {
+            request.south = vp::Latitude{std::stod(argv[first_arg+1])};
+            request.north = vp::Latitude{std::stod(argv[first_arg+2])};
+            request.west = vp::Longitude{std::stod(argv[first_arg+3])};
+            request.east = vp::Longitude{std::stod(argv[first_arg+4])};
+        }
+        if (args == 2 || args == 6) {
+            request.workers = static_cast<unsigned>(std::stoul(argv[argc-1]));
+        }
+        fmt::memory_buffer summary;
+        vp::text_ui::export_boundaries(request, [](std::string_view data) {
+            std::fwrite(data.data(), 1, data.size(), stdout);
+        }, fmt::appender{summary});
+        std::fflush(stdout);
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--build-almanac") == 0) {
+        if (argc-1 != 2 && argc-1 != 3 && argc-1 != 4 && argc-1 != 5) {
+            print_usage();
+            exit(-1);
+        }
+        auto from_year = date::year{1900};
+        auto to_year = date::year{2100};
+        if (argc-1 >= 4) {
+            from_year = date::year{std::stoi(argv[3])};
+            to_year = date::year{std::stoi(argv[4])};
+        }
+        auto workers = vp::Process_Pool::default_worker_count();
+        if (argc-1 == 3 || argc-1 == 5) {
+            workers = static_cast<unsigned>(std::stoul(argv[argc-1]));
+        }
+        fmt::memory_buffer summary;
+        vp::text_ui::build_almanac(argv[2], from_year, to_year, workers, fmt::appender{summary});
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--build-event-catalog") == 0) {
+        if (argc-1 != 2 && argc-1 != 3 && argc-1 != 4 && argc-1 != 5) {
+            print_usage();
+            exit(-1);
+        }
+        auto from_year = date::year{1800};
+        auto to_year = date::year{2200};
+        if (argc-1 >= 4) {
+            from_year = date::year{std::stoi(argv[3])};
+            to_year = date::year{std::stoi(argv[4])};
+        }
+        auto workers = vp::Process_Pool::default_worker_count();
+        if (argc-1 == 3 || argc-1 == 5) {
+            workers = static_cast<unsigned>(std::stoul(argv[argc-1]));
+        }
+        fmt::memory_buffer summary;
+        vp::text_ui::build_event_catalog(argv[2], from_year, to_year, workers, fmt::appender{summary});
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--build-tzdb") == 0) {
+        if (argc-1 != 2) {
+            print_usage();
+            exit(-1);
+        }
+        fmt::memory_buffer summary;
+        vp::text_ui::build_tz_database(argv[2], fmt::appender{summary});
+        fmt::print(stderr, "{}", std::string_view{summary.data(), summary.size()});
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--verify-almanac") == 0) {
+        if (argc-1 != 2 && argc-1 != 3) {
+            print_usage();
+            exit(-1);
+        }
+        const auto samples = argc-1 == 3 ? static_cast<std::size_t>(std::stoul(argv[3])) : std::size_t{200};
+        fmt::memory_buffer buf;
+        const bool ok = vp::text_ui::verify_almanac(argv[2], samples, fmt::appender{buf});
+        fmt::print("{}", std::string_view{buf.data(), buf.size()});
+        if (!ok) {
+            exit(1);
+        }
+    } else if (argc-1 >= 1 && strcmp(argv[1], "--batch") == 0) {
+        if (argc-1 != 2 && argc-1 != 3) {
+            print_usage();
+            exit(-1);
+        }
+        const auto workers = argc-1 == 3 ? static_cast<unsigned>(std::stoul(argv[3])) : vp::Process_Pool::default_worker_count();
+        auto write_line = [](std::string_view line) {
+            std::fwrite(line.data(), 1, line.size(), stdout);
+        };
+        vp::text_ui::Batch_Query_Summary summary;
+        if (strcmp(argv[2], "-") == 0) {
+            summary = vp::text_ui::run_batch_queries(std::cin, workers, write_line);
+        } else {
+            std::ifstream in{argv[2]};
+            if (!in) {
+                fmt::print(stderr, "Can't open '{}'\n", argv[2]);
+                exit(-1);
+            }
+            summary = vp::text_ui::run_batch_queries(in, workers, write_line);
+        }
+        std::fflush(stdout);
+        fmt::print(stderr, "{} queries ({} errors) in {:.3f}s, {:.0f} queries/s\n",
+                   summary.queries, summary.errors, summary.seconds,
+                   summary.seconds > 0 ? static_cast<double>(summary.queries) / summary.seconds : 0.0);
     } else {
-        if (argc-1 != 1 && argc-1 != 2 && argc-1 != 3) {
+        const bool nearest_time_zone = argc-1 == 4 && strcmp(argv[4], "--nearest-time-zone") == 0;
+        if (argc-1 != 1 && argc-1 != 2 && argc-1 != 3 && !nearest_time_zone) {
             print_usage();
             exit(-1);
         }
@@ -54,8 +413,15 @@ int main(int argc, char *argv[]) try
         } else {
             double latitude = std::stod(argv[2]);
             double longitude = std::stod(argv[3]);
+            vp::Location location{vp::Latitude{latitude}, vp::Longitude{longitude}};
+            if (nearest_time_zone) {
+                if (const auto nearest = vp::text_ui::LocationDb::find_nearest(vp::Coord{location.latitude, location.longitude})) {
+                    location.time_zone_name = nearest->time_zone_name;
+                    location.country = nearest->country;
+                }
+            }
             fmt::memory_buffer buf;
-            vp::text_ui::calc_and_report_one(base_date, vp::Location{vp::Latitude{latitude}, vp::Longitude{longitude}}, fmt::appender{buf});
+            vp::text_ui::calc_and_report_one(base_date, location, fmt::appender{buf});
             fmt::print("{}", std::string_view{buf.data(), buf.size()});
         }
     }
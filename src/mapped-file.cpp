@@ -0,0 +1,80 @@
+#include "mapped-file.h"
+
+#include "fmt-format-fixed.h"
+
+#include <stdexcept>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define VP_HAVE_MMAP
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace vp {
+
+#ifdef VP_HAVE_MMAP
+
+Mapped_File::Mapped_File(const fs::path & path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(fmt::format("can't open '{}': {}", path.string(), std::strerror(errno)));
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error(fmt::format("'{}' is empty or unreadable", path.string()));
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    void * address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const auto err = errno;
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error(fmt::format("can't map '{}': {}", path.string(), std::strerror(err)));
+    }
+    // users look up small pieces all over the file, read-ahead would only waste page cache
+    ::madvise(address, size, MADV_RANDOM);
+    address_ = address;
+    data_ = std::string_view{static_cast<const char *>(address), size};
+}
+
+Mapped_File::~Mapped_File()
+{
+    if (address_) {
+        ::munmap(address_, data_.size());
+    }
+}
+
+#else // no mmap(): read the whole file into memory
+
+Mapped_File::Mapped_File(const fs::path & path)
+{
+    std::ifstream f{path, std::ios::binary};
+    if (!f) {
+        throw std::runtime_error(fmt::format("can't open '{}'", path.string()));
+    }
+    contents_.assign(std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{});
+    if (contents_.empty()) {
+        throw std::runtime_error(fmt::format("'{}' is empty or unreadable", path.string()));
+    }
+    data_ = contents_;
+}
+
+Mapped_File::~Mapped_File() = default;
+
+#endif // VP_HAVE_MMAP
+
+Mapped_File::Mapped_File(std::string contents)
+    : contents_(std::move(contents))
+{
+    data_ = contents_;
+}
+
+} // namespace vp
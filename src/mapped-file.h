@@ -0,0 +1,38 @@
+#ifndef VP_MAPPED_FILE_H
+#define VP_MAPPED_FILE_H
+
+#include "filesystem-fixed.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace vp {
+
+/*
+ * Whole file mapped read-only into memory. Pages are loaded on first access,
+ * so opening even a big file is cheap. On platforms without mmap() the file
+ * is simply read into memory.
+ *
+ * Throws std::runtime_error if the file can't be opened or is empty.
+ */
+class Mapped_File {
+public:
+    explicit Mapped_File(const fs::path & path);
+    // Contents which are already in memory (e.g. just calculated), kept as is.
+    explicit Mapped_File(std::string contents);
+    ~Mapped_File();
+    Mapped_File(const Mapped_File &) = delete;
+    Mapped_File & operator=(const Mapped_File &) = delete;
+
+    std::string_view data() const { return data_; }
+
+private:
+    std::string_view data_;
+    void * address_ = nullptr; // mmap()ed
+    std::string contents_;    // read when there's no mmap()
+};
+
+} // namespace vp
+
+#endif // VP_MAPPED_FILE_H
@@ -142,6 +142,8 @@ public:
         return t1.num != t2.num;
     }
     std::string_view name() const;
+    // 0..26, or -1 for Unknown()
+    int number() const { return num; }
 private:
     int num = Unknown().num;
     explicit constexpr DiscreteNakshatra(int n) : num(n) {}
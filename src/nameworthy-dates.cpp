@@ -22,8 +22,8 @@ std::string paran_title(const vp::Paran & paran) {
         title += fmt::format(FMT_STRING("{} ({})"), paran.end_str_seconds(), paran.end_type());
     }
     if (paran.paran_limit) {
-        const auto limit_str = date::format("%H:%M:%S", date::floor<std::chrono::seconds>(paran.paran_limit->as_zoned_time(paran.time_zone).get_local_time()));
-        title += fmt::format(FMT_STRING(", absolute limit is {} (dvādaśī end)"), limit_str);
+        const auto limit = date::floor<std::chrono::seconds>(paran.paran_limit->as_local_time(paran.time_zone));
+        title += fmt::format(FMT_STRING(", absolute limit is {:%H:%M:%S} (dvādaśī end)"), limit);
     }
     return title;
 }
@@ -41,18 +41,23 @@ void insert_ekadashi_paran_etc(vp::NamedDates & dates, const vp::Vrata & vrata)
     }
     // 'c' means compact formatting ("*" for standard pAraNam, otherwise something like ">06:45", "<07:45" or "06:45-07.45")
     const auto paran = fmt::format(FMT_STRING("{:c}"), vrata.paran);
-    const auto paran_with_href = fmt::format(FMT_STRING(R"(<a href="#{}">{}</a>)"), html::escape_attribute(vrata.location_name()), html::escape_attribute(paran));
-    dates.emplace(vrata.local_paran_date(), vp::NamedDate{paran_with_href, paran_title(vrata.paran), ""});
+    fmt::memory_buffer paran_with_href;
+    fmt::format_to(fmt::appender{paran_with_href}, FMT_STRING(R"(<a href="#)"));
+    html::escape_attribute_to(paran_with_href, vrata.location_name());
+    fmt::format_to(fmt::appender{paran_with_href}, FMT_STRING(R"(">)"));
+    html::escape_attribute_to(paran_with_href, paran);
+    fmt::format_to(fmt::appender{paran_with_href}, FMT_STRING("</a>"));
+    dates.emplace(vrata.local_paran_date(), vp::NamedDate{fmt::to_string(paran_with_href), paran_title(vrata.paran), ""});
 
     if (const auto harivasara = vrata.harivasara()) {
-        const auto harivasara_local = harivasara->as_zoned_time(vrata.location.time_zone()).get_local_time();
+        const auto harivasara_local = harivasara->as_local_time(vrata.location.time_zone());
         const auto harivasara_date = date::floor<date::days>(harivasara_local);
-        const auto h_m = date::format("%H:%M", harivasara_local);
+        const auto h_m = date::floor<std::chrono::minutes>(harivasara_local);
         std::string str;
         if (harivasara_date != vrata.date) {
-            str = fmt::format(FMT_STRING("HV > {}"), h_m);
+            str = fmt::format(FMT_STRING("HV > {:%H:%M}"), h_m);
         } else {
-            str = fmt::format(FMT_STRING("HV > {} <small>{}</small>"), h_m, date::format("%d.%m", harivasara_date));
+            str = fmt::format(FMT_STRING("HV > {:%H:%M} <small>{:%d.%m}</small>"), h_m, harivasara_date);
         }
         dates.emplace(vrata.date - date::days{1}, vp::NamedDate{str});
     }
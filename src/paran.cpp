@@ -3,7 +3,7 @@
 namespace vp {
 
 std::string ParanFormatter::format(const Paran &paran,
-                                   const date::time_zone * time_zone,
+                                   const Time_Zone * time_zone,
                                    const char * paran_start_format,
                                    const char * separator,
                                    const char * paran_end_format,
@@ -14,16 +14,14 @@ std::string ParanFormatter::format(const Paran &paran,
     fmt::appender out{buf};
     if (paran.paran_start.has_value()) {
         auto rounded_up = date::ceil<std::chrono::seconds>(paran.paran_start->as_sys_time());
-        auto zoned = date::make_zoned(time_zone, rounded_up);
-        fmt::format_to(out, "{}", date::format(paran_start_format, zoned));
+        out = format_local_time(out, time_zone->to_local(rounded_up), paran_start_format);
     } else {
         fmt::format_to(out, "...");
     }
     fmt::format_to(out, "{}", separator);
     if (paran.paran_end.has_value()) {
         auto rounded_down = date::floor<std::chrono::seconds>(paran.paran_end->as_sys_time());
-        auto zoned = date::make_zoned(time_zone, rounded_down);
-        fmt::format_to(out, "{}", date::format(paran_end_format, zoned));
+        out = format_local_time(out, time_zone->to_local(rounded_down), paran_end_format);
     } else {
         fmt::format_to(out, "...");
     }
@@ -38,8 +36,8 @@ bool Paran::is_rounded_to_minutes() const
 {
     using namespace std::chrono_literals;
     if (!paran_start || !paran_end) return true;
-    const auto start_rounded_to_minutes = date::ceil<std::chrono::minutes>(paran_start->as_zoned_time(time_zone).get_local_time());
-    const auto end_rounded_to_minutes = date::floor<std::chrono::minutes>(paran_end->as_zoned_time(time_zone).get_local_time());
+    const auto start_rounded_to_minutes = date::ceil<std::chrono::minutes>(paran_start->as_local_time(time_zone));
+    const auto end_rounded_to_minutes = date::floor<std::chrono::minutes>(paran_end->as_local_time(time_zone));
     return end_rounded_to_minutes - start_rounded_to_minutes >= 5min;
 }
 
@@ -70,37 +68,37 @@ Paran::EndType Paran::end_type() const {
 std::string Paran::start_str() const
 {
     if (!paran_start) return "…";
-    const auto local = paran_start->as_zoned_time(time_zone).get_local_time();
+    const auto local = paran_start->as_local_time(time_zone);
     if (is_rounded_to_minutes()) {
-        return date::format("%H:%M", date::ceil<std::chrono::minutes>(local));
+        return fmt::format(FMT_STRING("{:%H:%M}"), date::ceil<std::chrono::minutes>(local));
     } else {
-        return date::format("%H:%M:%S", date::ceil<std::chrono::seconds>(local));
+        return fmt::format(FMT_STRING("{:%H:%M:%S}"), date::ceil<std::chrono::seconds>(local));
     }
 }
 
 std::string Paran::start_str_seconds() const
 {
     if (!paran_start) return "…";
-    const auto local = paran_start->as_zoned_time(time_zone).get_local_time();
-    return date::format("%H:%M:%S", date::ceil<std::chrono::seconds>(local));
+    const auto local = paran_start->as_local_time(time_zone);
+    return fmt::format(FMT_STRING("{:%H:%M:%S}"), date::ceil<std::chrono::seconds>(local));
 }
 
 std::string Paran::end_str() const
 {
     if (!paran_end) return "…";
-    const auto local = paran_end->as_zoned_time(time_zone).get_local_time();
+    const auto local = paran_end->as_local_time(time_zone);
     if (is_rounded_to_minutes()) {
-        return date::format("%H:%M", date::floor<std::chrono::minutes>(local));
+        return fmt::format(FMT_STRING("{:%H:%M}"), date::floor<std::chrono::minutes>(local));
     } else {
-        return date::format("%H:%M:%S", date::floor<std::chrono::seconds>(local));
+        return fmt::format(FMT_STRING("{:%H:%M:%S}"), date::floor<std::chrono::seconds>(local));
     }
 }
 
 std::string Paran::end_str_seconds() const
 {
     if (!paran_end) return "…";
-    const auto local = paran_end->as_zoned_time(time_zone).get_local_time();
-    return date::format("%H:%M:%S", date::floor<std::chrono::seconds>(local));
+    const auto local = paran_end->as_local_time(time_zone);
+    return fmt::format(FMT_STRING("{:%H:%M:%S}"), date::floor<std::chrono::seconds>(local));
 }
 
 } // namespace vp
@@ -12,8 +12,8 @@
 namespace vp {
 
 namespace {
-const date::time_zone * utc() {
-    static auto _utc = date::locate_zone("UTC");
+const Time_Zone * utc() {
+    static auto _utc = locate_time_zone("UTC");
     return _utc;
 }
 }
@@ -35,7 +35,7 @@ public:
           std::optional<JulDays_UT> _paran_start,
           std::optional<JulDays_UT> _paran_end,
           std::optional<JulDays_UT> _paran_limit,
-          const date::time_zone * _time_zone
+          const Time_Zone * _time_zone
           ): type(_type), paran_start(_paran_start), paran_end(_paran_end), paran_limit(_paran_limit), time_zone(_time_zone) {
         if (paran_start > paran_end && paran_end) {
             throw std::runtime_error(fmt::format("internal error: paran_start({}) is later than paran_end({})", paran_start, paran_end));
@@ -44,7 +44,7 @@ public:
     Paran(Type _type = Type::Standard,
           std::optional<JulDays_UT> _paran_start = std::nullopt,
           std::optional<JulDays_UT> _paran_end = std::nullopt,
-          const date::time_zone * _time_zone = utc()
+          const Time_Zone * _time_zone = utc()
           ): Paran(_type, _paran_start, _paran_end, std::nullopt, _time_zone) {}
 
     bool operator==(Paran const &other) const {
@@ -65,14 +65,16 @@ public:
     std::optional<JulDays_UT> paran_start{};
     std::optional<JulDays_UT> paran_end{};
     std::optional<JulDays_UT> paran_limit{};
-    const date::time_zone * time_zone;
+    const Time_Zone * time_zone;
 };
 
 class ParanFormatter {
 public:
+    // paran_start_format and paran_end_format are strftime-like, but only %Y, %m, %d, %H, %M, %S
+    // and %% are supported (see format_local_time() in date-fixed.h); others throw fmt::format_error.
     static std::string format(
             const Paran &paran,
-            const date::time_zone * time_zone,
+            const Time_Zone * time_zone,
             const char * paran_start_format = "%H:%M:%S",
             const char * separator = "-",
             const char * paran_end_format = "%H:%M:%S",
@@ -119,8 +121,8 @@ struct fmt::formatter<vp::Paran> : fmt::formatter<std::string_view> {
         if (p.type == vp::Paran::Type::Standard) {
             fmt::format_to(ctx.out(), "*");
             if (p.paran_limit) {
-                const auto local = p.paran_limit->as_zoned_time(p.time_zone).get_local_time();
-                fmt::format_to(ctx.out(), FMT_STRING(" (<{})"), date::format("%H:%M", date::floor<std::chrono::minutes>(local)));
+                const auto local = p.paran_limit->as_local_time(p.time_zone);
+                fmt::format_to(ctx.out(), FMT_STRING(" (<{:%H:%M})"), date::floor<std::chrono::minutes>(local));
             }
             return ctx.out();
         } else if (p.paran_start && !p.paran_end) {
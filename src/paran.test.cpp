@@ -46,7 +46,7 @@ TEST_CASE("Can compare paran types") {
 TEST_CASE("compact paran format: standard paran is '*'") {
     SECTION("standard pāraṇam without limit") {
         JulDays_UT arbitrary_time{2019_y/March/19, 5h + 3min + 5s};
-        auto timezone = date::locate_zone("Europe/Moscow");
+        auto timezone = locate_time_zone("Europe/Moscow");
         Paran p{Paran::Type::Standard, arbitrary_time, std::nullopt, timezone};
 
         REQUIRE("*" == fmt::format("{:c}", p));
@@ -54,7 +54,7 @@ TEST_CASE("compact paran format: standard paran is '*'") {
     SECTION("standard pāraṇam *with* limit") {
         JulDays_UT arbitrary_time{2019_y/March/19, 5h + 3min + 5s};
         JulDays_UT limit_time{2019_y/March/19, 9h + 3min + 5s};
-        auto timezone = date::locate_zone("Europe/Moscow");
+        auto timezone = locate_time_zone("Europe/Moscow");
         Paran p{Paran::Type::Standard, arbitrary_time, std::nullopt, limit_time, timezone};
 
         REQUIRE("* (<12:03)" == fmt::format("{:c}", p));
@@ -63,7 +63,7 @@ TEST_CASE("compact paran format: standard paran is '*'") {
 
 TEST_CASE("compact paran format: >08:04 case") {
     JulDays_UT arbitrary_time{2019_y/March/19, 5h + 3min + 5s};
-    auto timezone = date::locate_zone("Europe/Moscow");
+    auto timezone = locate_time_zone("Europe/Moscow");
     Paran p{Paran::Type::From_Quarter_Dvadashi, arbitrary_time, std::nullopt, timezone};
 
     REQUIRE(">08:04" == fmt::format("{:c}", p));
@@ -71,7 +71,7 @@ TEST_CASE("compact paran format: >08:04 case") {
 
 TEST_CASE("compact paran format: <09:03 case") {
     JulDays_UT arbitrary_time{2019_y/March/19, 6h + 3min + 5s};
-    auto timezone = date::locate_zone("Europe/Moscow");
+    auto timezone = locate_time_zone("Europe/Moscow");
     Paran p{Paran::Type::From_Quarter_Dvadashi, std::nullopt, arbitrary_time, timezone};
 
     REQUIRE("<09:03" == fmt::format("{:c}", p));
@@ -80,7 +80,7 @@ TEST_CASE("compact paran format: <09:03 case") {
 TEST_CASE("compact paran format: wide range (rounding to minute)") {
     JulDays_UT time1{2019_y/March/19, 5h + 3min + 5s};
     JulDays_UT time2{2019_y/March/19, 6h + 3min + 5s};
-    auto timezone = date::locate_zone("Europe/Moscow");
+    auto timezone = locate_time_zone("Europe/Moscow");
     Paran p{Paran::Type::Puccha_Dvadashi, time1, time2, timezone};
 
     REQUIRE("08:04–09:03" == fmt::format("{:c}", p));
@@ -89,7 +89,7 @@ TEST_CASE("compact paran format: wide range (rounding to minute)") {
 TEST_CASE("compact paran format: narrow range (rounding to seconds)") {
     JulDays_UT time1{2019_y/March/19, 5h + 3min + 4.3s};
     JulDays_UT time2{2019_y/March/19, 5h + 8min + 5.5s};
-    auto timezone = date::locate_zone("Europe/Moscow");
+    auto timezone = locate_time_zone("Europe/Moscow");
     Paran p{Paran::Type::From_Quarter_Dvadashi, time1, time2, timezone};
 
     REQUIRE("08:03:05–08:08:05" == fmt::format("{:c}", p));
@@ -98,7 +98,7 @@ TEST_CASE("compact paran format: narrow range (rounding to seconds)") {
 TEST_CASE("paran_start/end_str rounds to minutes for large (>=48 min) interval") {
     JulDays_UT time1{2019_y/March/19, 5h + 3min + 4s};
     JulDays_UT time2{2019_y/March/19, 5h + 3min + 4s + 48min};
-    auto timezone = date::locate_zone("Europe/Moscow");
+    auto timezone = locate_time_zone("Europe/Moscow");
     Paran p{Paran::Type::From_Quarter_Dvadashi, time1, time2, timezone};
 
     REQUIRE("08:04" == p.start_str());
@@ -132,3 +132,12 @@ TEST_CASE("can get and print types of paran start/end") {
     REQUIRE_THAT(fmt::to_string(paran.start_type()), Contains("sunrise"));
     REQUIRE_THAT(fmt::to_string(paran.end_type()), Contains("1/5th of daytime"));
 }
+
+TEST_CASE("ParanFormatter formats paran start and end by given specs") {
+    // start is rounded up to seconds, end is rounded down
+    const Paran paran{Paran::Type::Standard, JulDays_UT{2019_y/March/19, 6h + 30min + 10500ms}, JulDays_UT{2019_y/March/19, 9h + 15min + 50500ms}};
+    const auto * utc = locate_time_zone("UTC");
+    REQUIRE(ParanFormatter::format(paran, utc) == "06:30:11-09:15:50");
+    REQUIRE(ParanFormatter::format(paran, utc, "%H:%M", "..", "%H:%M on %d.%m") == "06:30..09:15 on 19.03");
+    REQUIRE_THROWS_AS(ParanFormatter::format(paran, utc, "%H:%M %Z"), fmt::format_error);
+}
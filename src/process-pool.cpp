@@ -0,0 +1,355 @@
+#include "process-pool.h"
+
+#include "binary-record.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define VP_HAVE_FORK
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace vp {
+
+Process_Pool::Process_Pool(unsigned worker_count, Worker_Fn worker_fn)
+    : worker_count_(std::max(1u, worker_count)), worker_fn_(std::move(worker_fn))
+{
+}
+
+unsigned Process_Pool::default_worker_count()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Run one task, converting exceptions to a failed result.
+bool run_one(const Process_Pool::Worker_Fn & fn, std::string_view task, fmt::memory_buffer & out) {
+    try {
+        fn(task, out);
+        return true;
+    } catch (const std::exception & e) {
+        out.clear();
+        fmt::format_to(fmt::appender{out}, "{}", e.what());
+    } catch (...) {
+        out.clear();
+        fmt::format_to(fmt::appender{out}, "unknown exception");
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+#ifdef VP_HAVE_FORK
+
+namespace {
+
+// Frame on the wire: u32 task index, u8 status (0 = ok), u32 payload length, payload.
+// Tasks sent to workers use the same framing with status always 0.
+constexpr std::size_t frame_header_size = 4 + 1 + 4;
+
+bool write_all(int fd, const char * data, std::size_t size) {
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+// false on error or EOF before all bytes were read
+bool read_all(int fd, char * data, std::size_t size) {
+    while (size > 0) {
+        const auto got = ::read(fd, data, size);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (got == 0) return false;
+        data += got;
+        size -= static_cast<std::size_t>(got);
+    }
+    return true;
+}
+
+bool write_frame(int fd, std::uint32_t index, bool ok, std::string_view payload) {
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    w.u32(index);
+    w.u8(ok ? 0 : 1);
+    w.str(payload);
+    return write_all(fd, buf.data(), buf.size());
+}
+
+struct Frame {
+    std::uint32_t index = 0;
+    bool ok = false;
+    std::string payload;
+};
+
+std::optional<Frame> read_frame(int fd) {
+    char header[frame_header_size];
+    if (!read_all(fd, header, sizeof(header))) return std::nullopt;
+    Record_Reader r{std::string_view{header, sizeof(header)}};
+    Frame frame;
+    frame.index = r.u32();
+    frame.ok = r.u8() == 0;
+    frame.payload.resize(r.u32());
+    if (!read_all(fd, frame.payload.data(), frame.payload.size())) return std::nullopt;
+    return frame;
+}
+
+[[noreturn]] void worker_main(int task_fd, int result_fd, const Process_Pool::Worker_Fn & fn) {
+    fmt::memory_buffer out;
+    while (auto task = read_frame(task_fd)) {
+        out.clear();
+        const bool ok = run_one(fn, task->payload, out);
+        if (!write_frame(result_fd, task->index, ok, std::string_view{out.data(), out.size()})) {
+            break;
+        }
+    }
+    // _exit(), not exit(): don't run parent's atexit handlers and don't flush stdio buffers inherited from it.
+    ::_exit(0);
+}
+
+std::string describe_exit_status(int status) {
+    if (WIFEXITED(status)) return fmt::format("exit code {}", WEXITSTATUS(status));
+    if (WIFSIGNALED(status)) return fmt::format("killed by signal {} ({})", WTERMSIG(status), ::strsignal(WTERMSIG(status)));
+    return fmt::format("unknown exit status {}", status);
+}
+
+void close_fd(int & fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+struct Worker {
+    pid_t pid = -1;
+    int task_fd = -1;   // we write tasks here...
+    int result_fd = -1; // ...and read results from here
+    std::optional<std::uint32_t> current_task;
+    Clock::time_point started;
+    std::size_t stats_index = 0;
+};
+
+} // anonymous namespace
+
+std::vector<Process_Pool::Task_Result> Process_Pool::run(const std::vector<std::string> & tasks, const Result_Fn & on_result)
+{
+    stats_.clear();
+    std::vector<Task_Result> results(tasks.size());
+    if (tasks.empty()) return results;
+    std::vector<bool> ready(tasks.size(), false);
+    std::size_t next_to_deliver = 0;
+
+    // Writing to the pipe of a crashed worker must return EPIPE instead of killing us.
+    struct sigaction ignore_sigpipe{};
+    struct sigaction old_sigpipe{};
+    ignore_sigpipe.sa_handler = SIG_IGN;
+    ::sigaction(SIGPIPE, &ignore_sigpipe, &old_sigpipe);
+
+    std::vector<Worker> workers(std::min<std::size_t>(worker_count_, tasks.size()));
+    std::size_t next_task = 0;
+    std::size_t done = 0;
+
+    auto spawn = [&](std::size_t slot) {
+        int to_worker[2];
+        int from_worker[2];
+        if (::pipe(to_worker) != 0) {
+            throw std::runtime_error(fmt::format("can't create pipe for worker process: {}", std::strerror(errno)));
+        }
+        if (::pipe(from_worker) != 0) {
+            const auto err = errno;
+            ::close(to_worker[0]);
+            ::close(to_worker[1]);
+            throw std::runtime_error(fmt::format("can't create pipe for worker process: {}", std::strerror(err)));
+        }
+        std::fflush(nullptr);
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            const auto err = errno;
+            for (int fd : {to_worker[0], to_worker[1], from_worker[0], from_worker[1]}) ::close(fd);
+            throw std::runtime_error(fmt::format("can't start worker process: {}", std::strerror(err)));
+        }
+        if (pid == 0) {
+            // Keep only our own pipe ends: holding task pipes of other workers
+            // would prevent them from ever seeing EOF and exiting.
+            for (auto & w : workers) {
+                close_fd(w.task_fd);
+                close_fd(w.result_fd);
+            }
+            ::close(to_worker[1]);
+            ::close(from_worker[0]);
+            worker_main(to_worker[0], from_worker[1], worker_fn_);
+        }
+        ::close(to_worker[0]);
+        ::close(from_worker[1]);
+        auto & w = workers[slot];
+        w.pid = pid;
+        w.task_fd = to_worker[1];
+        w.result_fd = from_worker[0];
+        w.current_task.reset();
+        w.started = Clock::now();
+        w.stats_index = stats_.size();
+        Worker_Stats stats;
+        stats.worker = static_cast<unsigned>(slot);
+        stats.pid = static_cast<long>(pid);
+        stats_.push_back(stats);
+    };
+
+    // Send next task to the idle worker. When there are no more tasks,
+    // close its task pipe so that it exits.
+    // Write errors are ignored here: dead worker is noticed by EOF on its result pipe.
+    auto dispatch = [&](std::size_t slot) {
+        auto & w = workers[slot];
+        if (next_task >= tasks.size()) {
+            close_fd(w.task_fd);
+            return;
+        }
+        const auto index = static_cast<std::uint32_t>(next_task++);
+        w.current_task = index;
+        write_frame(w.task_fd, index, true, tasks[index]);
+    };
+
+    auto complete = [&](std::uint32_t task, Task_Result && result) {
+        results[task] = std::move(result);
+        ready[task] = true;
+        if (!on_result) return;
+        for (; next_to_deliver < tasks.size() && ready[next_to_deliver]; ++next_to_deliver) {
+            on_result(next_to_deliver, std::move(results[next_to_deliver]));
+        }
+    };
+
+    auto reap = [&](Worker & w) {
+        close_fd(w.task_fd);
+        close_fd(w.result_fd);
+        int status = 0;
+        while (::waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {}
+        auto & stats = stats_[w.stats_index];
+        stats.seconds = seconds_since(w.started);
+        stats.exit_status = describe_exit_status(status);
+        w.pid = -1;
+        return stats.exit_status;
+    };
+
+    try {
+        for (std::size_t slot = 0; slot < workers.size(); ++slot) {
+            spawn(slot);
+            dispatch(slot);
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<std::size_t> fd_slots;
+        while (done < tasks.size()) {
+            fds.clear();
+            fd_slots.clear();
+            for (std::size_t slot = 0; slot < workers.size(); ++slot) {
+                if (workers[slot].pid > 0 && workers[slot].current_task) {
+                    fds.push_back(pollfd{workers[slot].result_fd, POLLIN, 0});
+                    fd_slots.push_back(slot);
+                }
+            }
+            if (fds.empty()) {
+                throw std::runtime_error("internal error: no busy worker processes, but not all tasks are done");
+            }
+            if (::poll(fds.data(), static_cast<nfds_t>(fds.size()), -1) < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(fmt::format("poll() failed while waiting for worker processes: {}", std::strerror(errno)));
+            }
+            for (std::size_t i = 0; i < fds.size(); ++i) {
+                if (fds[i].revents == 0) continue;
+                const auto slot = fd_slots[i];
+                auto & w = workers[slot];
+                const auto task = *w.current_task;
+                auto frame = read_frame(w.result_fd);
+                ++done;
+                ++stats_[w.stats_index].tasks;
+                if (frame && frame->index == task) {
+                    auto & stats = stats_[w.stats_index];
+                    stats.bytes_received += frame->payload.size();
+                    if (!frame->ok) ++stats.failed_tasks;
+                    complete(task, Task_Result{frame->ok, std::move(frame->payload), w.stats_index});
+                    w.current_task.reset();
+                    dispatch(slot);
+                } else {
+                    // Worker died in the middle of the task: report it and carry on with a fresh one.
+                    ++stats_[w.stats_index].failed_tasks;
+                    const auto stats_index = w.stats_index;
+                    const auto status = reap(w);
+                    complete(task, Task_Result{false, fmt::format("worker process {} died: {}", stats_[stats_index].pid, status), stats_index});
+                    if (next_task < tasks.size()) {
+                        spawn(slot);
+                        dispatch(slot);
+                    }
+                }
+            }
+        }
+        for (auto & w : workers) {
+            if (w.pid > 0) reap(w);
+        }
+    } catch (...) {
+        for (auto & w : workers) {
+            if (w.pid > 0) {
+                ::kill(w.pid, SIGKILL);
+                reap(w);
+            }
+        }
+        ::sigaction(SIGPIPE, &old_sigpipe, nullptr);
+        throw;
+    }
+    ::sigaction(SIGPIPE, &old_sigpipe, nullptr);
+    return results;
+}
+
+#else // no fork(): run everything in the current process
+
+std::vector<Process_Pool::Task_Result> Process_Pool::run(const std::vector<std::string> & tasks, const Result_Fn & on_result)
+{
+    stats_.clear();
+    std::vector<Task_Result> results(tasks.size());
+    Worker_Stats stats;
+    const auto started = Clock::now();
+    fmt::memory_buffer out;
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        out.clear();
+        const bool ok = run_one(worker_fn_, tasks[i], out);
+        results[i] = Task_Result{ok, fmt::to_string(out), 0};
+        ++stats.tasks;
+        if (!ok) ++stats.failed_tasks;
+        stats.bytes_received += out.size();
+        if (on_result) {
+            on_result(i, std::move(results[i]));
+        }
+    }
+    stats.seconds = seconds_since(started);
+    stats.exit_status = "in-process";
+    stats_.push_back(stats);
+    return results;
+}
+
+#endif // VP_HAVE_FORK
+
+} // namespace vp
@@ -0,0 +1,77 @@
+#ifndef VP_PROCESS_POOL_H
+#define VP_PROCESS_POOL_H
+
+#include "fmt-format-fixed.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vp {
+
+/*
+ * Runs independent tasks in N forked worker processes.
+ *
+ * sweph keeps its state in globals, so threads can't calculate in parallel,
+ * but separate processes can: each worker gets its own copy of sweph state.
+ * Tasks and results are opaque byte strings (see binary-record.h) sent over
+ * pipes, one task in flight per worker, so faster workers simply get more tasks.
+ *
+ * Crash isolation: if worker function throws, only this task is reported as
+ * failed. If worker process dies (e.g. segfault inside sweph), its current
+ * task is reported as failed and a replacement worker is started for the
+ * remaining tasks.
+ *
+ * Results are always returned in the order of tasks, regardless of which
+ * worker finished first.
+ *
+ * On platforms without fork() (Windows, emscripten) tasks are run
+ * sequentially in the current process.
+ *
+ * Caller must make sure no Swe object is alive while run() is called:
+ * forked children would share ephemeris file handles with the parent.
+ */
+class Process_Pool {
+public:
+    // Called in the worker process: decode the task, append encoded result to out.
+    using Worker_Fn = std::function<void(std::string_view task, fmt::memory_buffer & out)>;
+
+    struct Task_Result {
+        bool ok = false;
+        std::string data;   // encoded result when ok, human-readable error otherwise
+        std::size_t worker = 0; // index in stats() of the worker process which ran this task
+    };
+
+    // One entry per started worker process (replacement workers get their own entries).
+    struct Worker_Stats {
+        unsigned worker = 0; // slot number, [0..worker_count)
+        long pid = 0;
+        std::size_t tasks = 0;
+        std::size_t failed_tasks = 0;
+        std::size_t bytes_received = 0;
+        double seconds = 0.0; // wall time from start to exit
+        std::string exit_status;
+    };
+
+    // Called in the parent process with results in the order of tasks, as soon as
+    // the result and all results before it are ready. Result data is moved into
+    // the callback, so the corresponding entry returned from run() is left empty.
+    using Result_Fn = std::function<void(std::size_t task_index, Task_Result && result)>;
+
+    Process_Pool(unsigned worker_count, Worker_Fn worker_fn);
+
+    std::vector<Task_Result> run(const std::vector<std::string> & tasks, const Result_Fn & on_result = {});
+    const std::vector<Worker_Stats> & stats() const { return stats_; }
+
+    static unsigned default_worker_count();
+
+private:
+    unsigned worker_count_;
+    Worker_Fn worker_fn_;
+    std::vector<Worker_Stats> stats_;
+};
+
+} // namespace vp
+
+#endif // VP_PROCESS_POOL_H
@@ -0,0 +1,87 @@
+#include "process-pool.h"
+
+#include "catch-formatters.h"
+
+#include <cctype>
+#include <cstdlib>
+
+using namespace vp;
+
+namespace {
+void to_upper(std::string_view task, fmt::memory_buffer & out) {
+    for (char c : task) {
+        out.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+    }
+}
+}
+
+TEST_CASE("Process_Pool returns results in the order of tasks") {
+    std::vector<std::string> tasks;
+    for (int i = 0; i < 100; ++i) {
+        tasks.push_back(fmt::format("task {}", i));
+    }
+    Process_Pool pool{4, to_upper};
+    const auto results = pool.run(tasks);
+    REQUIRE(results.size() == tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        REQUIRE(results[i].ok);
+        REQUIRE(results[i].data == fmt::format("TASK {}", i));
+    }
+    std::size_t tasks_done = 0;
+    for (const auto & stats : pool.stats()) {
+        tasks_done += stats.tasks;
+    }
+    REQUIRE(tasks_done == tasks.size());
+}
+
+TEST_CASE("Process_Pool streams results to the callback in the order of tasks") {
+    std::vector<std::string> tasks;
+    for (int i = 0; i < 50; ++i) {
+        tasks.push_back(fmt::format("task {}", i));
+    }
+    Process_Pool pool{4, to_upper};
+    std::vector<std::size_t> delivered;
+    const auto results = pool.run(tasks, [&](std::size_t index, Process_Pool::Task_Result && result) {
+        REQUIRE(result.ok);
+        REQUIRE(result.data == fmt::format("TASK {}", index));
+        delivered.push_back(index);
+    });
+    REQUIRE(delivered.size() == tasks.size());
+    for (std::size_t i = 0; i < delivered.size(); ++i) {
+        REQUIRE(delivered[i] == i);
+    }
+    REQUIRE(results.size() == tasks.size());
+}
+
+TEST_CASE("Process_Pool reports exception in one task without failing others") {
+    Process_Pool pool{2, [](std::string_view task, fmt::memory_buffer & out) {
+        if (task == "bad") throw std::runtime_error("bad task");
+        to_upper(task, out);
+    }};
+    const auto results = pool.run({"a", "bad", "c"});
+    REQUIRE(results[0].ok);
+    REQUIRE_FALSE(results[1].ok);
+    REQUIRE(results[1].data == "bad task");
+    REQUIRE(results[2].ok);
+    REQUIRE(results[2].data == "C");
+}
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+TEST_CASE("Process_Pool survives crashing worker process") {
+    Process_Pool pool{2, [](std::string_view task, fmt::memory_buffer & out) {
+        // Not abort(): Catch's signal handlers are inherited by forked workers.
+        if (task == "crash") std::_Exit(3);
+        to_upper(task, out);
+    }};
+    const auto results = pool.run({"a", "crash", "c", "d", "crash", "f"});
+    REQUIRE(results[0].data == "A");
+    REQUIRE_FALSE(results[1].ok);
+    REQUIRE_THAT(results[1].data, Catch::Matchers::Contains("died"));
+    REQUIRE(results[2].data == "C");
+    REQUIRE(results[3].data == "D");
+    REQUIRE_FALSE(results[4].ok);
+    REQUIRE(results[5].data == "F");
+    // two crashed workers were replaced
+    REQUIRE(pool.stats().size() >= 3);
+}
+#endif
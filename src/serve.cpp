@@ -0,0 +1,335 @@
+#include "serve.h"
+
+#include "html-table-writer.h"
+#include "swe.h"
+#include "table-calendar-generator.h"
+#include "text-interface.h"
+#include "vrata_detail_printer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#define VP_HAVE_UNIX_SOCKETS
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace vp::text_ui {
+
+namespace {
+
+// Keeps log lines of parallel clients whole.
+std::mutex log_mutex;
+
+// Each client gets a thread of its own. More than this many at once wait for
+// a thread to be free before they are accepted.
+constexpr unsigned max_clients = 64;
+
+// Don't let a single client without newlines eat all the memory.
+constexpr std::size_t max_request_length = 4096;
+
+struct Bad_Request : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+std::string_view next_word(std::string_view & rest) {
+    const auto start = rest.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        rest = {};
+        return {};
+    }
+    rest.remove_prefix(start);
+    const auto end = std::min(rest.find(' '), rest.size());
+    const auto word = rest.substr(0, end);
+    rest.remove_prefix(end);
+    return word;
+}
+
+date::year_month_day parse_date_arg(std::string_view & rest) {
+    const auto word = next_word(rest);
+    const auto date = parse_ymd(word);
+    if (!date.ok()) {
+        throw Bad_Request{fmt::format("bad date '{}', expected YYYY-MM-DD", word)};
+    }
+    return date;
+}
+
+// Location names may contain spaces, so it's always the rest of the line.
+std::string parse_location_arg(std::string_view rest) {
+    const auto start = rest.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        throw Bad_Request{"location name expected"};
+    }
+    std::string name{rest.substr(start)};
+    if (!LocationDb::find_coord(name.c_str())) {
+        throw Bad_Request{fmt::format("location not found: '{}'", name)};
+    }
+    return name;
+}
+
+void expect_no_more_args(std::string_view rest) {
+    if (rest.find_first_not_of(' ') != std::string_view::npos) {
+        throw Bad_Request{fmt::format("unexpected arguments: '{}'", rest)};
+    }
+}
+
+// Only one request may calculate at a time (see sweph_mutex()). Clients are
+// still served in parallel otherwise: the lock is held for the calculation
+// only, not for formatting the response, and cache hits hold it only for a moment.
+std::string next_vrata(date::year_month_day date, const std::string & location_name) {
+    std::shared_ptr<const VratasForDate> vratas;
+    {
+        std::lock_guard<std::mutex> lock{sweph_mutex()};
+        vratas = calc_shared(date, location_name);
+    }
+    fmt::memory_buffer buf;
+    for (const auto & vrata : *vratas) {
+        if (vrata) {
+            fmt::format_to(fmt::appender{buf}, "{}\n\n", Vrata_Detail_Printer{*vrata});
+        } else {
+            fmt::format_to(fmt::appender{buf}, "Can't find next Ekadashi: {}\n", vrata.error());
+        }
+    }
+    return fmt::to_string(buf);
+}
+
+std::string daybyday(date::year_month_day date, const std::string & location_name) {
+    const auto location = LocationDb::find_coord(location_name.c_str());
+    DayByDayInfo info;
+    {
+        std::lock_guard<std::mutex> lock{sweph_mutex()};
+        info = daybyday_calc_one(date, *location, CalcFlags::Default);
+    }
+    fmt::memory_buffer buf;
+    daybyday_print_info(info, *location, fmt::appender{buf});
+    return fmt::to_string(buf);
+}
+
+std::string table(date::year_month_day date) {
+    std::shared_ptr<const VratasForDate> vratas;
+    {
+        std::lock_guard<std::mutex> lock{sweph_mutex()};
+        vratas = calc_shared(date, "all");
+    }
+    fmt::memory_buffer buf;
+    Html_Table_Writer{Table_Calendar_Generator::generate(*vratas, date.year())}.write(buf);
+    return fmt::to_string(buf);
+}
+
+std::string single_line(std::string_view s) {
+    std::string result{s};
+    std::replace(result.begin(), result.end(), '\n', ' ');
+    return result;
+}
+
+std::string handle_and_log(std::string_view client, std::string_view line) {
+    const auto started = std::chrono::steady_clock::now();
+    auto response = handle_serve_request(line);
+    const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    const auto status = std::string_view{response}.substr(0, std::min(response.find(' '), response.size()));
+    {
+        std::lock_guard<std::mutex> lock{log_mutex};
+        fmt::print(stderr, FMT_STRING("{}: {:.3f} ms {} {}\n"), client, ms, status, single_line(line));
+    }
+    return response;
+}
+
+// Make sure first request doesn't pay for what we can do in advance.
+void warm_up() {
+    LocationDb::locate_time_zones();
+}
+
+#ifdef VP_HAVE_UNIX_SOCKETS
+bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const auto written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+// Counts client threads, see max_clients.
+class Client_Slots {
+public:
+    void acquire() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        freed_.wait(lock, [this]() { return busy_ < max_clients; });
+        ++busy_;
+    }
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            --busy_;
+        }
+        freed_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable freed_;
+    unsigned busy_ = 0;
+};
+
+// Outlives detached client threads.
+Client_Slots & client_slots() {
+    static Client_Slots slots;
+    return slots;
+}
+
+void serve_connection(int fd, std::string client) {
+    std::string requests;
+    std::string responses;
+    char chunk[4096];
+    while (true) {
+        const auto got = ::read(fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        requests.append(chunk, static_cast<std::size_t>(got));
+        // Answer all complete requests received so far and send the responses in one go:
+        // pipelining clients don't have to wait for a round trip per request.
+        std::size_t start = 0;
+        for (auto end = requests.find('\n'); end != std::string::npos; end = requests.find('\n', start)) {
+            responses += handle_and_log(client, std::string_view{requests}.substr(start, end - start));
+            start = end + 1;
+        }
+        requests.erase(0, start);
+        const bool too_long = requests.size() > max_request_length;
+        if (too_long) {
+            responses += fmt::format("ERR request is longer than {} bytes\n", max_request_length);
+        }
+        if (!write_all(fd, responses) || too_long) break;
+        responses.clear();
+    }
+    ::close(fd);
+    client_slots().release();
+}
+#endif
+
+} // anonymous namespace
+
+std::string handle_serve_request(std::string_view line) {
+    try {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        auto rest = line;
+        const auto command = next_word(rest);
+        std::string payload;
+        if (command == "ping") {
+            expect_no_more_args(rest);
+            payload = "pong\n";
+        } else if (command == "next") {
+            const auto date = parse_date_arg(rest);
+            const auto location_name = parse_location_arg(rest);
+            payload = next_vrata(date, location_name);
+        } else if (command == "daybyday") {
+            const auto date = parse_date_arg(rest);
+            const auto location_name = parse_location_arg(rest);
+            payload = daybyday(date, location_name);
+        } else if (command == "table") {
+            const auto date = parse_date_arg(rest);
+            expect_no_more_args(rest);
+            payload = table(date);
+        } else {
+            throw Bad_Request{fmt::format("unknown command '{}', expected one of: next, daybyday, table, ping", command)};
+        }
+        return fmt::format("OK {}\n", payload.size()) + payload;
+    } catch (const std::exception & e) {
+        return fmt::format("ERR {}\n", single_line(e.what()));
+    }
+}
+
+void serve_stdio() {
+#ifdef _WIN32
+    // payload sizes are in bytes, so no "\n" => "\r\n" translation
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    warm_up();
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        const auto response = handle_and_log("stdio", line);
+        std::fwrite(response.data(), 1, response.size(), stdout);
+        // Flush only when there are no more pipelined requests already waiting.
+        if (std::cin.rdbuf()->in_avail() <= 0) {
+            std::fflush(stdout);
+        }
+    }
+    std::fflush(stdout);
+}
+
+#ifdef VP_HAVE_UNIX_SOCKETS
+void serve_unix_socket(const std::string & path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error(fmt::format("socket path is too long: '{}'", path));
+    }
+    // Client disconnecting before reading its responses must not kill the server.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error(fmt::format("can't create socket: {}", std::strerror(errno)));
+    }
+    // Socket left from the previous run would make bind() fail. Never remove anything else though.
+    if (std::error_code ec; fs::is_socket(path, ec)) {
+        fs::remove(path, ec);
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    if (::bind(listen_fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0
+            || ::listen(listen_fd, SOMAXCONN) != 0) {
+        const auto err = errno;
+        ::close(listen_fd);
+        throw std::runtime_error(fmt::format("can't listen on '{}': {}", path, std::strerror(err)));
+    }
+    warm_up();
+    fmt::print(stderr, "listening on {}\n", path);
+
+    unsigned long clients = 0;
+    while (true) {
+        // Clients over the limit wait in the listen backlog.
+        client_slots().acquire();
+        int fd;
+        do {
+            fd = ::accept(listen_fd, nullptr, nullptr);
+        } while (fd < 0 && (errno == EINTR || errno == ECONNABORTED));
+        if (fd < 0) {
+            const auto err = errno;
+            ::close(listen_fd);
+            client_slots().release();
+            throw std::runtime_error(fmt::format("accept() failed: {}", std::strerror(err)));
+        }
+        try {
+            std::thread{serve_connection, fd, fmt::format("client {}", ++clients)}.detach();
+        } catch (...) {
+            ::close(fd);
+            client_slots().release();
+            throw;
+        }
+    }
+}
+#else
+void serve_unix_socket(const std::string & path) {
+    throw std::runtime_error(fmt::format("can't listen on '{}': Unix domain sockets are not supported on this platform, use stdin/stdout", path));
+}
+#endif
+
+} // namespace vp::text_ui
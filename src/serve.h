@@ -0,0 +1,37 @@
+#ifndef VP_SERVE_H
+#define VP_SERVE_H
+
+#include <string>
+#include <string_view>
+
+namespace vp::text_ui {
+
+/*
+ * Resident server mode (--serve): keeps tzdata, LocationDb and result caches
+ * warm between requests instead of paying for them on each process start.
+ *
+ * Protocol is line-oriented, one request per line:
+ *
+ *     next YYYY-MM-DD location-name     (details of next ekādaśī, like "CLI date location")
+ *     daybyday YYYY-MM-DD location-name (like -d)
+ *     table YYYY-MM-DD                  (HTML table for all locations, like in GUI)
+ *     ping
+ *
+ * Each response is either "OK <n>\n" followed by exactly n bytes of payload,
+ * or "ERR <message>\n". Clients may send many requests without waiting for
+ * responses (pipelining); responses always come in the order of requests.
+ */
+
+// Handle single request line (without "\n"), return complete response.
+std::string handle_serve_request(std::string_view line);
+
+// Serve requests from stdin, write responses to stdout until EOF.
+void serve_stdio();
+
+// Listen on Unix domain socket at given path, one thread per connected client.
+// Runs until killed. Throws std::runtime_error if the socket can't be set up.
+void serve_unix_socket(const std::string & path);
+
+} // namespace vp::text_ui
+
+#endif // VP_SERVE_H
@@ -0,0 +1,51 @@
+#include "serve.h"
+
+#include "catch-formatters.h"
+
+using Catch::Matchers::Contains;
+using Catch::Matchers::StartsWith;
+using vp::text_ui::handle_serve_request;
+
+namespace {
+// "OK <n>\n<payload>" => payload, checking that n matches
+std::string payload_of(const std::string & response) {
+    REQUIRE_THAT(response, StartsWith("OK "));
+    const auto header_end = response.find('\n');
+    REQUIRE(header_end != std::string::npos);
+    const auto size = std::stoul(response.substr(3, header_end - 3));
+    const auto payload = response.substr(header_end + 1);
+    REQUIRE(payload.size() == size);
+    return payload;
+}
+}
+
+TEST_CASE("serve: ping") {
+    REQUIRE(handle_serve_request("ping") == "OK 5\npong\n");
+    REQUIRE(handle_serve_request("ping\r") == "OK 5\npong\n");
+}
+
+TEST_CASE("serve: bad requests give single-line errors") {
+    REQUIRE_THAT(handle_serve_request(""), StartsWith("ERR unknown command"));
+    REQUIRE_THAT(handle_serve_request("frobnicate"), StartsWith("ERR unknown command 'frobnicate'"));
+    REQUIRE_THAT(handle_serve_request("next 2020-13-45 Kiev"), StartsWith("ERR bad date '2020-13-45'"));
+    REQUIRE_THAT(handle_serve_request("next 2020-01-01"), StartsWith("ERR location name expected"));
+    REQUIRE_THAT(handle_serve_request("next 2020-01-01 Atlantis"), StartsWith("ERR location not found: 'Atlantis'"));
+    REQUIRE_THAT(handle_serve_request("table 2020-01-01 Kiev"), StartsWith("ERR unexpected arguments"));
+    for (const auto * request : {"", "next 2020-01-01 Atlantis", "ping pong"}) {
+        const auto response = handle_serve_request(request);
+        REQUIRE(response.find('\n') == response.size() - 1);
+    }
+}
+
+TEST_CASE("serve: next, daybyday and table") {
+    const auto next = payload_of(handle_serve_request("next 2020-01-01 Kiev"));
+    REQUIRE_THAT(next, Contains("Kiev"));
+    REQUIRE_THAT(next, Contains("Coordinates:"));
+
+    const auto daybyday = payload_of(handle_serve_request("daybyday 2020-01-01 Kiev"));
+    REQUIRE_THAT(daybyday, Contains("sunrise"));
+
+    const auto table = payload_of(handle_serve_request("table 2020-01-01"));
+    REQUIRE_THAT(table, Contains("<table"));
+    REQUIRE_THAT(table, Contains("Kiev"));
+}
@@ -0,0 +1,53 @@
+#include "string-pool.h"
+
+#include <cstring>
+#include <utility>
+
+namespace vp {
+
+String_Pool::String_Pool(String_Pool && other) noexcept
+    : chunks_(std::move(other.chunks_)),
+      free_(std::exchange(other.free_, nullptr)),
+      free_size_(std::exchange(other.free_size_, 0)),
+      index_(std::move(other.index_))
+{
+}
+
+String_Pool & String_Pool::operator=(String_Pool && other) noexcept
+{
+    chunks_ = std::move(other.chunks_);
+    free_ = std::exchange(other.free_, nullptr);
+    free_size_ = std::exchange(other.free_size_, 0);
+    index_ = std::move(other.index_);
+    return *this;
+}
+
+std::string_view String_Pool::intern(std::string_view s)
+{
+    if (s.empty()) return {};
+    if (const auto found = index_.find(s); found != index_.end()) return *found;
+    const auto stored = store(s);
+    index_.insert(stored);
+    return stored;
+}
+
+std::string_view String_Pool::store(std::string_view s)
+{
+    if (s.size() > chunk_size / 4) {
+        // long strings get a chunk of their own, so that they don't waste the rest of a regular one
+        auto & chunk = chunks_.emplace_back(std::make_unique<char[]>(s.size()));
+        std::memcpy(chunk.get(), s.data(), s.size());
+        return {chunk.get(), s.size()};
+    }
+    if (s.size() > free_size_) {
+        free_ = chunks_.emplace_back(std::make_unique<char[]>(chunk_size)).get();
+        free_size_ = chunk_size;
+    }
+    char * stored = free_;
+    std::memcpy(stored, s.data(), s.size());
+    free_ += s.size();
+    free_size_ -= s.size();
+    return {stored, s.size()};
+}
+
+} // namespace vp
@@ -0,0 +1,41 @@
+#ifndef VP_STRING_POOL_H
+#define VP_STRING_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace vp {
+
+/*
+ * Interned strings: each distinct string is stored once, in chunks owned by
+ * the pool, so interning N strings with U distinct ones allocates O(U) times,
+ * not O(N). Returned views stay valid while the pool lives, including after
+ * the pool is moved.
+ */
+class String_Pool {
+public:
+    String_Pool() = default;
+    String_Pool(String_Pool && other) noexcept;
+    String_Pool & operator=(String_Pool && other) noexcept;
+    String_Pool(const String_Pool &) = delete;
+    String_Pool & operator=(const String_Pool &) = delete;
+
+    std::string_view intern(std::string_view s);
+    std::size_t size() const { return index_.size(); } // distinct strings
+
+private:
+    std::string_view store(std::string_view s);
+
+    static constexpr std::size_t chunk_size = 4096;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char * free_ = nullptr; // in the last regular chunk
+    std::size_t free_size_ = 0;
+    std::unordered_set<std::string_view> index_;
+};
+
+} // namespace vp
+
+#endif // VP_STRING_POOL_H
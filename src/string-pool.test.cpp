@@ -0,0 +1,37 @@
+#include "string-pool.h"
+
+#include "catch-formatters.h"
+
+#include <string>
+
+TEST_CASE("String_Pool stores each distinct string once") {
+    vp::String_Pool pool;
+    std::string s1{"mainpart"};
+    std::string s2{"mainpart"};
+    const auto i1 = pool.intern(s1);
+    const auto i2 = pool.intern(s2);
+    REQUIRE(i1 == "mainpart");
+    REQUIRE(i1.data() == i2.data());
+    REQUIRE(i1.data() != s1.data());
+    REQUIRE(pool.intern("skipped") == "skipped");
+    REQUIRE(pool.size() == 2);
+    REQUIRE(pool.intern("").empty());
+}
+
+TEST_CASE("String_Pool keeps strings valid as it grows and when it's moved") {
+    vp::String_Pool pool;
+    std::vector<std::string_view> interned;
+    for (int i = 0; i < 2000; ++i) {
+        interned.push_back(pool.intern(fmt::format("string number {}", i)));
+    }
+    const std::string long_string(5000, 'x');
+    const auto long_interned = pool.intern(long_string);
+
+    vp::String_Pool moved{std::move(pool)};
+    for (int i = 0; i < 2000; ++i) {
+        REQUIRE(interned[static_cast<std::size_t>(i)] == fmt::format("string number {}", i));
+        REQUIRE(moved.intern(fmt::format("string number {}", i)).data() == interned[static_cast<std::size_t>(i)].data());
+    }
+    REQUIRE(long_interned == long_string);
+    REQUIRE(moved.size() == 2001);
+}
@@ -17,6 +17,12 @@ constexpr double atmospheric_temperature = 15;
 
 static std::string se_flag_to_string(uint_fast32_t flag);
 
+std::mutex & sweph_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
 [[noreturn]] static void throw_on_wrong_flags(int out_flags, int in_flags, const char *serr, const char *operation, double juldays) {
     if (out_flags == ERR) {
         throw std::runtime_error(serr);
@@ -9,6 +9,7 @@
 #include "tithi.h"
 
 #include <cstdint> // for int32_t
+#include <mutex>
 #include <tl/expected.hpp>
 
 namespace vp {
@@ -53,6 +54,11 @@ private:
     int32_t calc_ephemeris_flags(CalcFlags flags) const noexcept;
 };
 
+// sweph keeps its state in globals, so Swe objects must never be used from
+// several threads at the same time. Threaded code (server modes) holds this
+// mutex for the whole calculation, from creating Swe to destroying it.
+std::mutex & sweph_mutex();
+
 } // namespace vp
 
 #endif // SWE_H
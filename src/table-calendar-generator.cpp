@@ -2,7 +2,14 @@
 
 #include "html-util.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
 namespace {
@@ -42,33 +49,35 @@ void add_header(vp::Table & table, const std::set<date::local_days> & vrata_date
 
     for (auto date : vrata_dates) {
         if (date != expected_next_date) {
-            table.add_header_cell("...", "mainpart skipped");
+            table.add_header_cell("...", {vp::css::mainpart, vp::css::skipped});
         }
         expected_next_date = date + date::days{1};
         const auto ymd = date::year_month_day{date};
         if (default_year != date::year::min() && ymd.year() != default_year) {
-            table.add_header_cell(fmt::format(FMT_STRING("{:lhy}"), ymd), "mainpart");
+            table.add_header_cell(fmt::format(FMT_STRING("{:lhy}"), ymd), vp::css::mainpart);
         } else {
-            table.add_header_cell(fmt::format(FMT_STRING("{:lh}"), ymd), "mainpart");
+            table.add_header_cell(fmt::format(FMT_STRING("{:lh}"), ymd), vp::css::mainpart);
         }
     }
 }
 
-std::string get_timezone_text(const vp::MaybeVrata & vrata) {
-    if (!vrata) return "-";
-    if (!vrata->paran.paran_start) return "-";
-    auto paran_start_sys = vrata->paran.paran_start->as_sys_time();
-    auto timezone = vrata->location.time_zone();
-    auto info = timezone->get_info(paran_start_sys);
+// UTC offset in effect at pāraṇam start, which the table shows and separates rows by.
+std::optional<vp::Time_Zone::Utc_Offset> paran_start_utc_offset(const vp::Vrata & vrata) {
+    if (!vrata.paran.paran_start) return std::nullopt;
+    return vrata.location.time_zone()->utc_offset(vrata.paran.paran_start->round_to_second_down());
+}
+
+std::string get_timezone_text(const std::optional<vp::Time_Zone::Utc_Offset> & offset) {
+    if (!offset) return "-";
 
-    long long seconds = info.offset.count();
+    long long seconds = offset->offset.count();
     char sign = seconds < 0 ? '-' : '+';
     seconds = std::abs(seconds);
     auto hours = seconds / 3600;
     seconds -= hours * 3600;
     auto minutes = seconds / 60;
     seconds -= minutes * 60;
-    std::string dst = info.save != std::chrono::seconds{0} ? " (DST)" : "";
+    std::string dst = offset->is_dst ? " (DST)" : "";
 
     if (seconds != 0) {
         return fmt::format(FMT_STRING("{}{}:{:02}:{:02}{}"), sign, hours, minutes, seconds, dst);
@@ -76,14 +85,41 @@ std::string get_timezone_text(const vp::MaybeVrata & vrata) {
     return fmt::format(FMT_STRING("{}{}:{:02}{}"), sign, hours, minutes, dst);
 }
 
-void add_vrata(vp::Table & table, const vp::MaybeVrata & vrata, const std::set<date::local_days> & vrata_dates, std::string tr_classes, const vp::Custom_Dates & custom_dates) {
-    table.start_new_row(std::move(tr_classes));
-    table.add_cell(get_timezone_text(vrata));
-    table.add_cell(vrata->location.country);
-    {
-        auto location_with_href = fmt::format(FMT_STRING(R"(<a href="#{}">{}</a>)"), html::escape_attribute(vrata->location_name()), vrata->location_name());
-        table.add_cell(location_with_href).set_title(fmt::format(FMT_STRING("Timezone: {}"), vrata->location.time_zone_name));
-    }
+// Cells of the location columns, the same in all pakṣas.
+struct Location_Cells {
+    std::string country;
+    std::string anchor; // location name linking to its details
+    std::string title;
+};
+
+Location_Cells make_location_cells(const vp::Vrata & vrata) {
+    const auto location_name = vrata.location_name();
+    fmt::memory_buffer location_with_href;
+    fmt::format_to(fmt::appender{location_with_href}, FMT_STRING(R"(<a href="#)"));
+    html::escape_attribute_to(location_with_href, location_name);
+    fmt::format_to(fmt::appender{location_with_href}, FMT_STRING(R"(">{}</a>)"), location_name);
+    return Location_Cells{
+        std::string{vrata.location.country},
+        fmt::to_string(location_with_href),
+        fmt::format(FMT_STRING("Timezone: {}"), vrata.location.time_zone_name),
+    };
+}
+
+// Made once for all pakṣas of a multi-pakṣa table, by location_cells_key().
+using Location_Cells_Cache = std::unordered_map<std::string, Location_Cells>;
+
+// Everything Location_Cells are made of, so that locations which share a name
+// but not a country or time zone get cells of their own.
+std::string location_cells_key(const vp::Vrata & vrata) {
+    return fmt::format(FMT_STRING("{}\n{}\n{}"), vrata.location_name(), vrata.location.country, vrata.location.time_zone_name);
+}
+
+void add_vrata(vp::Table & table, const vp::MaybeVrata & vrata, const std::optional<vp::Time_Zone::Utc_Offset> & utc_offset, const Location_Cells & location_cells,
+               const std::set<date::local_days> & vrata_dates, vp::Css_Classes tr_classes, const vp::Custom_Dates & custom_dates) {
+    table.start_new_row(tr_classes);
+    table.add_cell(get_timezone_text(utc_offset));
+    table.add_cell(location_cells.country);
+    table.add_cell(location_cells.anchor).set_title(location_cells.title);
     if (!vrata) {
         for (std::size_t i=0; i < vrata_dates.size(); ++i) {
             table.add_cell("calculation error");
@@ -95,26 +131,26 @@ void add_vrata(vp::Table & table, const vp::MaybeVrata & vrata, const std::set<d
     date::local_days expected_next_date = *vrata_dates.begin();
     for (auto date : vrata_dates) {
         if (date != expected_next_date) {
-            table.add_cell("", "mainpart skipped");
+            table.add_cell("", {vp::css::mainpart, vp::css::skipped});
         }
         expected_next_date = date + date::days{1};
         if (auto found_it = custom_dates.find(date); found_it != custom_dates.end()) {
             bool description_is_not_empty = !found_it->second.empty();
-            const char * classes = description_is_not_empty ? "mainpart custom" : "mainpart";
+            const auto classes = description_is_not_empty ? vp::Css_Classes{vp::css::mainpart, vp::css::custom} : vp::Css_Classes{vp::css::mainpart};
             table.add_cell(found_it->second, classes);
         } else if (auto [begin, end] = vrata->dates_for_this_paksha.equal_range(date); begin != end) {
             // since std::distance(begin, end) != 0, we can safely use *begin and do ++begin before the loop
             std::string text;
             std::string title;
-            std::string css_classes;
+            vp::Css_Classes css_classes{vp::css::mainpart};
             for (; begin != end; ++begin) {
                 text += (text.empty() ? "" : ". ") + begin->second.name;
                 title += (title.empty() ? "" : ". ") + begin->second.title;
-                css_classes += (css_classes.empty() ? "" : " ") + begin->second.css_classes;
+                css_classes |= vp::Css_Classes::parse(begin->second.css_classes);
             }
-            table.add_cell(text, "mainpart " + css_classes).set_title(title);
+            table.add_cell(text, css_classes).set_title(title);
         } else {
-            table.add_unmergeable_cell("", "mainpart");
+            table.add_unmergeable_cell("", vp::css::mainpart);
         }
     }
 }
@@ -128,13 +164,13 @@ std::vector<double> calc_column_widths(const vp::Table & table) {
     constexpr double skipped_col_width = 2.0;
     std::vector<double> col_widths{timezone_col_width, country_col_width, city_col_width};
     col_widths.resize(width);
-    const auto skipped_col_count = std::count_if(table.row(0).data.begin(), table.row(0).data.end(), [](const vp::Table::Cell & cell) {
-        return cell.has_class("skipped");
+    const auto skipped_col_count = std::count_if(table.cells(0).begin(), table.cells(0).end(), [](const vp::Table::Cell & cell) {
+        return cell.has_class(vp::css::skipped);
     });
     const size_t mainpart_col_count = width - 3 - skipped_col_count;
     const double mainpart_col_width = (100.0 - timezone_col_width - country_col_width - city_col_width - skipped_col_width * skipped_col_count) / mainpart_col_count;
     for (size_t col=3; col < width; ++col) {
-        if (table.at(0, col).has_class("skipped")) {
+        if (table.at(0, col).has_class(vp::css::skipped)) {
             col_widths[col] = skipped_col_width;
         } else {
             col_widths[col] = mainpart_col_width;
@@ -143,45 +179,246 @@ std::vector<double> calc_column_widths(const vp::Table & table) {
     return col_widths;
 }
 
-std::chrono::seconds utc_offset_for_vrata(const vp::Vrata & vrata) {
-    if (!vrata.paran.paran_start) return {};
-    auto paran_start_sys = vrata.paran.paran_start->as_sys_time();
-    auto timezone = vrata.location.time_zone();
-    auto info = timezone->get_info(paran_start_sys);
+const char * const top_header_text = "॥ श्रीः ॥";
+const char * const bottom_header_text = "॥ ॐ तत्सत् ॥";
 
-    return info.offset;
+// Adds vrata's row, after a separator row when its UTC offset is far from the previous vrata's.
+// Location cells are taken from location_cells_cache when given, made anew otherwise.
+void add_vrata_row(vp::Table & table, const vp::MaybeVrata & vrata, const std::set<date::local_days> & vrata_dates,
+                   const vp::Custom_Dates & custom_dates, int & row, std::optional<std::chrono::seconds> & prev_vrata_utc_offset,
+                   const Location_Cells_Cache * location_cells_cache = nullptr) {
+    using namespace std::chrono_literals;
+    constexpr std::chrono::seconds min_utc_offset_for_separator = 7h;
+    std::optional<vp::Time_Zone::Utc_Offset> utc_offset;
+    Location_Cells own_location_cells;
+    const Location_Cells * location_cells = &own_location_cells;
+    if (vrata) {
+        utc_offset = paran_start_utc_offset(*vrata);
+        const auto vrata_utc_offset = utc_offset ? utc_offset->offset : 0s;
+        if (prev_vrata_utc_offset) {
+            if (abs(vrata_utc_offset - *prev_vrata_utc_offset) >= min_utc_offset_for_separator) {
+                table.start_new_row(vp::css::separator);
+            }
+        }
+        prev_vrata_utc_offset = vrata_utc_offset;
+        if (location_cells_cache) {
+            location_cells = &location_cells_cache->at(location_cells_key(*vrata));
+        } else {
+            own_location_cells = make_location_cells(*vrata);
+        }
+    }
+    add_vrata(table, vrata, utc_offset, *location_cells, vrata_dates, ++row % 2 ? vp::css::odd : vp::css::even, custom_dates);
 }
 
-} // anonymous namespace
+void add_location_cells(Location_Cells_Cache & cache, const vp::VratasForDate & vratas) {
+    for (const auto & vrata : vratas) {
+        if (!vrata) continue;
+        auto key = location_cells_key(*vrata);
+        if (cache.find(key) == cache.end()) {
+            cache.emplace(std::move(key), make_location_cells(*vrata));
+        }
+    }
+}
 
-vp::Table vp::Table_Calendar_Generator::generate(const vp::VratasForDate & vratas, date::year default_year, const Custom_Dates & custom_dates)
-{
+// Columns add_header() makes for vrata_dates.
+std::size_t column_count(const std::set<date::local_days> & vrata_dates) {
+    std::size_t count = 3 + vrata_dates.size();
+    std::optional<date::local_days> prev;
+    for (const auto date : vrata_dates) {
+        if (prev && date != *prev + date::days{1}) ++count; // "..."
+        prev = date;
+    }
+    return count;
+}
+
+// Pads the last row up to width, for pakṣas of a continuous table: header rows with an empty
+// header cell merged into a colspan, other rows with empty cells which don't merge with anything.
+void pad_last_row(vp::Table & table, std::size_t width) {
+    const auto cells = table.cells(table.height() - 1);
+    const auto length = static_cast<std::size_t>(cells.end() - cells.begin());
+    const bool header = length > 0 && cells.begin()->type == vp::Table::CellType::Header;
+    for (std::size_t col = length; col < width; ++col) {
+        if (header) {
+            table.add_header_cell("");
+        } else {
+            table.add_unmergeable_cell("");
+        }
+    }
+}
+
+// Equal widths of all date columns: in a continuous table they hold different dates from one section to another.
+std::vector<double> continuous_column_widths(std::size_t width) {
+    constexpr double timezone_col_width = 8.0; // percent
+    constexpr double country_col_width = 16.0;
+    constexpr double city_col_width = 16.0;
+    std::vector<double> col_widths{timezone_col_width, country_col_width, city_col_width};
+    if (width <= col_widths.size()) {
+        col_widths.resize(width);
+        return col_widths;
+    }
+    const double date_col_width = (100.0 - timezone_col_width - country_col_width - city_col_width) / static_cast<double>(width - col_widths.size());
+    col_widths.resize(width, date_col_width);
+    return col_widths;
+}
+
+// Header, a row per vrata and, unless it's to be closed later, the bottom header; cells merged.
+// With pad_to_width, rows are padded for a continuous table (separator rows stay empty).
+vp::Table paksha_table(const vp::VratasForDate & vratas, const std::set<date::local_days> & vrata_dates, date::year default_year, const vp::Custom_Dates & custom_dates,
+                       const Location_Cells_Cache * location_cells_cache, bool add_bottom_header, std::size_t pad_to_width = 0) {
     vp::Table table;
-    auto vrata_dates = get_vrata_dates(vratas, custom_dates);
-    add_header(table, vrata_dates, default_year, "॥ श्रीः ॥");
+    add_header(table, vrata_dates, default_year, top_header_text);
+    pad_last_row(table, pad_to_width);
     int row = 1;
-    const vp::MaybeVrata * prev_vrata{};
-    std::chrono::seconds prev_vrata_utc_offset;
-    using namespace std::chrono_literals;
-    constexpr std::chrono::seconds min_utc_offset_for_separator = 7h;
+    std::optional<std::chrono::seconds> prev_vrata_utc_offset;
     for (const auto & vrata : vratas) {
-        if (vrata) {
-            auto vrata_utc_offset = utc_offset_for_vrata(*vrata);
-            if (prev_vrata) {
-                if (abs(vrata_utc_offset - prev_vrata_utc_offset) >= min_utc_offset_for_separator) {
-                    table.start_new_row("separator");
-                }
-            }
-            prev_vrata = &vrata;
-            prev_vrata_utc_offset = vrata_utc_offset;
-        }
-        add_vrata(table, vrata, vrata_dates, ++row % 2 ? "odd" : "even", custom_dates);
+        add_vrata_row(table, vrata, vrata_dates, custom_dates, row, prev_vrata_utc_offset, location_cells_cache);
+        pad_last_row(table, pad_to_width);
+    }
+    if (add_bottom_header) {
+        add_header(table, vrata_dates, default_year, bottom_header_text);
+        pad_last_row(table, pad_to_width);
     }
-    add_header(table, vrata_dates, default_year, "॥ ॐ तत्सत् ॥");
     table.merge_cells_into_rowspans();
     table.merge_cells_into_colspans();
+    return table;
+}
+
+// Calls make(i) for each i < count on up to `threads` threads (0: one per hardware thread), and
+// take(i, result) on the calling thread in order of i, each as soon as it and all results before it
+// are made. At most two results per thread wait to be taken. The first exception thrown by make()
+// or take() stops the rest and is rethrown once all threads are done.
+template<typename Make, typename Take>
+void make_in_order(std::size_t count, unsigned threads, Make make, Take take) {
+    using Result = decltype(make(std::size_t{}));
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+    if (threads <= 1) {
+        for (std::size_t i = 0; i < count; ++i) take(i, make(i));
+        return;
+    }
+
+    const std::size_t max_waiting = 2 * std::size_t{threads};
+    std::vector<std::optional<Result>> results(count);
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t next_to_make = 0;
+    std::size_t next_to_take = 0;
+    std::exception_ptr error;
+    auto work = [&]() {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (true) {
+            changed.wait(lock, [&] { return error || next_to_make >= count || next_to_make < next_to_take + max_waiting; });
+            if (error || next_to_make >= count) return;
+            const auto i = next_to_make++;
+            lock.unlock();
+            std::optional<Result> result;
+            std::exception_ptr make_error;
+            try {
+                result.emplace(make(i));
+            } catch (...) {
+                make_error = std::current_exception();
+            }
+            lock.lock();
+            if (make_error) {
+                if (!error) error = make_error;
+            } else {
+                results[i] = std::move(result);
+            }
+            changed.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t) workers.emplace_back(work);
+
+    std::unique_lock<std::mutex> lock{mutex};
+    while (next_to_take < count) {
+        changed.wait(lock, [&] { return error || results[next_to_take]; });
+        if (error) break;
+        auto result = std::move(*results[next_to_take]);
+        results[next_to_take].reset();
+        const auto i = next_to_take++;
+        changed.notify_all();
+        lock.unlock();
+        std::exception_ptr take_error;
+        try {
+            take(i, std::move(result));
+        } catch (...) {
+            take_error = std::current_exception();
+        }
+        lock.lock();
+        if (take_error) {
+            if (!error) error = take_error;
+            changed.notify_all();
+            break;
+        }
+    }
+    lock.unlock();
+    for (auto & worker : workers) worker.join();
+    if (error) std::rethrow_exception(error);
+}
+
+} // anonymous namespace
+
+vp::Table vp::Table_Calendar_Generator::generate(const vp::VratasForDate & vratas, date::year default_year, const Custom_Dates & custom_dates)
+{
+    auto table = paksha_table(vratas, get_vrata_dates(vratas, custom_dates), default_year, custom_dates, nullptr, true);
     table.set_column_widths(calc_column_widths(table));
     table.add_even_odd_classes_for_col(0);
     table.add_even_odd_classes_for_col(1, Table::StartFrom::Even);
     return table;
 }
+
+void vp::Table_Calendar_Generator::generate_each(const std::vector<VratasForDate> & pakshas, const std::function<void(std::size_t, vp::Table &&)> & on_table,
+                                                   date::year default_year, const Custom_Dates & custom_dates, unsigned threads)
+{
+    Location_Cells_Cache location_cells;
+    for (const auto & vratas : pakshas) {
+        add_location_cells(location_cells, vratas);
+    }
+    make_in_order(pakshas.size(), threads, [&](std::size_t i) {
+        auto table = paksha_table(pakshas[i], get_vrata_dates(pakshas[i], custom_dates), default_year, custom_dates, &location_cells, true);
+        table.set_column_widths(calc_column_widths(table));
+        table.add_even_odd_classes_for_col(0);
+        table.add_even_odd_classes_for_col(1, Table::StartFrom::Even);
+        return table;
+    }, on_table);
+}
+
+std::vector<vp::Table> vp::Table_Calendar_Generator::generate_stacked(const std::vector<VratasForDate> & pakshas, date::year default_year, const Custom_Dates & custom_dates, unsigned threads)
+{
+    std::vector<vp::Table> tables;
+    tables.reserve(pakshas.size());
+    generate_each(pakshas, [&](std::size_t, vp::Table && table) {
+        tables.push_back(std::move(table));
+    }, default_year, custom_dates, threads);
+    return tables;
+}
+
+vp::Table vp::Table_Calendar_Generator::generate_continuous(const std::vector<VratasForDate> & pakshas, date::year default_year, const Custom_Dates & custom_dates, unsigned threads)
+{
+    vp::Table table;
+    if (pakshas.empty()) return table;
+    Location_Cells_Cache location_cells;
+    for (const auto & vratas : pakshas) {
+        add_location_cells(location_cells, vratas);
+    }
+    std::vector<std::set<date::local_days>> paksha_dates;
+    paksha_dates.reserve(pakshas.size());
+    std::size_t width = 0;
+    for (const auto & vratas : pakshas) {
+        paksha_dates.push_back(get_vrata_dates(vratas, custom_dates));
+        width = std::max(width, column_count(paksha_dates.back()));
+    }
+    make_in_order(pakshas.size(), threads, [&](std::size_t i) {
+        const bool last = i + 1 == pakshas.size();
+        auto section = paksha_table(pakshas[i], paksha_dates[i], default_year, custom_dates, &location_cells, last, width);
+        section.add_even_odd_classes_for_col(0);
+        section.add_even_odd_classes_for_col(1, Table::StartFrom::Even);
+        return section;
+    }, [&](std::size_t, vp::Table && section) {
+        table.append(section);
+    });
+    table.set_column_widths(continuous_column_widths(width));
+    return table;
+}
@@ -5,8 +5,11 @@
 #include "table.h"
 #include "vrata.h"
 
+#include <cstddef>
+#include <functional>
 #include <ostream>
 #include <unordered_map>
+#include <vector>
 
 namespace vp {
 
@@ -16,6 +19,27 @@ class Table_Calendar_Generator
 {
 public:
     static vp::Table generate(const VratasForDate & vratas, date::year default_year=date::year::min(), const Custom_Dates & custom_dates={});
+
+    /*
+     * Tables for several pakṣas at once. Location cells (country, name
+     * linking to details, time zone title) are made once per location for
+     * all of them, and pakṣas are laid out on up to `threads` threads
+     * (0: one per hardware thread); the result is the same whatever the
+     * number of threads.
+     *
+     * generate_each() calls on_table(i, table) with the same table as
+     * generate(pakshas[i]) on the calling thread, in order of i, as soon as
+     * the table and all the ones before it are ready, so that they can be
+     * written out while the rest are being laid out.
+     * generate_stacked() gives all of these tables at once.
+     * generate_continuous() gives a single table: a header and rows for each
+     * pakṣa in turn, all padded to the widest pakṣa, with common column
+     * widths and the closing header after the last pakṣa.
+     */
+    static void generate_each(const std::vector<VratasForDate> & pakshas, const std::function<void(std::size_t, vp::Table &&)> & on_table,
+                              date::year default_year=date::year::min(), const Custom_Dates & custom_dates={}, unsigned threads=0);
+    static std::vector<vp::Table> generate_stacked(const std::vector<VratasForDate> & pakshas, date::year default_year=date::year::min(), const Custom_Dates & custom_dates={}, unsigned threads=0);
+    static vp::Table generate_continuous(const std::vector<VratasForDate> & pakshas, date::year default_year=date::year::min(), const Custom_Dates & custom_dates={}, unsigned threads=0);
 };
 
 } // namespace vp
@@ -1,10 +1,14 @@
 #include "catch-formatters.h"
 
 #include "table-calendar-generator.h"
+#include "html-table-writer.h"
 #include "text-interface.h"
 
+#include <chrono>
 #include <regex>
 #include <sstream>
+#include <string>
+#include <vector>
 
 using namespace date;
 using Catch::Matchers::Contains;
@@ -49,19 +53,19 @@ TEST_CASE("default table") {
 
     SECTION("Table_Calendar_Generator returns reasonable table") {
         REQUIRE(table.width() == 6);
-        REQUIRE(table.at(0, 3).text == "August&nbsp;21");
-        REQUIRE(table.at(0, 4).text == "August&nbsp;22");
-        REQUIRE(table.at(0, 5).text == "August&nbsp;23");
+        REQUIRE(table.at(0, 3).text() == "August&nbsp;21");
+        REQUIRE(table.at(0, 4).text() == "August&nbsp;22");
+        REQUIRE(table.at(0, 5).text() == "August&nbsp;23");
 
         REQUIRE(table.height() >= 20);
 
-        REQUIRE(table.at(1, 0).text == "+5:30");
-        REQUIRE(table.at(1, 1).text == "India");
-        REQUIRE_THAT(table.at(1, 2).text, Contains("Udupi"));
-        REQUIRE_THAT(table.at(1, 3).text, Contains("HV > 01:04"));
-        REQUIRE_THAT(table.at(1, 3).text, Contains("22.08"));
-        REQUIRE(table.at(1, 4).text == "Pavitrā Ekādaśī");
-        REQUIRE_THAT(table.at(1, 5).text, Contains("*"));
+        REQUIRE(table.at(1, 0).text() == "+5:30");
+        REQUIRE(table.at(1, 1).text() == "India");
+        REQUIRE_THAT(std::string{table.at(1, 2).text()}, Contains("Udupi"));
+        REQUIRE_THAT(std::string{table.at(1, 3).text()}, Contains("HV > 01:04"));
+        REQUIRE_THAT(std::string{table.at(1, 3).text()}, Contains("22.08"));
+        REQUIRE(table.at(1, 4).text() == "Pavitrā Ekādaśī");
+        REQUIRE_THAT(std::string{table.at(1, 5).text()}, Contains("*"));
     }
 
     SECTION("Table_Calendar_Generator generates 'shrIH'/'Om tatsat' with dates as the top and bottom rows") {
@@ -69,28 +73,28 @@ TEST_CASE("default table") {
 
         REQUIRE(rows >= 3);
 
-        REQUIRE(table.at(0, 3).text == "August&nbsp;21");
-        REQUIRE(table.at(rows-1, 3).text == "August&nbsp;21");
-        REQUIRE(table.at(0, 4).text == "August&nbsp;22");
-        REQUIRE(table.at(rows-1, 4).text == "August&nbsp;22");
-        REQUIRE(table.at(0, 5).text == "August&nbsp;23");
-        REQUIRE(table.at(rows-1, 5).text == "August&nbsp;23");
+        REQUIRE(table.at(0, 3).text() == "August&nbsp;21");
+        REQUIRE(table.at(rows-1, 3).text() == "August&nbsp;21");
+        REQUIRE(table.at(0, 4).text() == "August&nbsp;22");
+        REQUIRE(table.at(rows-1, 4).text() == "August&nbsp;22");
+        REQUIRE(table.at(0, 5).text() == "August&nbsp;23");
+        REQUIRE(table.at(rows-1, 5).text() == "August&nbsp;23");
 
-        REQUIRE_THAT(table.at(0, 0).text, Contains("श्रीः"));
-        REQUIRE_THAT(table.at(rows-1, 0).text, Contains("ॐ तत्सत्"));
+        REQUIRE_THAT(std::string{table.at(0, 0).text()}, Contains("श्रीः"));
+        REQUIRE_THAT(std::string{table.at(rows-1, 0).text()}, Contains("ॐ तत्सत्"));
     }
 
     SECTION("generated table has 'mainpart' as a class for top/bottom date headers") {
-        REQUIRE_THAT(table.at(0, 3).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(0, 4).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(0, 5).classes, Contains("mainpart"));
+        REQUIRE(table.at(0, 3).has_class(vp::css::mainpart));
+        REQUIRE(table.at(0, 4).has_class(vp::css::mainpart));
+        REQUIRE(table.at(0, 5).has_class(vp::css::mainpart));
 
         size_t rows = table.height();
         REQUIRE(rows >= 3);
 
-        REQUIRE_THAT(table.at(rows-1, 3).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(rows-1, 4).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(rows-1, 5).classes, Contains("mainpart"));
+        REQUIRE(table.at(rows-1, 3).has_class(vp::css::mainpart));
+        REQUIRE(table.at(rows-1, 4).has_class(vp::css::mainpart));
+        REQUIRE(table.at(rows-1, 5).has_class(vp::css::mainpart));
     }
 
     SECTION("generated table has a separator row when switching to timezone 7 or more hours away from the previous one (e.g. between Petropavlovsk-Kamchatskiy and Yerevan") {
@@ -98,11 +102,11 @@ TEST_CASE("default table") {
         size_t separator_rows_count = 0;
         // skip first two rows (top-header and row without top-neighbor) and last two row (bottom-header and without bottom-neighbor)
         for (std::size_t row=2; row < table.height()-2; ++row) {
-            if (table.row(row).has_class("separator")) {
+            if (table.row(row).has_class(vp::css::separator)) {
                 REQUIRE(table.has_cell(row-1, 0));
                 REQUIRE(table.has_cell(row+1, 0));
-                const auto next_offset = utc_offset_string_to_seconds(table.at(row+1, 0).text);
-                const auto prev_offset = utc_offset_string_to_seconds(table.at(row-1,0).text);
+                const auto next_offset = utc_offset_string_to_seconds(std::string{table.at(row+1, 0).text()});
+                const auto prev_offset = utc_offset_string_to_seconds(std::string{table.at(row-1,0).text()});
                 REQUIRE(abs(next_offset - prev_offset) > max_delta);
                 ++separator_rows_count;
             }
@@ -111,27 +115,27 @@ TEST_CASE("default table") {
     }
 
     SECTION("generated table has &nbsp; as date separators") {
-        REQUIRE(table.at(0, 3).text == "August&nbsp;21");
+        REQUIRE(table.at(0, 3).text() == "August&nbsp;21");
     }
 
     SECTION("generated table contains titles for PAraNam details") {
-        REQUIRE_THAT(table.at(1, 5).title, Contains("06:22:42 (sunrise)…08:51:03 (1/5th of daytime)"));
+        REQUIRE_THAT(std::string{table.at(1, 5).title()}, Contains("06:22:42 (sunrise)…08:51:03 (1/5th of daytime)"));
     }
 
     SECTION("generated table contains titles with timezone name for cell with location name") {
-        REQUIRE_THAT(table.at(1, 2).title, Contains("Asia/Kolkata"));
+        REQUIRE_THAT(std::string{table.at(1, 2).title()}, Contains("Asia/Kolkata"));
     }
 
     SECTION("generated table contains links with details in cells with location name, vrata, pAraNam") {
-        REQUIRE_THAT(table.at(1, 2).text, Contains("<a href"));
+        REQUIRE_THAT(std::string{table.at(1, 2).text()}, Contains("<a href"));
     }
 
     auto find_row = [&table](const std::string & location_name) -> std::size_t {
         for (std::size_t row=1; row<table.height(); ++row) {
             CAPTURE(row);
             // skip empty row (e.g. separator between far-east and central Russia)
-            if (table.row(row).data.size() < 2) { continue; }
-            const auto text = table.at(row, 2).text;
+            if (table.row(row).size < 2) { continue; }
+            const auto text = table.at(row, 2).text();
             if (text.find(location_name) != std::string::npos) {
                 return row;
             }
@@ -141,21 +145,21 @@ TEST_CASE("default table") {
 
     SECTION("'title' attribute of Pāraṇam includes limit when paran_limit is set") {
         std::size_t row = find_row("Aktau");
-        REQUIRE_THAT(table.at(row, 5).title, Contains("absolute limit is 09:45:38 (dvādaśī end)"));
+        REQUIRE_THAT(std::string{table.at(row, 5).title()}, Contains("absolute limit is 09:45:38 (dvādaśī end)"));
     }
 
     SECTION("atirikā-dvādaśī is in separate cell from previous ekādaśī") {
         std::size_t row = find_row("Simferopol");
-        REQUIRE_THAT(table.at(row, 3).text, Contains("Pavitrā Ekādaśī"));
-        REQUIRE_THAT(table.at(row, 3).text, !Contains("Atiriktā Dvādaśī"));
-        REQUIRE_THAT(table.at(row, 4).text, Contains("Atiriktā Dvādaśī"));
-        REQUIRE_THAT(table.at(row, 4).text, !Contains("Pavitrā Ekādaśī"));
+        REQUIRE_THAT(std::string{table.at(row, 3).text()}, Contains("Pavitrā Ekādaśī"));
+        REQUIRE_THAT(std::string{table.at(row, 3).text()}, !Contains("Atiriktā Dvādaśī"));
+        REQUIRE_THAT(std::string{table.at(row, 4).text()}, Contains("Atiriktā Dvādaśī"));
+        REQUIRE_THAT(std::string{table.at(row, 4).text()}, !Contains("Pavitrā Ekādaśī"));
     }
 
     SECTION("css classes are properly set in table") {
         std::size_t row = find_row("Aktau");
-        REQUIRE_THAT(table.at(row, 4).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(row, 4).classes, Contains("vrata"));
+        REQUIRE(table.at(row, 4).has_class(vp::css::mainpart));
+        REQUIRE(table.at(row, 4).has_class(vp::css::vrata));
     }
 }
 
@@ -165,7 +169,7 @@ TEST_CASE("Table_Calendar_Generator returns reasonable table adds ' (DST)' for '
     int num_without_dst = 0;
     for (std::size_t row=0; row < table.height(); ++row) {
         if (!table.has_cell(row, 0)) { continue; }
-        auto text = table.at(row, 0).text;
+        auto text = table.at(row, 0).text();
         if (text.find("DST") != std::string::npos) {
             ++num_with_dst;
         } else {
@@ -182,7 +186,7 @@ TEST_CASE("generated table shows year for non-default-year dates when default ye
     std::vector<std::pair<size_t, size_t>> to_check{{0, 3}, {0, 4}, {0, 5}, {table.height()-1, 3}, {table.height()-1, 4}, {table.height()-1, 5}};
     for (const auto & pair : to_check) {
         CAPTURE(pair.first, pair.second);
-        REQUIRE_THAT(table.at(pair.first, pair.second).text, Contains("2019"));
+        REQUIRE_THAT(std::string{table.at(pair.first, pair.second).text()}, Contains("2019"));
     }
 }
 
@@ -196,30 +200,30 @@ TEST_CASE("Custom dates work OK") {
                 });
     SECTION("Generated table contains additional custom dates with given descriptions") {
         REQUIRE(table.width() == 10);
-        REQUIRE(table.at(1, 3).text == "custom1");
-        REQUIRE(table.at(1, 7).text == "custom2");
-        REQUIRE(table.at(1, 9).text == "");
+        REQUIRE(table.at(1, 3).text() == "custom1");
+        REQUIRE(table.at(1, 7).text() == "custom2");
+        REQUIRE(table.at(1, 9).text() == "");
     }
     SECTION("Custom date with non-empty desription is marked yellow (mainpart + custom CSS class)") {
-        REQUIRE_THAT(table.at(1, 3).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(1, 3).classes, Contains("custom"));
-        REQUIRE_THAT(table.at(1, 7).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(1, 7).classes, Contains("custom"));
+        REQUIRE(table.at(1, 3).has_class(vp::css::mainpart));
+        REQUIRE(table.at(1, 3).has_class(vp::css::custom));
+        REQUIRE(table.at(1, 7).has_class(vp::css::mainpart));
+        REQUIRE(table.at(1, 7).has_class(vp::css::custom));
     }
     SECTION("Custom date with empty description is NOT marked yellow ('mainpart', but not 'custom' CSS class)") {
-        REQUIRE_THAT(table.at(1, 9).classes, Contains("mainpart"));
-        REQUIRE_THAT(table.at(1, 9).classes, !Contains("custom"));
+        REQUIRE(table.at(1, 9).has_class(vp::css::mainpart));
+        REQUIRE_FALSE(table.at(1, 9).has_class(vp::css::custom));
     }
 }
 
 TEST_CASE("Generated table contains Vasanta-pañcamī and other dates from that pakṣa", "[wip]") {
     auto table = vp::Table_Calendar_Generator::generate(some_vratas(2021_y/2/10));
     REQUIRE(table.width() == 15); // 2 + 12 + one column for skipped date
-    REQUIRE(table.at(1, 3).text == "Vasanta-pañcamī");
-    REQUIRE(table.at(1, 6).text == "Ratha-saptamī");
-    REQUIRE(table.at(1, 7).text == "Bhīṣmāṣṭamī");
-    REQUIRE(table.at(1, 8).text == "Madhva-navamī (cāndra)");
-    REQUIRE(table.at(1, 14).text == "Pūrṇimā, Māgha-snāna-vrata ends");
+    REQUIRE(table.at(1, 3).text() == "Vasanta-pañcamī");
+    REQUIRE(table.at(1, 6).text() == "Ratha-saptamī");
+    REQUIRE(table.at(1, 7).text() == "Bhīṣmāṣṭamī");
+    REQUIRE(table.at(1, 8).text() == "Madhva-navamī (cāndra)");
+    REQUIRE(table.at(1, 14).text() == "Pūrṇimā, Māgha-snāna-vrata ends");
 }
 
 TEST_CASE("table for Vrata with multiple nameworthy dates on the same day lists all nameworthy dates in the same cell, separated by full stop.") {
@@ -231,7 +235,7 @@ TEST_CASE("table for Vrata with multiple nameworthy dates on the same day lists
         vratas.push_back(std::move(vrata));
     }
     const auto table = vp::Table_Calendar_Generator::generate(vratas);
-    REQUIRE_THAT(table.at(1, 5).text, Contains("event1. event2"));
+    REQUIRE_THAT(std::string{table.at(1, 5).text()}, Contains("event1. event2"));
 }
 
 TEST_CASE("table includes empty ('...') columns for skipped dates", "[wip]") {
@@ -244,6 +248,164 @@ TEST_CASE("table includes empty ('...') columns for skipped dates", "[wip]") {
         vratas.push_back(std::move(vrata));
     }
     const auto table = vp::Table_Calendar_Generator::generate(vratas);
-    REQUIRE_THAT(table.at(0, 5).text, Contains("..."));
-    REQUIRE_THAT(table.at(1, 6).text, Contains("separate event"));
+    REQUIRE_THAT(std::string{table.at(0, 5).text()}, Contains("..."));
+    REQUIRE_THAT(std::string{table.at(1, 6).text()}, Contains("separate event"));
+}
+
+namespace {
+std::string html(const vp::Table & table) {
+    fmt::memory_buffer buf;
+    vp::Html_Table_Writer{table}.write(buf);
+    return fmt::to_string(buf);
+}
+
+// Same vrata in several places, a day later in every other one, with a nameworthy date at the end of the pakṣa.
+std::vector<vp::Vrata> sample_vratas_of_one_paksha() {
+    std::vector<vp::Vrata> vratas;
+    for (int i = 0; i < 6; ++i) {
+        auto vrata = i % 3 == 2 ? vp::Vrata::SampleVrataWithHarivasara() : vp::Vrata::SampleVrata();
+        if (i % 2) {
+            vrata.date = vrata.date + date::days{1};
+        }
+        vrata.dates_for_this_paksha.emplace(date::local_days{2000_y/1/5}, vp::NamedDate{"Pūrṇimā", "", "custom"});
+        vratas.push_back(std::move(vrata));
+    }
+    return vratas;
+}
+} // anonymous namespace
+
+namespace {
+// Pakṣas a fortnight apart; the middle one has fewer dates, so fewer columns.
+std::vector<vp::VratasForDate> sample_pakshas() {
+    std::vector<vp::VratasForDate> pakshas(3);
+    for (int paksha = 0; paksha < 3; ++paksha) {
+        auto vratas = sample_vratas_of_one_paksha();
+        for (std::size_t i = 0; i < vratas.size(); ++i) {
+            auto & vrata = vratas[i];
+            vrata.date = vrata.date + date::days{15 * paksha};
+            if (paksha == 1) {
+                // the vratas which are not a day later, with no nameworthy dates
+                if (i % 2) continue;
+                vrata.dates_for_this_paksha.clear();
+            }
+            pakshas[static_cast<std::size_t>(paksha)].push_back(std::move(vrata));
+        }
+    }
+    return pakshas;
+}
+} // anonymous namespace
+
+TEST_CASE("Table_Calendar_Generator::generate_stacked() gives the same tables as generate() for each pakṣa") {
+    const auto pakshas = sample_pakshas();
+    const auto tables = vp::Table_Calendar_Generator::generate_stacked(pakshas, 2000_y);
+    REQUIRE(tables.size() == pakshas.size());
+    for (std::size_t i = 0; i < pakshas.size(); ++i) {
+        CAPTURE(i);
+        REQUIRE(html(tables[i]) == html(vp::Table_Calendar_Generator::generate(pakshas[i], 2000_y)));
+    }
+}
+
+TEST_CASE("Table_Calendar_Generator::generate_continuous() lays out all pakṣas in the same columns") {
+    const auto pakshas = sample_pakshas();
+    const auto table = vp::Table_Calendar_Generator::generate_continuous(pakshas, 2000_y);
+    const auto width = table.width();
+    REQUIRE(table.column_widths().size() == width);
+    std::size_t top_headers = 0;
+    for (std::size_t row = 0; row < table.height(); ++row) {
+        const auto cells = table.cells(row);
+        if (cells.begin() == cells.end()) continue; // separator
+        CAPTURE(row);
+        REQUIRE(static_cast<std::size_t>(cells.end() - cells.begin()) == width);
+        if (std::string_view{table.at(row, 0).text()} == "॥ श्रीः ॥") ++top_headers;
+    }
+    REQUIRE(top_headers == pakshas.size());
+    REQUIRE(std::string_view{table.at(table.height() - 1, 0).text()} == "॥ ॐ तत्सत् ॥");
+
+    // each pakṣa's rows are those of its own table, padded with empty cells;
+    // generate() closes every table, the continuous one only has the closing header at the end
+    REQUIRE(vp::Table_Calendar_Generator::generate(pakshas[1], 2000_y).width() < width);
+    std::size_t row = 0;
+    for (std::size_t i = 0; i < pakshas.size(); ++i) {
+        const auto own = vp::Table_Calendar_Generator::generate(pakshas[i], 2000_y);
+        const bool last = i + 1 == pakshas.size();
+        const auto own_height = last ? own.height() : own.height() - 1;
+        for (std::size_t own_row = 0; own_row < own_height; ++own_row, ++row) {
+            CAPTURE(i, own_row, row);
+            REQUIRE(row < table.height());
+            REQUIRE(table.row(row).classes == own.row(own_row).classes);
+            const auto own_cells = own.cells(own_row);
+            const auto own_length = static_cast<std::size_t>(own_cells.end() - own_cells.begin());
+            if (own_length == 0) {
+                REQUIRE(table.cells(row).begin() == table.cells(row).end());
+                continue;
+            }
+            for (std::size_t col = 0; col < width; ++col) {
+                CAPTURE(col);
+                const auto & cell = table.at(row, col);
+                if (col >= own_length) {
+                    REQUIRE(cell.text().empty());
+                    continue;
+                }
+                const auto & own_cell = own.at(own_row, col);
+                REQUIRE(cell.text() == own_cell.text());
+                REQUIRE(cell.title() == own_cell.title());
+                REQUIRE(cell.type == own_cell.type);
+                REQUIRE(cell.classes == own_cell.classes);
+                REQUIRE(cell.rowspan == own_cell.rowspan);
+                REQUIRE(cell.colspan == own_cell.colspan);
+            }
+        }
+    }
+    REQUIRE(row == table.height());
+}
+
+TEST_CASE("multi-pakṣa tables keep cells of locations which share a name apart") {
+    auto pakshas = sample_pakshas();
+    // same name and coordinates, another country and time zone
+    auto twin = **pakshas[0].begin();
+    twin.location.country = "Elsewhere";
+    twin.location.time_zone_name = "UTC";
+    twin.location.set_time_zone(vp::locate_time_zone("UTC"));
+    for (auto & vratas : pakshas) {
+        vratas.push_back(twin);
+    }
+    const auto tables = vp::Table_Calendar_Generator::generate_stacked(pakshas, 2000_y);
+    for (std::size_t i = 0; i < pakshas.size(); ++i) {
+        CAPTURE(i);
+        REQUIRE(html(tables[i]) == html(vp::Table_Calendar_Generator::generate(pakshas[i], 2000_y)));
+        REQUIRE_THAT(html(tables[i]), Contains("Elsewhere") && Contains("Timezone: UTC"));
+    }
+}
+
+TEST_CASE("Table_Calendar_Generator::generate_each() hands tables over in order of pakṣas") {
+    const auto pakshas = sample_pakshas();
+    std::vector<std::size_t> order;
+    std::vector<std::string> tables;
+    vp::Table_Calendar_Generator::generate_each(pakshas, [&](std::size_t i, vp::Table && table) {
+        order.push_back(i);
+        tables.push_back(html(table));
+    }, 2000_y, {}, 4);
+    REQUIRE(order == std::vector<std::size_t>{0, 1, 2});
+    for (std::size_t i = 0; i < pakshas.size(); ++i) {
+        REQUIRE(tables[i] == html(vp::Table_Calendar_Generator::generate(pakshas[i], 2000_y)));
+    }
+
+    // an exception thrown by the callback stops the rest and gets to the caller
+    std::size_t taken = 0;
+    REQUIRE_THROWS_AS(vp::Table_Calendar_Generator::generate_each(pakshas, [&](std::size_t, vp::Table &&) {
+        ++taken;
+        throw std::runtime_error{"write failed"};
+    }, 2000_y, {}, 4), std::runtime_error);
+    REQUIRE(taken == 1);
+}
+
+TEST_CASE("multi-pakṣa tables don't depend on the number of threads") {
+    const auto pakshas = sample_pakshas();
+    const auto continuous = html(vp::Table_Calendar_Generator::generate_continuous(pakshas, 2000_y, {}, 1));
+    REQUIRE(html(vp::Table_Calendar_Generator::generate_continuous(pakshas, 2000_y, {}, 4)) == continuous);
+    const auto stacked1 = vp::Table_Calendar_Generator::generate_stacked(pakshas, 2000_y, {}, 1);
+    const auto stacked4 = vp::Table_Calendar_Generator::generate_stacked(pakshas, 2000_y, {}, 4);
+    for (std::size_t i = 0; i < pakshas.size(); ++i) {
+        REQUIRE(html(stacked1[i]) == html(stacked4[i]));
+    }
 }
@@ -1,10 +1,11 @@
 #include "table.h"
 
 #include <algorithm>
+#include <stdexcept>
 
 size_t vp::Table::row_length(size_t row) const
 {
-    return rows[row].data.size();
+    return rows[row].size;
 }
 
 bool vp::Table::has_cell(std::size_t row, std::size_t col) const
@@ -20,9 +21,9 @@ std::size_t vp::Table::width() const
         rows.cbegin(),
         rows.cend(),
         [](const auto & l, const auto & r) {
-            return l.data.size() < r.data.size();
+            return l.size < r.size;
         }
-    )->data.size();
+    )->size;
 }
 
 std::size_t vp::Table::height() const
@@ -30,59 +31,102 @@ std::size_t vp::Table::height() const
     return rows.size();
 }
 
-vp::Table::Cell &vp::Table::do_add_cell(std::string text, std::string classes, CellType type, Mergeable mergeable) {
+vp::Table::Cell &vp::Table::do_add_cell(std::string_view text, Css_Classes classes, CellType type, Mergeable mergeable) {
     if (rows.empty()) { start_new_row(); }
     std::size_t row = height()-1;
     std::size_t col = row_length(row);
-    return rows.back().data.emplace_back(std::move(text), row, col, type, std::move(classes), mergeable);
+    // cells are only ever added to the last row, so they stay contiguous per row
+    auto & cell = cells_.emplace_back(*strings_, text, row, col, type, classes, mergeable);
+    ++rows.back().size;
+    return cell;
 }
 
-vp::Table::Cell &vp::Table::add_cell(std::string text, std::string classes)
+vp::Table::Cell &vp::Table::add_cell(std::string_view text, Css_Classes classes)
 {
-    return do_add_cell(std::move(text), std::move(classes), CellType::Normal, Mergeable::Yes);
+    return do_add_cell(text, classes, CellType::Normal, Mergeable::Yes);
 }
 
-vp::Table::Cell &vp::Table::add_unmergeable_cell(std::string text, std::string classes)
+vp::Table::Cell &vp::Table::add_unmergeable_cell(std::string_view text, Css_Classes classes)
 {
-    return do_add_cell(std::move(text), std::move(classes), CellType::Normal, Mergeable::No);
+    return do_add_cell(text, classes, CellType::Normal, Mergeable::No);
 }
 
-vp::Table::Cell &vp::Table::add_cell(std::string_view text, std::string classes)
+vp::Table::Cell &vp::Table::add_header_cell(std::string_view text, Css_Classes classes)
 {
-    return add_cell(std::string{text}, std::move(classes));
+    return do_add_cell(text, classes, CellType::Header, Mergeable::Yes);
 }
 
-vp::Table::Cell & vp::Table::add_cell(const char * const text, std::string classes) {
-    return add_cell(std::string{text}, std::move(classes));
+vp::Table::Cell &vp::Table::add_cell(std::string_view text, std::string_view classes)
+{
+    return add_cell(text, Css_Classes::parse(classes));
 }
 
-
-vp::Table::Cell &vp::Table::add_header_cell(std::string text, std::string classes)
+vp::Table::Cell &vp::Table::add_header_cell(std::string_view text, std::string_view classes)
 {
-    return do_add_cell(std::move(text), std::move(classes), CellType::Header, Mergeable::Yes);
+    return add_header_cell(text, Css_Classes::parse(classes));
 }
 
 vp::Table::Cell &vp::Table::at(std::size_t row, std::size_t col)
 {
-    return rows.at(row).data.at(col);
+    const auto & r = rows.at(row);
+    if (col >= r.size) throw std::out_of_range("vp::Table::at(): no such column");
+    return cells_[r.first_cell + col];
 }
 
 const vp::Table::Cell &vp::Table::at(std::size_t row, std::size_t col) const
 {
-    return rows.at(row).data.at(col);
+    const auto & r = rows.at(row);
+    if (col >= r.size) throw std::out_of_range("vp::Table::at(): no such column");
+    return cells_[r.first_cell + col];
 }
 
-void vp::Table::start_new_row(std::string classes)
+void vp::Table::start_new_row(Css_Classes classes)
 {
-    rows.emplace_back(std::move(classes));
+    rows.emplace_back(classes, cells_.size());
+}
+
+void vp::Table::append(const Table & other)
+{
+    for (std::size_t row = 0; row < other.height(); ++row) {
+        start_new_row(other.rows[row].classes);
+        for (const auto & other_cell : other.cells(row)) {
+            auto & cell = do_add_cell(other_cell.text(), other_cell.classes, other_cell.type, other_cell.mergeable);
+            if (!other_cell.title().empty()) cell.set_title(other_cell.title());
+            cell.rowspan = other_cell.rowspan;
+            cell.colspan = other_cell.colspan;
+        }
+    }
 }
 
 bool vp::Table::mergeable_cells(const vp::Table::Cell & c1, const vp::Table::Cell & c2) {
     if (c1.mergeable == Mergeable::No || c2.mergeable == Mergeable::No) return false;
     if (c1.type != c2.type) return false;
-    return c1.text == c2.text;
+    // texts are interned in the table's pool, so equal texts are the very same string
+    return c1.text().data() == c2.text().data();
 }
 
+namespace {
+
+// What merging needs to know of a cell, compactly, so that whole columns of
+// them can be laid out contiguously.
+struct Merge_Key {
+    enum class Kind : std::uint8_t { Missing, Unmergeable, Normal, Header };
+    const char * text = nullptr; // interned
+    Kind kind = Kind::Missing;
+
+    bool can_merge_with(const Merge_Key & other) const {
+        return kind >= Kind::Normal && kind == other.kind && text == other.text;
+    }
+};
+
+Merge_Key merge_key(const vp::Table::Cell & cell) {
+    using Kind = Merge_Key::Kind;
+    if (cell.mergeable == vp::Table::Mergeable::No) return Merge_Key{nullptr, Kind::Unmergeable};
+    return Merge_Key{cell.text().data(), cell.type == vp::Table::CellType::Header ? Kind::Header : Kind::Normal};
+}
+
+} // anonymous namespace
+
 // make sure we add spans as evenly as possible
 void vp::Table::add_row_span(Cell & cell, std::size_t overall_span_size) {
     constexpr std::size_t max_span_size = 12;
@@ -100,25 +144,36 @@ void vp::Table::add_row_span(Cell & cell, std::size_t overall_span_size) {
 
         // merge-to-top all cell runs except the first one
         if (row != cell.row) {
-            curr_cell.add_classes("merge-to-top");
+            curr_cell.add_classes(css::merge_to_top);
         }
         // merge-to-bottom all cell runs except the last one
         if (row + section_size < first_row_after_span) {
-            curr_cell.add_classes("merge-to-bottom");
+            curr_cell.add_classes(css::merge_to_bottom);
         }
     }
 }
 
 void vp::Table::merge_cells_into_rowspans()
 {
-    if (height() < 2) return;
-    std::size_t our_width = width();
-    for (size_t col=0; col < our_width; ++col) {
+    const auto our_height = height();
+    if (our_height < 2) return;
+    const auto our_width = width();
+    // Column-major copy of the keys: walking down a column then reads
+    // consecutive keys instead of striding over whole rows of cells.
+    std::vector<Merge_Key> keys(our_width * our_height);
+    for (std::size_t row = 0; row < our_height; ++row) {
+        const auto & r = rows[row];
+        for (std::size_t col = 0; col < r.size; ++col) {
+            keys[col * our_height + row] = merge_key(cells_[r.first_cell + col]);
+        }
+    }
+    for (std::size_t col = 0; col < our_width; ++col) {
+        const auto * column = keys.data() + col * our_height;
         std::size_t span_size = 1;
-        for (size_t row=height()-1; row > 0; --row) {
-            if (!has_cell(row, col)) continue;
-            auto & cell = at(row, col);
-            if (has_cell(row-1, col) && mergeable_cells(cell, at(row-1, col))) {
+        for (std::size_t row = our_height-1; row > 0; --row) {
+            if (column[row].kind == Merge_Key::Kind::Missing) continue;
+            auto & cell = cells_[rows[row].first_cell + col];
+            if (column[row].can_merge_with(column[row-1])) {
                 ++span_size;
                 cell.rowspan = 0;
             } else {
@@ -126,8 +181,8 @@ void vp::Table::merge_cells_into_rowspans()
                 span_size = 1;
             }
         }
-        if (has_cell(0, col)) {
-            add_row_span(at(0, col), span_size);
+        if (column[0].kind != Merge_Key::Kind::Missing) {
+            add_row_span(cells_[rows[0].first_cell + col], span_size);
         }
     }
 }
@@ -138,13 +193,14 @@ void vp::Table::add_col_span(Cell & cell, std::size_t span_size) {
 
 void vp::Table::merge_cells_into_colspans()
 {
-    for (std::size_t row = 0; row < height(); ++row) {
-        auto our_row_length = row_length(row);
-        if (our_row_length < 2) continue;
+    for (const auto & r : rows) {
+        if (r.size < 2) continue;
+        // cells of a row are contiguous already
+        auto * row_cells = cells_.data() + r.first_cell;
         std::size_t span_size = 1;
-        for (std::size_t col = our_row_length-1; col > 0; --col) {
-            auto & cell = at(row, col);
-            if (mergeable_cells(cell, at(row, col-1))) {
+        for (std::size_t col = r.size-1; col > 0; --col) {
+            auto & cell = row_cells[col];
+            if (mergeable_cells(cell, row_cells[col-1])) {
                 ++span_size;
                 cell.colspan = 0;
             } else {
@@ -152,7 +208,7 @@ void vp::Table::merge_cells_into_colspans()
                 span_size = 1;
             }
         }
-        add_col_span(at(row, 0), span_size);
+        add_col_span(row_cells[0], span_size);
     }
 }
 
@@ -174,11 +230,11 @@ void vp::Table::add_even_odd_classes_for_col(size_t col, StartFrom start_from)
         if (!has_cell(row,col)) { continue; }
         auto & cell = at(row, col);
         // do not switch between odd/even for multiple runs of rowspanning cell with the same text
-        if (prev_cell && prev_cell->text != cell.text) {
+        if (prev_cell && prev_cell->text() != cell.text()) {
             odd = !odd;
         }
         if (cell.rowspan >= 1) {
-            cell.add_classes(odd ? "odd" : "even");
+            cell.add_classes(odd ? css::odd : css::even);
         }
         prev_cell = &cell;
     }
@@ -189,11 +245,18 @@ const vp::Table::Row & vp::Table::row(size_t row_num) const
     return rows.at(row_num);
 }
 
+vp::Table::Cells vp::Table::cells(std::size_t row_num) const
+{
+    const auto & r = rows.at(row_num);
+    const auto * first = cells_.data() + r.first_cell;
+    return Cells{first, first + r.size};
+}
+
 void vp::Table::iterate(vp::Table::CallBack &it) const
 {
-    for (auto & row : rows) {
-        it.row_begin(row.classes);
-        for (auto & cell : row.data) {
+    for (std::size_t row_num = 0; row_num < height(); ++row_num) {
+        it.row_begin(rows[row_num].classes);
+        for (auto & cell : cells(row_num)) {
             if (cell.rowspan == 0 || cell.colspan == 0) continue;
             if (cell.type == CellType::Header) {
                 it.header_cell(cell);
@@ -226,26 +289,8 @@ bool vp::Table::Iterator::operator!=(const vp::Table::Iterator &other)
     return (row != other.row || col != other.col);
 }
 
-void vp::Table::Cell::add_classes(std::string new_classes) {
-    if (classes.empty()) {
-        classes = std::move(new_classes);
-    } else {
-        classes += " ";
-        classes += std::move(new_classes);
-    }
-}
-
-vp::Table::Cell &vp::Table::Cell::set_title(std::string new_title)
+vp::Table::Cell &vp::Table::Cell::set_title(std::string_view new_title)
 {
-    title = new_title;
+    title_ = strings_->intern(new_title);
     return *this;
 }
-
-bool vp::Table::Cell::has_class(const char *class_to_look_for) const
-{
-    return classes.find(class_to_look_for) != std::string::npos;
-}
-
-bool vp::Table::Row::has_class(std::string some_class) const {
-    return classes.find(some_class) != std::string::npos;
-}
@@ -1,12 +1,23 @@
 #ifndef VP_TABLE_H
 #define VP_TABLE_H
 
+#include "css-classes.h"
+#include "string-pool.h"
+
 #include <cstdint>
-#include <string>
+#include <memory>
+#include <string_view>
 #include <vector>
 
 namespace vp {
 
+/*
+ * Cell texts and titles are interned in the table's String_Pool, CSS classes
+ * of cells and rows are bitsets (see css-classes.h), and cells of all rows are
+ * stored in a single vector, so building a table allocates per distinct
+ * string rather than per cell. As texts are interned, merging cells compares
+ * them by identity. Cell references are invalidated by adding more cells.
+ */
 class Table
 {
 public:
@@ -14,41 +25,62 @@ public:
     enum class Mergeable : int8_t { No, Yes };
     enum class StartFrom : int8_t { Odd, Even };
     struct Cell {
-        std::string text;
         CellType type;
-        std::string classes;
-        std::string title;
+        Css_Classes classes;
         std::size_t row = 0;
         std::size_t col = 0;
         std::size_t rowspan = 1;
         std::size_t colspan = 1;
         Mergeable mergeable;
-        Cell(std::string _text, std::size_t _row, std::size_t _col, CellType _type=CellType::Normal, std::string _classes="", Mergeable _mergeable=Mergeable::Yes) :
-              text(_text), type(_type), classes(_classes), row{_row}, col{_col}, mergeable{_mergeable} {}
-        void add_classes(std::string new_classes);
-        Cell & set_title(std::string new_title);
-        bool has_class(const char *class_to_look_for) const;
+        Cell(String_Pool & strings, std::string_view _text, std::size_t _row, std::size_t _col, CellType _type=CellType::Normal, Css_Classes _classes={}, Mergeable _mergeable=Mergeable::Yes) :
+              type(_type), classes(_classes), row{_row}, col{_col}, mergeable{_mergeable}, text_(strings.intern(_text)), strings_(&strings) {}
+        // Read-only: texts and titles are interned in the table's pool, and merging compares texts by identity.
+        std::string_view text() const { return text_; }
+        std::string_view title() const { return title_; }
+        void add_classes(Css_Classes new_classes) { classes |= new_classes; }
+        Cell & set_title(std::string_view new_title);
+        bool has_class(Css_Class c) const { return classes.has(c); }
+    private:
+        std::string_view text_;
+        std::string_view title_;
+        String_Pool * strings_; // the table's
     };
     struct Row {
-        std::vector<Cell> data;
-        std::string classes;
-        Row(std::string classes_=""):classes(classes_){}
-        bool has_class(std::string some_class) const;
+        Css_Classes classes;
+        std::size_t first_cell; // index of the row's first cell in cells_
+        std::size_t size = 0;
+        Row(Css_Classes classes_, std::size_t first_cell_):classes(classes_), first_cell(first_cell_){}
+        bool has_class(Css_Class c) const { return classes.has(c); }
+    };
+    struct Cells {
+        const Cell * first;
+        const Cell * last;
+        const Cell * begin() const { return first; }
+        const Cell * end() const { return last; }
     };
 
+    Table() = default;
+    Table(Table &&) = default;
+    Table & operator=(Table &&) = default;
+    Table(const Table &) = delete;
+    Table & operator=(const Table &) = delete;
+
 private:
+    // unique_ptr: cells point to it, so it must stay put when the table is moved
+    std::unique_ptr<String_Pool> strings_ = std::make_unique<String_Pool>();
+    std::vector<Cell> cells_;
     std::vector<Row> rows;
     std::vector<double> col_widths_;
     template<typename Callable>
     void iterate_over_col(std::size_t col, Callable callable) {
         for (std::size_t row=0; row < height(); ++row) {
-            if (rows[row].data.size() >= col) {
-                callable(row, rows[row].data[col]);
+            if (rows[row].size >= col) {
+                callable(row, at(row, col));
             }
         }
     }
     std::size_t row_length(std::size_t row) const;
-    Cell & do_add_cell(std::string text, std::string classes, CellType type, Mergeable mergeable);
+    Cell & do_add_cell(std::string_view text, Css_Classes classes, CellType type, Mergeable mergeable);
     static bool mergeable_cells(const vp::Table::Cell &c1, const vp::Table::Cell &c2);
     void add_row_span(Cell &cell, std::size_t span_size);
     void add_col_span(Cell &cell, std::size_t span_size);
@@ -65,25 +97,30 @@ public:
     };
     std::size_t width() const;
     std::size_t height() const;
-    Cell & add_cell(std::string text, std::string classes="");
-    Cell & add_unmergeable_cell(std::string text, std::string classes="");
-    Cell & add_cell(std::string_view text, std::string classes="");
-    Cell & add_cell(const char * const text, std::string classes="");
-    Cell & add_header_cell(std::string text, std::string classes="");
+    Cell & add_cell(std::string_view text, Css_Classes classes={});
+    Cell & add_unmergeable_cell(std::string_view text, Css_Classes classes={});
+    Cell & add_header_cell(std::string_view text, Css_Classes classes={});
+    // classes as space-separated names
+    Cell & add_cell(std::string_view text, std::string_view classes);
+    Cell & add_header_cell(std::string_view text, std::string_view classes);
     Cell & at(size_t row, size_t col);
     const Cell & at(size_t row, size_t col) const;
-    void start_new_row(std::string classes="");
+    void start_new_row(Css_Classes classes={});
+    // Appends other's rows below, spans and classes as they are; texts get interned in this table's pool.
+    void append(const Table & other);
     void merge_cells_into_rowspans();
     void merge_cells_into_colspans();
     void set_column_widths(std::vector<double> _col_widths);
     const std::vector<double> & column_widths() const;
     void add_even_odd_classes_for_col(std::size_t col, StartFrom start_from = StartFrom::Odd);
     const Row & row(std::size_t row_num) const;
+    Cells cells(std::size_t row_num) const;
+    std::size_t interned_string_count() const { return strings_->size(); }
     bool has_cell(std::size_t row, std::size_t col) const;
 
     struct CallBack {
         virtual ~CallBack() = default;
-        virtual void row_begin(std::string_view classes="") = 0;
+        virtual void row_begin(Css_Classes classes) = 0;
         virtual void row_end() = 0;
         virtual void cell(const Cell & cell) = 0;
         virtual void header_cell(const Cell & cell) = 0;
@@ -1,11 +1,30 @@
 #include "text-interface.h"
 
+#include "almanac.h"
+#include "batch-calc.h"
 #include "calc.h"
+#include "daybyday-record.h"
+#include "disk-cache.h"
+#include "event-catalog.h"
+#include "html-table-writer.h"
+#include "ics-writer.h"
+#include "json-writer.h"
 #include "nameworthy-dates.h"
+#include "table-calendar-generator.h"
+#include "tz-database.h"
+#include "vrata-boundary.h"
+#include "vrata-export.h"
+#include "vrata-grid.h"
+#include "vrata-json.h"
+#include "vrata-record.h"
 #include "vrata_detail_printer.h"
+#include "year-calendar.h"
 
 #include <charconv>
+#include <chrono>
 #include <cstring>
+#include <fstream>
+#include <map>
 
 using namespace vp;
 
@@ -33,8 +52,8 @@ date::year_month_day parse_ymd(const std::string_view s) {
     return date::year{year}/date::month{month}/date::day{day};
 }
 
-const std::vector<Location> &LocationDb::locations() {
-    static std::vector<Location> locations_ {
+Location_Table &LocationDb::locations() {
+    static Location_Table locations_{std::vector<Location>{
         { udupi_coord },                    // 13.3408_N,  74.7517_E, UTC+05:30 India (Asia/Kolkata)
         { kalkuta_coord },                  // 22.5333_N,  88.3667_E, UTC+05:30 India (Asia/Kolkata)
         { manali_coord },                   // 32.2667_N,  77.1667_E, UTC+05:30 India (Asia/Kolkata)
@@ -168,22 +187,40 @@ const std::vector<Location> &LocationDb::locations() {
 //        { mundelein_coord },                // 42.2667_N,  88.0000_W, UTC-06/05 USA (America/Chicago)
 //        { edmonton_coord },                 // 53.5333_N, 113.5000_W, UTC-07/06 Canada (America/Edmonton)
 //        { sanfrantsisko_coord },            // 37.7667_N, 122.4000_W, UTC-08/07 USA (America/Los_Angeles)
-    };
+    }};
     return locations_;
 }
 
+std::uint64_t LocationDb::fingerprint() {
+    return locations().fingerprint();
+}
+
+void LocationDb::locate_time_zones() {
+    for (const auto & location : locations()) {
+        location.time_zone();
+    }
+}
+
 std::optional<Location> LocationDb::find_coord(const char *location_name) {
-    auto found = std::find_if(
-        std::begin(locations()),
-        std::end(locations()),
-        [=](const auto & named_coord){
-            return named_coord.name == location_name;
-        }
-    );
-    if (found == std::end(locations())) return std::nullopt;
+    const auto found = locations().find(location_name);
+    if (!found) return std::nullopt;
     return *found;
 }
 
+std::optional<Location> LocationDb::find_nearest(Coord coord) {
+    const auto found = locations().nearest(coord);
+    if (!found) return std::nullopt;
+    return *found;
+}
+
+void LocationDb::load(const fs::path & path) {
+    auto table = Location_Table::load_csv(path);
+    if (table.empty()) {
+        throw std::runtime_error(fmt::format("no locations in '{}'", path.string()));
+    }
+    locations() = std::move(table);
+}
+
 namespace {
 // try decreasing latitude until we get all necessary sunrises/sunsets
 tl::expected<vp::Vrata, vp::CalcError> decrease_latitude_and_find_vrata(date::local_days base_date, const Location & location) {
@@ -212,43 +249,8 @@ bool try_calc_all(date::local_days base_date, vp::VratasForDate & vratas, CalcFl
     return vratas.all_from_same_ekadashi();
 }
 
-struct CalcSettings {
-    date::local_days date;
-    vp::CalcFlags flags;
-};
-
-bool operator==(const CalcSettings & left, const CalcSettings & right);
-
-namespace {
-constexpr std::size_t hash_combine(std::size_t hash1, std::size_t hash2) {
-    return hash1 ^ (hash2 + 0x9e3779b9 + (hash1<<6) + (hash1>>2));
-}
-}
-
-struct MyHash {
-    std::size_t operator()(const CalcSettings & key) const {
-        const auto count = key.date.time_since_epoch().count();
-        using type=std::remove_cv_t<decltype(count)>;
-        auto hash_date = std::hash<type>{}(count);
-        using FlagsT = std::underlying_type_t<vp::CalcFlags>;
-        auto hash_flags = std::hash<FlagsT>{}(static_cast<FlagsT>(key.flags));
-        return hash_combine(hash_date, hash_flags);
-    }
-};
-
-std::unordered_map<CalcSettings, vp::VratasForDate, MyHash> cache;
-
-bool operator==(const CalcSettings & left, const CalcSettings & right)
-{
-    return (left.date == right.date) && (left.flags == right.flags);
-}
-
 vp::VratasForDate calc_all(date::local_days base_date, CalcFlags flags)
 {
-    const auto key = CalcSettings{base_date, flags};
-    if (auto found = cache.find(key); found != cache.end()) {
-        return found->second;
-    }
     vp::VratasForDate vratas;
 
     if (!try_calc_all(base_date, vratas, flags)) {
@@ -256,7 +258,6 @@ vp::VratasForDate calc_all(date::local_days base_date, CalcFlags flags)
         date::local_days adjusted_base_date = base_date - date::days{1};
         try_calc_all(adjusted_base_date, vratas, flags);
     }
-    cache[key] = vratas;
     return vratas;
 }
 
@@ -288,21 +289,239 @@ vp::MaybeVrata calc_one(date::local_days base_date, const Location & location, C
     return vrata;
 }
 
-vp::VratasForDate calc(date::year_month_day base_date, std::string location_name, CalcFlags flags)
+namespace {
+std::unique_ptr<Disk_Cache> & disk_cache() {
+    static std::unique_ptr<Disk_Cache> cache;
+    return cache;
+}
+
+std::string read_whole_file(const fs::path & path) {
+    std::ifstream f{path, std::ios::binary};
+    return std::string{std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{}};
+}
+
+// Results depend on ephemeris files and tzdata besides the inputs themselves,
+// so on-disk entries must be invalidated when any of those change.
+std::uint64_t data_files_fingerprint() {
+    std::vector<fs::path> eph_files;
+    std::error_code ec;
+    for (fs::directory_iterator it{"eph", ec}, end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() == ".se1") {
+            eph_files.push_back(it->path());
+        }
+    }
+    std::sort(eph_files.begin(), eph_files.end());
+    std::uint64_t hash = fnv1a_64("eph");
+    for (const auto & path : eph_files) {
+        hash = fnv1a_64(path.filename().string(), hash);
+        hash = fnv1a_64(read_whole_file(path), hash);
+    }
+    return fnv1a_64(read_whole_file(fs::path{"tzdata"} / "version"), hash);
+}
+
+std::string disk_cache_key(std::string_view kind, std::uint32_t record_version, date::local_days date, CalcFlags flags, std::uint64_t location_set) {
+    static const std::uint64_t data_files = data_files_fingerprint();
+    return fmt::format("{}-v{}|{}|{}|{:016x}|{}|{:016x}",
+                       kind, record_version,
+                       date.time_since_epoch().count(),
+                       static_cast<std::underlying_type_t<CalcFlags>>(flags),
+                       location_set, version(), data_files);
+}
+
+// value is calculated with calc() and stored on disk if it wasn't there yet
+template<typename Read, typename Write, typename Compute>
+auto disk_cached(const std::string & key, Read read, Write write, Compute calc) -> decltype(calc()) {
+    if (!disk_cache()) return calc();
+    if (auto data = disk_cache()->load(key)) {
+        try {
+            Record_Reader r{*data};
+            auto value = read(r);
+            if (r.at_end()) return value;
+        } catch (const std::exception &) {
+            // shouldn't happen with the right versions in the key, but recalculating is always safe
+        }
+    }
+    auto value = calc();
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    write(w, value);
+    disk_cache()->store(key, std::string_view{buf.data(), buf.size()});
+    return value;
+}
+} // anonymous namespace
+
+void enable_disk_cache(const fs::path & dir, std::uintmax_t max_bytes)
+{
+    disk_cache() = std::make_unique<Disk_Cache>(dir, max_bytes);
+}
+
+namespace {
+std::unique_ptr<Almanac> & almanac() {
+    static std::unique_ptr<Almanac> almanac_;
+    return almanac_;
+}
+
+// Everything almanac and event catalog contents depend on besides the inputs, same as for the disk cache.
+std::uint64_t precomputed_build_id() {
+    static const std::uint64_t build_id = fnv1a_64(fmt::format("{}|v{}|{:016x}", version(), vrata_record_version, data_files_fingerprint()));
+    return build_id;
+}
+} // anonymous namespace
+
+void enable_almanac(const fs::path & path)
+{
+    auto opened = std::make_unique<Almanac>(path);
+    if (opened->build_id() != precomputed_build_id()) {
+        throw std::runtime_error(fmt::format("almanac '{}' was built by another program version or with other ephemeris or tzdata, rebuild it", path.string()));
+    }
+    almanac() = std::move(opened);
+}
+
+void enable_event_catalog(const fs::path & path)
 {
+    auto opened = std::make_unique<const Event_Catalog>(path);
+    if (opened->build_id() != precomputed_build_id()) {
+        throw std::runtime_error(fmt::format("event catalog '{}' was built by another program version or with other ephemeris or tzdata, rebuild it", path.string()));
+    }
+    set_event_catalog(std::move(opened));
+}
+
+namespace {
+// Cached calc() results. location_set is LocationDb::fingerprint() for "all"
+// or fingerprint of the single location otherwise.
+struct Result_Cache_Key {
+    date::local_days date;
+    vp::CalcFlags flags;
+    std::uint64_t location_set;
+};
+
+bool operator==(const Result_Cache_Key & left, const Result_Cache_Key & right)
+{
+    return left.date == right.date && left.flags == right.flags && left.location_set == right.location_set;
+}
+
+constexpr std::size_t hash_combine(std::size_t hash1, std::size_t hash2) {
+    return hash1 ^ (hash2 + 0x9e3779b9 + (hash1<<6) + (hash1>>2));
+}
+
+struct Result_Cache_Key_Hash {
+    std::size_t operator()(const Result_Cache_Key & key) const {
+        const auto count = key.date.time_since_epoch().count();
+        using type=std::remove_cv_t<decltype(count)>;
+        auto hash_date = std::hash<type>{}(count);
+        using FlagsT = std::underlying_type_t<vp::CalcFlags>;
+        auto hash_flags = std::hash<FlagsT>{}(static_cast<FlagsT>(key.flags));
+        auto hash_location_set = std::hash<std::uint64_t>{}(key.location_set);
+        return hash_combine(hash_combine(hash_date, hash_flags), hash_location_set);
+    }
+};
+
+std::size_t approximate_memory_usage(const vp::VratasForDate & vratas) {
+    std::size_t bytes = sizeof(vratas) + vratas.size() * sizeof(vp::MaybeVrata);
+    for (const auto & vrata : vratas) {
+        if (!vrata) continue;
+        for (const auto & [date, named_date] : vrata->dates_for_this_paksha) {
+            // map node overhead is roughly four pointers
+            bytes += sizeof(date) + sizeof(named_date) + 4 * sizeof(void *)
+                    + named_date.name.capacity() + named_date.title.capacity() + named_date.css_classes.capacity();
+        }
+    }
+    return bytes;
+}
+
+constexpr std::size_t default_result_cache_budget = 32 * 1024 * 1024;
+
+using Result_Cache = Sharded_Lru_Cache<Result_Cache_Key, vp::VratasForDate, Result_Cache_Key_Hash>;
+
+Result_Cache & result_cache() {
+    static Result_Cache cache{default_result_cache_budget, approximate_memory_usage};
+    return cache;
+}
+
+vp::VratasForDate calc_uncached(date::local_days base_date, const std::optional<Location> & location, CalcFlags flags) {
     vp::VratasForDate vratas;
+    if (!location) {
+        vratas = calc_all(base_date, flags);
+    } else {
+        vratas.push_back(calc_one(base_date, *location, flags));
+    }
+    add_nameworthy_dates_for_this_paksha(vratas, flags);
+    return vratas;
+}
+
+// Same as calc_uncached(), but only if the almanac has all the answers.
+std::optional<vp::VratasForDate> calc_from_almanac(date::local_days base_date, const std::optional<Location> & location, CalcFlags flags) {
+    if (!almanac() || almanac()->flags() != flags) return std::nullopt;
+    auto find_all = [&](date::local_days date) -> std::optional<vp::VratasForDate> {
+        vp::VratasForDate vratas;
+        for (const auto & l : LocationDb()) {
+            auto vrata = almanac()->find(date, l, flags);
+            if (!vrata) return std::nullopt;
+            vratas.push_back(std::move(*vrata));
+        }
+        return vratas;
+    };
+    try {
+        if (location) {
+            auto vrata = almanac()->find(base_date, *location, flags);
+            if (!vrata) return std::nullopt;
+            vp::VratasForDate vratas;
+            vratas.push_back(std::move(*vrata));
+            return vratas;
+        }
+        // same retry as in calc_all()
+        auto vratas = find_all(base_date);
+        if (vratas && !vratas->all_from_same_ekadashi()) {
+            vratas = find_all(base_date - date::days{1});
+        }
+        return vratas;
+    } catch (const std::exception &) {
+        // damaged almanac: calculating is always safe
+        return std::nullopt;
+    }
+}
+} // anonymous namespace
+
+std::shared_ptr<const vp::VratasForDate> calc_shared(date::year_month_day base_date, const std::string & location_name, CalcFlags flags)
+{
+    std::optional<Location> location;
+    std::uint64_t location_set;
     if (location_name == "all") {
-        vratas = calc_all(date::local_days{base_date}, flags);
+        location_set = LocationDb::fingerprint();
     } else {
-        auto location = LocationDb::find_coord(location_name.c_str());
+        location = LocationDb::find_coord(location_name.c_str());
         if (!location) {
-            vratas.push_back(tl::make_unexpected(CantFindLocation{std::move(location_name)}));
-        } else {
-            vratas.push_back(calc_one(date::local_days{base_date}, *location, flags));
+            auto vratas = std::make_shared<vp::VratasForDate>();
+            vratas->push_back(tl::make_unexpected(CantFindLocation{location_name}));
+            return vratas;
         }
+        location_set = vp::fingerprint(*location);
     }
-    add_nameworthy_dates_for_this_paksha(vratas, flags);
-    return vratas;
+    const auto key = Result_Cache_Key{date::local_days{base_date}, flags, location_set};
+    return result_cache().get_or_compute(key, [&]() {
+        if (auto vratas = calc_from_almanac(key.date, location, flags)) {
+            return std::move(*vratas);
+        }
+        return disk_cached(
+            disk_cache_key("vratas", vrata_record_version, key.date, flags, location_set),
+            read_vratas, write_vratas,
+            [&]() { return calc_uncached(key.date, location, flags); });
+    });
+}
+
+vp::VratasForDate calc(date::year_month_day base_date, std::string location_name, CalcFlags flags)
+{
+    return *calc_shared(base_date, location_name, flags);
+}
+
+Lru_Cache_Stats result_cache_stats()
+{
+    return result_cache().stats();
+}
+
+void set_result_cache_budget(std::size_t bytes)
+{
+    result_cache().set_memory_budget(bytes);
 }
 
 namespace {
@@ -361,18 +580,18 @@ void daybyday_print_header(date::year_month_day base_date, const Location & coor
             const auto tithi_until = date::make_zoned(tz, info.tithi_until->round_to_minute());
             auto tithi_until_date{date::floor<date::days>(tithi_until.get_local_time())};
             fmt::format_to(out,
-                           FMT_STRING("{} until {}{}\n"),
+                           FMT_STRING("{} until {:%H:%M}{}\n"),
                            info.tithi,
-                           date::format("%H:%M", tithi_until),
+                           tithi_until.get_local_time(),
                            tithi_until_date == sunrise_date ? "" : " next day");
         }
         if (info.tithi2_until) {
             const auto tithi2_until = date::make_zoned(tz, info.tithi2_until->round_to_minute());
             auto tithi2_until_date{date::floor<date::days>(tithi2_until.get_local_time())};
             fmt::format_to(out,
-                           FMT_STRING("{} until {}{}\n"),
+                           FMT_STRING("{} until {:%H:%M}{}\n"),
                            info.tithi2,
-                           date::format("%H:%M", tithi2_until),
+                           tithi2_until.get_local_time(),
                            tithi2_until_date == sunrise_date ? "" : " next day");
         }
 
@@ -380,30 +599,69 @@ void daybyday_print_header(date::year_month_day base_date, const Location & coor
             const auto until = date::make_zoned(tz, info.nakshatra_until->round_to_minute());
             const auto date = date::floor<date::days>(until.get_local_time());
             fmt::format_to(out,
-                           FMT_STRING("{} until {}{}\n"),
+                           FMT_STRING("{} until {:%H:%M}{}\n"),
                            info.nakshatra,
-                           date::format("%H:%M", until),
+                           until.get_local_time(),
                            date == sunrise_date ? "" : " next day");
         }
         if (info.nakshatra2_until) {
             const auto until = date::make_zoned(tz, info.nakshatra2_until->round_to_minute());
             const auto date = date::floor<date::days>(until.get_local_time());
             fmt::format_to(out,
-                           FMT_STRING("{} until {}{}\n"),
+                           FMT_STRING("{} until {:%H:%M}{}\n"),
                            info.nakshatra2,
-                           date::format("%H:%M", until),
+                           until.get_local_time(),
                            date == sunrise_date ? "" : " next day");
         }
     }
 }
 
-void daybyday_add_tithi_events(vp::JulDays_UT from, vp::JulDays_UT to, const vp::Calc & calc, DayByDayInfo & info) {
+/*
+ * Boundaries already found for previous days of a day-by-day range (-d FROM..TO).
+ * Search windows of neighbouring days overlap by more than a day, so most
+ * tithi/nakshatra starts and masa ends of the next day are already known.
+ */
+struct Daybyday_Reuse {
+    // Search for the start of tithi/nakshatra N from search_start found `found`.
+    // So for any later search start up to `found`, the answer is still `found`.
+    struct Found {
+        JulDays_UT search_start;
+        JulDays_UT found;
+    };
+    std::map<double, Found> tithis;
+    std::map<double, Found> nakshatras;
+
+    struct Masa_Until {
+        JulDays_UT from; // time masa was calculated for
+        JulDays_UT until;
+    };
+    std::optional<std::pair<Masa_Until, Chandra_Masa>> chandra_masa;
+    std::optional<std::pair<Masa_Until, Saura_Masa>> saura_masa;
+};
+
+template<typename Find>
+JulDays_UT reuse_or_find(Daybyday_Reuse * reuse, std::map<double, Daybyday_Reuse::Found> Daybyday_Reuse::* memo, double key, JulDays_UT search_start, Find find) {
+    if (!reuse) return find();
+    auto & found_by_key = (*reuse).*memo;
+    if (auto found = found_by_key.find(key); found != found_by_key.end()) {
+        if (found->second.search_start <= search_start && search_start <= found->second.found) {
+            return found->second.found;
+        }
+    }
+    const auto found = find();
+    found_by_key.insert_or_assign(key, Daybyday_Reuse::Found{search_start, found});
+    return found;
+}
+
+void daybyday_add_tithi_events(vp::JulDays_UT from, vp::JulDays_UT to, const vp::Calc & calc, DayByDayInfo & info, Daybyday_Reuse * reuse) {
     const auto min_tithi = calc.swe.tithi(from).floor();
     const auto max_tithi = calc.swe.tithi(to).ceil() + 1.0;
     auto start = from - std::chrono::hours{36};
     // need "!=" to handle cross-amavasya cases correctly, when max_tithi is less than min_tithi
     for (vp::Tithi tithi = min_tithi; tithi != max_tithi; tithi += 1.0) {
-        auto tithi_start = calc.find_exact_tithi_start(start, tithi);
+        auto tithi_start = reuse_or_find(reuse, &Daybyday_Reuse::tithis, tithi.tithi, start, [&]() {
+            return calc.find_exact_tithi_start(start, tithi);
+        });
         if (tithi_start >= info.sunrise1) {
             if (info.tithi == vp::DiscreteTithi::Unknown()) {
                 // -1.0 because local "tithi" variable holds the next tithi,
@@ -453,12 +711,14 @@ void daybyday_add_tithi_events(vp::JulDays_UT from, vp::JulDays_UT to, const vp:
     }
 }
 
-void daybyday_add_nakshatra_events(vp::JulDays_UT from, vp::JulDays_UT to, const vp::Calc & calc, DayByDayInfo & info) {
+void daybyday_add_nakshatra_events(vp::JulDays_UT from, vp::JulDays_UT to, const vp::Calc & calc, DayByDayInfo & info, Daybyday_Reuse * reuse) {
     const auto min_nakshatra = calc.swe.nakshatra(from).floor();
     const auto max_nakshatra = calc.swe.nakshatra(to).ceil() + 1.0;
     auto start = from - std::chrono::hours{36}; // to ensure we get beginning of first nakshatra
     for (vp::Nakshatra n = min_nakshatra; n != max_nakshatra; ++n) {
-        auto nakshatra_start = calc.find_nakshatra_start(start, n);
+        auto nakshatra_start = reuse_or_find(reuse, &Daybyday_Reuse::nakshatras, n.nakshatra, start, [&]() {
+            return calc.find_nakshatra_start(start, n);
+        });
         if (nakshatra_start >= info.sunrise1) {
             if (info.nakshatra == DiscreteNakshatra::Unknown()) {
                 info.nakshatra = DiscreteNakshatra{n - 1.0}; // we mark the end of the previous nakshatra
@@ -515,7 +775,7 @@ daybyday_add_moonrise_moonset_events(vp::JulDays_UT from, vp::JulDays_UT to, con
 }
 
 
-DayByDayInfo daybyday_events(date::year_month_day base_date, const vp::Calc & calc) {
+DayByDayInfo daybyday_events(date::year_month_day base_date, const vp::Calc & calc, Daybyday_Reuse * reuse) {
     DayByDayInfo info;
     const auto local_astronomical_midnight = calc.calc_astronomical_midnight(date::local_days{base_date});
     const auto sunrise = calc.swe.next_sunrise(local_astronomical_midnight);
@@ -565,8 +825,8 @@ DayByDayInfo daybyday_events(date::year_month_day base_date, const vp::Calc & ca
                 info.events.push_back(NamedTimePoint{"next sunrise", *sunrise2});
                 const auto earliest_timepoint = arunodaya ? * arunodaya : *sunrise;
                 const auto latest_timepoint = *sunrise2;
-                daybyday_add_tithi_events(earliest_timepoint, latest_timepoint, calc, info);
-                daybyday_add_nakshatra_events(earliest_timepoint, latest_timepoint, calc, info);
+                daybyday_add_tithi_events(earliest_timepoint, latest_timepoint, calc, info, reuse);
+                daybyday_add_nakshatra_events(earliest_timepoint, latest_timepoint, calc, info, reuse);
                 daybyday_add_moonrise_moonset_events(earliest_timepoint, latest_timepoint, calc, info);
             }
         }
@@ -587,21 +847,30 @@ void add_to_sorted(NamedTimePoints & points, NamedTimePoint point) {
         point);
 }
 
-void daybyday_add_sauramasa_info(DayByDayInfo & info, const vp::Calc & calc) {
+void daybyday_add_sauramasa_info(DayByDayInfo & info, const vp::Calc & calc, Daybyday_Reuse * reuse) {
     if (info.events.empty()) {
         return;
     }
 
+    const auto initial_time = info.events[0].time_point;
+    const auto last_time = info.events.back().time_point;
+    const auto [initial_masa, next_masa_start] = [&]() {
+        if (reuse && reuse->saura_masa && reuse->saura_masa->first.from <= initial_time && initial_time < reuse->saura_masa->first.until) {
+            return std::make_pair(reuse->saura_masa->second, reuse->saura_masa->first.until);
+        }
+        const auto masa = calc.saura_masa(initial_time);
+        const auto until = calc.find_sankranti(initial_time, masa + 1);
+        if (reuse) {
+            reuse->saura_masa = std::make_pair(Daybyday_Reuse::Masa_Until{initial_time, until}, masa);
+        }
+        return std::make_pair(masa, until);
+    }();
+
     if (info.sunrise1) {
         info.saura_masa = calc.saura_masa(*info.sunrise1);
     }
 
-    const auto initial_time = info.events[0].time_point;
-    const auto initial_masa = calc.saura_masa(initial_time);
-    const auto last_time = info.events.back().time_point;
-
     const auto next_masa = initial_masa + 1;
-    const auto next_masa_start = calc.find_sankranti(initial_time, next_masa);
     info.saura_masa_until = next_masa_start;
     if (next_masa_start <= last_time) {
         auto event_name = fmt::format(FMT_STRING("{} sankranti"), next_masa);
@@ -609,33 +878,58 @@ void daybyday_add_sauramasa_info(DayByDayInfo & info, const vp::Calc & calc) {
     }
 }
 
-void daybyday_add_chandramasa_info(DayByDayInfo & info, const vp::Calc & calc) {
+void daybyday_add_chandramasa_info(DayByDayInfo & info, const vp::Calc & calc, Daybyday_Reuse * reuse) {
     if (!info.sunrise1.has_value()) {
         return;
     }
     const auto initial_time = *info.sunrise1;
+    if (reuse && reuse->chandra_masa && reuse->chandra_masa->first.from <= initial_time && initial_time < reuse->chandra_masa->first.until) {
+        info.chandra_masa = reuse->chandra_masa->second;
+        info.chandra_masa_until = reuse->chandra_masa->first.until;
+        return;
+    }
     info.chandra_masa = calc.chandra_masa_amanta(initial_time, &info.chandra_masa_until);
+    if (reuse && info.chandra_masa_until) {
+        reuse->chandra_masa = std::make_pair(Daybyday_Reuse::Masa_Until{initial_time, *info.chandra_masa_until}, info.chandra_masa);
+    }
 }
-} // anonymous namespace
 
-DayByDayInfo daybyday_calc_one(date::year_month_day base_date, const Location & coord, CalcFlags flags)
+// reuse is nullptr for a single day, or shared between consecutive days of a range.
+DayByDayInfo daybyday_calc_uncached(date::year_month_day base_date, const Location & coord, CalcFlags flags, Daybyday_Reuse * reuse = nullptr)
 {
     Calc calc{Swe{coord, flags}};
-    DayByDayInfo info = daybyday_events(base_date, calc);
+    DayByDayInfo info = daybyday_events(base_date, calc, reuse);
     info.location = coord;
     info.date = base_date;
     std::stable_sort(info.events.begin(), info.events.end(), NamedPointComparator);
-    daybyday_add_sauramasa_info(info, calc);
-    daybyday_add_chandramasa_info(info, calc);
+    daybyday_add_sauramasa_info(info, calc, reuse);
+    daybyday_add_chandramasa_info(info, calc, reuse);
     return info;
 }
+} // anonymous namespace
 
-namespace {
-/* print day-by-day report (-d mode) for a single date and single location */
-void daybyday_print_one(date::year_month_day base_date, const Location & coord, const fmt::appender & out, vp::CalcFlags flags) {
-    auto info = daybyday_calc_one(base_date, coord, flags);
+DayByDayInfo daybyday_calc_one(date::year_month_day base_date, const Location & coord, CalcFlags flags)
+{
+    return disk_cached(
+        disk_cache_key("daybyday", daybyday_record_version, date::local_days{base_date}, flags, vp::fingerprint(coord)),
+        read_daybyday, write_daybyday,
+        [&]() { return daybyday_calc_uncached(base_date, coord, flags); });
+}
 
-    daybyday_print_header(base_date, coord, info, out);
+std::vector<DayByDayInfo> daybyday_calc_range(date::year_month_day from, date::year_month_day to, const Location & coord, CalcFlags flags)
+{
+    // Not using disk cache here: reused boundaries can differ from the ones
+    // found by a fresh single-day search within the search precision.
+    std::vector<DayByDayInfo> infos;
+    Daybyday_Reuse reuse;
+    for (auto day = date::local_days{from}; day <= date::local_days{to}; day += date::days{1}) {
+        infos.push_back(daybyday_calc_uncached(date::year_month_day{day}, coord, flags, &reuse));
+    }
+    return infos;
+}
+
+void daybyday_print_info(const DayByDayInfo & info, const Location & coord, const fmt::appender & out) {
+    daybyday_print_header(info.date, coord, info, out);
 
     for (const auto & e : info.events) {
         // add separator before sunrises to mark current day better
@@ -645,6 +939,12 @@ void daybyday_print_one(date::year_month_day base_date, const Location & coord,
         fmt::format_to(out, "{} {}\n", vp::JulDays_Zoned{coord.time_zone(), e.time_point}, e.name);
     }
 }
+
+namespace {
+/* print day-by-day report (-d mode) for a single date and single location */
+void daybyday_print_one(date::year_month_day base_date, const Location & coord, const fmt::appender & out, vp::CalcFlags flags) {
+    daybyday_print_info(daybyday_calc_one(base_date, coord, flags), coord, out);
+}
 }
 
 void daybyday_print_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out, vp::CalcFlags flags) {
@@ -656,6 +956,20 @@ void daybyday_print_one(date::year_month_day base_date, const char * location_na
     daybyday_print_one(base_date, *coord, out, flags);
 }
 
+void daybyday_print_range(date::year_month_day from, date::year_month_day to, const char * location_name, const fmt::appender & out, vp::CalcFlags flags) {
+    const std::optional<Location> coord = LocationDb::find_coord(location_name);
+    if (!coord) {
+        fmt::format_to(out, "Location not found: '{}'\n", location_name);
+        return;
+    }
+    bool first = true;
+    for (const auto & info : daybyday_calc_range(from, to, *coord, flags)) {
+        if (!first) fmt::format_to(out, "\n");
+        first = false;
+        daybyday_print_info(info, *coord, out);
+    }
+}
+
 void calc_and_report_all(date::year_month_day d) {
     for (auto &l : LocationDb()) {
         fmt::memory_buffer buf;
@@ -664,6 +978,434 @@ void calc_and_report_all(date::year_month_day d) {
     }
 }
 
+void batch_calc_and_report(date::year_month_day from, date::year_month_day to, const char * location_name, unsigned workers, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out) {
+    Batch_Request request;
+    request.from = date::local_days{from};
+    request.to = date::local_days{to};
+    request.workers = workers;
+    if (std::strcmp(location_name, "all") == 0) {
+        request.locations.assign(LocationDb().begin(), LocationDb().end());
+    } else {
+        const auto location = LocationDb::find_coord(location_name);
+        if (!location) {
+            out(fmt::format("Location not found: '{}'\n", location_name));
+            return;
+        }
+        request.locations.push_back(*location);
+    }
+
+    fmt::memory_buffer buf;
+    const auto result = batch_calc(request, [&](Batch_Entry && entry) {
+        const auto & location = request.locations[entry.location_index];
+        buf.clear();
+        if (entry.vrata) {
+            fmt::format_to(fmt::appender{buf}, FMT_STRING("{}: {}\n"), location.name, *entry.vrata);
+        } else {
+            fmt::format_to(fmt::appender{buf}, FMT_STRING("{}: error: {}\n"), location.name, entry.vrata.error());
+        }
+        out(std::string_view{buf.data(), buf.size()});
+    });
+    for (const auto & failure : result.failures) {
+        buf.clear();
+        fmt::format_to(fmt::appender{buf}, FMT_STRING("{}: failed to calculate {}..{}: {}\n"),
+                       request.locations[failure.location_index].name,
+                       date::year_month_day{failure.from},
+                       date::year_month_day{failure.to},
+                       failure.reason);
+        out(std::string_view{buf.data(), buf.size()});
+    }
+
+    std::size_t total_vratas = 0;
+    for (const auto & worker : result.workers) {
+        const auto & p = worker.process;
+        fmt::format_to(summary_out,
+                       FMT_STRING("worker {} (pid {}): {} shards ({} failed), {} vratas in {:.2f}s, {:.1f} vratas/s, {}\n"),
+                       p.worker, p.pid, p.tasks, p.failed_tasks, worker.vratas, p.seconds,
+                       p.seconds > 0 ? static_cast<double>(worker.vratas) / p.seconds : 0.0,
+                       p.exit_status);
+        total_vratas += worker.vratas;
+    }
+    fmt::format_to(summary_out,
+                   FMT_STRING("total: {} vratas, {} failed shards in {:.2f}s, {:.1f} vratas/s\n"),
+                   total_vratas, result.failures.size(), result.seconds,
+                   result.seconds > 0 ? static_cast<double>(total_vratas) / result.seconds : 0.0);
+}
+
+void export_vratas(date::year_month_day base_date, const std::string & location_name, Record_Exporter & exporter) {
+    for (const auto & vrata : *calc_shared(base_date, location_name)) {
+        exporter.write(vrata);
+    }
+}
+
+void export_daybyday_range(date::year_month_day from, date::year_month_day to, const char * location_name, Record_Exporter & exporter) {
+    const std::optional<Location> coord = LocationDb::find_coord(location_name);
+    if (!coord) {
+        throw std::runtime_error(fmt::format("Location not found: '{}'", location_name));
+    }
+    if (from == to) {
+        exporter.write(daybyday_calc_one(from, *coord, CalcFlags::Default));
+        return;
+    }
+    for (const auto & info : daybyday_calc_range(from, to, *coord, CalcFlags::Default)) {
+        exporter.write(info);
+    }
+}
+
+void export_batch(date::year_month_day from, date::year_month_day to, const char * location_name, unsigned workers, Record_Exporter & exporter, const fmt::appender & summary_out) {
+    Batch_Request request;
+    request.from = date::local_days{from};
+    request.to = date::local_days{to};
+    request.workers = workers;
+    if (std::strcmp(location_name, "all") == 0) {
+        request.locations.assign(LocationDb().begin(), LocationDb().end());
+    } else {
+        const auto location = LocationDb::find_coord(location_name);
+        if (!location) {
+            throw std::runtime_error(fmt::format("Location not found: '{}'", location_name));
+        }
+        request.locations.push_back(*location);
+    }
+    std::size_t vratas = 0;
+    const auto result = batch_calc(request, [&](Batch_Entry && entry) {
+        exporter.write(entry.vrata);
+        ++vratas;
+    });
+    for (const auto & failure : result.failures) {
+        fmt::format_to(summary_out, FMT_STRING("{}: failed to calculate {}..{}: {}\n"),
+                       request.locations[failure.location_index].name,
+                       date::year_month_day{failure.from},
+                       date::year_month_day{failure.to},
+                       failure.reason);
+    }
+    fmt::format_to(summary_out, FMT_STRING("total: {} vratas, {} failed shards in {:.2f}s\n"),
+                   vratas, result.failures.size(), result.seconds);
+}
+
+void export_ics(const char * location_name, date::year from_year, date::year to_year, unsigned workers, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out) {
+    const auto location = LocationDb::find_coord(location_name);
+    if (!location) {
+        throw std::runtime_error(fmt::format("Location not found: '{}'", location_name));
+    }
+    Batch_Request request;
+    request.from = date::local_days{from_year / date::January / 1};
+    request.to = date::local_days{(to_year + date::years{1}) / date::January / 1};
+    request.locations.push_back(*location);
+    request.workers = workers;
+    // one year per task: small enough to keep all workers busy, large enough for the search state to pay off
+    request.shard_length = date::days{366};
+
+    Ics_Writer writer{fmt::format(FMT_STRING("Ekādaśī, {}"), location->name), out};
+    std::size_t vratas = 0;
+    const auto result = batch_calc(request, [&](Batch_Entry && entry) {
+        if (entry.vrata) {
+            writer.write(*entry.vrata);
+            ++vratas;
+        } else {
+            fmt::format_to(summary_out, FMT_STRING("{}: error: {}\n"), location->name, entry.vrata.error());
+        }
+    });
+    writer.finish();
+    for (const auto & failure : result.failures) {
+        fmt::format_to(summary_out, FMT_STRING("{}: failed to calculate {}..{}: {}\n"),
+                       location->name, date::year_month_day{failure.from}, date::year_month_day{failure.to}, failure.reason);
+    }
+    fmt::format_to(summary_out, FMT_STRING("{} vratas in {:.2f}s\n"), vratas, result.seconds);
+}
+
+void export_grid(const Grid_Request & request, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out) {
+    fmt::memory_buffer buf;
+    constexpr std::string_view header = "latitude,longitude,time_zone,date,type,paran_start,error\n";
+    buf.append(header.data(), header.data() + header.size());
+    const auto result = calc_grid(request, [&](Grid_Cell && cell) {
+        fmt::format_to(fmt::appender{buf}, FMT_STRING("{},{},"), cell.center.latitude, cell.center.longitude);
+        if (cell.vrata) {
+            const auto & vrata = *cell.vrata;
+            fmt::format_to(fmt::appender{buf}, FMT_STRING("{},"), vrata.location.time_zone_name);
+            format_iso_date(buf, vrata.date);
+            fmt::format_to(fmt::appender{buf}, FMT_STRING(",{},"), vrata.type);
+            if (vrata.paran.paran_start) {
+                format_iso_local_time(buf, vrata.location.time_zone(), *vrata.paran.paran_start);
+            }
+            buf.push_back(',');
+            buf.push_back('\n');
+        } else {
+            // errors may have commas and quotes in them
+            auto error = fmt::format(FMT_STRING("{}"), cell.vrata.error());
+            for (std::size_t pos = 0; (pos = error.find('"', pos)) != std::string::npos; pos += 2) {
+                error.insert(pos, 1, '"');
+            }
+            fmt::format_to(fmt::appender{buf}, FMT_STRING("{},,,,\"{}\"\n"), nautical_time_zone_name(cell.center.longitude), error);
+        }
+        if (buf.size() >= 64 * 1024) {
+            out(std::string_view{buf.data(), buf.size()});
+            buf.clear();
+        }
+    });
+    out(std::string_view{buf.data(), buf.size()});
+    for (const auto & failure : result.failures) {
+        fmt::format_to(summary_out, FMT_STRING("failed: {}\n"), failure);
+    }
+    fmt::format_to(summary_out, FMT_STRING("{}x{} cells, {} errors, {} failed rows in {:.2f}s\n"),
+                   result.rows, result.columns, result.errors, result.failures.size(), result.seconds);
+}
+
+namespace {
+
+void write_boundary_side(Json_Writer & w, std::string_view side, const Vrata_Key & key) {
+    w.key(fmt::format("{}_date", side));
+    if (key.ok) {
+        w.raw_string([&](fmt::memory_buffer & out) { format_iso_date(out, key.date); });
+    } else {
+        w.null();
+    }
+    w.key(fmt::format("{}_type", side));
+    if (key.ok) {
+        w.formatted_value("{}", key.type);
+    } else {
+        w.null();
+    }
+}
+
+void write_position(Json_Writer & w, Coord coord) {
+    // GeoJSON positions are [longitude, latitude]
+    w.begin_array().value(coord.longitude.longitude).value(coord.latitude.latitude).end_array();
+}
+
+} // anonymous namespace
+
+void export_boundaries(const Boundary_Request & request, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out) {
+    const auto result = find_vrata_boundaries(request);
+    fmt::memory_buffer buf;
+    Json_Writer w{buf};
+    w.begin_object().key("type").value("FeatureCollection").key("features").begin_array();
+    for (const auto & polyline : result.polylines) {
+        w.begin_object().key("type").value("Feature");
+        w.key("geometry").begin_object();
+        if (polyline.points.size() == 1) {
+            w.key("type").value("Point").key("coordinates");
+            write_position(w, polyline.points.front());
+        } else {
+            w.key("type").value("LineString").key("coordinates").begin_array();
+            for (const auto & point : polyline.points) {
+                write_position(w, point);
+            }
+            w.end_array();
+        }
+        w.end_object();
+        w.key("properties").begin_object();
+        write_boundary_side(w, "before", polyline.before);
+        write_boundary_side(w, "after", polyline.after);
+        w.end_object();
+        w.end_object();
+    }
+    w.end_array().end_object();
+    buf.push_back('\n');
+    out(std::string_view{buf.data(), buf.size()});
+    for (const auto & failure : result.failures) {
+        fmt::format_to(summary_out, FMT_STRING("failed: {}\n"), failure);
+    }
+    fmt::format_to(summary_out, FMT_STRING("{} frontiers, {} probes, {} failed scan lines in {:.2f}s\n"),
+                   result.polylines.size(), result.probes, result.failures.size(), result.seconds);
+}
+
+void build_almanac(const fs::path & path, date::year from_year, date::year to_year, unsigned workers, const fmt::appender & summary_out) {
+    Batch_Request request;
+    request.from = date::local_days{from_year / date::January / 1};
+    request.to = date::local_days{(to_year + date::years{1}) / date::January / 1};
+    request.locations.assign(LocationDb().begin(), LocationDb().end());
+    request.workers = workers;
+    request.shard_length = date::days{366};
+
+    Almanac_Writer writer{path, precomputed_build_id(), request.flags, request.from, request.to};
+    std::size_t errors = 0;
+    const auto result = batch_calc(request, [&](Batch_Entry && entry) {
+        if (entry.vrata) {
+            writer.add(request.locations[entry.location_index], entry.search_from, *entry.vrata);
+        } else {
+            // not stored: such dates are simply calculated live
+            fmt::format_to(summary_out, FMT_STRING("{}: error: {}\n"), request.locations[entry.location_index].name, entry.vrata.error());
+            ++errors;
+        }
+    });
+    writer.finish();
+    for (const auto & failure : result.failures) {
+        fmt::format_to(summary_out, FMT_STRING("{}: failed to calculate {}..{}: {}\n"),
+                       request.locations[failure.location_index].name,
+                       date::year_month_day{failure.from},
+                       date::year_month_day{failure.to},
+                       failure.reason);
+    }
+    fmt::format_to(summary_out, FMT_STRING("{}: {} vratas for {} locations, {} errors, {} failed shards in {:.2f}s\n"),
+                   path.string(), writer.entry_count(), request.locations.size(), errors, result.failures.size(), result.seconds);
+}
+
+void build_event_catalog(const fs::path & path, date::year from_year, date::year to_year, unsigned workers, const fmt::appender & summary_out) {
+    const auto started = std::chrono::steady_clock::now();
+    auto data = calc_event_catalog(from_year, to_year, CalcFlags::Default, workers);
+    data.build_id = precomputed_build_id();
+    write_event_catalog(path, data);
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    fmt::format_to(summary_out, FMT_STRING("{}: {} tithis, {} nakshatras, {} sankrantis in {:.2f}s\n"),
+                   path.string(),
+                   data.series[static_cast<std::size_t>(Event_Series::Tithi)].times.size(),
+                   data.series[static_cast<std::size_t>(Event_Series::Nakshatra)].times.size(),
+                   data.series[static_cast<std::size_t>(Event_Series::Sankranti)].times.size(),
+                   seconds);
+}
+
+void enable_tz_database(const fs::path & path)
+{
+    auto opened = std::make_unique<const Tz_Database>(path);
+    // text tzdata is what the database is checked against; without it there's nothing to compare with
+    if (const auto tzdata_version = fs::path{"tzdata"} / "version"; fs::is_regular_file(tzdata_version)) {
+        const auto text = read_whole_file(tzdata_version);
+        const auto expected = std::string_view{text}.substr(0, text.find_first_of("\r\n"));
+        if (opened->version() != expected) {
+            throw std::runtime_error(fmt::format("tz database '{}' was compiled from tzdata {}, but tzdata is {}; rebuild it", path.string(), opened->version(), expected));
+        }
+    }
+    set_tz_database(std::move(opened));
+}
+
+void build_tz_database(const fs::path & path, const fmt::appender & summary_out) {
+    const auto started = std::chrono::steady_clock::now();
+    const auto data = compile_tz_database();
+    write_tz_database(path, data);
+    std::size_t transitions = 0;
+    for (const auto & zone : data.zones) {
+        transitions += zone.begins().size();
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    fmt::format_to(summary_out, FMT_STRING("{}: tzdata {}, {} zones, {} links, {} transitions in {:.2f}s\n"),
+                   path.string(), data.version, data.zones.size(), data.links.size(), transitions, seconds);
+}
+
+bool verify_almanac(const fs::path & path, std::size_t samples, const fmt::appender & out) {
+    const Almanac stored{path};
+    bool ok = true;
+    if (stored.build_id() != precomputed_build_id()) {
+        fmt::format_to(out, "almanac was built by another program version or with other ephemeris or tzdata\n");
+        ok = false;
+    }
+    try {
+        stored.verify_checksums();
+    } catch (const std::exception & e) {
+        fmt::format_to(out, "{}\n", e.what());
+        return false;
+    }
+
+    std::unordered_map<std::uint64_t, Location> locations;
+    for (const auto & location : LocationDb()) {
+        locations.emplace(vp::fingerprint(location), location);
+    }
+    auto encode = [](const vp::MaybeVrata & vrata) {
+        fmt::memory_buffer buf;
+        Record_Writer w{buf};
+        write_vrata(w, vrata);
+        return fmt::to_string(buf);
+    };
+    const auto count = stored.entry_count();
+    samples = static_cast<std::size_t>(std::min<std::uint64_t>(samples, count));
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < samples; ++i) {
+        // spread evenly over the file, so that all locations get checked
+        const auto entry = stored.entry(count / samples * i);
+        const auto location = locations.find(entry.location_fingerprint);
+        if (location == locations.end()) {
+            fmt::format_to(out, FMT_STRING("{}: location is not in the built-in list anymore\n"), entry.vrata.location.name);
+            ++mismatches;
+            continue;
+        }
+        auto live = calc_one(entry.search_from, location->second, stored.flags());
+        if (live) {
+            live->dates_for_this_paksha = nameworthy_dates_for_this_paksha(*live, stored.flags());
+        }
+        if (encode(live) == encode(entry.vrata)) continue;
+        ++mismatches;
+        fmt::format_to(out, FMT_STRING("{} from {}: almanac has {}, calculated "), location->second.name, date::year_month_day{entry.search_from}, entry.vrata);
+        if (live) {
+            fmt::format_to(out, FMT_STRING("{}\n"), *live);
+        } else {
+            fmt::format_to(out, FMT_STRING("error: {}\n"), live.error());
+        }
+    }
+    fmt::format_to(out, FMT_STRING("{} vratas for {} locations in {}..{}, checksums OK, {} of {} samples differ\n"),
+                   count, stored.location_count(),
+                   date::year_month_day{stored.from()}, date::year_month_day{stored.to() - date::days{1}},
+                   mismatches, samples);
+    return ok && mismatches == 0;
+}
+
+namespace {
+// The way yearly calendars used to be made: one calc(date, "all") per ekādaśī,
+// each with its own base date guess. Returns number of runs.
+std::size_t calc_year_per_paksha(date::year year, CalcFlags flags) {
+    const date::local_days end{(year + date::years{1}) / date::January / 1};
+    std::size_t runs = 0;
+    for (date::local_days base_date{year / date::January / 1}; base_date < end;) {
+        const auto vratas = calc_uncached(base_date, std::nullopt, flags);
+        ++runs;
+        const auto min_date = vratas.min_date();
+        if (!min_date || *min_date >= end) break;
+        base_date = vratas.guess_start_date_for_next_ekadashi(base_date);
+    }
+    return runs;
+}
+} // anonymous namespace
+
+void year_calc_and_report(date::year year, Year_Layout layout, unsigned workers, bool compare_with_per_paksha_runs, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out) {
+    Year_Request request;
+    request.year = year;
+    request.locations.assign(LocationDb().begin(), LocationDb().end());
+    request.workers = workers;
+
+    const auto calendar = calc_year(request);
+
+    if (layout == Year_Layout::Combined) {
+        VratasForDate all;
+        for (const auto & vratas : calendar.pakshas) {
+            for (const auto & vrata : vratas) {
+                all.push_back(vrata);
+            }
+        }
+        Html_Table_Writer{Table_Calendar_Generator::generate(all, year)}.write(out);
+    } else if (layout == Year_Layout::Continuous) {
+        Html_Table_Writer{Table_Calendar_Generator::generate_continuous(calendar.pakshas, year)}.write(out);
+    } else {
+        // each table is written as soon as it and all the ones before it are ready
+        Table_Calendar_Generator::generate_each(calendar.pakshas, [&](std::size_t i, vp::Table && table) {
+            const auto & first = *calendar.pakshas[i].begin();
+            out(fmt::format(FMT_STRING("<h2>{} {} {}</h2>\n"), first->masa, first->paksha, first->ekadashi_name()));
+            Html_Table_Writer{table}.write(out);
+        }, year);
+    }
+
+    std::size_t total_vratas = 0;
+    for (const auto & vratas : calendar.pakshas) {
+        total_vratas += vratas.size();
+    }
+    for (const auto & entry : calendar.errors) {
+        fmt::format_to(summary_out, FMT_STRING("{}: error: {}\n"), request.locations[entry.location_index].name, entry.vrata.error());
+    }
+    for (const auto & failure : calendar.failures) {
+        fmt::format_to(summary_out, FMT_STRING("{}: failed: {}\n"), request.locations[failure.location_index].name, failure.reason);
+    }
+    fmt::format_to(summary_out,
+                   FMT_STRING("{}: {} ekadashis, {} vratas for {} locations in {:.2f}s using {} worker processes\n"),
+                   static_cast<int>(year), calendar.pakshas.size(), total_vratas, request.locations.size(), calendar.seconds, calendar.workers.size());
+
+    if (compare_with_per_paksha_runs) {
+        // Run after calc_year(): its workers are forked, so this (parent) process
+        // still starts with cold caches, same as separate cold runs would.
+        const auto started = std::chrono::steady_clock::now();
+        const auto runs = calc_year_per_paksha(year, request.flags);
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        fmt::format_to(summary_out,
+                       FMT_STRING("{}: {} separate calc(date, \"all\") runs took {:.2f}s, {:.1f}x slower\n"),
+                       static_cast<int>(year), runs, seconds, calendar.seconds > 0 ? seconds / calendar.seconds : 0.0);
+    }
+}
+
 namespace detail {
     fs::path determine_exe_dir(const char* argv0) {
         return fs::absolute(fs::path{argv0}).parent_path();
@@ -696,7 +1438,6 @@ void change_to_data_dir(const char* argv0)
     fs::current_path(working_dir);
 }
 
-namespace {
 std::string version()
 {
 #ifdef VP_VERSION
@@ -705,7 +1446,6 @@ std::string version()
     return std::string{"unknown"};
 #endif
 }
-}
 
 std::string program_name_and_version()
 {
@@ -3,16 +3,26 @@
 
 #include "calc-flags.h"
 #include "location.h"
+#include "location-table.h"
+#include "lru-cache.h"
 #include "nakshatra.h"
 #include "tz-fixed.h"
 #include "vrata.h"
 
 #include <chrono>
+#include <functional>
 #include "filesystem-fixed.h"
+#include <memory>
 #include <optional>
 #include <tl/expected.hpp>
 #include <unordered_map>
 
+namespace vp {
+class Record_Exporter;
+struct Grid_Request;
+struct Boundary_Request;
+}
+
 namespace vp::text_ui {
 
 enum class TrackIntervalChange {
@@ -72,21 +82,96 @@ tl::expected<vp::Vrata, vp::CalcError> calc_and_report_one(date::year_month_day
 tl::expected<vp::Vrata, vp::CalcError> find_calc_and_report_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out);
 
 DayByDayInfo daybyday_calc_one(date::year_month_day base_date, const Location & coord, vp::CalcFlags flags);
+void daybyday_print_info(const DayByDayInfo & info, const Location & coord, const fmt::appender & out);
 void daybyday_print_one(date::year_month_day base_date, const char * location_name, const fmt::appender & out, vp::CalcFlags flags);
+// Consecutive days from..to (inclusive). Tithi and nakṣatra starts and masa ends
+// shared by neighbouring days are searched for only once.
+std::vector<DayByDayInfo> daybyday_calc_range(date::year_month_day from, date::year_month_day to, const Location & coord, vp::CalcFlags flags);
+void daybyday_print_range(date::year_month_day from, date::year_month_day to, const char * location_name, const fmt::appender & out, vp::CalcFlags flags);
 void calc_and_report_all(date::year_month_day d);
+// Calculate all vratas in [from, to) using `workers` processes, for the named location or for all of them (location_name == "all").
+// Vratas go to out line by line as calculation goes, per-worker throughput summary goes to summary_out.
+void batch_calc_and_report(date::year_month_day from, date::year_month_day to, const char * location_name, unsigned workers, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out);
+enum class Year_Layout {
+    Per_Paksha, // one table per ekādaśī
+    Combined,   // single table for the whole year
+    Continuous, // single table with a header per ekādaśī and the same columns throughout
+};
+// Calculate all vratas of the year for all locations using `workers` processes, stream HTML table(s) to out
+// in chunks as they get rendered (see html-table-writer.h). Timing summary goes to summary_out.
+// When compare_with_per_paksha_runs is set, also time the old way of doing it
+// (one uncached calc(date, "all") per ekādaśī) for reference.
+void year_calc_and_report(date::year year, Year_Layout layout, unsigned workers, bool compare_with_per_paksha_runs, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out);
+// Machine-readable counterparts of the above (see vrata-export.h).
+// location_name can be "all" for export_vratas() and export_batch().
+void export_vratas(date::year_month_day base_date, const std::string & location_name, Record_Exporter & exporter);
+void export_daybyday_range(date::year_month_day from, date::year_month_day to, const char * location_name, Record_Exporter & exporter);
+void export_batch(date::year_month_day from, date::year_month_day to, const char * location_name, unsigned workers, Record_Exporter & exporter, const fmt::appender & summary_out);
+// iCalendar with all vratas in [from_year, to_year] for the named location (see ics-writer.h),
+// streamed to out piece by piece as calculation goes. Errors and timing go to summary_out.
+void export_ics(const char * location_name, date::year from_year, date::year to_year, unsigned workers, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out);
+// CSV map of the next vrata after the request's base date over a lat/long grid (see vrata-grid.h):
+// one line per cell with its center, time zone, vrata date, type and paranam start,
+// streamed to out as rows get ready. Timing goes to summary_out.
+void export_grid(const Grid_Request & request, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out);
+// GeoJSON FeatureCollection of frontiers where the next vrata after the request's base date
+// changes (see vrata-boundary.h): one LineString per frontier, with dates and types of the
+// vratas on both sides in its properties. Timing and probe count go to summary_out.
+void export_boundaries(const Boundary_Request & request, const std::function<void(std::string_view)> & out, const fmt::appender & summary_out);
 vp::MaybeVrata calc_one(date::local_days base_date, const Location & location, CalcFlags flags = CalcFlags::Default);
 vp::VratasForDate calc(date::year_month_day base_date, std::string location_name, CalcFlags flags = CalcFlags::Default);
+// Same as calc(), but returns shared immutable result straight from the result cache, without copying.
+std::shared_ptr<const vp::VratasForDate> calc_shared(date::year_month_day base_date, const std::string & location_name, CalcFlags flags = CalcFlags::Default);
+Lru_Cache_Stats result_cache_stats();
+void set_result_cache_budget(std::size_t bytes);
+// Keep calculated vratas and day-by-day infos in dir between runs (see disk-cache.h).
+// Call once at startup, after change_to_data_dir() and before any calculations.
+void enable_disk_cache(const fs::path & dir, std::uintmax_t max_bytes = 64 * 1024 * 1024);
+// Answer calc() from the precomputed almanac (see almanac.h) whenever it has the answer.
+// Call once at startup, after change_to_data_dir() and before any calculations.
+// Throws std::runtime_error if the file can't be used, e.g. when it was built by another
+// program version or with other ephemeris or tzdata.
+void enable_almanac(const fs::path & path);
+// Calculate all vratas of [from_year, to_year] for all locations using `workers` processes
+// and write them to the almanac file. Progress and timing go to summary_out.
+void build_almanac(const fs::path & path, date::year from_year, date::year to_year, unsigned workers, const fmt::appender & summary_out);
+// Check almanac checksums and recalculate `samples` entries spread evenly over it.
+// Reports mismatches to out, returns true if there were none.
+bool verify_almanac(const fs::path & path, std::size_t samples, const fmt::appender & out);
+// Take tithi, nakshatra and sankranti times from the event catalog (see event-catalog.h).
+// Same rules as for enable_almanac().
+void enable_event_catalog(const fs::path & path);
+// Calculate all tithi, nakshatra and sankranti starts of [from_year, to_year] using `workers` processes
+// and write them to the event catalog file. Timing goes to summary_out.
+void build_event_catalog(const fs::path & path, date::year from_year, date::year to_year, unsigned workers, const fmt::appender & summary_out);
+// Take time zones from the compiled database (see tz-database.h) instead of text tzdata.
+// Call once at startup, after change_to_data_dir() and before any time zone lookups.
+// Throws std::runtime_error if the file can't be used, e.g. when it was compiled from another tzdata version.
+void enable_tz_database(const fs::path & path);
+// Compile text tzdata into the database file. Timing goes to summary_out.
+void build_tz_database(const fs::path & path, const fmt::appender & summary_out);
+std::string version();
 std::string program_name_and_version();
 
 class LocationDb {
 public:
 
-    auto begin() { return locations().cbegin(); }
-    auto end() { return locations().cend(); }
+    auto begin() { return locations().begin(); }
+    auto end() { return locations().end(); }
     static std::optional<Location> find_coord(const char *location_name);
+    // Known location closest to coord.
+    static std::optional<Location> find_nearest(Coord coord);
+    // Identity of the whole set of locations, used in "all" cache keys.
+    static std::uint64_t fingerprint();
+    // Look up time zones of all locations now rather than on their first use,
+    // e.g. before a server starts answering requests.
+    static void locate_time_zones();
+    // Replace built-in locations with ones from the CSV file (see location-table.h).
+    // Call once at startup, before any calculations (and before forking worker processes).
+    static void load(const fs::path & path);
 
 private:
-    static const std::vector<Location> & locations();
+    static Location_Table & locations();
 };
 
 namespace detail {
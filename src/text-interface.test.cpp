@@ -1,5 +1,6 @@
 #include "text-interface.h"
 
+#include "daybyday-record.h"
 #include "location.h"
 
 #include <algorithm>
@@ -416,3 +417,74 @@ TEST_CASE("calc_one works") {
     REQUIRE(vrata->location == l);
     REQUIRE(vrata->date == date::local_days{2023_y/12/22});
 }
+
+TEST_CASE("calc_shared returns the same cached result for the same inputs") {
+    using namespace date;
+    const auto before = vp::text_ui::result_cache_stats();
+    const auto vratas1 = vp::text_ui::calc_shared(2020_y/February/2, "Kiev");
+    const auto vratas2 = vp::text_ui::calc_shared(2020_y/February/2, "Kiev");
+    const auto after = vp::text_ui::result_cache_stats();
+    REQUIRE(vratas1.get() == vratas2.get());
+    REQUIRE(after.hits > before.hits);
+
+    // different location set => different cache entry
+    const auto vratas3 = vp::text_ui::calc_shared(2020_y/February/2, "Odessa");
+    REQUIRE(vratas3.get() != vratas1.get());
+}
+
+TEST_CASE("DayByDayInfo survives binary record round trip") {
+    using namespace date;
+    const auto location = vp::text_ui::LocationDb::find_coord("Udupi");
+    REQUIRE(location.has_value());
+    const auto info = vp::text_ui::daybyday_calc_one(2020_y/December/15, *location, vp::CalcFlags::Default);
+
+    fmt::memory_buffer buf;
+    vp::Record_Writer w{buf};
+    vp::text_ui::write_daybyday(w, info);
+    vp::Record_Reader r{std::string_view{buf.data(), buf.size()}};
+    const auto decoded = vp::text_ui::read_daybyday(r);
+    REQUIRE(r.at_end());
+
+    REQUIRE(decoded.location == info.location);
+    REQUIRE(decoded.date == info.date);
+    REQUIRE(decoded.sunrise1 == info.sunrise1);
+    REQUIRE(decoded.saura_masa == info.saura_masa);
+    REQUIRE(decoded.chandra_masa == info.chandra_masa);
+    REQUIRE(decoded.tithi == info.tithi);
+    REQUIRE(decoded.tithi_until == info.tithi_until);
+    REQUIRE(decoded.nakshatra == info.nakshatra);
+    REQUIRE(decoded.nakshatra2 == info.nakshatra2);
+    REQUIRE(decoded.events.size() == info.events.size());
+    for (std::size_t i = 0; i < info.events.size(); ++i) {
+        REQUIRE(decoded.events[i].name == info.events[i].name);
+        REQUIRE(decoded.events[i].time_point == info.events[i].time_point);
+        REQUIRE(decoded.events[i].trackIntervalChange == info.events[i].trackIntervalChange);
+    }
+}
+
+TEST_CASE("daybyday_calc_range gives the same days as separate daybyday_calc_one calls") {
+    using namespace date;
+    const auto location = vp::text_ui::LocationDb::find_coord("Udupi");
+    REQUIRE(location.has_value());
+    // crosses both a sankranti (Dhanu, 2020-12-15) and an amavasya (2020-12-14)
+    const auto infos = vp::text_ui::daybyday_calc_range(2020_y/December/12, 2020_y/December/17, *location, vp::CalcFlags::Default);
+    REQUIRE(infos.size() == 6);
+    for (const auto & info : infos) {
+        const auto single = vp::text_ui::daybyday_calc_one(info.date, *location, vp::CalcFlags::Default);
+        REQUIRE(info.sunrise1 == single.sunrise1);
+        REQUIRE(info.saura_masa == single.saura_masa);
+        REQUIRE(info.chandra_masa == single.chandra_masa);
+        REQUIRE(info.tithi == single.tithi);
+        REQUIRE(info.tithi2 == single.tithi2);
+        REQUIRE(info.nakshatra == single.nakshatra);
+        REQUIRE(info.nakshatra2 == single.nakshatra2);
+        REQUIRE(info.events.size() == single.events.size());
+        for (std::size_t i = 0; i < info.events.size(); ++i) {
+            REQUIRE(info.events[i].name == single.events[i].name);
+            // reused boundaries may differ from fresh ones only within search precision
+            REQUIRE(std::abs((info.events[i].time_point - single.events[i].time_point).count()) < 1.0 / 86400);
+        }
+    }
+    REQUIRE(infos.front().date == 2020_y/December/12);
+    REQUIRE(infos.back().date == 2020_y/December/17);
+}
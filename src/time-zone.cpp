@@ -0,0 +1,216 @@
+#include "time-zone.h"
+
+#include "tz-database.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace vp {
+
+Time_Zone::Time_Zone(std::string name, std::vector<Local_Time_Type> types, std::vector<std::int64_t> begins, std::vector<std::uint8_t> type_indexes)
+    : name_(std::move(name)), types_(std::move(types)), begins_(std::move(begins)), type_indexes_(std::move(type_indexes))
+{
+    if (begins_.empty() || begins_.size() != type_indexes_.size()) {
+        throw std::runtime_error(fmt::format("time zone {}: no transitions or transition count mismatch", name_));
+    }
+    for (const auto index : type_indexes_) {
+        if (index >= types_.size()) {
+            throw std::runtime_error(fmt::format("time zone {}: bad local time type {}", name_, index));
+        }
+    }
+    if (!std::is_sorted(begins_.begin() + 1, begins_.end())) {
+        throw std::runtime_error(fmt::format("time zone {}: transitions are out of order", name_));
+    }
+    build_lookup_tables();
+}
+
+void Time_Zone::build_lookup_tables()
+{
+    offsets_.reserve(type_indexes_.size());
+    for (const auto index : type_indexes_) {
+        const auto & type = types_[index];
+        offsets_.push_back(Offset_Entry{static_cast<std::int32_t>(type.offset.count()), type.save != std::chrono::minutes{0}});
+    }
+
+    const date::sys_seconds from{date::sys_days{time_zone_compiled_from / date::January / 1}};
+    const date::sys_seconds to{date::sys_days{time_zone_compiled_to / date::January / 1}};
+    lookup_origin_ = from.time_since_epoch().count();
+    const auto bucket_count = static_cast<std::size_t>((to.time_since_epoch().count() - lookup_origin_) >> bucket_shift) + 1;
+    bucket_transitions_.reserve(bucket_count);
+    std::size_t i = 0;
+    for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        const auto bucket_start = lookup_origin_ + (static_cast<std::int64_t>(bucket) << bucket_shift);
+        while (i + 1 < begins_.size() && begins_[i + 1] <= bucket_start) ++i;
+        bucket_transitions_.push_back(static_cast<std::uint32_t>(i));
+    }
+}
+
+Time_Zone Time_Zone::compile(const date::time_zone & zone)
+{
+    const date::sys_seconds from{date::sys_days{time_zone_compiled_from / date::January / 1}};
+    const date::sys_seconds to{date::sys_days{time_zone_compiled_to / date::January / 1}};
+    std::vector<Local_Time_Type> types;
+    std::vector<std::int64_t> begins;
+    std::vector<std::uint8_t> type_indexes;
+    for (auto t = from;;) {
+        const auto info = zone.get_info(t);
+        auto type = std::find_if(types.begin(), types.end(), [&](const Local_Time_Type & known) {
+            return known.offset == info.offset && known.save == info.save && known.abbrev == info.abbrev;
+        });
+        if (type == types.end()) {
+            if (types.size() > std::numeric_limits<std::uint8_t>::max()) {
+                throw std::runtime_error(fmt::format("time zone {} has too many local time types", zone.name()));
+            }
+            type = types.insert(types.end(), Local_Time_Type{info.offset, info.save, info.abbrev});
+        }
+        const auto index = static_cast<std::uint8_t>(type - types.begin());
+        // rule changes which don't change local time are not transitions for us
+        if (type_indexes.empty() || type_indexes.back() != index) {
+            begins.push_back(begins.empty() ? date::sys_seconds::min().time_since_epoch().count() : info.begin.time_since_epoch().count());
+            type_indexes.push_back(index);
+        }
+        if (info.end >= to) break;
+        t = info.end;
+    }
+    return Time_Zone{std::string{zone.name()}, std::move(types), std::move(begins), std::move(type_indexes)};
+}
+
+std::size_t Time_Zone::transition(date::sys_seconds t) const
+{
+    const auto s = t.time_since_epoch().count();
+    if (s >= lookup_origin_) {
+        const auto bucket = static_cast<std::uint64_t>(s - lookup_origin_) >> bucket_shift;
+        if (bucket < bucket_transitions_.size()) {
+            std::size_t i = bucket_transitions_[bucket];
+            while (i + 1 < begins_.size() && begins_[i + 1] <= s) ++i;
+            return i;
+        }
+    }
+    const auto next = std::upper_bound(begins_.begin() + 1, begins_.end(), s);
+    return static_cast<std::size_t>(next - begins_.begin()) - 1;
+}
+
+date::sys_info Time_Zone::info(std::size_t transition) const
+{
+    const auto & type = types_[type_indexes_[transition]];
+    date::sys_info info;
+    info.begin = transition == 0 ? date::sys_seconds::min() : date::sys_seconds{std::chrono::seconds{begins_[transition]}};
+    info.end = transition + 1 == begins_.size() ? date::sys_seconds::max() : date::sys_seconds{std::chrono::seconds{begins_[transition + 1]}};
+    info.offset = type.offset;
+    info.save = type.save;
+    info.abbrev = type.abbrev;
+    return info;
+}
+
+date::local_info Time_Zone::local_info_at(date::local_seconds t) const
+{
+    // Offsets are within a day and local time types last longer than that,
+    // so only transitions next to the one at t-as-if-it-was-UTC can contain t.
+    const auto local = t.time_since_epoch().count();
+    const auto near = transition(date::sys_seconds{t.time_since_epoch()});
+    const auto from = near >= 2 ? near - 2 : 0;
+    const auto to = std::min(near + 3, begins_.size());
+    const auto local_begin = [&](std::size_t i) {
+        return i == 0 ? std::numeric_limits<std::int64_t>::min() : begins_[i] + types_[type_indexes_[i]].offset.count();
+    };
+    const auto local_end = [&](std::size_t i) {
+        return i + 1 == begins_.size() ? std::numeric_limits<std::int64_t>::max() : begins_[i + 1] + types_[type_indexes_[i]].offset.count();
+    };
+
+    date::local_info result{};
+    int found = 0;
+    for (std::size_t i = from; i < to && found < 2; ++i) {
+        if (local >= local_begin(i) && local < local_end(i)) {
+            (found == 0 ? result.first : result.second) = info(i);
+            ++found;
+        }
+    }
+    if (found == 2) {
+        result.result = date::local_info::ambiguous;
+    } else if (found == 1) {
+        result.result = date::local_info::unique;
+    } else {
+        // in a gap: between the end of one local time type and the start of the next one
+        result.result = date::local_info::nonexistent;
+        for (std::size_t i = from + 1; i < to; ++i) {
+            if (local < local_begin(i)) {
+                result.first = info(i - 1);
+                result.second = info(i);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+namespace {
+
+struct Zone_Registry {
+    std::mutex mutex;
+    std::unique_ptr<const Tz_Database> database;
+    std::deque<Time_Zone> zones; // deque: handed out pointers must survive growth
+    std::unordered_map<std::string, const Time_Zone *> by_name; // requested names, links included
+};
+
+Zone_Registry & registry() {
+    static Zone_Registry registry_;
+    return registry_;
+}
+
+} // anonymous namespace
+
+const Time_Zone * locate_time_zone(std::string_view name)
+{
+    auto & r = registry();
+    std::lock_guard<std::mutex> lock{r.mutex};
+    std::string key{name};
+    if (const auto found = r.by_name.find(key); found != r.by_name.end()) {
+        return found->second;
+    }
+    const Time_Zone * zone = nullptr;
+    if (r.database) {
+        const auto zone_name = r.database->zone_name(name);
+        if (!zone_name) {
+            throw std::runtime_error(fmt::format("{} not found in compiled timezone database", name));
+        }
+        if (const auto found = r.by_name.find(std::string{*zone_name}); found != r.by_name.end()) {
+            zone = found->second;
+        } else {
+            zone = &r.zones.emplace_back(r.database->load(*zone_name));
+        }
+    } else {
+        // throws std::runtime_error for unknown zones
+        const auto & tzdata_zone = *date::locate_zone(name);
+        if (const auto found = r.by_name.find(std::string{tzdata_zone.name()}); found != r.by_name.end()) {
+            zone = found->second;
+        } else {
+            zone = &r.zones.emplace_back(Time_Zone::compile(tzdata_zone));
+        }
+    }
+    r.by_name.emplace(std::string{zone->name()}, zone);
+    r.by_name.emplace(std::move(key), zone);
+    return zone;
+}
+
+std::unique_ptr<const Tz_Database> set_tz_database(std::unique_ptr<const Tz_Database> database)
+{
+    auto & r = registry();
+    std::lock_guard<std::mutex> lock{r.mutex};
+    // already located zones stay valid, later lookups go to the new database
+    r.by_name.clear();
+    std::swap(r.database, database);
+    return database;
+}
+
+const Tz_Database * tz_database()
+{
+    auto & r = registry();
+    std::lock_guard<std::mutex> lock{r.mutex};
+    return r.database.get();
+}
+
+} // namespace vp
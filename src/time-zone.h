@@ -0,0 +1,160 @@
+#ifndef VP_TIME_ZONE_H
+#define VP_TIME_ZONE_H
+
+#include "tz-fixed.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace vp {
+
+class Tz_Database;
+
+/*
+ * Time zone as a flat table of its UTC offset changes, the way TZif files
+ * store it: transition instants plus a small table of local time types
+ * (offset, DST save, abbreviation) they switch to.
+ *
+ * Has the part of date::time_zone interface which date::zoned_time needs, so
+ * date::zoned_time<Duration, const Time_Zone *> (see Zoned_Time) and
+ * date::make_zoned(zone, t) work exactly as with date::time_zone.
+ *
+ * Transitions are compiled from tzdata for [time_zone_compiled_from, time_zone_compiled_to);
+ * before the first one the first type applies, after the last one the last type does.
+ */
+class Time_Zone {
+public:
+    struct Local_Time_Type {
+        std::chrono::seconds offset;
+        std::chrono::minutes save; // zero for standard time
+        std::string abbrev;
+    };
+
+    // begins are seconds since 1970-01-01 UTC, ascending; the first one is ignored
+    // (the first type applies since the beginning of time). types[type_indexes[i]] starts at begins[i].
+    Time_Zone(std::string name, std::vector<Local_Time_Type> types, std::vector<std::int64_t> begins, std::vector<std::uint8_t> type_indexes);
+    // All changes of the tzdata zone in the compiled range. Slow: walks the zone's rules year by year.
+    static Time_Zone compile(const date::time_zone & zone);
+
+    std::string_view name() const { return name_; }
+    const std::vector<Local_Time_Type> & types() const { return types_; }
+    const std::vector<std::int64_t> & begins() const { return begins_; }
+    const std::vector<std::uint8_t> & type_indexes() const { return type_indexes_; }
+
+    struct Utc_Offset {
+        std::chrono::seconds offset;
+        bool is_dst;
+    };
+    // Just the offset, without building a whole date::sys_info.
+    Utc_Offset utc_offset(date::sys_seconds t) const {
+        const auto & entry = offsets_[transition(t)];
+        return {std::chrono::seconds{entry.offset}, entry.is_dst};
+    }
+    std::chrono::seconds offset(date::sys_seconds t) const {
+        return std::chrono::seconds{offsets_[transition(t)].offset};
+    }
+    // Same as get_info(t).abbrev, without copying it.
+    std::string_view abbrev(date::sys_seconds t) const {
+        return types_[type_indexes_[transition(t)]].abbrev;
+    }
+
+    template<typename Duration>
+    date::sys_info get_info(date::sys_time<Duration> t) const {
+        return info(transition(date::floor<std::chrono::seconds>(t)));
+    }
+    template<typename Duration>
+    date::local_info get_info(date::local_time<Duration> t) const {
+        return local_info_at(date::floor<std::chrono::seconds>(t));
+    }
+
+    template<typename Duration>
+    date::local_time<std::common_type_t<Duration, std::chrono::seconds>> to_local(date::sys_time<Duration> t) const {
+        using Result = std::common_type_t<Duration, std::chrono::seconds>;
+        return date::local_time<Result>{Result{t.time_since_epoch()} + offset(date::floor<std::chrono::seconds>(t))};
+    }
+    // Throws date::nonexistent_local_time or date::ambiguous_local_time, like date::time_zone::to_sys().
+    template<typename Duration>
+    date::sys_time<std::common_type_t<Duration, std::chrono::seconds>> to_sys(date::local_time<Duration> t) const {
+        const auto i = get_info(t);
+        if (i.result == date::local_info::nonexistent) {
+            throw date::nonexistent_local_time(t, i);
+        }
+        if (i.result == date::local_info::ambiguous) {
+            throw date::ambiguous_local_time(t, i);
+        }
+        return as_sys(t, i.first.offset);
+    }
+    template<typename Duration>
+    date::sys_time<std::common_type_t<Duration, std::chrono::seconds>> to_sys(date::local_time<Duration> t, date::choose z) const {
+        const auto i = get_info(t);
+        if (i.result == date::local_info::nonexistent) {
+            return i.first.end;
+        }
+        if (i.result == date::local_info::ambiguous && z == date::choose::latest) {
+            return as_sys(t, i.second.offset);
+        }
+        return as_sys(t, i.first.offset);
+    }
+
+private:
+    template<typename Duration>
+    static date::sys_time<std::common_type_t<Duration, std::chrono::seconds>> as_sys(date::local_time<Duration> t, std::chrono::seconds offset) {
+        using Result = std::common_type_t<Duration, std::chrono::seconds>;
+        return date::sys_time<Result>{Result{t.time_since_epoch()} - offset};
+    }
+    // index of the transition in effect at t
+    std::size_t transition(date::sys_seconds t) const;
+    date::sys_info info(std::size_t transition) const;
+    date::local_info local_info_at(date::local_seconds t) const;
+
+    void build_lookup_tables();
+
+    std::string name_;
+    std::vector<Local_Time_Type> types_;
+    std::vector<std::int64_t> begins_;
+    std::vector<std::uint8_t> type_indexes_;
+
+    // Lookup tables built from the above, for offset() and friends, which
+    // are called several times per vrata when formatting local times.
+    struct Offset_Entry {
+        std::int32_t offset; // seconds
+        bool is_dst;
+    };
+    std::vector<Offset_Entry> offsets_; // types_[type_indexes_[i]], flattened
+    // Transition in effect at the start of each 2^bucket_shift s (about a year)
+    // since lookup_origin_: a lookup starts there and steps over the few
+    // transitions within the bucket instead of binary-searching all of them.
+    static constexpr int bucket_shift = 25;
+    std::int64_t lookup_origin_{};
+    std::vector<std::uint32_t> bucket_transitions_;
+};
+
+// Range of years with exact transitions in compiled zones.
+constexpr date::year time_zone_compiled_from{1800};
+constexpr date::year time_zone_compiled_to{2200}; // exclusive
+
+using Zoned_Time = date::zoned_time<std::chrono::seconds, const Time_Zone *>;
+
+/*
+ * Zone by tzdata name (or link name), like date::locate_zone(). Zones are
+ * materialized once, on first request, and live until the program exits.
+ * With a compiled database set (see set_tz_database()) they are decoded from
+ * it one at a time; otherwise they are compiled from text tzdata, which
+ * date parses as a whole on first use.
+ * Throws std::runtime_error for unknown names.
+ */
+const Time_Zone * locate_time_zone(std::string_view name);
+
+// Call at startup, before looking up any zones (and before forking worker processes).
+// Returns the previous database.
+std::unique_ptr<const Tz_Database> set_tz_database(std::unique_ptr<const Tz_Database> database);
+const Tz_Database * tz_database();
+
+} // namespace vp
+
+#endif // VP_TIME_ZONE_H
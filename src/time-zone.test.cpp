@@ -0,0 +1,145 @@
+#include "time-zone.h"
+
+#include "catch-formatters.h"
+
+using namespace date;
+using namespace vp;
+using namespace std::chrono_literals;
+
+namespace {
+
+sys_seconds utc(year_month_day d, std::chrono::seconds time) {
+    return sys_days{d} + time;
+}
+
+// +02:00 "EET", with +03:00 "EEST" from 2019-03-31 01:00 UTC to 2019-10-27 01:00 UTC, like Europe/Kiev.
+Time_Zone synthetic_zone() {
+    std::vector<Time_Zone::Local_Time_Type> types{
+        {2h, 0min, "EET"},
+        {3h, 60min, "EEST"},
+    };
+    std::vector<std::int64_t> begins{
+        sys_seconds::min().time_since_epoch().count(),
+        utc(2019_y/March/31, 1h).time_since_epoch().count(),
+        utc(2019_y/October/27, 1h).time_since_epoch().count(),
+    };
+    return Time_Zone{"Test/Synthetic", std::move(types), std::move(begins), {0, 1, 0}};
+}
+
+} // anonymous namespace
+
+TEST_CASE("Time_Zone::get_info(sys_time) gives the local time type in effect and its interval") {
+    const auto zone = synthetic_zone();
+    const auto winter = zone.get_info(utc(2019_y/January/1, 0h));
+    REQUIRE(winter.offset == 2h);
+    REQUIRE(winter.save == 0min);
+    REQUIRE(winter.abbrev == "EET");
+    REQUIRE(winter.begin == sys_seconds::min());
+    REQUIRE(winter.end == utc(2019_y/March/31, 1h));
+
+    const auto summer = zone.get_info(utc(2019_y/March/31, 1h));
+    REQUIRE(summer.offset == 3h);
+    REQUIRE(summer.save == 60min);
+    REQUIRE(summer.abbrev == "EEST");
+    REQUIRE(summer.end == utc(2019_y/October/27, 1h));
+
+    const auto after = zone.get_info(utc(2100_y/July/1, 0h));
+    REQUIRE(after.offset == 2h);
+    REQUIRE(after.end == sys_seconds::max());
+    REQUIRE(zone.offset(utc(2019_y/October/27, 1h) - 1s) == 3h);
+    REQUIRE(zone.abbrev(utc(2019_y/October/27, 1h) - 1s) == "EEST");
+    REQUIRE(zone.abbrev(utc(2019_y/October/27, 1h)) == "EET");
+}
+
+TEST_CASE("Time_Zone::get_info(local_time) finds unique, nonexistent and ambiguous local times") {
+    const auto zone = synthetic_zone();
+    const auto unique = zone.get_info(local_days{2019_y/June/1} + 12h);
+    REQUIRE(unique.result == local_info::unique);
+    REQUIRE(unique.first.abbrev == "EEST");
+
+    // 03:00 EET jumps to 04:00 EEST
+    const auto gap = zone.get_info(local_days{2019_y/March/31} + 3h + 30min);
+    REQUIRE(gap.result == local_info::nonexistent);
+    REQUIRE(gap.first.abbrev == "EET");
+    REQUIRE(gap.second.abbrev == "EEST");
+
+    // 04:00 EEST goes back to 03:00 EET
+    const auto overlap = zone.get_info(local_days{2019_y/October/27} + 3h + 30min);
+    REQUIRE(overlap.result == local_info::ambiguous);
+    REQUIRE(overlap.first.abbrev == "EEST");
+    REQUIRE(overlap.second.abbrev == "EET");
+}
+
+TEST_CASE("Time_Zone converts between UTC and local time like date::time_zone") {
+    const auto zone = synthetic_zone();
+    REQUIRE(zone.to_local(utc(2019_y/June/1, 9h)) == local_days{2019_y/June/1} + 12h);
+    REQUIRE(zone.to_sys(local_days{2019_y/June/1} + 12h) == utc(2019_y/June/1, 9h));
+    REQUIRE_THROWS_AS(zone.to_sys(local_days{2019_y/March/31} + 3h + 30min), nonexistent_local_time);
+    REQUIRE_THROWS_AS(zone.to_sys(local_days{2019_y/October/27} + 3h + 30min), ambiguous_local_time);
+    REQUIRE(zone.to_sys(local_days{2019_y/March/31} + 3h + 30min, choose::earliest) == utc(2019_y/March/31, 1h));
+    REQUIRE(zone.to_sys(local_days{2019_y/October/27} + 3h + 30min, choose::earliest) == utc(2019_y/October/27, 30min));
+    REQUIRE(zone.to_sys(local_days{2019_y/October/27} + 3h + 30min, choose::latest) == utc(2019_y/October/27, 1h + 30min));
+
+    const auto zoned = make_zoned(&zone, utc(2019_y/June/1, 9h));
+    REQUIRE(zoned.get_local_time() == local_days{2019_y/June/1} + 12h);
+    REQUIRE(zoned.get_info().abbrev == "EEST");
+}
+
+TEST_CASE("Time_Zone::utc_offset() finds the same transition as a linear search") {
+    // transitions twice a year, several in some years, and some outside of the compiled range
+    std::vector<std::int64_t> begins{sys_seconds::min().time_since_epoch().count()};
+    std::vector<std::uint8_t> type_indexes{0};
+    for (auto y = 1700_y; y < 2300_y; ++y) {
+        begins.push_back(utc(y/March/31, 1h).time_since_epoch().count());
+        type_indexes.push_back(1);
+        if (y == 1800_y || y == 1942_y || y == 2199_y) {
+            begins.push_back(utc(y/June/1, 0h).time_since_epoch().count());
+            type_indexes.push_back(0);
+            begins.push_back(utc(y/June/1, 0h + 1s).time_since_epoch().count());
+            type_indexes.push_back(1);
+        }
+        begins.push_back(utc(y/October/27, 1h).time_since_epoch().count());
+        type_indexes.push_back(0);
+    }
+    const Time_Zone zone{"Test/Dense", {{2h, 0min, "EET"}, {3h, 60min, "EEST"}}, begins, type_indexes};
+    for (auto t = utc(1690_y/January/1, 0h); t < utc(2310_y/January/1, 0h); t += days{3} + 5h + 7s) {
+        std::size_t expected = 0;
+        while (expected + 1 < begins.size() && begins[expected + 1] <= t.time_since_epoch().count()) ++expected;
+        const auto actual = zone.utc_offset(t);
+        REQUIRE(actual.offset == (type_indexes[expected] == 1 ? 3h : 2h));
+        REQUIRE(actual.is_dst == (type_indexes[expected] == 1));
+    }
+    REQUIRE(zone.utc_offset(utc(1942_y/June/1, 0h)).offset == 2h);
+    REQUIRE(zone.utc_offset(utc(1942_y/June/1, 0h) - 1s).offset == 3h);
+    REQUIRE(zone.utc_offset(utc(1942_y/June/1, 0h) + 1s).offset == 3h);
+}
+
+TEST_CASE("Time_Zone refuses transitions out of order") {
+    REQUIRE_THROWS_AS((Time_Zone{"Test/Bad", {{0h, 0min, "A"}, {1h, 0min, "B"}}, {0, 100, 50}, {0, 1, 0}}), std::runtime_error);
+}
+
+TEST_CASE("Time_Zone::compile() agrees with tzdata") {
+    for (const auto name : {"Europe/Kiev", "America/New_York", "Asia/Kolkata", "Australia/Lord_Howe"}) {
+        const auto & tzdata_zone = *locate_zone(name);
+        const auto compiled = Time_Zone::compile(tzdata_zone);
+        REQUIRE(compiled.name() == tzdata_zone.name());
+        // every 5 days and 7 hours, so that all hours of the day and all seasons are hit
+        for (auto t = utc(1900_y/January/1, 0h); t < utc(2100_y/January/1, 0h); t += days{5} + 7h) {
+            const auto expected = tzdata_zone.get_info(t);
+            const auto actual = compiled.get_info(t);
+            REQUIRE(actual.offset == expected.offset);
+            REQUIRE(actual.save == expected.save);
+            REQUIRE(actual.abbrev == expected.abbrev);
+            const auto local = tzdata_zone.to_local(t);
+            REQUIRE(compiled.get_info(local).result == tzdata_zone.get_info(local).result);
+            REQUIRE(compiled.to_sys(local, choose::earliest) == tzdata_zone.to_sys(local, choose::earliest));
+        }
+    }
+}
+
+TEST_CASE("locate_time_zone() gives the same zone for a link and its target") {
+    const auto * kiev = locate_time_zone("Europe/Kiev");
+    REQUIRE(kiev == locate_time_zone("Europe/Kiev"));
+    REQUIRE(kiev == locate_time_zone(kiev->name()));
+    REQUIRE_THROWS_AS(locate_time_zone("Mars/Olympus_Mons"), std::runtime_error);
+}
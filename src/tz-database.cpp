@@ -0,0 +1,225 @@
+#include "tz-database.h"
+
+#include "binary-record.h"
+#include "disk-cache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+namespace vp {
+
+namespace {
+
+constexpr std::uint32_t tz_database_magic = 0x5A545056; // "VPTZ" when read as little-endian bytes
+
+void write_zone(Record_Writer & w, const Time_Zone & zone) {
+    w.str(zone.name());
+    w.u8(static_cast<std::uint8_t>(zone.types().size()));
+    for (const auto & type : zone.types()) {
+        w.i32(static_cast<std::int32_t>(type.offset.count()));
+        w.i32(static_cast<std::int32_t>(type.save.count()));
+        w.str(type.abbrev);
+    }
+    w.u32(static_cast<std::uint32_t>(zone.begins().size()));
+    for (const auto begin : zone.begins()) {
+        w.u64(static_cast<std::uint64_t>(begin));
+    }
+    for (const auto index : zone.type_indexes()) {
+        w.u8(index);
+    }
+}
+
+Time_Zone read_zone(Record_Reader & r) {
+    std::string name{r.str()};
+    std::vector<Time_Zone::Local_Time_Type> types(r.u8());
+    for (auto & type : types) {
+        type.offset = std::chrono::seconds{r.i32()};
+        type.save = std::chrono::minutes{r.i32()};
+        type.abbrev = std::string{r.str()};
+    }
+    const auto count = r.u32();
+    std::vector<std::int64_t> begins(count);
+    for (auto & begin : begins) {
+        begin = static_cast<std::int64_t>(r.u64());
+    }
+    std::vector<std::uint8_t> type_indexes(count);
+    for (auto & index : type_indexes) {
+        index = r.u8();
+    }
+    return Time_Zone{std::move(name), std::move(types), std::move(begins), std::move(type_indexes)};
+}
+
+} // anonymous namespace
+
+Tz_Database_Data compile_tz_database()
+{
+    const auto & tzdb = date::get_tzdb();
+    Tz_Database_Data data;
+    data.version = tzdb.version;
+    data.zones.reserve(tzdb.zones.size());
+    for (const auto & zone : tzdb.zones) {
+        data.zones.push_back(Time_Zone::compile(zone));
+    }
+    for (const auto & link : tzdb.links) {
+        data.links.emplace_back(std::string{link.name()}, std::string{link.target()});
+    }
+    return data;
+}
+
+std::string encode_tz_database(const Tz_Database_Data & data)
+{
+    // zone records first, to know their offsets
+    fmt::memory_buffer records;
+    std::unordered_map<std::string_view, std::uint64_t> record_offsets; // relative to the start of records
+    {
+        Record_Writer w{records};
+        for (const auto & zone : data.zones) {
+            record_offsets.emplace(zone.name(), records.size());
+            write_zone(w, zone);
+        }
+    }
+    std::vector<std::pair<std::string_view, std::uint64_t>> names;
+    names.reserve(data.zones.size() + data.links.size());
+    for (const auto & zone : data.zones) {
+        names.emplace_back(zone.name(), record_offsets.at(zone.name()));
+    }
+    for (const auto & [name, target] : data.links) {
+        const auto found = record_offsets.find(target);
+        if (found == record_offsets.end()) {
+            throw std::runtime_error(fmt::format("time zone link {} points to unknown zone {}", name, target));
+        }
+        names.emplace_back(name, found->second);
+    }
+    std::sort(names.begin(), names.end());
+    if (names.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("tz database: too many zones");
+    }
+
+    const std::size_t header_size = 4 + 4 + 4 + 4 + 4 + 8 + 4 + data.version.size();
+    std::size_t names_size = 0;
+    for (const auto & name : names) {
+        names_size += 4 + name.first.size() + 8;
+    }
+    fmt::memory_buffer index;
+    {
+        Record_Writer w{index};
+        for (const auto & [name, offset] : names) {
+            w.str(name);
+            w.u64(header_size + names_size + offset);
+        }
+    }
+
+    fmt::memory_buffer header;
+    Record_Writer w{header};
+    w.u32(tz_database_magic);
+    w.u32(tz_database_format_version);
+    w.i32(static_cast<int>(time_zone_compiled_from));
+    w.i32(static_cast<int>(time_zone_compiled_to));
+    w.u32(static_cast<std::uint32_t>(names.size()));
+    w.u64(fnv1a_64(std::string_view{index.data(), index.size()}));
+    w.str(data.version);
+    return fmt::to_string(header) + fmt::to_string(index) + fmt::to_string(records);
+}
+
+void write_tz_database(const fs::path & path, const Tz_Database_Data & data)
+{
+    const auto contents = encode_tz_database(data);
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream f{temp_path, std::ios::binary | std::ios::trunc};
+        f.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        f.close();
+        if (!f) {
+            std::error_code ec;
+            fs::remove(temp_path, ec);
+            throw std::runtime_error(fmt::format("can't write tz database '{}'", temp_path.string()));
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        throw std::runtime_error(fmt::format("can't rename '{}' to '{}': {}", temp_path.string(), path.string(), ec.message()));
+    }
+}
+
+Tz_Database::Tz_Database(const fs::path & path)
+    : file_(path), data_(file_.data()), source_name_(path.string())
+{
+    read_index(source_name_);
+}
+
+Tz_Database::Tz_Database(std::string contents)
+    : file_(std::move(contents)), data_(file_.data()), source_name_("(in memory)")
+{
+    read_index(source_name_);
+}
+
+void Tz_Database::read_index(std::string_view source_name)
+{
+    constexpr std::size_t fixed_header_size = 4 + 4 + 4 + 4;
+    if (data_.size() < fixed_header_size) {
+        throw std::runtime_error(fmt::format("'{}' is not a tz database: too short", source_name));
+    }
+    Record_Reader r{data_};
+    if (r.u32() != tz_database_magic) {
+        throw std::runtime_error(fmt::format("'{}' is not a tz database", source_name));
+    }
+    if (const auto version = r.u32(); version != tz_database_format_version) {
+        throw std::runtime_error(fmt::format("tz database '{}' has format version {}, expected {}; rebuild it", source_name, version, tz_database_format_version));
+    }
+    const auto from = date::year{r.i32()};
+    const auto to = date::year{r.i32()};
+    if (from != time_zone_compiled_from || to != time_zone_compiled_to) {
+        throw std::runtime_error(fmt::format("tz database '{}' covers years {}..{}, expected {}..{}; rebuild it",
+                                             source_name, static_cast<int>(from), static_cast<int>(to),
+                                             static_cast<int>(time_zone_compiled_from), static_cast<int>(time_zone_compiled_to)));
+    }
+    try {
+        const auto count = r.u32();
+        const auto checksum = r.u64();
+        version_ = r.str();
+        const auto index_start = r.position();
+        names_.reserve(std::min<std::size_t>(count, data_.size() / 13)); // a damaged count mustn't exhaust memory
+        for (std::uint32_t i = 0; i < count; ++i) {
+            const auto name = r.str();
+            const auto offset = r.u64();
+            if (offset >= data_.size()) {
+                throw std::runtime_error(fmt::format("zone {} is out of the file", name));
+            }
+            names_.emplace(name, offset);
+        }
+        if (fnv1a_64(data_.substr(index_start, r.position() - index_start)) != checksum) {
+            throw std::runtime_error("checksum mismatch");
+        }
+    } catch (const std::runtime_error & err) {
+        throw std::runtime_error(fmt::format("tz database '{}' is damaged: {}", source_name, err.what()));
+    }
+}
+
+std::optional<std::string_view> Tz_Database::zone_name(std::string_view name) const
+{
+    const auto found = names_.find(name);
+    if (found == names_.end()) return std::nullopt;
+    Record_Reader r{data_.substr(found->second)};
+    return r.str();
+}
+
+Time_Zone Tz_Database::load(std::string_view name) const
+{
+    const auto found = names_.find(name);
+    if (found == names_.end()) {
+        throw std::runtime_error(fmt::format("{} not found in tz database '{}'", name, source_name_));
+    }
+    try {
+        Record_Reader r{data_.substr(found->second)};
+        return read_zone(r);
+    } catch (const std::runtime_error & err) {
+        throw std::runtime_error(fmt::format("tz database '{}': can't read zone {}: {}", source_name_, name, err.what()));
+    }
+}
+
+} // namespace vp
@@ -0,0 +1,79 @@
+#ifndef VP_TZ_DATABASE_H
+#define VP_TZ_DATABASE_H
+
+#include "filesystem-fixed.h"
+#include "mapped-file.h"
+#include "time-zone.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vp {
+
+/*
+ * All zones of text tzdata compiled into a single binary file (tzdata.vpz),
+ * so that the program doesn't have to parse the whole text tzdata on start
+ * only to use a handful of zones out of it.
+ *
+ * The file is memory-mapped (see mapped-file.h). Opening it reads only the
+ * name index; a zone is decoded into a Time_Zone when it's first asked for
+ * (see locate_time_zone()), the rest of the file is never touched.
+ *
+ * File layout (little-endian, see binary-record.h):
+ *   u32 magic, u32 format version, i32 from year, i32 to year (see time_zone_compiled_from),
+ *   u32 name count, u64 checksum of the names, str tzdata version,
+ *   names: str name, u64 offset of its zone record (links point to their target's record),
+ *   zone records: str name, u8 type count, types: i32 offset (s), i32 save (min), str abbrev,
+ *                 u32 transition count, i64 begin of each transition (s since 1970), u8 type of each transition
+ */
+constexpr std::uint32_t tz_database_format_version = 1;
+
+// Contents of text tzdata, as compiled or as read back.
+struct Tz_Database_Data {
+    std::string version;
+    std::vector<Time_Zone> zones;
+    std::vector<std::pair<std::string, std::string>> links; // name, target zone name
+};
+
+// Compile all zones of text tzdata (date::get_tzdb()).
+Tz_Database_Data compile_tz_database();
+// Contents of the database file.
+std::string encode_tz_database(const Tz_Database_Data & data);
+void write_tz_database(const fs::path & path, const Tz_Database_Data & data);
+
+class Tz_Database {
+public:
+    // Throws std::runtime_error if the file can't be read, it's not a database or it's damaged.
+    explicit Tz_Database(const fs::path & path);
+    // In-memory database, e.g. just encoded.
+    explicit Tz_Database(std::string contents);
+    Tz_Database(const Tz_Database &) = delete;
+    Tz_Database & operator=(const Tz_Database &) = delete;
+
+    std::string_view version() const { return version_; }
+    std::size_t size() const { return names_.size(); } // zones and links
+
+    // Name of the zone itself: the same name for a zone, the target for a link,
+    // nullopt if it's not in the database. Points into the database.
+    std::optional<std::string_view> zone_name(std::string_view name) const;
+    // Decode the zone (or link target). Throws std::runtime_error if it's not in the database or the record is damaged.
+    Time_Zone load(std::string_view name) const;
+
+private:
+    void read_index(std::string_view source_name);
+
+    Mapped_File file_;
+    std::string_view data_;
+    std::string source_name_;
+    std::string_view version_;
+    std::unordered_map<std::string_view, std::uint64_t> names_; // record offsets, views into data_
+};
+
+} // namespace vp
+
+#endif // VP_TZ_DATABASE_H
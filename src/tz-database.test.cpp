@@ -0,0 +1,87 @@
+#include "tz-database.h"
+
+#include "catch-formatters.h"
+
+using namespace date;
+using namespace vp;
+using namespace std::chrono_literals;
+
+namespace {
+
+Time_Zone fixed_zone(std::string name, std::chrono::seconds offset, std::string abbrev) {
+    return Time_Zone{std::move(name), {{offset, 0min, std::move(abbrev)}}, {sys_seconds::min().time_since_epoch().count()}, {0}};
+}
+
+Tz_Database_Data synthetic_data() {
+    Tz_Database_Data data;
+    data.version = "2099z";
+    data.zones.push_back(fixed_zone("Test/Plus_Five_Thirty", 5h + 30min, "+0530"));
+    data.zones.push_back(Time_Zone{"Test/Summer",
+                                   {{1h, 0min, "STD"}, {2h, 60min, "DST"}},
+                                   {sys_seconds::min().time_since_epoch().count(), sys_seconds{sys_days{2020_y/March/29} + 1h}.time_since_epoch().count()},
+                                   {0, 1}});
+    data.links.emplace_back("Test/Alias", "Test/Summer");
+    return data;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Tz_Database decodes zones and links it was encoded with") {
+    const Tz_Database database{encode_tz_database(synthetic_data())};
+    REQUIRE(database.version() == "2099z");
+    REQUIRE(database.size() == 3);
+    REQUIRE(database.zone_name("Test/Alias") == std::optional<std::string_view>{"Test/Summer"});
+    REQUIRE(database.zone_name("Test/Summer") == std::optional<std::string_view>{"Test/Summer"});
+    REQUIRE_FALSE(database.zone_name("Test/Missing").has_value());
+
+    const auto summer = database.load("Test/Alias");
+    REQUIRE(summer.name() == "Test/Summer");
+    REQUIRE(summer.offset(sys_days{2020_y/January/1}) == 1h);
+    REQUIRE(summer.get_info(sys_days{2020_y/June/1}).abbrev == "DST");
+    REQUIRE(summer.get_info(sys_days{2020_y/June/1}).save == 60min);
+
+    const auto fixed = database.load("Test/Plus_Five_Thirty");
+    REQUIRE(fixed.to_local(sys_days{2020_y/June/1}) == local_days{2020_y/June/1} + 5h + 30min);
+    REQUIRE_THROWS_AS(database.load("Test/Missing"), std::runtime_error);
+}
+
+TEST_CASE("Tz_Database refuses files which are not databases or are damaged") {
+    REQUIRE_THROWS_WITH(Tz_Database{std::string{"VPTZ"}}, Catch::Contains("not a tz database"));
+    REQUIRE_THROWS_WITH(Tz_Database{std::string(64, 'x')}, Catch::Contains("not a tz database"));
+
+    const auto contents = encode_tz_database(synthetic_data());
+    REQUIRE_THROWS_WITH(Tz_Database{contents.substr(0, 40)}, Catch::Contains("damaged"));
+    auto corrupted = contents;
+    corrupted[40] ^= 1; // in the name index
+    REQUIRE_THROWS_WITH(Tz_Database{corrupted}, Catch::Contains("damaged"));
+}
+
+TEST_CASE("encode_tz_database() refuses links to unknown zones") {
+    auto data = synthetic_data();
+    data.links.emplace_back("Test/Dangling", "Test/Nowhere");
+    REQUIRE_THROWS_WITH(encode_tz_database(data), Catch::Contains("Test/Nowhere"));
+}
+
+TEST_CASE("locate_time_zone() takes zones from the database once it is set") {
+    auto previous = set_tz_database(std::make_unique<const Tz_Database>(encode_tz_database(synthetic_data())));
+    const auto * alias = locate_time_zone("Test/Alias");
+    REQUIRE(alias->name() == "Test/Summer");
+    REQUIRE(alias == locate_time_zone("Test/Summer"));
+    REQUIRE_THROWS_AS(locate_time_zone("Europe/Kiev"), std::runtime_error);
+    set_tz_database(std::move(previous));
+    REQUIRE(locate_time_zone("Europe/Kiev") != nullptr);
+}
+
+TEST_CASE("compile_tz_database() round-trips through the file format") {
+    const auto data = compile_tz_database();
+    REQUIRE_FALSE(data.zones.empty());
+    const Tz_Database database{encode_tz_database(data)};
+    REQUIRE(database.version() == data.version);
+    REQUIRE(database.size() == data.zones.size() + data.links.size());
+    for (const auto & zone : data.zones) {
+        const auto loaded = database.load(zone.name());
+        REQUIRE(loaded.begins() == zone.begins());
+        REQUIRE(loaded.type_indexes() == zone.type_indexes());
+        REQUIRE(loaded.types().size() == zone.types().size());
+    }
+}
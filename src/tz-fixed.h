@@ -14,13 +14,13 @@ DISABLE_WARNING_SHADOW
 #include "date/tz.h"
 DISABLE_WARNING_POP
 
-template<typename Duration>
-struct fmt::formatter<date::zoned_time<Duration>> {
+template<typename Duration, typename TimeZonePtr>
+struct fmt::formatter<date::zoned_time<Duration, TimeZonePtr>> {
     template<typename ParseContext>
     constexpr auto parse(ParseContext & ctx) { return ctx.begin(); }
 
     template<typename FormatContext>
-    auto format(const date::zoned_time<Duration> & t, FormatContext & ctx) {
+    auto format(const date::zoned_time<Duration, TimeZonePtr> & t, FormatContext & ctx) {
         return fmt::format_to(ctx.out(), "{} {}", t.get_local_time(), t.get_info().abbrev);
     }
 };
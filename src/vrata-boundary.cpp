@@ -0,0 +1,235 @@
+#include "vrata-boundary.h"
+
+#include "binary-record.h"
+#include "event-catalog.h"
+#include "text-interface.h"
+#include "vrata-grid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+
+namespace vp {
+
+bool operator==(const Vrata_Key & one, const Vrata_Key & other)
+{
+    if (one.ok != other.ok) return false;
+    return !one.ok || (one.date == other.date && one.type == other.type);
+}
+
+bool operator!=(const Vrata_Key & one, const Vrata_Key & other)
+{
+    return !(one == other);
+}
+
+Vrata_Key vrata_key(const MaybeVrata & vrata)
+{
+    if (!vrata) return Vrata_Key{};
+    return Vrata_Key{true, vrata->date, vrata->type};
+}
+
+namespace {
+
+Coord coord_on_line(Boundary_Scan scan, double fixed, double along) {
+    if (scan == Boundary_Scan::Along_Latitudes) {
+        return Coord{Latitude{fixed}, Longitude{along}};
+    }
+    return Coord{Latitude{along}, Longitude{fixed}};
+}
+
+double along_line(Boundary_Scan scan, Coord coord) {
+    return scan == Boundary_Scan::Along_Latitudes ? coord.longitude.longitude : coord.latitude.latitude;
+}
+
+class Line_Scanner {
+public:
+    Line_Scanner(date::local_days base_date, CalcFlags flags, Boundary_Scan scan, double fixed, double tolerance, std::size_t & probes)
+        : base_date_(base_date), flags_(flags), scan_(scan), fixed_(fixed), tolerance_(tolerance), probes_(probes) {}
+
+    Vrata_Key probe(double along) {
+        ++probes_;
+        return vrata_key(text_ui::calc_one(base_date_, grid_location(coord_on_line(scan_, fixed_, along)), flags_));
+    }
+
+    // Crossings between lo and hi, in order. A third vrata found in between
+    // means two crossings, so both halves are searched then.
+    void bisect(double lo, const Vrata_Key & lo_key, double hi, const Vrata_Key & hi_key, std::vector<Boundary_Crossing> & out) {
+        if (hi - lo <= tolerance_) {
+            out.push_back(Boundary_Crossing{coord_on_line(scan_, fixed_, (lo + hi) / 2), lo_key, hi_key});
+            return;
+        }
+        const double mid = (lo + hi) / 2;
+        const auto mid_key = probe(mid);
+        if (mid_key != lo_key) bisect(lo, lo_key, mid, mid_key, out);
+        if (mid_key != hi_key) bisect(mid, mid_key, hi, hi_key, out);
+    }
+
+private:
+    date::local_days base_date_;
+    CalcFlags flags_;
+    Boundary_Scan scan_;
+    double fixed_;
+    double tolerance_;
+    std::size_t & probes_;
+};
+
+void write_key(Record_Writer & w, const Vrata_Key & key) {
+    w.u8(key.ok ? 1 : 0);
+    w.i32(static_cast<std::int32_t>(key.date.time_since_epoch().count()));
+    w.u8(static_cast<std::uint8_t>(key.type));
+}
+
+Vrata_Key read_key(Record_Reader & r) {
+    Vrata_Key key;
+    key.ok = r.u8() != 0;
+    key.date = date::local_days{date::days{r.i32()}};
+    key.type = static_cast<Vrata_Type>(r.u8());
+    return key;
+}
+
+// Runs in the worker process. Task is (u32 flags, i32 base date, u8 scan,
+// f64 fixed, f64 from, f64 to, f64 step, f64 tolerance), result is u64 probes,
+// u32 crossing count and that many (f64 latitude, f64 longitude, key before, key after).
+void scan_line(std::string_view task, fmt::memory_buffer & out) {
+    Record_Reader r{task};
+    const auto flags = static_cast<CalcFlags>(r.u32());
+    const date::local_days base_date{date::days{r.i32()}};
+    const auto scan = static_cast<Boundary_Scan>(r.u8());
+    const auto fixed = r.f64();
+    const auto from = r.f64();
+    const auto to = r.f64();
+    const auto step = r.f64();
+    const auto tolerance = r.f64();
+
+    std::size_t probes = 0;
+    const auto crossings = find_crossings_on_line(base_date, flags, scan, fixed, from, to, step, tolerance, probes);
+    Record_Writer w{out};
+    w.u64(probes);
+    w.u32(static_cast<std::uint32_t>(crossings.size()));
+    for (const auto & crossing : crossings) {
+        w.f64(crossing.coord.latitude.latitude);
+        w.f64(crossing.coord.longitude.longitude);
+        write_key(w, crossing.before);
+        write_key(w, crossing.after);
+    }
+}
+
+} // anonymous namespace
+
+std::vector<Boundary_Crossing> find_crossings_on_line(date::local_days base_date, CalcFlags flags, Boundary_Scan scan,
+                                                      double fixed, double from, double to, double step, double tolerance,
+                                                      std::size_t & probes)
+{
+    Line_Scanner scanner{base_date, flags, scan, fixed, tolerance, probes};
+    std::vector<Boundary_Crossing> crossings;
+    const auto intervals = static_cast<std::size_t>(std::ceil((to - from) / step - 1e-9));
+    double prev = from;
+    auto prev_key = scanner.probe(from);
+    for (std::size_t i = 1; i <= intervals; ++i) {
+        const double next = std::min(from + step * static_cast<double>(i), to);
+        const auto next_key = scanner.probe(next);
+        if (next_key != prev_key) {
+            scanner.bisect(prev, prev_key, next, next_key, crossings);
+        }
+        prev = next;
+        prev_key = next_key;
+    }
+    return crossings;
+}
+
+std::vector<Boundary_Polyline> join_crossings(const std::vector<std::vector<Boundary_Crossing>> & crossings, Boundary_Scan scan, double max_distance)
+{
+    std::vector<Boundary_Polyline> polylines;
+    std::vector<std::size_t> open; // polylines which got a point on the previous line
+    for (const auto & line : crossings) {
+        std::vector<std::size_t> next_open;
+        std::vector<bool> taken(open.size(), false);
+        for (const auto & crossing : line) {
+            const double along = along_line(scan, crossing.coord);
+            std::optional<std::size_t> best;
+            double best_distance = max_distance;
+            for (std::size_t k = 0; k < open.size(); ++k) {
+                const auto & polyline = polylines[open[k]];
+                if (taken[k] || polyline.before != crossing.before || polyline.after != crossing.after) continue;
+                const double distance = std::abs(along - along_line(scan, polyline.points.back()));
+                if (distance <= best_distance) {
+                    best = k;
+                    best_distance = distance;
+                }
+            }
+            if (best) {
+                taken[*best] = true;
+                polylines[open[*best]].points.push_back(crossing.coord);
+                next_open.push_back(open[*best]);
+            } else {
+                polylines.push_back(Boundary_Polyline{crossing.before, crossing.after, {crossing.coord}});
+                next_open.push_back(polylines.size() - 1);
+            }
+        }
+        open = std::move(next_open);
+    }
+    return polylines;
+}
+
+Boundary_Result find_vrata_boundaries(const Boundary_Request & request)
+{
+    const auto started = std::chrono::steady_clock::now();
+    if (!(request.step > 0.0) || !(request.tolerance > 0.0) || request.north <= request.south || request.east <= request.west
+            || request.south < Latitude{-90.0} || request.north > Latitude{90.0}
+            || request.west < Longitude{-180.0} || request.east > Longitude{180.0}) {
+        throw std::runtime_error(fmt::format("bad boundary search area: {}..{} N, {}..{} E with step {} and tolerance {}",
+                                             request.south, request.north, request.west, request.east, request.step, request.tolerance));
+    }
+    const bool along_latitudes = request.scan == Boundary_Scan::Along_Latitudes;
+    const double lines_from = along_latitudes ? request.south.latitude : request.west.longitude;
+    const double lines_to = along_latitudes ? request.north.latitude : request.east.longitude;
+    const double along_from = along_latitudes ? request.west.longitude : request.south.latitude;
+    const double along_to = along_latitudes ? request.east.longitude : request.north.latitude;
+    const auto line_count = static_cast<std::size_t>(std::floor((lines_to - lines_from) / request.step + 1e-9)) + 1;
+
+    const Event_Catalog_Scope shared_events{request.base_date, request.flags, request.workers};
+
+    std::vector<std::string> tasks;
+    tasks.reserve(line_count);
+    for (std::size_t i = 0; i < line_count; ++i) {
+        fmt::memory_buffer buf;
+        Record_Writer w{buf};
+        w.u32(static_cast<std::uint32_t>(request.flags));
+        w.i32(static_cast<std::int32_t>(request.base_date.time_since_epoch().count()));
+        w.u8(static_cast<std::uint8_t>(request.scan));
+        w.f64(lines_from + request.step * static_cast<double>(i));
+        w.f64(along_from);
+        w.f64(along_to);
+        w.f64(request.step);
+        w.f64(request.tolerance);
+        tasks.push_back(fmt::to_string(buf));
+    }
+
+    Boundary_Result result;
+    std::vector<std::vector<Boundary_Crossing>> crossings(line_count);
+    Process_Pool pool{request.workers, scan_line};
+    pool.run(tasks, [&](std::size_t i, Process_Pool::Task_Result && task_result) {
+        if (!task_result.ok) {
+            result.failures.push_back(fmt::format("scan line at {}: {}", lines_from + request.step * static_cast<double>(i), task_result.data));
+            return;
+        }
+        Record_Reader r{task_result.data};
+        result.probes += static_cast<std::size_t>(r.u64());
+        const auto count = r.u32();
+        for (std::uint32_t k = 0; k < count; ++k) {
+            const Latitude latitude{r.f64()};
+            const Longitude longitude{r.f64()};
+            const auto before = read_key(r);
+            const auto after = read_key(r);
+            crossings[i].push_back(Boundary_Crossing{Coord{latitude, longitude}, before, after});
+        }
+    });
+    // A frontier crossing scan lines at 70° moves by less than 3 steps from one line to the next.
+    result.polylines = join_crossings(crossings, request.scan, 3 * request.step);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+} // namespace vp
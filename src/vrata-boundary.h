@@ -0,0 +1,95 @@
+#ifndef VP_VRATA_BOUNDARY_H
+#define VP_VRATA_BOUNDARY_H
+
+#include "calc-flags.h"
+#include "location.h"
+#include "process-pool.h"
+#include "vrata.h"
+
+#include <vector>
+
+namespace vp {
+
+/*
+ * Frontiers where the next vrata after base_date changes its date or type,
+ * e.g. where daśamī-viddha at ativṛddhāditvam_timepoint() starts to push the
+ * fast to the next day, or where atirikta appears.
+ *
+ * The area is cut into scan lines `step` degrees apart (lines of latitude by
+ * default, or lines of longitude). Each line is sampled every `step` degrees,
+ * and wherever two neighbouring samples disagree the exact crossing is found
+ * by bisection down to `tolerance` degrees. Crossings on neighbouring lines
+ * with the same vratas on both sides are joined into polylines, ready for a
+ * map overlay. Two crossings closer than `step` on the same line can be missed.
+ *
+ * Locations are grid_location()s (see vrata-grid.h). Tithi times are shared
+ * through the event catalog (see Event_Catalog_Scope), so each probe only
+ * calculates local sunrises and sunsets. Scan lines run in parallel, one
+ * Process_Pool task each.
+ */
+enum class Boundary_Scan {
+    Along_Latitudes,  // bisect on longitude
+    Along_Longitudes, // bisect on latitude
+};
+
+struct Boundary_Request {
+    date::local_days base_date;
+    Latitude south{-60.0};
+    Latitude north{60.0};
+    Longitude west{-180.0};
+    Longitude east{180.0};
+    double step = 2.0;        // degrees between scan lines and between samples on a line
+    double tolerance = 0.001; // degrees
+    Boundary_Scan scan = Boundary_Scan::Along_Latitudes;
+    CalcFlags flags = CalcFlags::Default;
+    unsigned workers = Process_Pool::default_worker_count();
+};
+
+// What decides the side of a frontier. Locations where calculation fails
+// (e.g. no sunrise near the poles) form their own "vrata" with ok == false.
+struct Vrata_Key {
+    bool ok = false;
+    date::local_days date;
+    Vrata_Type type = Vrata_Type::Ekadashi;
+};
+bool operator==(const Vrata_Key & one, const Vrata_Key & other);
+bool operator!=(const Vrata_Key & one, const Vrata_Key & other);
+Vrata_Key vrata_key(const MaybeVrata & vrata);
+
+struct Boundary_Crossing {
+    Coord coord;
+    Vrata_Key before; // to the west (south for Along_Longitudes)
+    Vrata_Key after;  // to the east (north)
+};
+
+struct Boundary_Polyline {
+    Vrata_Key before;
+    Vrata_Key after;
+    std::vector<Coord> points; // one per scan line, in scan line order
+};
+
+struct Boundary_Result {
+    std::vector<Boundary_Polyline> polylines;
+    std::size_t probes = 0; // vrata calculations done
+    std::vector<std::string> failures; // scan lines which failed as a whole
+    double seconds = 0.0;
+};
+
+// Throws std::runtime_error on bad bounds, step or tolerance.
+Boundary_Result find_vrata_boundaries(const Boundary_Request & request);
+
+// Crossings on a single scan line, calculated in the current process.
+// `fixed` is the latitude (Along_Latitudes) or longitude of the line, [from, to] is the
+// range of the other coordinate. probes is incremented for each vrata calculation.
+std::vector<Boundary_Crossing> find_crossings_on_line(date::local_days base_date, CalcFlags flags, Boundary_Scan scan,
+                                                      double fixed, double from, double to, double step, double tolerance,
+                                                      std::size_t & probes);
+
+// Join crossings of consecutive scan lines (crossings[i] are on line i) into polylines.
+// A crossing continues a polyline from the previous line when both have the same keys and
+// it's within max_distance degrees along the line; otherwise it starts a new one.
+std::vector<Boundary_Polyline> join_crossings(const std::vector<std::vector<Boundary_Crossing>> & crossings, Boundary_Scan scan, double max_distance);
+
+} // namespace vp
+
+#endif // VP_VRATA_BOUNDARY_H
@@ -0,0 +1,123 @@
+#include "vrata-boundary.h"
+
+#include "text-interface.h"
+#include "vrata-grid.h"
+
+#include "catch-formatters.h"
+
+#include <algorithm>
+
+using namespace date;
+using namespace vp;
+
+namespace {
+
+Vrata_Key key(local_days date, Vrata_Type type = Vrata_Type::Ekadashi) {
+    return Vrata_Key{true, date, type};
+}
+
+Boundary_Crossing crossing(double latitude, double longitude, const Vrata_Key & before, const Vrata_Key & after) {
+    return Boundary_Crossing{Coord{Latitude{latitude}, Longitude{longitude}}, before, after};
+}
+
+} // anonymous namespace
+
+TEST_CASE("Vrata_Key compares date and type, and all failures are the same") {
+    const auto day = local_days{2020_y/January/6};
+    REQUIRE(key(day) == key(day));
+    REQUIRE(key(day) != key(day + days{1}));
+    REQUIRE(key(day) != key(day, Vrata_Type::With_Atirikta_Dvadashi));
+    REQUIRE(Vrata_Key{} == Vrata_Key{false, day, Vrata_Type::With_Atirikta_Ekadashi});
+    REQUIRE(Vrata_Key{} != key(day));
+}
+
+TEST_CASE("join_crossings() links crossings with the same sides on consecutive lines") {
+    const auto a = key(local_days{2020_y/January/6});
+    const auto b = key(local_days{2020_y/January/7});
+    const auto c = key(local_days{2020_y/January/7}, Vrata_Type::With_Atirikta_Dvadashi);
+    const std::vector<std::vector<Boundary_Crossing>> crossings{
+        {crossing(0, -30.0, a, b), crossing(0, 40.0, b, c)},
+        {crossing(2, -31.5, a, b), crossing(2, 41.0, b, c)},
+        {crossing(4, -33.0, a, b)},                 // b|c frontier ends here
+        {crossing(6, -34.0, a, b), crossing(6, 45.0, b, c)}, // ... and a new one starts
+        {crossing(8, 10.0, a, b)},                  // too far from the a|b one
+    };
+    const auto polylines = join_crossings(crossings, Boundary_Scan::Along_Latitudes, 6.0);
+    REQUIRE(polylines.size() == 4);
+
+    REQUIRE(polylines[0].before == a);
+    REQUIRE(polylines[0].after == b);
+    REQUIRE(polylines[0].points.size() == 4);
+    REQUIRE(polylines[0].points[3].longitude == Longitude{-34.0});
+
+    REQUIRE(polylines[1].before == b);
+    REQUIRE(polylines[1].after == c);
+    REQUIRE(polylines[1].points.size() == 2);
+
+    REQUIRE(polylines[2].points.size() == 1);
+    REQUIRE(polylines[2].points[0].longitude == Longitude{45.0});
+
+    REQUIRE(polylines[3].points.size() == 1);
+    REQUIRE(polylines[3].points[0].latitude == Latitude{8.0});
+}
+
+TEST_CASE("join_crossings() gives each crossing to the nearest polyline only once") {
+    const auto a = key(local_days{2020_y/January/6});
+    const auto b = key(local_days{2020_y/January/7});
+    const std::vector<std::vector<Boundary_Crossing>> crossings{
+        {crossing(10.0, 0, a, b), crossing(20.0, 0, a, b)},
+        {crossing(19.0, 2, a, b), crossing(11.0, 2, a, b)},
+    };
+    const auto polylines = join_crossings(crossings, Boundary_Scan::Along_Longitudes, 5.0);
+    REQUIRE(polylines.size() == 2);
+    REQUIRE(polylines[0].points.size() == 2);
+    REQUIRE(polylines[0].points[1].latitude == Latitude{11.0});
+    REQUIRE(polylines[1].points.size() == 2);
+    REQUIRE(polylines[1].points[1].latitude == Latitude{19.0});
+}
+
+TEST_CASE("find_vrata_boundaries() rejects bad bounds") {
+    Boundary_Request request;
+    request.base_date = local_days{2020_y/January/1};
+    request.tolerance = 0.0;
+    REQUIRE_THROWS_WITH(find_vrata_boundaries(request), Catch::Contains("bad boundary"));
+    request.tolerance = 0.001;
+    request.west = Longitude{10.0};
+    request.east = Longitude{-10.0};
+    REQUIRE_THROWS_WITH(find_vrata_boundaries(request), Catch::Contains("bad boundary"));
+}
+
+TEST_CASE("find_crossings_on_line() finds where the vrata changes, to within tolerance") {
+    const auto base_date = local_days{2020_y/January/1};
+    const double latitude = 20.0;
+    const double tolerance = 0.01;
+    std::size_t probes = 0;
+    const auto crossings = find_crossings_on_line(base_date, CalcFlags::Default, Boundary_Scan::Along_Latitudes,
+                                                  latitude, -180.0, 180.0, 5.0, tolerance, probes);
+    REQUIRE(probes >= 73); // every 5 degrees, both ends included, plus bisection
+    // Pauṣa Putradā Ekādaśī is on January 6 in India and a day later further east,
+    // so the line must cross at least one frontier.
+    REQUIRE(!crossings.empty());
+    const auto india = text_ui::calc_one(base_date, grid_location(Coord{Latitude{latitude}, Longitude{77.0}}));
+    REQUIRE(india);
+    REQUIRE(india->date == local_days{2020_y/January/6});
+    // crossings go from west to east, each one starting on the side where the previous one ended
+    REQUIRE(crossings.front().before == vrata_key(text_ui::calc_one(base_date, grid_location(Coord{Latitude{latitude}, Longitude{-180.0}}))));
+    REQUIRE(crossings.back().after == vrata_key(text_ui::calc_one(base_date, grid_location(Coord{Latitude{latitude}, Longitude{180.0}}))));
+    for (std::size_t i = 1; i < crossings.size(); ++i) {
+        REQUIRE(crossings[i].coord.longitude > crossings[i-1].coord.longitude);
+        REQUIRE(crossings[i].before == crossings[i-1].after);
+    }
+    const bool leaves_india_date = std::any_of(crossings.begin(), crossings.end(), [&](const Boundary_Crossing & c) {
+        return c.before == vrata_key(india) && c.coord.longitude.longitude > 77.0;
+    });
+    REQUIRE(leaves_india_date);
+    for (const auto & c : crossings) {
+        REQUIRE(c.before != c.after);
+        const auto longitude = c.coord.longitude.longitude;
+        const auto west = text_ui::calc_one(base_date, grid_location(Coord{Latitude{latitude}, Longitude{longitude - tolerance}}));
+        const auto east = text_ui::calc_one(base_date, grid_location(Coord{Latitude{latitude}, Longitude{longitude + tolerance}}));
+        REQUIRE(vrata_key(west) == c.before);
+        REQUIRE(vrata_key(east) == c.after);
+    }
+}
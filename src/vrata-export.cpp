@@ -0,0 +1,253 @@
+#include "vrata-export.h"
+
+#include "daybyday-record.h"
+#include "json-writer.h"
+#include "vrata-json.h"
+#include "vrata-record.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace vp {
+
+std::optional<Export_Format> parse_export_format(std::string_view name) {
+    if (name == "ndjson") return Export_Format::Ndjson;
+    if (name == "csv") return Export_Format::Csv;
+    if (name == "bin") return Export_Format::Bin;
+    return std::nullopt;
+}
+
+namespace {
+
+enum class Record_Kind : std::uint8_t {
+    Vrata = 1,
+    DayByDay = 2,
+};
+
+// One CSV line written field by field straight into the output buffer.
+// Fields are quoted only when they contain separators, quotes or line breaks.
+class Csv_Line {
+public:
+    explicit Csv_Line(fmt::memory_buffer & out) : out_(out) {}
+
+    Csv_Line & field(std::string_view s) {
+        separator();
+        if (std::any_of(s.begin(), s.end(), needs_quotes)) {
+            write_quoted(s);
+        } else {
+            out_.append(s.data(), s.data() + s.size());
+        }
+        return *this;
+    }
+    template<typename... Args>
+    Csv_Line & formatted(fmt::format_string<Args...> format, Args &&... args) {
+        separator();
+        const auto start = out_.size();
+        fmt::format_to(fmt::appender{out_}, format, std::forward<Args>(args)...);
+        quote_from(start);
+        return *this;
+    }
+    // Field appended by write(out), e.g. date or time.
+    template<typename Write>
+    Csv_Line & custom(Write && write) {
+        separator();
+        const auto start = out_.size();
+        write(out_);
+        quote_from(start);
+        return *this;
+    }
+    Csv_Line & empty() {
+        separator();
+        return *this;
+    }
+    void end() {
+        out_.push_back('\n');
+    }
+
+private:
+    static bool needs_quotes(char c) {
+        return c == ',' || c == '"' || c == '\n' || c == '\r';
+    }
+    void separator() {
+        if (!first_) out_.push_back(',');
+        first_ = false;
+    }
+    void write_quoted(std::string_view s) {
+        out_.push_back('"');
+        for (const char c : s) {
+            if (c == '"') out_.push_back('"');
+            out_.push_back(c);
+        }
+        out_.push_back('"');
+    }
+    // Quote the field which was appended from `start` in place, if it needs that.
+    void quote_from(std::size_t start) {
+        if (std::none_of(out_.data() + start, out_.data() + out_.size(), needs_quotes)) return;
+        const std::string raw{out_.data() + start, out_.size() - start};
+        out_.resize(start);
+        write_quoted(raw);
+    }
+
+    fmt::memory_buffer & out_;
+    bool first_ = true;
+};
+
+void write_csv_time(Csv_Line & line, const Time_Zone * time_zone, const std::optional<JulDays_UT> & t) {
+    if (t) {
+        line.custom([&](fmt::memory_buffer & out) { format_iso_local_time(out, time_zone, *t); });
+    } else {
+        line.empty();
+    }
+}
+
+void write_csv_date(Csv_Line & line, date::local_days d) {
+    line.custom([&](fmt::memory_buffer & out) { format_iso_date(out, d); });
+}
+
+void write_csv_vrata_header(fmt::memory_buffer & out) {
+    constexpr std::string_view header =
+        "location,country,latitude,longitude,time_zone,type,name,date,masa,paksha,"
+        "paran_type,paran_date,paran_start,paran_end,sunrise,dates_for_this_paksha,error\n";
+    out.append(header.data(), header.data() + header.size());
+}
+
+void write_csv(fmt::memory_buffer & out, const MaybeVrata & vrata) {
+    Csv_Line line{out};
+    if (!vrata) {
+        for (int i = 0; i < 16; ++i) line.empty();
+        line.formatted("{}", vrata.error());
+        line.end();
+        return;
+    }
+    const auto & location = vrata->location;
+    const auto * time_zone = location.time_zone();
+    line.field(location.name).field(location.country)
+        .formatted("{}", location.latitude.latitude).formatted("{}", location.longitude.longitude)
+        .field(location.time_zone_name)
+        .formatted("{}", vrata->type).field(vrata->ekadashi_name());
+    write_csv_date(line, vrata->date);
+    line.formatted("{}", vrata->masa).formatted("{}", vrata->paksha)
+        .formatted("{}", vrata->paran.type);
+    write_csv_date(line, vrata->local_paran_date());
+    write_csv_time(line, time_zone, vrata->paran.paran_start);
+    write_csv_time(line, time_zone, vrata->paran.paran_end);
+    write_csv_time(line, time_zone, vrata->sunrise1);
+    line.custom([&](fmt::memory_buffer & field) {
+        bool first = true;
+        for (const auto & [date, named_date] : vrata->dates_for_this_paksha) {
+            if (!first) {
+                field.push_back(';');
+                field.push_back(' ');
+            }
+            first = false;
+            format_iso_date(field, date);
+            field.push_back(' ');
+            field.append(named_date.name.data(), named_date.name.data() + named_date.name.size());
+        }
+    });
+    line.empty();
+    line.end();
+}
+
+void write_csv_daybyday_header(fmt::memory_buffer & out) {
+    constexpr std::string_view header = "location,date,time,event\n";
+    out.append(header.data(), header.data() + header.size());
+}
+
+void write_csv(fmt::memory_buffer & out, const text_ui::DayByDayInfo & info) {
+    const auto * time_zone = info.location.time_zone();
+    for (const auto & event : info.events) {
+        Csv_Line line{out};
+        line.field(info.location.name);
+        write_csv_date(line, date::local_days{info.date});
+        write_csv_time(line, time_zone, event.time_point);
+        line.field(event.name);
+        line.end();
+    }
+}
+
+// u8 kind, u32 length (patched in when the record is complete), record
+template<typename Write>
+void write_bin_record(fmt::memory_buffer & out, Record_Kind kind, Write && write) {
+    Record_Writer w{out};
+    w.u8(static_cast<std::uint8_t>(kind));
+    const auto length_at = out.size();
+    w.u32(0);
+    write(w);
+    const auto length = static_cast<std::uint32_t>(out.size() - length_at - 4);
+    fmt::memory_buffer length_buf;
+    Record_Writer{length_buf}.u32(length);
+    std::memcpy(out.data() + length_at, length_buf.data(), 4);
+}
+
+} // anonymous namespace
+
+Record_Exporter::Record_Exporter(Export_Format format, Flush_Fn flush)
+    : format_(format), flush_(std::move(flush))
+{
+}
+
+void Record_Exporter::write(const MaybeVrata & vrata) {
+    switch (format_) {
+    case Export_Format::Ndjson: {
+        Json_Writer w{buf_};
+        write_json(w, vrata);
+        buf_.push_back('\n');
+        break;
+    }
+    case Export_Format::Csv:
+        if (!vrata_header_written_) {
+            write_csv_vrata_header(buf_);
+            vrata_header_written_ = true;
+        }
+        write_csv(buf_, vrata);
+        break;
+    case Export_Format::Bin:
+        write_bin_header_once();
+        write_bin_record(buf_, Record_Kind::Vrata, [&](Record_Writer & w) { write_vrata(w, vrata); });
+        break;
+    }
+    flush();
+}
+
+void Record_Exporter::write(const text_ui::DayByDayInfo & info) {
+    switch (format_) {
+    case Export_Format::Ndjson: {
+        Json_Writer w{buf_};
+        write_json(w, info);
+        buf_.push_back('\n');
+        break;
+    }
+    case Export_Format::Csv:
+        if (!daybyday_header_written_) {
+            write_csv_daybyday_header(buf_);
+            daybyday_header_written_ = true;
+        }
+        write_csv(buf_, info);
+        break;
+    case Export_Format::Bin:
+        write_bin_header_once();
+        write_bin_record(buf_, Record_Kind::DayByDay, [&](Record_Writer & w) { text_ui::write_daybyday(w, info); });
+        break;
+    }
+    flush();
+}
+
+void Record_Exporter::write_bin_header_once() {
+    if (header_written_) return;
+    constexpr std::string_view magic{"VPX1"};
+    buf_.append(magic.data(), magic.data() + magic.size());
+    Record_Writer w{buf_};
+    w.u32(vrata_record_version);
+    w.u32(text_ui::daybyday_record_version);
+    header_written_ = true;
+}
+
+void Record_Exporter::flush() {
+    flush_(std::string_view{buf_.data(), buf_.size()});
+    buf_.clear();
+}
+
+} // namespace vp
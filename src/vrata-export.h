@@ -0,0 +1,60 @@
+#ifndef VP_VRATA_EXPORT_H
+#define VP_VRATA_EXPORT_H
+
+#include "fmt-format-fixed.h"
+#include "text-interface.h"
+#include "vrata.h"
+
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace vp {
+
+enum class Export_Format {
+    Ndjson,
+    Csv,
+    Bin,
+};
+
+// "ndjson", "csv" or "bin"
+std::optional<Export_Format> parse_export_format(std::string_view name);
+
+/*
+ * Machine-readable output of calculation results (--format=...), one record at a time.
+ *
+ * ndjson: one JSON object per line, see vrata-json.h.
+ * csv:    header line before the first record of each kind, then one line
+ *         per vrata or one line per day-by-day event. Named dates of the
+ *         paksha are "YYYY-MM-DD name" joined with "; " in a single column.
+ * bin:    "VPX1", u32 vrata_record_version, u32 daybyday_record_version,
+ *         then for each record: u8 kind (1 = vrata, 2 = day-by-day), u32 length
+ *         and the record itself (see vrata-record.h, daybyday-record.h).
+ *
+ * Each record is written into the same reused buffer and handed to flush()
+ * as soon as it's complete, so memory use doesn't grow with the output size.
+ */
+class Record_Exporter {
+public:
+    using Flush_Fn = std::function<void(std::string_view data)>;
+
+    Record_Exporter(Export_Format format, Flush_Fn flush);
+
+    void write(const MaybeVrata & vrata);
+    void write(const text_ui::DayByDayInfo & info);
+
+private:
+    void write_bin_header_once();
+    void flush();
+
+    Export_Format format_;
+    Flush_Fn flush_;
+    fmt::memory_buffer buf_;
+    bool header_written_ = false;         // bin
+    bool vrata_header_written_ = false;    // csv
+    bool daybyday_header_written_ = false; // csv
+};
+
+} // namespace vp
+
+#endif // VP_VRATA_EXPORT_H
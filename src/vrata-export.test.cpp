@@ -0,0 +1,83 @@
+#include "vrata-export.h"
+
+#include "catch-formatters.h"
+#include "vrata-record.h"
+
+#include <algorithm>
+
+using namespace vp;
+using Catch::Matchers::StartsWith;
+
+namespace {
+std::vector<std::string> export_vratas(Export_Format format, const VratasForDate & vratas) {
+    std::vector<std::string> flushes;
+    Record_Exporter exporter{format, [&](std::string_view data) { flushes.emplace_back(data); }};
+    for (const auto & vrata : vratas) {
+        exporter.write(vrata);
+    }
+    return flushes;
+}
+
+VratasForDate two_vratas() {
+    using namespace date;
+    VratasForDate vratas;
+    vratas.push_back(text_ui::calc_one(local_days{2020_y/November/20}, *text_ui::LocationDb::find_coord("Udupi")));
+    vratas.push_back(tl::make_unexpected(CantFindLocation{"Nowhere"}));
+    return vratas;
+}
+}
+
+TEST_CASE("parse_export_format") {
+    REQUIRE(parse_export_format("ndjson") == Export_Format::Ndjson);
+    REQUIRE(parse_export_format("csv") == Export_Format::Csv);
+    REQUIRE(parse_export_format("bin") == Export_Format::Bin);
+    REQUIRE_FALSE(parse_export_format("xml"));
+}
+
+TEST_CASE("Record_Exporter flushes each record separately") {
+    const auto vratas = two_vratas();
+    REQUIRE(vratas.cbegin()->has_value());
+
+    SECTION("ndjson: one JSON object per line") {
+        const auto flushes = export_vratas(Export_Format::Ndjson, vratas);
+        REQUIRE(flushes.size() == 2);
+        REQUIRE_THAT(flushes[0], StartsWith("{\"location\":{\"name\":\"Udupi\""));
+        REQUIRE(std::count(flushes[0].begin(), flushes[0].end(), '\n') == 1);
+        REQUIRE_THAT(flushes[1], StartsWith("{\"error\":"));
+    }
+
+    SECTION("csv: header once, same number of columns in every line") {
+        const auto flushes = export_vratas(Export_Format::Csv, vratas);
+        REQUIRE(flushes.size() == 2);
+        REQUIRE_THAT(flushes[0], StartsWith("location,country,"));
+        const auto header_end = flushes[0].find('\n');
+        const auto header = flushes[0].substr(0, header_end);
+        const auto line1 = flushes[0].substr(header_end + 1);
+        REQUIRE_THAT(line1, StartsWith("Udupi,India,"));
+        REQUIRE(line1.find(",2020-11-") != std::string::npos);
+        const auto columns = std::count(header.begin(), header.end(), ',');
+        REQUIRE(std::count(flushes[1].begin(), flushes[1].end(), ',') == columns);
+    }
+
+    SECTION("bin: records can be read back") {
+        const auto flushes = export_vratas(Export_Format::Bin, vratas);
+        REQUIRE(flushes.size() == 2);
+        std::string all = flushes[0] + flushes[1];
+        REQUIRE_THAT(all, StartsWith("VPX1"));
+        Record_Reader r{std::string_view{all}.substr(4)};
+        REQUIRE(r.u32() == vrata_record_version);
+        r.u32(); // daybyday_record_version
+        for (const auto & expected : vratas) {
+            REQUIRE(r.u8() == 1);
+            const auto record = r.str();
+            Record_Reader record_reader{record};
+            const auto vrata = read_vrata(record_reader);
+            REQUIRE(record_reader.at_end());
+            REQUIRE(vrata.has_value() == expected.has_value());
+            if (vrata) {
+                REQUIRE(vrata->date == expected->date);
+            }
+        }
+        REQUIRE(r.at_end());
+    }
+}
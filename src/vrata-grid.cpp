@@ -0,0 +1,122 @@
+#include "vrata-grid.h"
+
+#include "binary-record.h"
+#include "event-catalog.h"
+#include "text-interface.h"
+#include "vrata-record.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace vp {
+
+namespace {
+
+const std::array<std::string, 25> & nautical_zone_names() {
+    static const std::array<std::string, 25> names = [] {
+        std::array<std::string, 25> result;
+        for (int offset = -12; offset <= 12; ++offset) {
+            // POSIX-style names: "Etc/GMT-5" is five hours *ahead* of UTC
+            result[static_cast<std::size_t>(offset + 12)] = offset == 0 ? "Etc/GMT" : fmt::format("Etc/GMT{:+}", -offset);
+        }
+        return result;
+    }();
+    return names;
+}
+
+const std::string & nautical_zone(Longitude longitude) {
+    const auto offset = std::clamp(std::lround(longitude.longitude / 15.0), -12l, 12l);
+    return nautical_zone_names()[static_cast<std::size_t>(offset + 12)];
+}
+
+// Runs in the worker process. Task is (u32 flags, i32 base date, f64 latitude,
+// f64 longitude of the first cell, f64 step, u32 cell count), result is
+// u32 cell count followed by that many vrata records.
+void calc_row(std::string_view task, fmt::memory_buffer & out) {
+    Record_Reader r{task};
+    const auto flags = static_cast<CalcFlags>(r.u32());
+    const date::local_days base_date{date::days{r.i32()}};
+    const Latitude latitude{r.f64()};
+    const auto first_longitude = r.f64();
+    const auto step = r.f64();
+    const auto count = r.u32();
+
+    Record_Writer w{out};
+    w.u32(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const Longitude longitude{first_longitude + step * static_cast<double>(i)};
+        write_vrata(w, text_ui::calc_one(base_date, grid_location(Coord{latitude, longitude}), flags));
+    }
+}
+
+} // anonymous namespace
+
+std::string_view nautical_time_zone_name(Longitude longitude)
+{
+    return nautical_zone(longitude);
+}
+
+Location grid_location(Coord coord)
+{
+    return Location{coord.latitude, coord.longitude, "Grid cell", nautical_zone(coord.longitude).c_str()};
+}
+
+Grid_Result calc_grid(const Grid_Request & request, const Grid_Cell_Fn & on_cell)
+{
+    const auto started = std::chrono::steady_clock::now();
+    if (!(request.step > 0.0) || request.north <= request.south || request.east <= request.west
+            || request.south < Latitude{-90.0} || request.north > Latitude{90.0}
+            || request.west < Longitude{-180.0} || request.east > Longitude{180.0}) {
+        throw std::runtime_error(fmt::format("bad grid: {}..{} N, {}..{} E with step {}",
+                                             request.south, request.north, request.west, request.east, request.step));
+    }
+    Grid_Result result;
+    // a tiny tolerance, so that e.g. 0.1° steps don't lose the last row to rounding
+    constexpr double tolerance = 1e-9;
+    result.rows = static_cast<std::size_t>(std::floor((request.north.latitude - request.south.latitude) / request.step + tolerance));
+    result.columns = static_cast<std::size_t>(std::floor((request.east.longitude - request.west.longitude) / request.step + tolerance));
+    if (result.rows == 0 || result.columns == 0) {
+        throw std::runtime_error(fmt::format("grid step {} is larger than the grid itself", request.step));
+    }
+
+    const Event_Catalog_Scope shared_events{request.base_date, request.flags, request.workers};
+
+    const auto first_longitude = request.west.longitude + request.step / 2;
+    std::vector<std::string> tasks;
+    tasks.reserve(result.rows);
+    for (std::size_t row = 0; row < result.rows; ++row) {
+        fmt::memory_buffer buf;
+        Record_Writer w{buf};
+        w.u32(static_cast<std::uint32_t>(request.flags));
+        w.i32(static_cast<std::int32_t>(request.base_date.time_since_epoch().count()));
+        w.f64(request.north.latitude - request.step * (static_cast<double>(row) + 0.5));
+        w.f64(first_longitude);
+        w.f64(request.step);
+        w.u32(static_cast<std::uint32_t>(result.columns));
+        tasks.push_back(fmt::to_string(buf));
+    }
+
+    Process_Pool pool{request.workers, calc_row};
+    pool.run(tasks, [&](std::size_t row, Process_Pool::Task_Result && task_result) {
+        const Latitude latitude{request.north.latitude - request.step * (static_cast<double>(row) + 0.5)};
+        if (!task_result.ok) {
+            result.failures.push_back(fmt::format("row at {}: {}", latitude, task_result.data));
+            return;
+        }
+        Record_Reader r{task_result.data};
+        const auto count = r.u32();
+        for (std::uint32_t column = 0; column < count; ++column) {
+            Grid_Cell cell{Coord{latitude, Longitude{first_longitude + request.step * static_cast<double>(column)}}, read_vrata(r)};
+            if (!cell.vrata) ++result.errors;
+            on_cell(std::move(cell));
+        }
+    });
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+} // namespace vp
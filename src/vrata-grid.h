@@ -0,0 +1,68 @@
+#ifndef VP_VRATA_GRID_H
+#define VP_VRATA_GRID_H
+
+#include "calc-flags.h"
+#include "location.h"
+#include "process-pool.h"
+#include "vrata.h"
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace vp {
+
+/*
+ * Map of the next vrata after base_date over a latitude/longitude grid:
+ * which places fast on which date, with which vrata type and pāraṇam.
+ *
+ * Cells are step×step degrees, each is calculated at its center, rows go
+ * from north to south, cells in a row from west to east. Local dates need a
+ * time zone, so each cell gets the nautical zone of its longitude
+ * ("Etc/GMT-5" for 67.5°E..82.5°E etc.), not the civil one of whatever
+ * country happens to be there.
+ *
+ * Tithi, nakṣatra and saṅkrānti times are the same everywhere, so they are
+ * found once for the whole grid (see event-catalog.h) and shared with all
+ * worker processes; each cell only has to calculate its own sunrises and sunsets.
+ * One grid row is one Process_Pool task.
+ */
+struct Grid_Request {
+    date::local_days base_date;
+    double step = 1.0; // degrees
+    Latitude south{-90.0};
+    Latitude north{90.0};
+    Longitude west{-180.0};
+    Longitude east{180.0};
+    CalcFlags flags = CalcFlags::Default;
+    unsigned workers = Process_Pool::default_worker_count();
+};
+
+struct Grid_Cell {
+    Coord center;
+    MaybeVrata vrata;
+};
+
+struct Grid_Result {
+    std::size_t rows = 0;
+    std::size_t columns = 0;
+    std::size_t errors = 0;
+    // Rows which failed as a whole (e.g. worker process crashed).
+    std::vector<std::string> failures;
+    double seconds = 0.0;
+};
+
+// Called in the parent process for each cell, in grid order.
+using Grid_Cell_Fn = std::function<void(Grid_Cell && cell)>;
+
+// Throws std::runtime_error on bad grid bounds.
+Grid_Result calc_grid(const Grid_Request & request, const Grid_Cell_Fn & on_cell);
+
+// Nautical time zone for the longitude, e.g. "Etc/GMT-5" for 75°E.
+std::string_view nautical_time_zone_name(Longitude longitude);
+// Unnamed location in the nautical time zone, the way grid cells are calculated.
+Location grid_location(Coord coord);
+
+} // namespace vp
+
+#endif // VP_VRATA_GRID_H
@@ -0,0 +1,66 @@
+#include "vrata-grid.h"
+
+#include "text-interface.h"
+
+#include "catch-formatters.h"
+
+using namespace date;
+using namespace vp;
+
+TEST_CASE("nautical_time_zone_name() uses POSIX sign convention and 15-degree bands") {
+    REQUIRE(nautical_time_zone_name(Longitude{0.0}) == "Etc/GMT");
+    REQUIRE(nautical_time_zone_name(Longitude{7.4}) == "Etc/GMT");
+    REQUIRE(nautical_time_zone_name(Longitude{77.2}) == "Etc/GMT-5");
+    REQUIRE(nautical_time_zone_name(Longitude{-74.0}) == "Etc/GMT+5");
+    REQUIRE(nautical_time_zone_name(Longitude{180.0}) == "Etc/GMT-12");
+    REQUIRE(nautical_time_zone_name(Longitude{-180.0}) == "Etc/GMT+12");
+}
+
+TEST_CASE("calc_grid() rejects bad bounds") {
+    Grid_Request request;
+    request.base_date = local_days{2020_y/January/1};
+    request.step = 0.0;
+    REQUIRE_THROWS_WITH(calc_grid(request, [](Grid_Cell &&) {}), Catch::Contains("bad grid"));
+    request.step = 1.0;
+    request.south = Latitude{10.0};
+    request.north = Latitude{5.0};
+    REQUIRE_THROWS_WITH(calc_grid(request, [](Grid_Cell &&) {}), Catch::Contains("bad grid"));
+    request.north = Latitude{10.5};
+    REQUIRE_THROWS_WITH(calc_grid(request, [](Grid_Cell &&) {}), Catch::Contains("larger than the grid"));
+}
+
+TEST_CASE("calc_grid() gives the same vratas as separate calc_one() calls, north to south, west to east") {
+    Grid_Request request;
+    request.base_date = local_days{2020_y/January/1};
+    request.step = 10.0;
+    request.south = Latitude{0.0};
+    request.north = Latitude{20.0};
+    request.west = Longitude{60.0};
+    request.east = Longitude{90.0};
+    request.workers = 2;
+
+    std::vector<Grid_Cell> cells;
+    const auto result = calc_grid(request, [&](Grid_Cell && cell) { cells.push_back(std::move(cell)); });
+    REQUIRE(result.rows == 2);
+    REQUIRE(result.columns == 3);
+    REQUIRE(result.errors == 0);
+    REQUIRE(result.failures.empty());
+    REQUIRE(cells.size() == 6);
+    REQUIRE(cells[0].center.latitude == Latitude{15.0});
+    REQUIRE(cells[0].center.longitude == Longitude{65.0});
+    REQUIRE(cells[5].center.latitude == Latitude{5.0});
+    REQUIRE(cells[5].center.longitude == Longitude{85.0});
+
+    for (const auto & cell : cells) {
+        const auto expected = text_ui::calc_one(request.base_date, grid_location(cell.center), request.flags);
+        REQUIRE(cell.vrata.has_value());
+        REQUIRE(expected.has_value());
+        REQUIRE(cell.vrata->date == expected->date);
+        REQUIRE(cell.vrata->type == expected->type);
+        REQUIRE(cell.vrata->paran.paran_start.has_value() == expected->paran.paran_start.has_value());
+        if (expected->paran.paran_start) {
+            // shared tithi times come from the catalog, rounded to milliseconds
+            REQUIRE(cell.vrata->paran.paran_start->raw_julian_days_ut().count() == Approx(expected->paran.paran_start->raw_julian_days_ut().count()).margin(1e-6));
+        }
+    }
+}
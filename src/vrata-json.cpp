@@ -0,0 +1,154 @@
+#include "vrata-json.h"
+
+#include "tz-fixed.h"
+
+namespace vp {
+
+void format_iso_date(fmt::memory_buffer & out, date::local_days d) {
+    const date::year_month_day ymd{d};
+    fmt::format_to(fmt::appender{out}, FMT_STRING("{:04}-{:02}-{:02}"),
+                   static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()));
+}
+
+// Same as date::format("%FT%T%Ez", make_zoned(time_zone, t.round_to_second())), but without going through iostreams.
+void format_iso_local_time(fmt::memory_buffer & out, const Time_Zone * time_zone, JulDays_UT t) {
+    const auto utc = t.round_to_second();
+    const auto offset = time_zone->offset(utc);
+    const auto local = date::local_seconds{utc.time_since_epoch() + offset};
+    const auto day = date::floor<date::days>(local);
+    format_iso_date(out, day);
+    const date::hh_mm_ss<std::chrono::seconds> time{local - day};
+    const auto offset_minutes = std::chrono::duration_cast<std::chrono::minutes>(offset).count();
+    const auto abs_offset_minutes = offset_minutes < 0 ? -offset_minutes : offset_minutes;
+    fmt::format_to(fmt::appender{out}, FMT_STRING("T{:02}:{:02}:{:02}{}{:02}:{:02}"),
+                   time.hours().count(), time.minutes().count(), time.seconds().count(),
+                   offset_minutes < 0 ? '-' : '+', abs_offset_minutes / 60, abs_offset_minutes % 60);
+}
+
+namespace {
+
+void write_time(Json_Writer & w, const Time_Zone * time_zone, const std::optional<JulDays_UT> & t) {
+    if (t) {
+        w.raw_string([&](fmt::memory_buffer & out) { format_iso_local_time(out, time_zone, *t); });
+    } else {
+        w.null();
+    }
+}
+
+void write_date(Json_Writer & w, date::local_days d) {
+    w.raw_string([&](fmt::memory_buffer & out) { format_iso_date(out, d); });
+}
+
+} // anonymous namespace
+
+void write_json(Json_Writer & w, const Location & location) {
+    w.begin_object();
+    w.key("name").value(location.name);
+    w.key("country").value(location.country);
+    w.key("latitude").value(location.latitude.latitude);
+    w.key("longitude").value(location.longitude.longitude);
+    w.key("time_zone").value(location.time_zone_name);
+    w.key("latitude_adjusted").value(location.latitude_adjusted);
+    w.end_object();
+}
+
+void write_json(Json_Writer & w, const MaybeVrata & vrata) {
+    w.begin_object();
+    if (!vrata) {
+        w.key("error").formatted_value("{}", vrata.error());
+        w.end_object();
+        return;
+    }
+    const auto * time_zone = vrata->location.time_zone();
+    w.key("location");
+    write_json(w, vrata->location);
+    w.key("type").formatted_value("{}", vrata->type);
+    w.key("name").value(vrata->ekadashi_name());
+    w.key("date");
+    write_date(w, vrata->date);
+    if (is_atirikta(vrata->type)) {
+        w.key("date2");
+        write_date(w, vrata->date + date::days{1});
+    }
+    w.key("masa").formatted_value("{}", vrata->masa);
+    w.key("paksha").formatted_value("{}", vrata->paksha);
+    w.key("paran").begin_object();
+    w.key("type").formatted_value("{}", vrata->paran.type);
+    w.key("date");
+    write_date(w, vrata->local_paran_date());
+    w.key("start");
+    write_time(w, time_zone, vrata->paran.paran_start);
+    w.key("end");
+    write_time(w, time_zone, vrata->paran.paran_end);
+    w.end_object();
+    w.key("sunrise");
+    write_time(w, time_zone, vrata->sunrise1);
+    w.key("dates_for_this_paksha").begin_array();
+    for (const auto & [date, named_date] : vrata->dates_for_this_paksha) {
+        w.begin_object();
+        w.key("date");
+        write_date(w, date);
+        w.key("name").value(named_date.name);
+        w.key("title").value(named_date.title);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+}
+
+void write_json(Json_Writer & w, const VratasForDate & vratas) {
+    w.begin_array();
+    for (const auto & vrata : vratas) {
+        write_json(w, vrata);
+    }
+    w.end_array();
+}
+
+void write_json(Json_Writer & w, const text_ui::DayByDayInfo & info) {
+    const auto * time_zone = info.location.time_zone();
+    w.begin_object();
+    w.key("location");
+    write_json(w, info.location);
+    w.key("date");
+    write_date(w, date::local_days{info.date});
+    w.key("sunrise");
+    write_time(w, time_zone, info.sunrise1);
+    w.key("sunset");
+    write_time(w, time_zone, info.sunset1);
+    w.key("next_sunrise");
+    write_time(w, time_zone, info.sunrise2);
+    w.key("saura_masa").formatted_value("{}", info.saura_masa);
+    w.key("saura_masa_until");
+    write_time(w, time_zone, info.saura_masa_until);
+    w.key("chandra_masa").formatted_value("{}", info.chandra_masa);
+    w.key("chandra_masa_until");
+    write_time(w, time_zone, info.chandra_masa_until);
+    w.key("tithis").begin_array();
+    for (const auto & [tithi, until] : {std::pair{info.tithi, info.tithi_until}, std::pair{info.tithi2, info.tithi2_until}}) {
+        if (tithi == DiscreteTithi::Unknown()) continue;
+        w.begin_object().key("name").formatted_value("{}", tithi).key("until");
+        write_time(w, time_zone, until);
+        w.end_object();
+    }
+    w.end_array();
+    w.key("nakshatras").begin_array();
+    for (const auto & [nakshatra, until] : {std::pair{info.nakshatra, info.nakshatra_until}, std::pair{info.nakshatra2, info.nakshatra2_until}}) {
+        if (nakshatra == DiscreteNakshatra::Unknown()) continue;
+        w.begin_object().key("name").formatted_value("{}", nakshatra).key("until");
+        write_time(w, time_zone, until);
+        w.end_object();
+    }
+    w.end_array();
+    w.key("events").begin_array();
+    for (const auto & event : info.events) {
+        w.begin_object();
+        w.key("time");
+        write_time(w, time_zone, event.time_point);
+        w.key("name").value(event.name);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+}
+
+} // namespace vp
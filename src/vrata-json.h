@@ -0,0 +1,27 @@
+#ifndef VP_VRATA_JSON_H
+#define VP_VRATA_JSON_H
+
+#include "json-writer.h"
+#include "text-interface.h"
+#include "vrata.h"
+
+namespace vp {
+
+/*
+ * JSON representation of calculation results for API clients.
+ * Dates are "YYYY-MM-DD", time points are ISO 8601 local times with UTC
+ * offset of the location's time zone, e.g. "2020-01-07T08:12:34+02:00".
+ * Errors are {"error": "..."} in place of the vrata.
+ */
+// "YYYY-MM-DD" and "YYYY-MM-DDTHH:MM:SS+HH:MM", appended without temporary strings.
+void format_iso_date(fmt::memory_buffer & out, date::local_days d);
+void format_iso_local_time(fmt::memory_buffer & out, const Time_Zone * time_zone, JulDays_UT t);
+
+void write_json(Json_Writer & w, const Location & location);
+void write_json(Json_Writer & w, const MaybeVrata & vrata);
+void write_json(Json_Writer & w, const VratasForDate & vratas);
+void write_json(Json_Writer & w, const text_ui::DayByDayInfo & info);
+
+} // namespace vp
+
+#endif // VP_VRATA_JSON_H
@@ -0,0 +1,243 @@
+#include "vrata-record.h"
+
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace vp {
+
+namespace {
+
+// Location keeps its strings as string_views, so decoded names must live
+// somewhere. Same names come again and again, so keep exactly one copy of each.
+const char * interned(std::string_view s) {
+    static std::mutex mutex;
+    static std::set<std::string, std::less<>> strings;
+    std::lock_guard<std::mutex> lock{mutex};
+    auto found = strings.find(s);
+    if (found == strings.end()) {
+        found = strings.emplace(s).first;
+    }
+    return found->c_str();
+}
+
+void write_local_days(Record_Writer & w, date::local_days d) {
+    w.i32(static_cast<std::int32_t>(d.time_since_epoch().count()));
+}
+
+date::local_days read_local_days(Record_Reader & r) {
+    return date::local_days{date::days{r.i32()}};
+}
+
+void write_paran(Record_Writer & w, const Paran & paran) {
+    w.u8(static_cast<std::uint8_t>(paran.type));
+    write_optional_juldays(w, paran.paran_start);
+    write_optional_juldays(w, paran.paran_end);
+    write_optional_juldays(w, paran.paran_limit);
+    w.str(paran.time_zone ? std::string_view{paran.time_zone->name()} : std::string_view{});
+}
+
+Paran read_paran(Record_Reader & r) {
+    const auto type = static_cast<Paran::Type>(r.u8());
+    const auto start = read_optional_juldays(r);
+    const auto end = read_optional_juldays(r);
+    const auto limit = read_optional_juldays(r);
+    const auto time_zone_name = r.str();
+    const Time_Zone * time_zone = time_zone_name.empty() ? nullptr : locate_time_zone(time_zone_name);
+    return Paran{type, start, end, limit, time_zone};
+}
+
+void write_time_points(Record_Writer & w, const Vrata_Time_Points & times) {
+    write_juldays(w, times.ativrddha_54gh_40vigh);
+    write_juldays(w, times.vrddha_55gh);
+    write_juldays(w, times.samyam_55gh_50vigh);
+    write_juldays(w, times.hrasva_55gh_55vigh);
+    write_juldays(w, times.arunodaya);
+    write_juldays(w, times.dashami_start);
+    write_juldays(w, times.ekadashi_start);
+    write_juldays(w, times.dvadashi_start);
+    write_juldays(w, times.trayodashi_start);
+}
+
+Vrata_Time_Points read_time_points(Record_Reader & r) {
+    // Evaluation order of braced initializer elements is guaranteed left-to-right.
+    return Vrata_Time_Points{
+        read_juldays(r),
+        read_juldays(r),
+        read_juldays(r),
+        read_juldays(r),
+        read_juldays(r),
+        read_juldays(r),
+        read_juldays(r),
+        read_juldays(r),
+        read_juldays(r),
+    };
+}
+
+enum class Record_Tag : std::uint8_t {
+    Vrata = 0,
+    Error = 1,
+};
+
+} // anonymous namespace
+
+void write_juldays(Record_Writer & w, JulDays_UT t) {
+    w.f64(t.raw_julian_days_ut().count());
+}
+
+JulDays_UT read_juldays(Record_Reader & r) {
+    return JulDays_UT{double_days{r.f64()}};
+}
+
+void write_optional_juldays(Record_Writer & w, const std::optional<JulDays_UT> & t) {
+    w.u8(t.has_value() ? 1 : 0);
+    if (t) {
+        write_juldays(w, *t);
+    }
+}
+
+std::optional<JulDays_UT> read_optional_juldays(Record_Reader & r) {
+    if (r.u8() == 0) {
+        return std::nullopt;
+    }
+    return read_juldays(r);
+}
+
+void write_location(Record_Writer & w, const Location & location) {
+    w.f64(location.latitude.latitude);
+    w.f64(location.longitude.longitude);
+    w.str(location.name);
+    w.str(location.time_zone_name);
+    w.str(location.country);
+    w.u8(location.latitude_adjusted ? 1 : 0);
+}
+
+Location read_location(Record_Reader & r) {
+    const auto latitude = r.f64();
+    const auto longitude = r.f64();
+    const auto name = interned(r.str());
+    const auto time_zone_name = interned(r.str());
+    const auto country = interned(r.str());
+    Location location{Latitude{latitude}, Longitude{longitude}, name, time_zone_name, country};
+    location.latitude_adjusted = r.u8() != 0;
+    return location;
+}
+
+void write_named_dates(Record_Writer & w, const NamedDates & dates) {
+    w.u32(static_cast<std::uint32_t>(dates.size()));
+    for (const auto & [date, named_date] : dates) {
+        write_local_days(w, date);
+        w.str(named_date.name);
+        w.str(named_date.title);
+        w.str(named_date.css_classes);
+    }
+}
+
+NamedDates read_named_dates(Record_Reader & r) {
+    NamedDates dates;
+    const auto count = r.u32();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const auto date = read_local_days(r);
+        std::string name{r.str()};
+        std::string title{r.str()};
+        std::string css_classes{r.str()};
+        dates.emplace(date, NamedDate{std::move(name), std::move(title), std::move(css_classes)});
+    }
+    return dates;
+}
+
+void write_calc_error(Record_Writer & w, const CalcError & error) {
+    w.u8(static_cast<std::uint8_t>(error.index()));
+    if (const auto * e = std::get_if<CantFindSunriseAfter>(&error)) {
+        write_juldays(w, e->after);
+    } else if (const auto * e2 = std::get_if<CantFindSunriseBefore>(&error)) {
+        write_juldays(w, e2->before);
+    } else if (const auto * e3 = std::get_if<CantFindSunsetAfter>(&error)) {
+        write_juldays(w, e3->after);
+    } else if (const auto * e4 = std::get_if<CantFindLocation>(&error)) {
+        w.str(e4->location_name);
+    }
+    // NoRohiniAshtamiIntersectionForJayanti and NoJayantiOnThisHalfMasa have no fields
+}
+
+CalcError read_calc_error(Record_Reader & r) {
+    const auto index = r.u8();
+    switch (index) {
+    case 0: return CantFindSunriseAfter{read_juldays(r)};
+    case 1: return CantFindSunriseBefore{read_juldays(r)};
+    case 2: return CantFindSunsetAfter{read_juldays(r)};
+    case 3: return CantFindLocation{std::string{r.str()}};
+    case 4: return NoRohiniAshtamiIntersectionForJayanti{};
+    case 5: return NoJayantiOnThisHalfMasa{};
+    }
+    throw std::runtime_error(fmt::format("unknown CalcError index {} in binary record", index));
+}
+
+void write_vrata(Record_Writer & w, const MaybeVrata & vrata) {
+    if (!vrata) {
+        w.u8(static_cast<std::uint8_t>(Record_Tag::Error));
+        write_calc_error(w, vrata.error());
+        return;
+    }
+    w.u8(static_cast<std::uint8_t>(Record_Tag::Vrata));
+    w.u8(static_cast<std::uint8_t>(vrata->type));
+    write_local_days(w, vrata->date);
+    w.u8(static_cast<std::uint8_t>(vrata->masa));
+    w.u8(static_cast<std::uint8_t>(vrata->paksha));
+    write_paran(w, vrata->paran);
+    write_location(w, vrata->location);
+    write_time_points(w, vrata->times);
+    write_optional_juldays(w, vrata->sunrise0);
+    write_juldays(w, vrata->sunset0);
+    write_juldays(w, vrata->sunrise1);
+    write_juldays(w, vrata->sunrise2);
+    write_juldays(w, vrata->sunset2);
+    write_juldays(w, vrata->sunrise3);
+    write_juldays(w, vrata->sunset3);
+    write_named_dates(w, vrata->dates_for_this_paksha);
+}
+
+MaybeVrata read_vrata(Record_Reader & r) {
+    const auto tag = static_cast<Record_Tag>(r.u8());
+    if (tag == Record_Tag::Error) {
+        return tl::make_unexpected(read_calc_error(r));
+    }
+    if (tag != Record_Tag::Vrata) {
+        throw std::runtime_error(fmt::format("unknown record tag {} in binary vrata record", static_cast<int>(tag)));
+    }
+    Vrata vrata;
+    vrata.type = static_cast<Vrata_Type>(r.u8());
+    vrata.date = read_local_days(r);
+    vrata.masa = static_cast<Chandra_Masa>(r.u8());
+    vrata.paksha = static_cast<Paksha>(r.u8());
+    vrata.paran = read_paran(r);
+    vrata.location = read_location(r);
+    vrata.times = read_time_points(r);
+    vrata.sunrise0 = read_optional_juldays(r);
+    vrata.sunset0 = read_juldays(r);
+    vrata.sunrise1 = read_juldays(r);
+    vrata.sunrise2 = read_juldays(r);
+    vrata.sunset2 = read_juldays(r);
+    vrata.sunrise3 = read_juldays(r);
+    vrata.sunset3 = read_juldays(r);
+    vrata.dates_for_this_paksha = read_named_dates(r);
+    return vrata;
+}
+
+void write_vratas(Record_Writer & w, const VratasForDate & vratas) {
+    w.u32(static_cast<std::uint32_t>(vratas.size()));
+    for (const auto & vrata : vratas) {
+        write_vrata(w, vrata);
+    }
+}
+
+VratasForDate read_vratas(Record_Reader & r) {
+    VratasForDate vratas;
+    const auto count = r.u32();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        vratas.push_back(read_vrata(r));
+    }
+    return vratas;
+}
+
+} // namespace vp
@@ -0,0 +1,46 @@
+#ifndef VP_VRATA_RECORD_H
+#define VP_VRATA_RECORD_H
+
+#include "binary-record.h"
+#include "vrata.h"
+
+#include <optional>
+
+namespace vp {
+
+/*
+ * Compact binary (de)serialization of Vrata and its parts. Used to pass
+ * results between processes and to store them on disk, so the decoded
+ * value must be usable exactly like a freshly calculated one: string_views
+ * in Location point to interned strings which live until program exit,
+ * time zones are looked up again by name.
+ *
+ * Bump vrata_record_version whenever the layout changes.
+ */
+constexpr std::uint32_t vrata_record_version = 1;
+
+void write_juldays(Record_Writer & w, JulDays_UT t);
+JulDays_UT read_juldays(Record_Reader & r);
+
+void write_optional_juldays(Record_Writer & w, const std::optional<JulDays_UT> & t);
+std::optional<JulDays_UT> read_optional_juldays(Record_Reader & r);
+
+void write_location(Record_Writer & w, const Location & location);
+Location read_location(Record_Reader & r);
+
+void write_named_dates(Record_Writer & w, const NamedDates & dates);
+NamedDates read_named_dates(Record_Reader & r);
+
+void write_calc_error(Record_Writer & w, const CalcError & error);
+CalcError read_calc_error(Record_Reader & r);
+
+void write_vrata(Record_Writer & w, const MaybeVrata & vrata);
+MaybeVrata read_vrata(Record_Reader & r);
+
+// u32 count followed by that many vrata records
+void write_vratas(Record_Writer & w, const VratasForDate & vratas);
+VratasForDate read_vratas(Record_Reader & r);
+
+} // namespace vp
+
+#endif // VP_VRATA_RECORD_H
@@ -0,0 +1,91 @@
+#include "vrata-record.h"
+
+#include "catch-formatters.h"
+#include "date-fixed.h"
+#include "location.h"
+
+using namespace date;
+using namespace vp;
+
+namespace {
+MaybeVrata round_trip(const MaybeVrata & vrata) {
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    write_vrata(w, vrata);
+    Record_Reader r{std::string_view{buf.data(), buf.size()}};
+    auto decoded = read_vrata(r);
+    REQUIRE(r.at_end());
+    return decoded;
+}
+}
+
+TEST_CASE("Record_Writer and Record_Reader round-trip primitive values") {
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    w.u8(0xAB);
+    w.u32(0xDEADBEEF);
+    w.i32(-12345);
+    w.f64(2459000.5);
+    w.str("Ekādaśī");
+    REQUIRE(buf.size() == 1 + 4 + 4 + 8 + 4 + std::string_view{"Ekādaśī"}.size());
+
+    Record_Reader r{std::string_view{buf.data(), buf.size()}};
+    REQUIRE(r.u8() == 0xAB);
+    REQUIRE(r.u32() == 0xDEADBEEF);
+    REQUIRE(r.i32() == -12345);
+    REQUIRE(r.f64() == 2459000.5);
+    REQUIRE(r.str() == "Ekādaśī");
+    REQUIRE(r.at_end());
+}
+
+TEST_CASE("Record_Writer writes little-endian integers") {
+    fmt::memory_buffer buf;
+    Record_Writer w{buf};
+    w.u32(0x01020304);
+    REQUIRE(std::string_view{buf.data(), buf.size()} == std::string_view{"\x04\x03\x02\x01", 4});
+}
+
+TEST_CASE("Record_Reader throws on truncated data") {
+    Record_Reader r{std::string_view{"\x01\x02", 2}};
+    REQUIRE_THROWS_AS(r.u32(), std::runtime_error);
+}
+
+TEST_CASE("Vrata survives binary round-trip") {
+    auto vrata = Vrata::SampleVrata();
+    vrata.location = kiev_coord;
+    vrata.location.latitude_adjusted = true;
+    vrata.paran = Paran{Paran::Type::Puccha_Dvadashi, vrata.sunrise2, vrata.sunset2, vrata.sunset2, kiev_coord.time_zone()};
+    vrata.dates_for_this_paksha.emplace(vrata.date + days{1}, NamedDate{"Śrī Varāha Dvādaśī", "title", "vrata custom"});
+
+    const auto decoded = round_trip(vrata);
+
+    REQUIRE(decoded.has_value());
+    REQUIRE(decoded->type == vrata.type);
+    REQUIRE(decoded->date == vrata.date);
+    REQUIRE(decoded->masa == vrata.masa);
+    REQUIRE(decoded->paksha == vrata.paksha);
+    REQUIRE(decoded->paran.type == vrata.paran.type);
+    REQUIRE(decoded->paran.paran_start == vrata.paran.paran_start);
+    REQUIRE(decoded->paran.paran_end == vrata.paran.paran_end);
+    REQUIRE(decoded->paran.paran_limit == vrata.paran.paran_limit);
+    REQUIRE(decoded->paran.time_zone == vrata.paran.time_zone);
+    REQUIRE(decoded->location == vrata.location);
+    REQUIRE(decoded->location.country == vrata.location.country);
+    REQUIRE(decoded->location.latitude_adjusted);
+    REQUIRE(decoded->location_name() == vrata.location_name());
+    REQUIRE(decoded->times.ekadashi_start == vrata.times.ekadashi_start);
+    REQUIRE(decoded->times.trayodashi_start == vrata.times.trayodashi_start);
+    REQUIRE(decoded->sunrise0 == vrata.sunrise0);
+    REQUIRE(decoded->sunrise1 == vrata.sunrise1);
+    REQUIRE(decoded->sunset3 == vrata.sunset3);
+    REQUIRE(decoded->dates_for_this_paksha == vrata.dates_for_this_paksha);
+    REQUIRE(fmt::to_string(*decoded) == fmt::to_string(vrata));
+}
+
+TEST_CASE("Vrata calculation error survives binary round-trip") {
+    const MaybeVrata error = tl::make_unexpected(CantFindLocation{"Atlantis"});
+    const auto decoded = round_trip(error);
+    REQUIRE_FALSE(decoded.has_value());
+    REQUIRE(std::holds_alternative<CantFindLocation>(decoded.error()));
+    REQUIRE(std::get<CantFindLocation>(decoded.error()).location_name == "Atlantis");
+}
@@ -39,14 +39,14 @@ struct fmt::formatter<vp::Vrata_Summary> : fmt::formatter<std::string_view> {
             fmt::format_to(ctx.out(), FMT_STRING("<p>{} {} on <span class=\"date paran\">{}</span> <span class=\"weekday\">({:w})</span></p>\n"), vs.vrata->ekadashi_name(), vs.vrata->type, date, date);
         }
         if (const auto harivasara=vs.vrata->harivasara(); harivasara) {
-            const auto harivasara_str = date::format("%H:%M on <small>%Y-%m-%d</small>", date::floor<std::chrono::minutes>(harivasara->as_zoned_time(vs.vrata->paran.time_zone).get_local_time()));
-            fmt::format_to(ctx.out(), FMT_STRING("<p>Harivāsara starts at {}</p>\n"), harivasara_str);
+            const auto harivasara_local = date::floor<std::chrono::minutes>(harivasara->as_local_time(vs.vrata->paran.time_zone));
+            fmt::format_to(ctx.out(), FMT_STRING("<p>Harivāsara starts at {:%H:%M on <small>%Y-%m-%d</small>}</p>\n"), harivasara_local);
         }
         const auto paran_date = date::year_month_day{vs.vrata->local_paran_date()}; // year_month_day to ensure proper formatting, wihout hours, minutes and seconds
         fmt::format_to(ctx.out(), FMT_STRING(R"(<p class="paran">Pāraṇam: {} <span class="paran-range">{}–{})"), paran_date, vs.vrata->paran.start_str(), vs.vrata->paran.end_str());
         if (vs.vrata->paran.paran_limit) {
-            const auto limit_str = date::format("%H:%M", date::floor<std::chrono::minutes>(vs.vrata->paran.paran_limit->as_zoned_time(vs.vrata->paran.time_zone).get_local_time()));
-            fmt::format_to(ctx.out(), FMT_STRING(" (&lt;{})"), limit_str);
+            const auto limit = date::floor<std::chrono::minutes>(vs.vrata->paran.paran_limit->as_local_time(vs.vrata->paran.time_zone));
+            fmt::format_to(ctx.out(), FMT_STRING(" (&lt;{:%H:%M})"), limit);
         }
         fmt::format_to(ctx.out(), FMT_STRING("</span><br>"));
         fmt::format_to(ctx.out(), FMT_STRING(R"(<span class="paran-type">{}</span></p>)"), vs.vrata->paran.type);
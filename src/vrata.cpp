@@ -293,7 +293,7 @@ bool VratasForDate::all_from_same_ekadashi() const
     return length <= date::days{2};
 }
 
-date::local_days VratasForDate::guess_start_date_for_next_ekadashi(date::local_days current_start_date)
+date::local_days VratasForDate::guess_start_date_for_next_ekadashi(date::local_days current_start_date) const
 {
     auto l_max_date = max_date();
     if (!l_max_date) {
@@ -302,7 +302,7 @@ date::local_days VratasForDate::guess_start_date_for_next_ekadashi(date::local_d
     return *l_max_date + date::days{1};
 }
 
-date::local_days VratasForDate::guess_start_date_for_prev_ekadashi(date::local_days current_start_date)
+date::local_days VratasForDate::guess_start_date_for_prev_ekadashi(date::local_days current_start_date) const
 {
     auto l_min_date = min_date();
     if (!l_min_date) {
@@ -167,8 +167,8 @@ public:
     // true if all vratas in the set are within 1 day from one another.
     bool all_from_same_ekadashi() const;
 
-    date::local_days guess_start_date_for_next_ekadashi(date::local_days current_start_date);
-    date::local_days guess_start_date_for_prev_ekadashi(date::local_days current_start_date);
+    date::local_days guess_start_date_for_next_ekadashi(date::local_days current_start_date) const;
+    date::local_days guess_start_date_for_prev_ekadashi(date::local_days current_start_date) const;
 
     MinMaxDate minmax_date() const;
     std::optional<date::local_days> min_date() const;
@@ -0,0 +1,61 @@
+#include "year-calendar.h"
+
+#include <algorithm>
+
+namespace vp {
+
+std::vector<VratasForDate> group_by_paksha(std::vector<Batch_Entry> entries, std::vector<Batch_Entry> & errors)
+{
+    const auto first_error = std::stable_partition(entries.begin(), entries.end(), [](const Batch_Entry & entry) {
+        return entry.vrata.has_value();
+    });
+    std::move(first_error, entries.end(), std::back_inserter(errors));
+    entries.erase(first_error, entries.end());
+
+    // Same ekādaśī is never more than 2 days apart between locations
+    // (see VratasForDate::all_from_same_ekadashi()), and neighbouring ekādaśīs
+    // are at least ~13 days apart, so sorting by date and cutting on gaps is enough.
+    std::stable_sort(entries.begin(), entries.end(), [](const Batch_Entry & left, const Batch_Entry & right) {
+        return left.vrata->date < right.vrata->date;
+    });
+    std::vector<VratasForDate> pakshas;
+    auto group_start = entries.begin();
+    while (group_start != entries.end()) {
+        const auto first_date = group_start->vrata->date;
+        const auto group_end = std::find_if(group_start, entries.end(), [first_date](const Batch_Entry & entry) {
+            return entry.vrata->date - first_date > date::days{3};
+        });
+        std::stable_sort(group_start, group_end, [](const Batch_Entry & left, const Batch_Entry & right) {
+            return left.location_index < right.location_index;
+        });
+        VratasForDate & vratas = pakshas.emplace_back();
+        for (auto it = group_start; it != group_end; ++it) {
+            vratas.push_back(std::move(it->vrata));
+        }
+        group_start = group_end;
+    }
+    return pakshas;
+}
+
+Year_Calendar calc_year(const Year_Request & request)
+{
+    Batch_Request batch;
+    batch.from = date::local_days{request.year / date::January / 1};
+    batch.to = date::local_days{(request.year + date::years{1}) / date::January / 1};
+    batch.locations = request.locations;
+    batch.flags = request.flags;
+    batch.workers = request.workers;
+    // Single shard per location: every vrata search starts right after the previous vrata.
+    batch.shard_length = batch.to - batch.from;
+
+    auto result = batch_calc(batch);
+
+    Year_Calendar calendar;
+    calendar.pakshas = group_by_paksha(std::move(result.entries), calendar.errors);
+    calendar.failures = std::move(result.failures);
+    calendar.workers = std::move(result.workers);
+    calendar.seconds = result.seconds;
+    return calendar;
+}
+
+} // namespace vp
@@ -0,0 +1,44 @@
+#ifndef VP_YEAR_CALENDAR_H
+#define VP_YEAR_CALENDAR_H
+
+#include "batch-calc.h"
+
+#include <vector>
+
+namespace vp {
+
+/*
+ * All vratas of a calendar year for a set of locations, grouped by pakṣa.
+ *
+ * Each location is walked from one vrata to the next through the whole
+ * year (one batch_calc() shard per location), so there are no per-pakṣa
+ * base date guesses and no retries when locations disagree on which
+ * ekādaśī is "next".
+ */
+struct Year_Request {
+    date::year year;
+    std::vector<Location> locations;
+    CalcFlags flags = CalcFlags::Default;
+    unsigned workers = Process_Pool::default_worker_count();
+};
+
+struct Year_Calendar {
+    // One entry per ekādaśī, ordered by date. Vratas inside each are in
+    // the order of Year_Request::locations (locations without this vrata are skipped).
+    std::vector<VratasForDate> pakshas;
+    // Vratas which couldn't be calculated; their dates are unknown so they don't belong to any paksha.
+    std::vector<Batch_Entry> errors;
+    std::vector<Batch_Failure> failures;
+    std::vector<Batch_Worker_Summary> workers;
+    double seconds = 0.0;
+};
+
+Year_Calendar calc_year(const Year_Request & request);
+
+// Split (location, vrata) entries into groups of the same ekādaśī.
+// Entries with errors are moved to errors.
+std::vector<VratasForDate> group_by_paksha(std::vector<Batch_Entry> entries, std::vector<Batch_Entry> & errors);
+
+} // namespace vp
+
+#endif // VP_YEAR_CALENDAR_H
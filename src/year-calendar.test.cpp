@@ -0,0 +1,42 @@
+#include "year-calendar.h"
+
+#include "catch-formatters.h"
+
+using namespace date;
+using namespace vp;
+
+namespace {
+Batch_Entry entry(std::size_t location_index, date::year_month_day ymd, Chandra_Masa masa, Paksha paksha) {
+    return Batch_Entry{location_index, Vrata{date::local_days{ymd}, masa, paksha}};
+}
+}
+
+TEST_CASE("group_by_paksha splits entries on date gaps and orders each group by location") {
+    std::vector<Batch_Entry> entries;
+    // as batch_calc() returns them: by location, then by date
+    entries.push_back(entry(0, 2021_y/January/9, Chandra_Masa::Pausha, Paksha::Krishna));
+    entries.push_back(entry(0, 2021_y/January/24, Chandra_Masa::Pausha, Paksha::Shukla));
+    entries.push_back(entry(1, 2021_y/January/8, Chandra_Masa::Pausha, Paksha::Krishna));
+    entries.push_back(Batch_Entry{1, tl::make_unexpected(CantFindLocation{"test"})});
+    entries.push_back(entry(2, 2021_y/January/9, Chandra_Masa::Pausha, Paksha::Krishna));
+    entries.push_back(entry(2, 2021_y/January/25, Chandra_Masa::Pausha, Paksha::Shukla));
+
+    std::vector<Batch_Entry> errors;
+    const auto pakshas = group_by_paksha(std::move(entries), errors);
+
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].location_index == 1);
+    REQUIRE(pakshas.size() == 2);
+    REQUIRE(pakshas[0].size() == 3);
+    REQUIRE(pakshas[1].size() == 2);
+    std::vector<date::local_days> first_dates;
+    for (const auto & vrata : pakshas[0]) first_dates.push_back(vrata->date);
+    REQUIRE(first_dates == std::vector<date::local_days>{local_days{2021_y/January/9}, local_days{2021_y/January/8}, local_days{2021_y/January/9}});
+    for (const auto & vrata : pakshas[1]) REQUIRE(vrata->paksha == Paksha::Shukla);
+}
+
+TEST_CASE("group_by_paksha handles empty input") {
+    std::vector<Batch_Entry> errors;
+    REQUIRE(group_by_paksha({}, errors).empty());
+    REQUIRE(errors.empty());
+}
@@ -0,0 +1,28 @@
+#ifndef TEMP_DIR_H
+#define TEMP_DIR_H
+
+#include "disk-cache.h"
+#include "filesystem-fixed.h"
+#include "fmt-format-fixed.h"
+
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+#include <system_error>
+
+// Fresh empty directory, removed at the end of the test.
+struct Temp_Dir {
+    fs::path path;
+    explicit Temp_Dir(std::string_view name)
+        : path(fs::temp_directory_path() / fmt::format("vp-{}-{:016x}", name, vp::fnv1a_64(name, static_cast<std::uint64_t>(std::time(nullptr)))))
+    {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~Temp_Dir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+#endif // TEMP_DIR_H
@@ -2,6 +2,9 @@
 
 #include "catch-formatters.h"
 
+#include <chrono>
+#include <string>
+
 using namespace date;
 
 TEST_CASE("Date keeps year, month and day") {
@@ -40,6 +43,39 @@ TEST_CASE("can print local_time with fmt") {
     REQUIRE(fmt::to_string(t) == "0020-06-07 05:00:00.000000");
 }
 
+TEST_CASE("can print local_time with strftime-like format spec") {
+    using namespace std::chrono_literals;
+    const auto t = date::local_time<std::chrono::seconds>(date::local_days{2021_y/February/3} + 6h + 7min + 8s);
+    REQUIRE(fmt::format("{:%H:%M}", t) == "06:07");
+    REQUIRE(fmt::format("{:%H:%M:%S}", t) == "06:07:08");
+    REQUIRE(fmt::format("{:%d.%m}", date::floor<date::days>(t)) == "03.02");
+    REQUIRE(fmt::format("HV > {:%H:%M on <small>%Y-%m-%d</small>}", t) == "HV > 06:07 on <small>2021-02-03</small>");
+    REQUIRE(fmt::format("{:100%%}", t) == "100%");
+    REQUIRE(fmt::format("{:%Y}", date::local_days{20_y/June/7}) == "0020");
+    // fractions are dropped, like date::format() does for whole minutes and seconds
+    REQUIRE(fmt::format("{:%H:%M:%S}", date::local_time<std::chrono::milliseconds>{t} + 999ms) == "06:07:08");
+    REQUIRE_THROWS_AS(fmt::format(fmt::runtime("{:%H:%M %Z}"), t), fmt::format_error);
+}
+
+TEST_CASE("vp::format_local_time() writes by a spec given at run time") {
+    using namespace std::chrono_literals;
+    const auto t = date::local_time<std::chrono::seconds>(date::local_days{2021_y/February/3} + 6h + 7min + 8s);
+    fmt::memory_buffer buf;
+    vp::format_local_time(fmt::appender{buf}, t, "%d.%m.%Y %H:%M:%S 100%%");
+    REQUIRE(fmt::to_string(buf) == "03.02.2021 06:07:08 100%");
+    REQUIRE_THROWS_AS(vp::format_local_time(fmt::appender{buf}, t, "%H:%M %Z"), fmt::format_error);
+    REQUIRE_THROWS_AS(vp::format_local_time(fmt::appender{buf}, t, "%H:%"), fmt::format_error);
+}
+
+TEST_CASE("local_time format spec gives the same as date::format()") {
+    using namespace std::chrono_literals;
+    for (auto t = date::local_seconds{date::local_days{1899_y/December/30}}; t < date::local_days{2101_y/January/1}; t += date::days{17} + 3h + 11min + 13s) {
+        CAPTURE(fmt::to_string(t));
+        REQUIRE(fmt::format("{:%H:%M:%S}", t) == date::format("%H:%M:%S", t));
+        REQUIRE(fmt::format("{:%H:%M on %Y-%m-%d}", date::floor<std::chrono::minutes>(t)) == date::format("%H:%M on %Y-%m-%d", date::floor<std::chrono::minutes>(t)));
+    }
+}
+
 TEST_CASE("can format as local date (russian pre-reform locale)") {
     REQUIRE("January 6" == fmt::format("{:l}", 2020_y/January/6));
 }
@@ -9,8 +9,8 @@ using namespace date::literals;
 using namespace std::chrono_literals;
 
 namespace {
-template <class Duration>
-bool operator==(const date::zoned_time<Duration> & left, std::chrono::minutes right) {
+template <class Duration, class TimeZonePtr>
+bool operator==(const date::zoned_time<Duration, TimeZonePtr> & left, std::chrono::minutes right) {
     const auto rounded = date::round<std::chrono::minutes>(left.get_local_time());
     return date::format("%H:%M", rounded) == date::format("%H:%M", right);
 }
@@ -45,8 +45,8 @@ TEST_CASE("compare sunrises with Palimaru 2020 panchangams") {
             int num_fails = 0;
             double sum_distance = 0;
             const auto check_sunrise_sunset = [&swe, &num_fails, &sum_distance](date::year_month_day date, std::chrono::minutes expected_sunrise, std::chrono::minutes expected_sunset) {
-                const auto sunrise = swe.find_sunrise_v(vp::JulDays_UT{date}).as_zoned_time(date::locate_zone("Asia/Kolkata"));
-                const auto sunset = swe.find_sunset_v(vp::JulDays_UT{date}).as_zoned_time(date::locate_zone("Asia/Kolkata"));
+                const auto sunrise = swe.find_sunrise_v(vp::JulDays_UT{date}).as_zoned_time(vp::locate_time_zone("Asia/Kolkata"));
+                const auto sunset = swe.find_sunset_v(vp::JulDays_UT{date}).as_zoned_time(vp::locate_time_zone("Asia/Kolkata"));
                 const auto expected_local_sunrise = date::local_days{date} + expected_sunrise;
                 const auto expected_local_sunset = date::local_days{date} + expected_sunset;
                 const auto delta_sunrise = (sunrise.get_local_time() - expected_local_sunrise).count();
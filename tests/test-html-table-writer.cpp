@@ -0,0 +1,141 @@
+#include "catch-formatters.h"
+
+#include "html-table-writer.h"
+#include "html-util.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Html_Table_Writer against a reference writer which streams the table
+ * piece by piece into std::ostream.
+ */
+
+namespace {
+
+struct Reference_Writer : vp::Table::CallBack {
+    std::ostream & s_;
+    const vp::Table & table_;
+    std::vector<bool> width_written_for_column;
+    Reference_Writer(std::ostream & s, const vp::Table & table) : s_(s), table_(table) {
+        width_written_for_column.resize(table.width());
+    }
+    void write_classes(vp::Css_Classes classes) {
+        if (classes.empty()) return;
+        s_ << " class=\"";
+        bool first = true;
+        classes.for_each_name([&](std::string_view name) {
+            if (!first) s_ << ' ';
+            s_ << name;
+            first = false;
+        });
+        s_ << "\"";
+    }
+    void row_begin(vp::Css_Classes classes) override {
+        s_ << "<tr";
+        write_classes(classes);
+        s_ << ">";
+    }
+    void row_end() override {
+        s_ << "</tr>\n";
+    }
+    void write_col_width_if_needed(const vp::Table::Cell & cell) {
+        if (width_written_for_column[cell.col]) {
+            return;
+        }
+        auto & col_widths = table_.column_widths();
+        if (col_widths.size() >= cell.col+1) {
+            s_ << " width=\"" << col_widths[cell.col] << "%\"";
+        }
+        width_written_for_column[cell.col] = true;
+    }
+    void write_td_or_th(const vp::Table::Cell & cell, std::string_view tag) {
+        s_ << "<" << tag;
+        if (cell.rowspan != 1) {
+            s_ << " rowspan=\"" << cell.rowspan << "\"";
+        }
+        if (cell.colspan != 1) {
+            s_ << " colspan=\"" << cell.colspan << "\"";
+        } else {
+            write_col_width_if_needed(cell);
+        }
+        write_classes(cell.classes);
+        if (!cell.title().empty()) {
+            s_ << " title=\"" << html::escape_attribute(cell.title()) << "\"";
+        }
+        s_ << ">" << cell.text() << "</" << tag << ">\n";
+    }
+    void cell(const vp::Table::Cell & cell) override {
+        write_td_or_th(cell, "td");
+    }
+    void header_cell(const vp::Table::Cell & cell) override {
+        write_td_or_th(cell, "th");
+    }
+};
+
+std::string reference_html(const vp::Table & table) {
+    std::ostringstream s;
+    s << "<table>\n";
+    {
+        Reference_Writer writer{s, table};
+        table.iterate(writer);
+    }
+    s << "</table>\n";
+    return s.str();
+}
+
+// Laid out like Table_Calendar_Generator's tables: a header row, location
+// columns with titles, and date columns with runs of repeated vrata texts.
+vp::Table synthetic_calendar(std::size_t locations, std::size_t dates, unsigned seed) {
+    std::mt19937 random{seed};
+    const std::vector<std::string> vrata_texts{
+        "<a href=\"#Kiev\">Ekādaśī</a>", "<a href=\"#Kiev\">Atiriktā Ekādaśī</a>", "*", "&gt;06:50", "06:50-10:20", ""
+    };
+    vp::Table table;
+    table.start_new_row();
+    table.add_header_cell("");
+    table.add_header_cell("");
+    table.add_header_cell("");
+    for (std::size_t d = 0; d < dates; ++d) table.add_header_cell(fmt::format("{} Nov", d + 1), vp::css::mainpart);
+    for (std::size_t l = 0; l < locations; ++l) {
+        if (l % 50 == 0) table.start_new_row(vp::css::separator);
+        table.start_new_row();
+        table.add_cell(fmt::format("+{}:00", l / 10));
+        table.add_cell(fmt::format("Country {}", l / 5));
+        table.add_cell(fmt::format(R"(<a href="#Location {0}">Location {0}</a>)", l)).set_title(fmt::format("Timezone: Zone/{}\n\"quoted\" & <more>", l / 10));
+        for (std::size_t d = 0; d < dates; ++d) {
+            const auto & text = vrata_texts[(l / (1 + random() % 8) + d) % vrata_texts.size()];
+            if (text.empty()) {
+                table.add_unmergeable_cell("", vp::css::mainpart);
+            } else {
+                table.add_cell(text, {vp::css::mainpart, vp::css::vrata});
+            }
+        }
+    }
+    table.merge_cells_into_rowspans();
+    table.merge_cells_into_colspans();
+    table.add_even_odd_classes_for_col(0);
+    table.add_even_odd_classes_for_col(1, vp::Table::StartFrom::Even);
+    std::vector<double> widths{5.0, 10.0, 100.0 / 7};
+    for (std::size_t d = 0; d < dates; ++d) widths.push_back(70.0 / static_cast<double>(dates));
+    table.set_column_widths(widths);
+    return table;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Html_Table_Writer writes the same HTML as the std::ostream writer did") {
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        CAPTURE(seed);
+        const auto table = synthetic_calendar(120, 17, seed);
+        fmt::memory_buffer buf;
+        vp::Html_Table_Writer{table}.write(buf);
+        REQUIRE(fmt::to_string(buf) == reference_html(table));
+
+        std::string chunked;
+        vp::Html_Table_Writer{table}.write([&](std::string_view data) { chunked += data; });
+        REQUIRE(chunked == fmt::to_string(buf));
+    }
+}
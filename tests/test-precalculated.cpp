@@ -132,15 +132,15 @@ struct Paranam {
         Seconds
     };
 
-    std::optional<date::zoned_seconds> start;
-    std::optional<date::zoned_seconds> end;
+    std::optional<vp::Zoned_Time> start;
+    std::optional<vp::Zoned_Time> end;
     Precision precision;
-    Paranam(std::optional<date::zoned_seconds> start_ = std::nullopt, std::optional<date::zoned_seconds> end_ = std::nullopt, Precision precision_ = Precision::Minutes)
+    Paranam(std::optional<vp::Zoned_Time> start_ = std::nullopt, std::optional<vp::Zoned_Time> end_ = std::nullopt, Precision precision_ = Precision::Minutes)
         : start(start_), end(end_), precision(precision_)
     {}
 };
 
-bool time_equals(const std::optional<date::zoned_seconds> & t1, const std::optional<date::zoned_seconds> & t2) {
+bool time_equals(const std::optional<vp::Zoned_Time> & t1, const std::optional<vp::Zoned_Time> & t2) {
     if (t1.has_value() != t2.has_value()) return false;
     if (!t1 && !t2) return true;
     return t1->get_sys_time() == t2->get_sys_time();
@@ -339,7 +339,7 @@ TEST_CASE("h_m_from_string works for basic cases") {
 
 Paranam parse_precalc_paranam(const std::string & s,
                               date::year_month_day date,
-                              const date::time_zone *time_zone)
+                              const vp::Time_Zone *time_zone)
 {
     std::smatch match;
     // "*" alone or "*;" followed by other descriptions.
@@ -732,14 +732,14 @@ using FixVariant = std::variant<
 using Fixes = std::map<vp::Location, std::vector<FixVariant>>;
 
 /* Make time nullopt provided that it's old value matches the expected */
-void remove_time(std::optional<date::zoned_seconds> & time, std::optional<date::zoned_seconds> expected) {
+void remove_time(std::optional<vp::Zoned_Time> & time, std::optional<vp::Zoned_Time> expected) {
     if (time != expected) {
         throw std::runtime_error(fmt::format("can't remove {} in {}: HH:MM:SS do not match", expected, time));
     }
     time = std::nullopt;
 }
 
-void replace_time(std::optional<date::zoned_seconds> & time, std::optional<date::zoned_seconds> expected, date::zoned_seconds new_time) {
+void replace_time(std::optional<vp::Zoned_Time> & time, std::optional<vp::Zoned_Time> expected, vp::Zoned_Time new_time) {
     if (time != expected) {
         throw std::runtime_error(fmt::format("can't replace {}=>{} in {}: HH:MM:SS do not match",
                                              expected, new_time, time));
@@ -747,7 +747,7 @@ void replace_time(std::optional<date::zoned_seconds> & time, std::optional<date:
     time = new_time;
 }
 
-void shift_time_if_exists(std::optional<date::zoned_seconds> & time, const std::chrono::seconds & shift_by) {
+void shift_time_if_exists(std::optional<vp::Zoned_Time> & time, const std::chrono::seconds & shift_by) {
     if (!time) return;
     auto time_zone = time->get_time_zone();
     *time = date::make_zoned(time_zone, time->get_local_time() + shift_by);
@@ -766,11 +766,11 @@ struct VrataFixer {
     void operator()(const FixShiftStartTime & fix) {
         shift_time_if_exists(vrata.paranam.start, fix.s);
     }
-    date::zoned_seconds local_paran_hms_to_zone(const date::time_zone * time_zone, date::local_days date, std::chrono::seconds hms) {
+    vp::Zoned_Time local_paran_hms_to_zone(const vp::Time_Zone * time_zone, date::local_days date, std::chrono::seconds hms) {
         auto local = date + hms;
         return date::make_zoned(time_zone, local);
     }
-    std::optional<date::zoned_seconds> replace_hms(std::optional<date::zoned_seconds> zoned, std::optional<std::chrono::seconds> hms) {
+    std::optional<vp::Zoned_Time> replace_hms(std::optional<vp::Zoned_Time> zoned, std::optional<std::chrono::seconds> hms) {
         if (zoned.has_value() != hms.has_value()) {
             std::optional<date::hh_mm_ss<std::chrono::seconds>> hms_for_printing{hms};
             throw std::runtime_error(fmt::format("can't replace hms part of '{}' with '{}': one of them doesn't exist", zoned, hms_for_printing));
@@ -0,0 +1,93 @@
+#include "catch-formatters.h"
+
+#include "table.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Allocation-count benchmark for vp::Table: global operator new is replaced
+ * (for the whole test binary, it only counts) and a calendar-sized table is
+ * built and merged the way Table_Calendar_Generator does it.
+ *
+ * Run with "test-main [allocations] -s" to see the numbers.
+ */
+
+namespace {
+std::atomic<std::size_t> allocation_count{0};
+}
+
+void * operator new(std::size_t size) {
+    ++allocation_count;
+    if (void * p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+
+TEST_CASE("building and merging a calendar-sized Table allocates per distinct string, not per cell", "[allocations]") {
+    constexpr std::size_t location_count = 150;
+    constexpr std::size_t date_count = 20;
+
+    // all strings are made up front: the caller's formatting is not what's measured
+    std::vector<std::string> headers;
+    for (std::size_t d = 0; d < date_count; ++d) headers.push_back(fmt::format("{} Nov", d + 1));
+    std::vector<std::string> utc_offsets;
+    std::vector<std::string> countries;
+    std::vector<std::string> names;
+    std::vector<std::string> titles;
+    for (std::size_t l = 0; l < location_count; ++l) {
+        utc_offsets.push_back(fmt::format("+{}:00", l / 10));
+        countries.push_back(fmt::format("Country {}", l / 5));
+        names.push_back(fmt::format(R"(<a href="#Location {0}">Location {0}</a>)", l));
+        titles.push_back(fmt::format("Timezone: Zone/{}", l / 10));
+    }
+    const std::vector<std::string> vrata_texts{
+        "<a href=\"#\">Ekādaśī</a>", "<a href=\"#\">Atiriktā Ekādaśī</a>", "*", "&gt;06:50", "06:50-10:20", "Pūrṇimā"
+    };
+
+    std::set<std::string> distinct{headers.begin(), headers.end()};
+    distinct.insert(utc_offsets.begin(), utc_offsets.end());
+    distinct.insert(countries.begin(), countries.end());
+    distinct.insert(names.begin(), names.end());
+    distinct.insert(titles.begin(), titles.end());
+    distinct.insert(vrata_texts.begin(), vrata_texts.end());
+
+    const auto before = allocation_count.load();
+    vp::Table table;
+    table.start_new_row();
+    table.add_header_cell("");
+    table.add_header_cell("");
+    table.add_header_cell("");
+    for (const auto & header : headers) table.add_header_cell(header, vp::css::mainpart);
+    for (std::size_t l = 0; l < location_count; ++l) {
+        if (l % 50 == 0) table.start_new_row(vp::css::separator);
+        table.start_new_row(l % 2 ? vp::css::odd : vp::css::even);
+        table.add_cell(utc_offsets[l]);
+        table.add_cell(countries[l]);
+        table.add_cell(names[l]).set_title(titles[l]);
+        for (std::size_t d = 0; d < date_count; ++d) {
+            if ((l / 7 + d) % 3 == 0) {
+                table.add_cell(vrata_texts[(l / 7 + d) % vrata_texts.size()], {vp::css::mainpart, vp::css::vrata});
+            } else {
+                table.add_unmergeable_cell("", vp::css::mainpart);
+            }
+        }
+    }
+    table.merge_cells_into_rowspans();
+    table.merge_cells_into_colspans();
+    table.add_even_odd_classes_for_col(0);
+    table.add_even_odd_classes_for_col(1, vp::Table::StartFrom::Even);
+    const auto allocations = allocation_count.load() - before;
+
+    const auto cell_count = (location_count + 1) * (3 + date_count);
+    CAPTURE(cell_count, distinct.size(), table.interned_string_count());
+    REQUIRE(table.interned_string_count() <= distinct.size());
+    // one per distinct string (hash set node) plus amortized growth of the pool, hash set and cell and row vectors
+    REQUIRE(allocations < distinct.size() + 100);
+    REQUIRE(allocations < cell_count / 4);
+}
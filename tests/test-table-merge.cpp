@@ -0,0 +1,142 @@
+#include "catch-formatters.h"
+
+#include "table.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Table::merge_cells_into_rowspans() and merge_cells_into_colspans() against
+ * a straightforward reference which compares full texts of every adjacent
+ * pair of cells, kept as std::strings.
+ */
+
+namespace {
+
+struct Reference_Cell {
+    std::string text;
+    bool header = false;
+    bool mergeable = true;
+    std::size_t rowspan = 1;
+    std::size_t colspan = 1;
+};
+
+using Reference_Table = std::vector<std::vector<Reference_Cell>>;
+
+bool reference_mergeable(const Reference_Cell & c1, const Reference_Cell & c2) {
+    return c1.mergeable && c2.mergeable && c1.header == c2.header && c1.text == c2.text;
+}
+
+bool reference_has_cell(const Reference_Table & t, std::size_t row, std::size_t col) {
+    return row < t.size() && col < t[row].size();
+}
+
+void reference_add_row_span(Reference_Table & t, std::size_t cell_row, std::size_t col, std::size_t overall_span_size) {
+    constexpr std::size_t max_span_size = 12;
+    if (overall_span_size < max_span_size) {
+        t[cell_row][col].rowspan = overall_span_size;
+        return;
+    }
+    std::size_t num_sections = (overall_span_size + max_span_size - 1) / max_span_size;
+    std::size_t section_size = (overall_span_size + num_sections - 1) / num_sections;
+    std::size_t first_row_after_span = cell_row + overall_span_size;
+    for (std::size_t row = cell_row; row < first_row_after_span; row += section_size) {
+        t[row][col].rowspan = std::min(section_size, first_row_after_span - row);
+    }
+}
+
+void reference_merge(Reference_Table & t) {
+    std::size_t width = 0;
+    for (const auto & row : t) width = std::max(width, row.size());
+    if (t.size() >= 2) {
+        for (std::size_t col = 0; col < width; ++col) {
+            std::size_t span_size = 1;
+            for (std::size_t row = t.size()-1; row > 0; --row) {
+                if (!reference_has_cell(t, row, col)) continue;
+                if (reference_has_cell(t, row-1, col) && reference_mergeable(t[row][col], t[row-1][col])) {
+                    ++span_size;
+                    t[row][col].rowspan = 0;
+                } else {
+                    reference_add_row_span(t, row, col, span_size);
+                    span_size = 1;
+                }
+            }
+            if (reference_has_cell(t, 0, col)) {
+                reference_add_row_span(t, 0, col, span_size);
+            }
+        }
+    }
+    for (auto & row : t) {
+        if (row.size() < 2) continue;
+        std::size_t span_size = 1;
+        for (std::size_t col = row.size()-1; col > 0; --col) {
+            if (reference_mergeable(row[col], row[col-1])) {
+                ++span_size;
+                row[col].colspan = 0;
+            } else {
+                row[col].colspan = span_size;
+                span_size = 1;
+            }
+        }
+        row[0].colspan = span_size;
+    }
+}
+
+// Rows of varying length with runs of repeated long texts, like multi-year
+// calendars with paran cells, plus some headers and unmergeable cells.
+Reference_Table synthetic_table(std::size_t rows, std::size_t cols, unsigned seed) {
+    std::mt19937 random{seed};
+    const std::string long_text(300, 'x');
+    Reference_Table t(rows);
+    for (std::size_t row = 0; row < rows; ++row) {
+        const auto length = random() % 8 == 0 ? cols - random() % cols : cols;
+        for (std::size_t col = 0; col < length; ++col) {
+            Reference_Cell cell;
+            // runs: the same text for a few rows and columns in a row
+            cell.text = fmt::format("{}{}", long_text, (row / (1 + random() % 16)) * 7 + col / (1 + random() % 3));
+            cell.header = row % 1000 == 0;
+            cell.mergeable = cell.header || random() % 10 != 0; // header cells are always mergeable
+            t[row].push_back(std::move(cell));
+        }
+    }
+    return t;
+}
+
+vp::Table to_table(const Reference_Table & t) {
+    vp::Table table;
+    for (const auto & row : t) {
+        table.start_new_row();
+        for (const auto & cell : row) {
+            if (cell.header) {
+                table.add_header_cell(cell.text);
+            } else if (cell.mergeable) {
+                table.add_cell(cell.text);
+            } else {
+                table.add_unmergeable_cell(cell.text);
+            }
+        }
+    }
+    return table;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Table merges cells into the same spans as the straightforward algorithm") {
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        CAPTURE(seed);
+        auto reference = synthetic_table(200, 12, seed);
+        auto table = to_table(reference);
+        reference_merge(reference);
+        table.merge_cells_into_rowspans();
+        table.merge_cells_into_colspans();
+        for (std::size_t row = 0; row < reference.size(); ++row) {
+            for (std::size_t col = 0; col < reference[row].size(); ++col) {
+                CAPTURE(row, col);
+                REQUIRE(table.at(row, col).rowspan == reference[row][col].rowspan);
+                REQUIRE(table.at(row, col).colspan == reference[row][col].colspan);
+            }
+        }
+    }
+}